@@ -0,0 +1,27 @@
+#ifndef BENCH_CTD_H
+#define BENCH_CTD_H
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+static inline uint64_t bench_now_ns()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000u + (uint64_t)time.tv_nsec;
+}
+
+/*
+ * Times a single call of bench_<method_name>(__VA_ARGS__) and prints how long it took next to label.
+ * The benchmarked function returns a value that is accumulated into bench_sink so the work can't be optimized out.
+ */
+#define RUN_BENCH(method_name, label, bench_sink, ...)                                                                 \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        uint64_t _bench_start = bench_now_ns();                                                                        \
+        bench_sink += bench_##method_name(__VA_ARGS__);                                                                \
+        uint64_t _bench_elapsed = bench_now_ns() - _bench_start;                                                       \
+        printf("%-28s %-32s %12.3f ms\n", #method_name, label, (double)_bench_elapsed / 1e6);                          \
+    } while (0)
+
+#endif // BENCH_CTD_H
@@ -0,0 +1,6 @@
+#ifndef BENCH_CTD_MULTI_MATCHER_H
+#define BENCH_CTD_MULTI_MATCHER_H
+
+void bench_ctd_multi_matcher_functions();
+
+#endif // BENCH_CTD_MULTI_MATCHER_H
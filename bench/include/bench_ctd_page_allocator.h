@@ -0,0 +1,6 @@
+#ifndef BENCH_CTD_PAGE_ALLOCATOR_H
+#define BENCH_CTD_PAGE_ALLOCATOR_H
+
+void bench_ctd_page_allocator_functions();
+
+#endif // BENCH_CTD_PAGE_ALLOCATOR_H
@@ -0,0 +1,6 @@
+#ifndef BENCH_CTD_SCRUB_H
+#define BENCH_CTD_SCRUB_H
+
+void bench_ctd_scrub_functions();
+
+#endif // BENCH_CTD_SCRUB_H
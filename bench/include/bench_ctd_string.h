@@ -0,0 +1,6 @@
+#ifndef BENCH_CTD_STRING_H
+#define BENCH_CTD_STRING_H
+
+void bench_ctd_string_functions();
+
+#endif // BENCH_CTD_STRING_H
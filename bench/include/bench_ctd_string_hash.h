@@ -0,0 +1,6 @@
+#ifndef BENCH_CTD_STRING_HASH_H
+#define BENCH_CTD_STRING_HASH_H
+
+void bench_ctd_string_hash_functions();
+
+#endif // BENCH_CTD_STRING_HASH_H
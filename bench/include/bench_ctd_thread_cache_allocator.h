@@ -0,0 +1,6 @@
+#ifndef BENCH_CTD_THREAD_CACHE_ALLOCATOR_H
+#define BENCH_CTD_THREAD_CACHE_ALLOCATOR_H
+
+void bench_ctd_thread_cache_allocator_functions();
+
+#endif // BENCH_CTD_THREAD_CACHE_ALLOCATOR_H
@@ -0,0 +1,6 @@
+#ifndef BENCH_CTD_VIRTUAL_ARENA_ALLOCATOR_H
+#define BENCH_CTD_VIRTUAL_ARENA_ALLOCATOR_H
+
+void bench_ctd_virtual_arena_allocator_functions();
+
+#endif // BENCH_CTD_VIRTUAL_ARENA_ALLOCATOR_H
@@ -0,0 +1,42 @@
+#ifndef BENCH_REPLAY_H
+#define BENCH_REPLAY_H
+#include <ctd_allocator.h>
+#include <ctd_error.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Results of replaying a trace against an allocator.
+ *
+ * peak_rss_bytes is how far the process' resident set grew above where it was when the replay started, sampled between
+ * batches of records. fragmentation divides it by peak_bytes_live, so 1.0 means the allocator needed no more memory than
+ * was live, and anything above it is overhead, padding and memory stranded between live blocks.
+ */
+typedef struct bench_replay_result
+{
+    ptrdiff_t operations;
+    // Calls that succeeded when recorded but failed when replayed. Later calls on the same block are skipped.
+    ptrdiff_t failed_operations;
+    uint64_t elapsed_ns;
+    ptrdiff_t peak_bytes_live;
+    ptrdiff_t peak_rss_bytes;
+    double fragmentation;
+} bench_replay_result;
+
+/**
+ * Replays a trace recorded by ctd_trace_allocator against an allocator. Records are decoded in batches, and only the
+ * calls into the allocator are timed, so the trace can be streamed from a file or pipe of any length. Blocks that are
+ * still live when the trace ends are deallocated afterwards.
+ *
+ * @param stream Stream positioned at the start of the trace
+ * @param allocator Allocator the trace is replayed against
+ * @param error Pointer to error struct, which is set if the trace can't be read
+ * @return Results of the replay, up to where an error occurred.
+ */
+bench_replay_result bench_replay_trace(FILE* stream, ctd_allocator* allocator, ctd_error* error);
+/**
+ * Prints the results of a replay as a single line that starts with label.
+ */
+void bench_replay_print_result(const char* label, bench_replay_result result);
+
+#endif // BENCH_REPLAY_H
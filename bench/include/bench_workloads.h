@@ -0,0 +1,12 @@
+#ifndef BENCH_WORKLOADS_H
+#define BENCH_WORKLOADS_H
+
+/**
+ * Runs every standard workload against every allocator and prints a table of the results. Each pair runs in its own
+ * child process, so that the peak memory of one run isn't inflated by memory an earlier run left behind.
+ *
+ * @param json_path Path the results are written to as JSON, or NULL to only print them.
+ */
+void bench_workloads_functions(const char* json_path);
+
+#endif // BENCH_WORKLOADS_H
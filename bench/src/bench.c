@@ -0,0 +1,32 @@
+#include <bench_ctd_concurrent_arena_allocator.h>
+#include <bench_ctd_multi_matcher.h>
+#include <bench_ctd_page_allocator.h>
+#include <bench_ctd_scrub.h>
+#include <bench_ctd_string.h>
+#include <bench_ctd_string_hash.h>
+#include <bench_ctd_thread_cache_allocator.h>
+#include <bench_ctd_tlsf_allocator.h>
+#include <bench_ctd_trace_allocator.h>
+#include <bench_ctd_virtual_arena_allocator.h>
+#include <bench_workloads.h>
+
+/**
+ * Usage: ctdlib_bench [path of the JSON results, ctdlib_bench.json by default]
+ */
+int main(int argc, char** argv)
+{
+    // Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers
+    bench_workloads_functions(argc > 1 ? argv[1] : "ctdlib_bench.json");
+    bench_ctd_concurrent_arena_allocator_functions();
+    bench_ctd_multi_matcher_functions();
+    bench_ctd_page_allocator_functions();
+    bench_ctd_scrub_functions();
+    bench_ctd_string_functions();
+    bench_ctd_string_hash_functions();
+    bench_ctd_thread_cache_allocator_functions();
+    bench_ctd_tlsf_allocator_functions();
+    bench_ctd_trace_allocator_functions();
+    bench_ctd_virtual_arena_allocator_functions();
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <bench_ctd_concurrent_arena_allocator.h>
+#include <ctd_concurrent_arena_allocator.h>
+#include <ctd_arena_allocator.h>
+#include <bench.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <string.h>
+
+#define BENCH_ALLOCATIONS_PER_THREAD 500000
+#define BENCH_ALLOCATION_SIZE 32
+#define BENCH_CHUNK_SIZE ((ptrdiff_t)64 << 10)
+#define BENCH_MAX_THREADS 32
+#define BENCH_ARENA_SIZE ((ptrdiff_t)BENCH_MAX_THREADS * BENCH_ALLOCATIONS_PER_THREAD * BENCH_ALLOCATION_SIZE + ((ptrdiff_t)64 << 20))
+
+typedef enum bench_arena_mode
+{
+    BENCH_ARENA_LOCKED,
+    BENCH_ARENA_ATOMIC,
+    BENCH_ARENA_CHUNKED,
+} bench_arena_mode;
+
+typedef struct bench_arena_worker
+{
+    bench_arena_mode mode;
+    ctd_allocator* allocator;
+    ctd_concurrent_arena_allocator* concurrent_arena;
+    pthread_mutex_t* lock;
+    uint64_t sink;
+} bench_arena_worker;
+
+static void* bench_arena_worker_run(void* argument)
+{
+    bench_arena_worker* worker = argument;
+    ctd_allocator* allocator = worker->allocator;
+    ctd_concurrent_arena_chunk chunk = {0};
+    for (ptrdiff_t i = 0; i < BENCH_ALLOCATIONS_PER_THREAD; i++)
+    {
+        char* data = NULL;
+        switch (worker->mode)
+        {
+        case BENCH_ARENA_LOCKED:
+            pthread_mutex_lock(worker->lock);
+            data = allocator->allocate(allocator->context, BENCH_ALLOCATION_SIZE, alignof(max_align_t));
+            pthread_mutex_unlock(worker->lock);
+            break;
+        case BENCH_ARENA_ATOMIC:
+            data = allocator->allocate(allocator->context, BENCH_ALLOCATION_SIZE, alignof(max_align_t));
+            break;
+        case BENCH_ARENA_CHUNKED:
+            data = ctd_concurrent_arena_chunk_allocate(&chunk, BENCH_ALLOCATION_SIZE, alignof(max_align_t));
+            if (data == NULL)
+            {
+                chunk = ctd_concurrent_arena_allocator_reserve(worker->concurrent_arena, BENCH_CHUNK_SIZE);
+                data = ctd_concurrent_arena_chunk_allocate(&chunk, BENCH_ALLOCATION_SIZE, alignof(max_align_t));
+            }
+            break;
+        }
+        if (data == NULL) return NULL;
+        data[0] = (char)i;
+        worker->sink += (uintptr_t)data;
+    }
+
+    return NULL;
+}
+
+static uint64_t bench_arena_threads(bench_arena_worker* workers, ptrdiff_t thread_count)
+{
+    pthread_t threads[BENCH_MAX_THREADS];
+    uint64_t sink = 0;
+    for (ptrdiff_t i = 0; i < thread_count; i++)
+    {
+        pthread_create(&threads[i], NULL, bench_arena_worker_run, &workers[i]);
+    }
+    for (ptrdiff_t i = 0; i < thread_count; i++)
+    {
+        pthread_join(threads[i], NULL);
+        sink += workers[i].sink;
+    }
+
+    return sink;
+}
+
+static void bench_arena_with_threads(ptrdiff_t thread_count, uint64_t* sink)
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_arena_allocator arena = ctd_arena_allocator_create(BENCH_ARENA_SIZE, &heap_allocator);
+    ctd_concurrent_arena_allocator concurrent_arena = ctd_concurrent_arena_allocator_create(BENCH_ARENA_SIZE, &heap_allocator);
+    pthread_mutex_t lock;
+    pthread_mutex_init(&lock, NULL);
+    bench_arena_worker workers[BENCH_MAX_THREADS];
+    char label[64];
+
+    // Fault in both arenas up front, so that page faults don't make whichever runs first look slower
+    memset(arena.allocator.allocate(arena.allocator.context, BENCH_ARENA_SIZE, alignof(char)), 0, BENCH_ARENA_SIZE);
+    memset(concurrent_arena.allocator.allocate(concurrent_arena.allocator.context, BENCH_ARENA_SIZE, alignof(char)), 0, BENCH_ARENA_SIZE);
+    ctd_arena_allocator_reset(&arena);
+    ctd_concurrent_arena_allocator_reset(&concurrent_arena);
+
+    const char* mode_names[] = {"mutex around arena", "atomic bump", "reserved chunks"};
+    for (bench_arena_mode mode = BENCH_ARENA_LOCKED; mode <= BENCH_ARENA_CHUNKED; mode++)
+    {
+        for (ptrdiff_t i = 0; i < thread_count; i++)
+        {
+            workers[i] = (bench_arena_worker) {
+                .mode = mode,
+                .allocator = mode == BENCH_ARENA_LOCKED ? &arena.allocator : &concurrent_arena.allocator,
+                .concurrent_arena = &concurrent_arena,
+                .lock = &lock,
+            };
+        }
+        snprintf(label, sizeof(label), "%s, %td threads", mode_names[mode], thread_count);
+        RUN_BENCH(arena_threads, label, *sink, workers, thread_count);
+        ctd_arena_allocator_reset(&arena);
+        ctd_concurrent_arena_allocator_reset(&concurrent_arena);
+    }
+
+    pthread_mutex_destroy(&lock);
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    ctd_arena_allocator_destroy(&arena, &heap_allocator);
+}
+
+void bench_ctd_concurrent_arena_allocator_functions()
+{
+    uint64_t sink = 0;
+    printf("---------- Begin ctd_concurrent_arena_allocator Bench ----------\n");
+
+    for (ptrdiff_t thread_count = 1; thread_count <= BENCH_MAX_THREADS; thread_count *= 2)
+    {
+        bench_arena_with_threads(thread_count, &sink);
+    }
+
+    printf("(sink %llu)\n", (unsigned long long)sink);
+    printf("---------- End ctd_concurrent_arena_allocator Bench ----------\n\n");
+}
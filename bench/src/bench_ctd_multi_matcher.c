@@ -0,0 +1,105 @@
+#include <bench_ctd_multi_matcher.h>
+#include <ctd_multi_matcher.h>
+#include <bench.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MULTI_MATCHER_LOG_SIZE ((ptrdiff_t)8 << 20)
+#define BENCH_MULTI_MATCHER_KEYWORDS 300
+#define BENCH_MULTI_MATCHER_KEYWORD_SIZE 24
+
+static void bench_multi_matcher_fill_log(char* log)
+{
+    static const char* const lines[] = {
+        "2026-10-17T12:00:00.000Z INFO  request handled path=/api/v1/items status=200 duration_ms=3\n",
+        "2026-10-17T12:00:00.001Z WARN  request slow path=/api/v1/search status=200 duration_ms=412\n",
+        "2026-10-17T12:00:00.002Z ERROR request failed path=/api/v1/items status=500 reason=retry\n",
+    };
+    ptrdiff_t length = 0;
+    for (ptrdiff_t i = 0; length < BENCH_MULTI_MATCHER_LOG_SIZE; i++)
+    {
+        const char* line = lines[i % countof(lines)];
+        const ptrdiff_t line_length = ctd_min((ptrdiff_t)strlen(line), BENCH_MULTI_MATCHER_LOG_SIZE - length);
+        memcpy(log + length, line, line_length);
+        length += line_length;
+    }
+}
+
+/**
+ * Keywords a log scrubber would look for, most of which never appear, and a few that appear on every other line.
+ */
+static void bench_multi_matcher_keywords(char (*keyword_data)[BENCH_MULTI_MATCHER_KEYWORD_SIZE], ctd_string* keywords)
+{
+    static const char* const prefixes[] = {"password=", "token=", "secret_", "api_key=", "session=", "card_"};
+    static const char* const hits[] = {"status=500", "duration_ms=412", "ERROR"};
+    for (ptrdiff_t i = 0; i < BENCH_MULTI_MATCHER_KEYWORDS; i++)
+    {
+        int length;
+        if (i < countof(hits))
+        {
+            length = snprintf(keyword_data[i], BENCH_MULTI_MATCHER_KEYWORD_SIZE, "%s", hits[i]);
+        }
+        else
+        {
+            length = snprintf(keyword_data[i], BENCH_MULTI_MATCHER_KEYWORD_SIZE, "%s%td", prefixes[i % countof(prefixes)], i);
+        }
+        keywords[i] = (ctd_string) {.data = keyword_data[i], .length = length};
+    }
+}
+
+static uint64_t bench_multi_matcher_find_each(const ctd_string* keywords, const ctd_string log)
+{
+    uint64_t matches = 0;
+    ctd_error error = {0};
+    for (ptrdiff_t i = 0; i < BENCH_MULTI_MATCHER_KEYWORDS; i++)
+    {
+        ctd_option(ptrdiff_t) index = ctd_string_find(log, keywords[i], 0, &error);
+        while (IS_SOME(index) && index.value + keywords[i].length < log.length)
+        {
+            matches++;
+            index = ctd_string_find(log, keywords[i], index.value + keywords[i].length, &error);
+        }
+        matches += IS_SOME(index);
+    }
+    return matches;
+}
+
+static uint64_t bench_multi_matcher_find_all(const ctd_multi_matcher* matcher, const ctd_string log)
+{
+    return ctd_multi_matcher_find_all(matcher, log, NULL, NULL);
+}
+
+void bench_ctd_multi_matcher_functions()
+{
+    uint64_t sink = 0;
+    printf("---------- Begin ctd_multi_matcher Bench ----------\n");
+
+    char* log_data = malloc(BENCH_MULTI_MATCHER_LOG_SIZE);
+    char (*keyword_data)[BENCH_MULTI_MATCHER_KEYWORD_SIZE] = malloc(BENCH_MULTI_MATCHER_KEYWORDS * BENCH_MULTI_MATCHER_KEYWORD_SIZE);
+    ctd_string* keywords = malloc(BENCH_MULTI_MATCHER_KEYWORDS * sizeof(ctd_string));
+    if (log_data == NULL || keyword_data == NULL || keywords == NULL)
+    {
+        free(keywords);
+        free(keyword_data);
+        free(log_data);
+        return;
+    }
+    bench_multi_matcher_fill_log(log_data);
+    bench_multi_matcher_keywords(keyword_data, keywords);
+    const ctd_string log = {.data = log_data, .length = BENCH_MULTI_MATCHER_LOG_SIZE};
+
+    RUN_BENCH(multi_matcher_find_each, "ctd_string_find per keyword", sink, keywords, log);
+    ctd_error error = {0};
+    const uint64_t start = bench_now_ns();
+    ctd_multi_matcher matcher = ctd_multi_matcher_create(keywords, BENCH_MULTI_MATCHER_KEYWORDS, &ctd_heap_allocator_instance.allocator, &error);
+    printf("%-28s %-32s %12.3f ms\n", "multi_matcher_create", "300 keywords", (double)(bench_now_ns() - start) / 1e6);
+    printf("    %td states, %td byte classes, %td KB\n", matcher.state_count, matcher.class_count, matcher.tables_size / 1024);
+    RUN_BENCH(multi_matcher_find_all, "single pass", sink, &matcher, log);
+    ctd_multi_matcher_destroy(&matcher);
+
+    free(keywords);
+    free(keyword_data);
+    free(log_data);
+    printf("(sink %llu)\n", (unsigned long long)sink);
+    printf("---------- End ctd_multi_matcher Bench ----------\n\n");
+}
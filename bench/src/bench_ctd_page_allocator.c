@@ -0,0 +1,118 @@
+#include <bench_ctd_page_allocator.h>
+#include <ctd_page_allocator.h>
+#include <bench.h>
+#include <stdalign.h>
+#include <stdbool.h>
+
+#define BENCH_PAGE_SIZE ((ptrdiff_t)64 << 10)
+#define BENCH_ROUNDS 1000
+#define BENCH_SMALL_ALLOCATIONS_PER_ROUND 4000
+#define BENCH_SMALL_ALLOCATION_SIZE 48
+#define BENCH_LARGE_ALLOCATION_INTERVAL 500
+#define BENCH_LARGE_ALLOCATION_SIZE ((ptrdiff_t)1 << 20)
+#define BENCH_NODE_COUNT 1024
+#define BENCH_NODE_SIZE 32
+
+/**
+ * Simulates a request loop: each round mixes many small allocations with the occasional oversized one, then rewinds the
+ * page allocator back to where it started.
+ */
+static uint64_t bench_page_allocator_request_rounds(ctd_page_allocator* page_allocator, ptrdiff_t* peak_stranded_bytes)
+{
+    ctd_allocator allocator = page_allocator->allocator;
+    uint64_t sink = 0;
+    ctd_arena_save_point save_point = ctd_page_allocator_mark(page_allocator);
+    for (ptrdiff_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for (ptrdiff_t i = 0; i < BENCH_SMALL_ALLOCATIONS_PER_ROUND; i++)
+        {
+            ptrdiff_t size = i % BENCH_LARGE_ALLOCATION_INTERVAL == 0 ? BENCH_LARGE_ALLOCATION_SIZE : BENCH_SMALL_ALLOCATION_SIZE;
+            char* data = allocator.allocate(allocator.context, size, alignof(max_align_t));
+            if (data == NULL) return sink;
+            data[0] = (char)i;
+            sink += (uintptr_t)data;
+        }
+        ptrdiff_t stranded_bytes = ctd_page_allocator_get_stats(page_allocator).stranded_bytes;
+        if (stranded_bytes > *peak_stranded_bytes)
+        {
+            *peak_stranded_bytes = stranded_bytes;
+        }
+        ctd_page_allocator_rewind(page_allocator, save_point);
+    }
+
+    return sink;
+}
+
+static void bench_page_allocator_with_cache(const char* label, ptrdiff_t max_cached_pages, uint64_t* sink)
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator page_allocator = ctd_page_allocator_create_with_page_cache(BENCH_PAGE_SIZE, max_cached_pages, &heap_allocator);
+    ptrdiff_t peak_stranded_bytes = 0;
+
+    RUN_BENCH(page_allocator_request_rounds, label, *sink, &page_allocator, &peak_stranded_bytes);
+    ctd_page_allocator_stats stats = ctd_page_allocator_get_stats(&page_allocator);
+    printf("    pages allocated from parent: %td, peak stranded bytes: %td\n", stats.pages_allocated, peak_stranded_bytes);
+
+    ctd_page_allocator_destroy(&page_allocator);
+}
+
+/**
+ * Builds and tears down a graph of small nodes every round, either with a call per node or with one batch call.
+ */
+static uint64_t bench_page_allocator_build_nodes(ctd_page_allocator* page_allocator, const bool batched)
+{
+    ctd_allocator allocator = page_allocator->allocator;
+    uint64_t sink = 0;
+    void* nodes[BENCH_NODE_COUNT];
+    ctd_arena_save_point save_point = ctd_page_allocator_mark(page_allocator);
+    for (ptrdiff_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        if (batched)
+        {
+            if (!ctd_allocator_allocate_batch(&allocator, BENCH_NODE_COUNT, BENCH_NODE_SIZE, alignof(max_align_t), nodes)) return sink;
+        }
+        else
+        {
+            for (ptrdiff_t i = 0; i < BENCH_NODE_COUNT; i++)
+            {
+                nodes[i] = allocator.allocate(allocator.context, BENCH_NODE_SIZE, alignof(max_align_t));
+                if (nodes[i] == NULL) return sink;
+            }
+        }
+        sink += (uintptr_t)nodes[round % BENCH_NODE_COUNT];
+
+        if (batched)
+        {
+            ctd_allocator_deallocate_batch(&allocator, BENCH_NODE_COUNT, BENCH_NODE_SIZE, nodes);
+        }
+        else
+        {
+            for (ptrdiff_t i = BENCH_NODE_COUNT - 1; i >= 0; i--)
+            {
+                allocator.deallocate(allocator.context, nodes[i], BENCH_NODE_SIZE);
+            }
+        }
+        ctd_page_allocator_rewind(page_allocator, save_point);
+    }
+
+    return sink;
+}
+
+void bench_ctd_page_allocator_functions()
+{
+    uint64_t sink = 0;
+    printf("---------- Begin ctd_page_allocator Bench ----------\n");
+
+    bench_page_allocator_with_cache("no page cache", 0, &sink);
+    bench_page_allocator_with_cache("default page cache", CTD_PAGE_ALLOCATOR_DEFAULT_CACHED_PAGES, &sink);
+    bench_page_allocator_with_cache("32 page cache", 32, &sink);
+
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator page_allocator = ctd_page_allocator_create(BENCH_PAGE_SIZE, &heap_allocator);
+    RUN_BENCH(page_allocator_build_nodes, "call per node", sink, &page_allocator, false);
+    RUN_BENCH(page_allocator_build_nodes, "batch", sink, &page_allocator, true);
+    ctd_page_allocator_destroy(&page_allocator);
+
+    printf("(sink %llu)\n", (unsigned long long)sink);
+    printf("---------- End ctd_page_allocator Bench ----------\n\n");
+}
@@ -0,0 +1,108 @@
+#include <bench_ctd_scrub.h>
+#include <ctd_arena_allocator.h>
+#include <ctd_slab_allocator.h>
+#include <ctd_scrub.h>
+#include <ctd_define.h>
+#include <bench.h>
+#include <stdalign.h>
+#include <string.h>
+
+#define BENCH_SLAB_SIZE ((ptrdiff_t)1 << 20)
+#define BENCH_SMALL_BLOCK_ROUNDS 1000
+#define BENCH_SMALL_BLOCK_COUNT 1024
+#define BENCH_SMALL_BLOCK_SIZE 256
+#define BENCH_LARGE_BLOCK_COUNT 256
+#define BENCH_LARGE_BLOCK_SIZE ((ptrdiff_t)1 << 20)
+
+static const char* const bench_scrub_policy_names[] = {
+    [CTD_SCRUB_ZERO] = "zero",
+    [CTD_SCRUB_NONE] = "none",
+    [CTD_SCRUB_POISON] = "poison",
+    [CTD_SCRUB_RELEASE_PAGES] = "release pages",
+};
+
+/**
+ * Repeatedly fills a batch of blocks from a slab allocator and frees them all again. The batch fits in cache, so the
+ * cost of scrubbing isn't hidden behind cache misses.
+ */
+static uint64_t bench_slab_allocator_churn_small_blocks(ctd_allocator allocator, char** blocks)
+{
+    uint64_t sink = 0;
+    for (ptrdiff_t round = 0; round < BENCH_SMALL_BLOCK_ROUNDS; round++)
+    {
+        for (ptrdiff_t i = 0; i < BENCH_SMALL_BLOCK_COUNT; i++)
+        {
+            blocks[i] = allocator.allocate(allocator.context, BENCH_SMALL_BLOCK_SIZE, alignof(max_align_t));
+            blocks[i][BENCH_SMALL_BLOCK_SIZE - 1] = (char)i;
+        }
+        for (ptrdiff_t i = 0; i < BENCH_SMALL_BLOCK_COUNT; i++)
+        {
+            sink += blocks[i][BENCH_SMALL_BLOCK_SIZE - 1];
+            allocator.deallocate(allocator.context, blocks[i], BENCH_SMALL_BLOCK_SIZE);
+        }
+    }
+
+    return sink;
+}
+
+/**
+ * Frees every block, newest first, so that each one is the tail of the arena when it is freed.
+ */
+static uint64_t bench_arena_allocator_free_large_blocks(ctd_allocator allocator, char** blocks)
+{
+    for (ptrdiff_t i = BENCH_LARGE_BLOCK_COUNT - 1; i >= 0; i--)
+    {
+        allocator.deallocate(allocator.context, blocks[i], BENCH_LARGE_BLOCK_SIZE);
+    }
+
+    return (uintptr_t)blocks[0];
+}
+
+static void bench_slab_allocator_with_scrub_policy(ctd_scrub_policy scrub_policy, char** blocks, uint64_t* sink)
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_slab_allocator slab_allocator = ctd_slab_allocator_create_with_scrub_policy(BENCH_SLAB_SIZE, scrub_policy, &heap_allocator);
+    ctd_allocator allocator = slab_allocator.allocator;
+
+    RUN_BENCH(slab_allocator_churn_small_blocks, bench_scrub_policy_names[scrub_policy], *sink, allocator, blocks);
+
+    ctd_slab_allocator_destroy(&slab_allocator);
+}
+
+static void bench_arena_allocator_with_scrub_policy(ctd_scrub_policy scrub_policy, char** blocks, uint64_t* sink)
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_arena_allocator arena = ctd_arena_allocator_create_with_scrub_policy(BENCH_LARGE_BLOCK_COUNT * BENCH_LARGE_BLOCK_SIZE, scrub_policy, &heap_allocator);
+    ctd_allocator allocator = arena.allocator;
+    for (ptrdiff_t i = 0; i < BENCH_LARGE_BLOCK_COUNT; i++)
+    {
+        blocks[i] = allocator.allocate(allocator.context, BENCH_LARGE_BLOCK_SIZE, alignof(char));
+        memset(blocks[i], 1, BENCH_LARGE_BLOCK_SIZE);
+    }
+
+    RUN_BENCH(arena_allocator_free_large_blocks, bench_scrub_policy_names[scrub_policy], *sink, allocator, blocks);
+
+    ctd_arena_allocator_destroy(&arena, &heap_allocator);
+}
+
+void bench_ctd_scrub_functions()
+{
+    // Large enough for both benchmarks
+    char* blocks[BENCH_SMALL_BLOCK_COUNT];
+    uint64_t sink = 0;
+    printf("---------- Begin ctd_scrub Bench ----------\n");
+
+    printf("%d rounds of %d allocations and frees of %d byte blocks:\n", BENCH_SMALL_BLOCK_ROUNDS, BENCH_SMALL_BLOCK_COUNT, BENCH_SMALL_BLOCK_SIZE);
+    for (ptrdiff_t policy = 0; policy < countof(bench_scrub_policy_names); policy++)
+    {
+        bench_slab_allocator_with_scrub_policy((ctd_scrub_policy)policy, blocks, &sink);
+    }
+    printf("%d frees of %td byte blocks:\n", BENCH_LARGE_BLOCK_COUNT, BENCH_LARGE_BLOCK_SIZE);
+    for (ptrdiff_t policy = 0; policy < countof(bench_scrub_policy_names); policy++)
+    {
+        bench_arena_allocator_with_scrub_policy((ctd_scrub_policy)policy, blocks, &sink);
+    }
+
+    printf("(sink %llu)\n", (unsigned long long)sink);
+    printf("---------- End ctd_scrub Bench ----------\n\n");
+}
@@ -0,0 +1,181 @@
+#include <bench_ctd_string.h>
+#include <ctd_string.h>
+#include <ctd_string_searcher.h>
+#include <ctd_internal_string_search.h>
+#include <ctd_define.h>
+#include <bench.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_STRING_LOG_SIZE ((ptrdiff_t)8 << 20)
+#define BENCH_STRING_SEARCHES 20
+#define BENCH_STRING_TEMPLATE_SIZE ((ptrdiff_t)256 << 10)
+
+static const char* const bench_string_search_level_names[] = {
+    [CTD_STRING_SEARCH_SCALAR] = "scalar",
+    [CTD_STRING_SEARCH_SSE2] = "sse2",
+    [CTD_STRING_SEARCH_AVX2] = "avx2",
+    [CTD_STRING_SEARCH_AVX512] = "avx512",
+};
+
+/**
+ * Fills a buffer with log lines that share most of their bytes with the needle, and puts the needle on the last line.
+ */
+static void bench_string_fill_log(char* log, const ctd_string needle)
+{
+    static const char* const lines[] = {
+        "2026-10-17T12:00:00.000Z INFO  request handled path=/api/v1/items status=200 duration_ms=3\n",
+        "2026-10-17T12:00:00.001Z WARN  request slow path=/api/v1/search status=200 duration_ms=412\n",
+        "2026-10-17T12:00:00.002Z ERROR request failed path=/api/v1/items status=500 reason=retry\n",
+    };
+    ptrdiff_t length = 0;
+    for (ptrdiff_t i = 0; length < BENCH_STRING_LOG_SIZE; i++)
+    {
+        const char* line = lines[i % countof(lines)];
+        const ptrdiff_t line_length = ctd_min((ptrdiff_t)strlen(line), BENCH_STRING_LOG_SIZE - length);
+        memcpy(log + length, line, line_length);
+        length += line_length;
+    }
+    memcpy(log + BENCH_STRING_LOG_SIZE - needle.length - 1, needle.data, needle.length);
+}
+
+/**
+ * The search ctd_string_find did before it had SIMD kernels: compare the first byte at every position, and the whole
+ * needle wherever it matches.
+ */
+static ptrdiff_t bench_string_byte_at_a_time_find(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    for (ptrdiff_t i = 0; i <= haystack_length - needle_length; i++)
+    {
+        if (haystack[i] != needle[0])
+        {
+            continue;
+        }
+        ctd_string candidate = {.data = (char*)haystack + i, .length = needle_length};
+        ctd_string substring = {.data = (char*)needle, .length = needle_length};
+        if (ctd_string_equals(candidate, substring))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Searcher used by bench_string_searcher_find, which has to fit ctd_string_search_function
+static ctd_string_searcher bench_string_searcher;
+
+static ptrdiff_t bench_string_searcher_find(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    (void)needle;
+    (void)needle_length;
+    ctd_error error = {0};
+    const ctd_option(ptrdiff_t) index = ctd_string_searcher_find(&bench_string_searcher, (ctd_string) {.data = (char*)haystack, .length = haystack_length}, 0, &error);
+    return IS_SOME(index) ? index.value : -1;
+}
+
+static uint64_t bench_string_find(ctd_string_search_function find, const char* log, const ctd_string needle)
+{
+    uint64_t sink = 0;
+    for (ptrdiff_t i = 0; i < BENCH_STRING_SEARCHES; i++)
+    {
+        sink += find(log, BENCH_STRING_LOG_SIZE, needle.data, needle.length);
+    }
+    return sink;
+}
+
+static void bench_string_find_and_print(const char* label, ctd_string_search_function find, const char* log, const ctd_string needle, uint64_t* sink)
+{
+    const uint64_t start = bench_now_ns();
+    RUN_BENCH(string_find, label, *sink, find, log, needle);
+    const double seconds = (double)(bench_now_ns() - start) / 1e9;
+    printf("    %.2f GB/s\n", (double)BENCH_STRING_LOG_SIZE * BENCH_STRING_SEARCHES / seconds / 1e9);
+}
+
+/**
+ * The replace_all ctd_string_builder had before it replaced in a single pass: find an instance and move the rest of the
+ * string to make room for its replacement, once per instance.
+ */
+static void bench_string_replace_one_at_a_time(ctd_string_builder* builder, const ctd_string substring, const ctd_string replacement, ctd_error* error)
+{
+    ptrdiff_t start = 0;
+    ctd_option(ptrdiff_t) index;
+    while (start < builder->length && IS_SOME((index = ctd_string_builder_find(builder, substring, start, error))))
+    {
+        ctd_string_builder_replace_at(builder, replacement, index.value, substring.length, error);
+        start = index.value + replacement.length;
+    }
+}
+
+/**
+ * Fills a template with a placeholder on every line, and replaces all of them.
+ */
+static uint64_t bench_string_replace_all(bool one_at_a_time, const ctd_string replacement)
+{
+    static char line[] = "Dear {{name}}, your order has shipped and will arrive on Monday.\n";
+    const ctd_string placeholder = ctd_string_create_from_literal("{{name}}");
+    ctd_error error = {0};
+    ctd_string_builder builder = ctd_string_builder_create(BENCH_STRING_TEMPLATE_SIZE, &ctd_heap_allocator_instance.allocator, &error);
+    while (builder.length + (ptrdiff_t)sizeof(line) - 1 <= BENCH_STRING_TEMPLATE_SIZE)
+    {
+        ctd_string_builder_append(&builder, ctd_string_create_from_literal(line), &error);
+    }
+
+    if (one_at_a_time)
+    {
+        bench_string_replace_one_at_a_time(&builder, placeholder, replacement, &error);
+    }
+    else
+    {
+        ctd_string_builder_replace_all(&builder, placeholder, replacement, 0, &error);
+    }
+    const uint64_t length = (uint64_t)builder.length;
+    ctd_string_builder_destroy(&builder);
+    return length;
+}
+
+void bench_ctd_string_functions()
+{
+    uint64_t sink = 0;
+    printf("---------- Begin ctd_string Bench ----------\n");
+
+    char* log = malloc(BENCH_STRING_LOG_SIZE);
+    if (log == NULL) return;
+    const ctd_string needle = ctd_string_create_from_literal("ERROR request failed path=/api/v1/items status=503");
+    bench_string_fill_log(log, needle);
+
+    bench_string_find_and_print("byte at a time", bench_string_byte_at_a_time_find, log, needle, &sink);
+    for (ptrdiff_t level = 0; level <= ctd_string_search_supported_level(); level++)
+    {
+        bench_string_find_and_print(bench_string_search_level_names[level], ctd_string_find_functions[level], log, needle, &sink);
+    }
+    ctd_error error = {0};
+    bench_string_searcher = ctd_string_searcher_create(needle, &ctd_heap_allocator_instance.allocator, &error);
+    bench_string_find_and_print("searcher", bench_string_searcher_find, log, needle, &sink);
+    ctd_string_searcher_destroy(&bench_string_searcher);
+
+    // A haystack of a single letter, where the first and last bytes of the needle match at every position
+    printf("Worst case:\n");
+    memset(log, 'a', BENCH_STRING_LOG_SIZE);
+    char periodic_data[64];
+    memset(periodic_data, 'a', sizeof(periodic_data));
+    periodic_data[sizeof(periodic_data) / 2] = 'b';
+    const ctd_string periodic_needle = {.data = periodic_data, .length = sizeof(periodic_data)};
+    const ctd_string_search_level level = ctd_string_search_supported_level();
+    bench_string_find_and_print(bench_string_search_level_names[level], ctd_string_find_functions[level], log, periodic_needle, &sink);
+    bench_string_searcher = ctd_string_searcher_create(periodic_needle, &ctd_heap_allocator_instance.allocator, &error);
+    bench_string_find_and_print("searcher", bench_string_searcher_find, log, periodic_needle, &sink);
+    ctd_string_searcher_destroy(&bench_string_searcher);
+
+    free(log);
+
+    // Templates with a placeholder every 65 bytes
+    const ctd_string longer = ctd_string_create_from_literal("Ada Lovelace");
+    const ctd_string shorter = ctd_string_create_from_literal("Ada");
+    RUN_BENCH(string_replace_all, "one at a time, longer", sink, true, longer);
+    RUN_BENCH(string_replace_all, "single pass, longer", sink, false, longer);
+    RUN_BENCH(string_replace_all, "one at a time, shorter", sink, true, shorter);
+    RUN_BENCH(string_replace_all, "single pass, shorter", sink, false, shorter);
+
+    printf("(sink %llu)\n", (unsigned long long)sink);
+    printf("---------- End ctd_string Bench ----------\n\n");
+}
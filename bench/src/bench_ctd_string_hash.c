@@ -0,0 +1,90 @@
+#include <bench_ctd_string_hash.h>
+#include <ctd_string_hash.h>
+#include <bench.h>
+#include <stdlib.h>
+
+// Bytes hashed for every key length, and the size of the buffer the keys are taken from
+#define BENCH_STRING_HASH_BYTES ((ptrdiff_t)64 << 20)
+#define BENCH_STRING_HASH_BUFFER_SIZE ((ptrdiff_t)128 << 10)
+// Size of the pieces the streaming hasher is given
+#define BENCH_STRING_HASH_PIECE 100
+
+typedef enum bench_string_hash_function
+{
+    BENCH_STRING_HASH_DJB2,
+    BENCH_STRING_HASH_HASH64,
+    BENCH_STRING_HASH_HASHER,
+} bench_string_hash_function;
+
+/**
+ * Hashes keys of a given length, each starting one byte after the last one, so that no two keys are the same.
+ */
+static uint64_t bench_string_hash(const bench_string_hash_function function, const char* buffer, const ptrdiff_t key_length)
+{
+    uint64_t sink = 0;
+    ptrdiff_t offset = 0;
+    for (ptrdiff_t i = 0; i < BENCH_STRING_HASH_BYTES / key_length; i++)
+    {
+        const ctd_string key = {.data = (char*)buffer + offset, .length = key_length};
+        offset = offset + key_length < BENCH_STRING_HASH_BUFFER_SIZE ? offset + 1 : 0;
+        switch (function)
+        {
+        case BENCH_STRING_HASH_DJB2:
+            sink += ctd_string_hash(key);
+            break;
+        case BENCH_STRING_HASH_HASH64:
+            sink += ctd_string_hash64(key);
+            break;
+        case BENCH_STRING_HASH_HASHER:
+        {
+            ctd_string_hasher hasher = ctd_string_hasher_create(0);
+            for (ptrdiff_t start = 0; start < key.length; start += BENCH_STRING_HASH_PIECE)
+            {
+                ctd_string_hasher_update(&hasher, (ctd_string) {.data = key.data + start, .length = ctd_min(BENCH_STRING_HASH_PIECE, key.length - start)});
+            }
+            sink += ctd_string_hasher_finish(&hasher);
+            break;
+        }
+        }
+    }
+    return sink;
+}
+
+static void bench_string_hash_and_print(const char* name, const bench_string_hash_function function, const char* buffer, const ptrdiff_t key_length, uint64_t* sink)
+{
+    char label[32];
+    snprintf(label, sizeof(label), "%s, %td B keys", name, key_length);
+    const uint64_t start = bench_now_ns();
+    RUN_BENCH(string_hash, label, *sink, function, buffer, key_length);
+    const double seconds = (double)(bench_now_ns() - start) / 1e9;
+    printf("    %.2f GB/s, %.1f ns per key\n", (double)BENCH_STRING_HASH_BYTES / seconds / 1e9, seconds * 1e9 / (double)(BENCH_STRING_HASH_BYTES / key_length));
+}
+
+void bench_ctd_string_hash_functions()
+{
+    static const ptrdiff_t key_lengths[] = {4, 16, 64, 256, 1024, 4096, 16384, 65536};
+    uint64_t sink = 0;
+    printf("---------- Begin ctd_string_hash Bench ----------\n");
+
+    char* buffer = malloc(BENCH_STRING_HASH_BUFFER_SIZE);
+    if (buffer == NULL) return;
+    uint64_t random = 0x9E3779B97F4A7C15u;
+    for (ptrdiff_t i = 0; i < BENCH_STRING_HASH_BUFFER_SIZE; i++)
+    {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        buffer[i] = (char)random;
+    }
+
+    for (ptrdiff_t i = 0; i < countof(key_lengths); i++)
+    {
+        bench_string_hash_and_print("djb2", BENCH_STRING_HASH_DJB2, buffer, key_lengths[i], &sink);
+        bench_string_hash_and_print("hash64", BENCH_STRING_HASH_HASH64, buffer, key_lengths[i], &sink);
+        bench_string_hash_and_print("hasher", BENCH_STRING_HASH_HASHER, buffer, key_lengths[i], &sink);
+    }
+
+    free(buffer);
+    printf("(sink %llu)\n", (unsigned long long)sink);
+    printf("---------- End ctd_string_hash Bench ----------\n\n");
+}
@@ -0,0 +1,129 @@
+#include <bench_ctd_thread_cache_allocator.h>
+#include <ctd_thread_cache_allocator.h>
+#include <ctd_slab_allocator.h>
+#include <ctd_define.h>
+#include <bench.h>
+#include <pthread.h>
+#include <stdalign.h>
+
+#define BENCH_SLAB_SIZE ((ptrdiff_t)64 << 10)
+#define BENCH_OPERATIONS_PER_THREAD 1000000
+#define BENCH_LIVE_BLOCKS_PER_THREAD 64
+#define BENCH_MAX_THREADS 32
+
+/**
+ * The baseline: a slab allocator with a single mutex around every call.
+ */
+typedef struct bench_locked_context
+{
+    pthread_mutex_t lock;
+    ctd_allocator* allocator;
+} bench_locked_context;
+
+static void* bench_locked_allocate(void* context, ptrdiff_t size, ptrdiff_t align)
+{
+    bench_locked_context* locked = context;
+    pthread_mutex_lock(&locked->lock);
+    void* ptr = locked->allocator->allocate(locked->allocator->context, size, align);
+    pthread_mutex_unlock(&locked->lock);
+    return ptr;
+}
+
+static void* bench_locked_reallocate(void* context, void* source, ptrdiff_t old_size, ptrdiff_t new_size, ptrdiff_t align)
+{
+    bench_locked_context* locked = context;
+    pthread_mutex_lock(&locked->lock);
+    void* ptr = locked->allocator->reallocate(locked->allocator->context, source, old_size, new_size, align);
+    pthread_mutex_unlock(&locked->lock);
+    return ptr;
+}
+
+static void bench_locked_deallocate(void* context, void* block, ptrdiff_t size)
+{
+    bench_locked_context* locked = context;
+    pthread_mutex_lock(&locked->lock);
+    locked->allocator->deallocate(locked->allocator->context, block, size);
+    pthread_mutex_unlock(&locked->lock);
+}
+
+/**
+ * Each thread keeps a small working set of blocks of mixed sizes and keeps replacing them.
+ */
+static void* bench_thread_churn(void* argument)
+{
+    const ctd_allocator* allocator = argument;
+    char* blocks[BENCH_LIVE_BLOCKS_PER_THREAD] = {0};
+    for (ptrdiff_t i = 0; i < BENCH_OPERATIONS_PER_THREAD; i++)
+    {
+        const ptrdiff_t slot = (i * 7) % BENCH_LIVE_BLOCKS_PER_THREAD;
+        const ptrdiff_t size = 16 << (slot % 5);
+        if (blocks[slot] != NULL)
+        {
+            allocator->deallocate(allocator->context, blocks[slot], size);
+        }
+        blocks[slot] = allocator->allocate(allocator->context, size, alignof(max_align_t));
+        blocks[slot][0] = (char)i;
+    }
+    for (ptrdiff_t slot = 0; slot < BENCH_LIVE_BLOCKS_PER_THREAD; slot++)
+    {
+        if (blocks[slot] != NULL)
+        {
+            allocator->deallocate(allocator->context, blocks[slot], 16 << (slot % 5));
+        }
+    }
+
+    return NULL;
+}
+
+static uint64_t bench_threads_churn(ctd_allocator* allocator, ptrdiff_t thread_count)
+{
+    pthread_t threads[BENCH_MAX_THREADS];
+    for (ptrdiff_t i = 0; i < thread_count; i++)
+    {
+        pthread_create(&threads[i], NULL, bench_thread_churn, allocator);
+    }
+    for (ptrdiff_t i = 0; i < thread_count; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    return thread_count;
+}
+
+static void bench_thread_cache_allocator_with_threads(ptrdiff_t thread_count, uint64_t* sink)
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    char label[64];
+
+    ctd_slab_allocator locked_slab = ctd_slab_allocator_create(BENCH_SLAB_SIZE, &heap_allocator);
+    bench_locked_context locked_context = {.allocator = &locked_slab.allocator};
+    pthread_mutex_init(&locked_context.lock, NULL);
+    ctd_allocator locked = {.allocate = bench_locked_allocate, .reallocate = bench_locked_reallocate, .deallocate = bench_locked_deallocate, .context = &locked_context};
+    snprintf(label, sizeof(label), "mutex around slab, %td threads", thread_count);
+    RUN_BENCH(threads_churn, label, *sink, &locked, thread_count);
+    pthread_mutex_destroy(&locked_context.lock);
+    ctd_slab_allocator_destroy(&locked_slab);
+
+    ctd_slab_allocator cached_slab = ctd_slab_allocator_create(BENCH_SLAB_SIZE, &heap_allocator);
+    ctd_thread_cache_allocator thread_cache_allocator = ctd_thread_cache_allocator_create(&cached_slab.allocator);
+    snprintf(label, sizeof(label), "thread cache, %td threads", thread_count);
+    RUN_BENCH(threads_churn, label, *sink, &thread_cache_allocator.allocator, thread_count);
+    printf("    lock acquisitions: %td of %td operations\n", ctd_thread_cache_allocator_lock_acquisitions(&thread_cache_allocator),
+           2 * thread_count * BENCH_OPERATIONS_PER_THREAD);
+    ctd_thread_cache_allocator_destroy(&thread_cache_allocator);
+    ctd_slab_allocator_destroy(&cached_slab);
+}
+
+void bench_ctd_thread_cache_allocator_functions()
+{
+    uint64_t sink = 0;
+    printf("---------- Begin ctd_thread_cache_allocator Bench ----------\n");
+
+    for (ptrdiff_t thread_count = 1; thread_count <= BENCH_MAX_THREADS; thread_count *= 2)
+    {
+        bench_thread_cache_allocator_with_threads(thread_count, &sink);
+    }
+
+    printf("(sink %llu)\n", (unsigned long long)sink);
+    printf("---------- End ctd_thread_cache_allocator Bench ----------\n\n");
+}
@@ -0,0 +1,121 @@
+#include <bench_ctd_tlsf_allocator.h>
+#include <ctd_buddy_allocator.h>
+#include <ctd_tlsf_allocator.h>
+#include <bench.h>
+#include <stdalign.h>
+#include <stdlib.h>
+
+#define BENCH_TLSF_OPERATIONS ((ptrdiff_t)1 << 20)
+#define BENCH_TLSF_SLOTS 4096
+#define BENCH_TLSF_MIN_SIZE_LOG2 4
+#define BENCH_TLSF_MAX_SIZE_LOG2 16
+#define BENCH_TLSF_REGION_SIZE ((ptrdiff_t)512 << 20)
+
+typedef struct bench_tlsf_slot
+{
+    char* block;
+    ptrdiff_t size;
+} bench_tlsf_slot;
+
+static inline uint64_t bench_tlsf_next_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static int bench_tlsf_compare_latencies(const void* a, const void* b)
+{
+    const uint64_t first = *(const uint64_t*)a;
+    const uint64_t second = *(const uint64_t*)b;
+    return (first > second) - (first < second);
+}
+
+/**
+ * Allocates and frees blocks of random sizes in a random order, timing every call on its own. Sizes are spread evenly
+ * over powers of two, so that small and large blocks are equally common. The latencies include the cost of reading the
+ * clock, which is the same for every allocator.
+ */
+static uint64_t bench_tlsf_random_latencies(ctd_allocator* allocator, uint64_t* latencies)
+{
+    bench_tlsf_slot* slots = calloc(BENCH_TLSF_SLOTS, sizeof(bench_tlsf_slot));
+    if (slots == NULL) return 0;
+    uint64_t random = 0x9E3779B97F4A7C15u;
+    uint64_t sink = 0;
+
+    for (ptrdiff_t i = 0; i < BENCH_TLSF_OPERATIONS; i++)
+    {
+        bench_tlsf_slot* slot = &slots[bench_tlsf_next_random(&random) % BENCH_TLSF_SLOTS];
+        if (slot->block != NULL)
+        {
+            const uint64_t start = bench_now_ns();
+            allocator->deallocate(allocator->context, slot->block, slot->size);
+            latencies[i] = bench_now_ns() - start;
+            slot->block = NULL;
+            continue;
+        }
+
+        const uint64_t bits = bench_tlsf_next_random(&random);
+        const int size_log2 = BENCH_TLSF_MIN_SIZE_LOG2 + (int)(bits % (BENCH_TLSF_MAX_SIZE_LOG2 - BENCH_TLSF_MIN_SIZE_LOG2));
+        slot->size = ((ptrdiff_t)1 << size_log2) + (ptrdiff_t)((bits >> 8) & (((uint64_t)1 << size_log2) - 1));
+        const uint64_t start = bench_now_ns();
+        slot->block = allocator->allocate(allocator->context, slot->size, alignof(max_align_t));
+        latencies[i] = bench_now_ns() - start;
+        if (slot->block == NULL) break;
+        slot->block[0] = (char)i;
+        sink += (uintptr_t)slot->block;
+    }
+
+    for (ptrdiff_t i = 0; i < BENCH_TLSF_SLOTS; i++)
+    {
+        if (slots[i].block != NULL)
+        {
+            allocator->deallocate(allocator->context, slots[i].block, slots[i].size);
+        }
+    }
+    free(slots);
+    return sink;
+}
+
+/**
+ * Runs the workload once untimed first, so that page faults on memory touched for the first time don't end up in the
+ * tail of whichever allocator runs first, then times it and prints the percentiles.
+ */
+static void bench_tlsf_run(const char* label, ctd_allocator* allocator, uint64_t* latencies, uint64_t* sink)
+{
+    *sink += bench_tlsf_random_latencies(allocator, latencies);
+    RUN_BENCH(tlsf_random_latencies, label, *sink, allocator, latencies);
+
+    qsort(latencies, BENCH_TLSF_OPERATIONS, sizeof(uint64_t), bench_tlsf_compare_latencies);
+    printf("    p50 %5llu ns   p99 %6llu ns   p99.9 %7llu ns   max %9llu ns\n",
+           (unsigned long long)latencies[BENCH_TLSF_OPERATIONS / 2],
+           (unsigned long long)latencies[BENCH_TLSF_OPERATIONS * 99 / 100],
+           (unsigned long long)latencies[BENCH_TLSF_OPERATIONS * 999 / 1000],
+           (unsigned long long)latencies[BENCH_TLSF_OPERATIONS - 1]);
+}
+
+void bench_ctd_tlsf_allocator_functions()
+{
+    uint64_t sink = 0;
+    printf("---------- Begin ctd_tlsf_allocator Bench ----------\n");
+
+    uint64_t* latencies = calloc(BENCH_TLSF_OPERATIONS, sizeof(uint64_t));
+    if (latencies == NULL) return;
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+
+    bench_tlsf_run("heap", &ctd_heap_allocator_instance.allocator, latencies, &sink);
+
+    // Scrubbing isn't part of what's being compared, and malloc doesn't do it either
+    ctd_tlsf_allocator tlsf_allocator = ctd_tlsf_allocator_create_with_scrub_policy(BENCH_TLSF_REGION_SIZE, CTD_SCRUB_NONE, &heap_allocator);
+    bench_tlsf_run("tlsf", &tlsf_allocator.allocator, latencies, &sink);
+    ctd_tlsf_allocator_destroy(&tlsf_allocator);
+
+    ctd_buddy_allocator buddy_allocator = ctd_buddy_allocator_create_with_scrub_policy(BENCH_TLSF_REGION_SIZE, 64, CTD_SCRUB_NONE, &heap_allocator);
+    bench_tlsf_run("buddy", &buddy_allocator.allocator, latencies, &sink);
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+
+    free(latencies);
+    printf("(sink %llu)\n", (unsigned long long)sink);
+    printf("---------- End ctd_tlsf_allocator Bench ----------\n\n");
+}
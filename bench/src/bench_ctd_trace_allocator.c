@@ -0,0 +1,124 @@
+#include <bench_ctd_trace_allocator.h>
+#include <bench_replay.h>
+#include <ctd_arena_allocator.h>
+#include <ctd_expandable_arena_allocator.h>
+#include <ctd_page_allocator.h>
+#include <ctd_trace_allocator.h>
+#include <bench.h>
+#include <stdalign.h>
+
+#define BENCH_TRACE_OPERATIONS 200000
+#define BENCH_TRACE_SLOTS 2048
+#define BENCH_TRACE_MAX_SMALL_SIZE 512
+#define BENCH_TRACE_LARGE_SIZE ((ptrdiff_t)16 << 10)
+#define BENCH_TRACE_ARENA_SIZE ((ptrdiff_t)256 << 20)
+#define BENCH_TRACE_PAGE_SIZE ((ptrdiff_t)64 << 10)
+
+static uint64_t bench_trace_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Stands in for a service's allocation pattern: a pool of live blocks that are freed at random, mostly small with the
+ * occasional large one, and some that grow the way buffers do.
+ */
+static uint64_t bench_trace_allocator_record_workload(ctd_allocator allocator)
+{
+    char* blocks[BENCH_TRACE_SLOTS] = {0};
+    ptrdiff_t sizes[BENCH_TRACE_SLOTS] = {0};
+    uint64_t random = 0x2545F4914F6CDD1Du;
+    uint64_t sink = 0;
+    for (ptrdiff_t i = 0; i < BENCH_TRACE_OPERATIONS; i++)
+    {
+        const uint64_t value = bench_trace_random(&random);
+        const ptrdiff_t slot = (ptrdiff_t)(value % BENCH_TRACE_SLOTS);
+        if (blocks[slot] == NULL)
+        {
+            sizes[slot] = value % 64 == 0 ? BENCH_TRACE_LARGE_SIZE : (ptrdiff_t)(value >> 32) % BENCH_TRACE_MAX_SMALL_SIZE + 1;
+            blocks[slot] = allocator.allocate(allocator.context, sizes[slot], alignof(max_align_t));
+        }
+        else if (value % 8 == 0 && sizes[slot] < BENCH_TRACE_LARGE_SIZE)
+        {
+            char* grown = allocator.reallocate(allocator.context, blocks[slot], sizes[slot], sizes[slot] * 2, alignof(max_align_t));
+            if (grown != NULL)
+            {
+                blocks[slot] = grown;
+                sizes[slot] *= 2;
+            }
+        }
+        else
+        {
+            allocator.deallocate(allocator.context, blocks[slot], sizes[slot]);
+            blocks[slot] = NULL;
+        }
+        if (blocks[slot] != NULL)
+        {
+            blocks[slot][0] = (char)i;
+            sink += (uintptr_t)blocks[slot];
+        }
+    }
+    for (ptrdiff_t slot = 0; slot < BENCH_TRACE_SLOTS; slot++)
+    {
+        if (blocks[slot] != NULL)
+        {
+            allocator.deallocate(allocator.context, blocks[slot], sizes[slot]);
+        }
+    }
+
+    return sink;
+}
+
+static void bench_trace_allocator_replay(FILE* trace, const char* label, ctd_allocator* allocator)
+{
+    ctd_error error = {0};
+    rewind(trace);
+    bench_replay_result result = bench_replay_trace(trace, allocator, &error);
+    CTD_ERROR_CHECK(error);
+    bench_replay_print_result(label, result);
+}
+
+void bench_ctd_trace_allocator_functions()
+{
+    uint64_t sink = 0;
+    printf("---------- Begin ctd_trace_allocator Bench ----------\n");
+
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    FILE* trace = tmpfile();
+    if (trace == NULL)
+    {
+        printf("Couldn't create a temporary file for the trace\n");
+        return;
+    }
+
+    printf("%d operations over %d live blocks:\n", BENCH_TRACE_OPERATIONS, BENCH_TRACE_SLOTS);
+    RUN_BENCH(trace_allocator_record_workload, "heap", sink, heap_allocator);
+    ctd_trace_allocator trace_allocator = ctd_trace_allocator_create(&heap_allocator, trace);
+    RUN_BENCH(trace_allocator_record_workload, "heap with trace", sink, trace_allocator.allocator);
+    ctd_trace_allocator_destroy(&trace_allocator);
+    printf("trace size %ld bytes\n", ftell(trace));
+
+    // The heap replays into memory malloc kept from recording, so its RSS growth understates what it would need cold
+    printf("Replaying the trace:\n");
+    bench_trace_allocator_replay(trace, "heap", &heap_allocator);
+
+    ctd_arena_allocator arena = ctd_arena_allocator_create(BENCH_TRACE_ARENA_SIZE, &heap_allocator);
+    bench_trace_allocator_replay(trace, "arena", &arena.allocator);
+    ctd_arena_allocator_destroy(&arena, &heap_allocator);
+
+    // Growing an expandable arena moves every block in it, which the replay can't follow, so it starts out large enough
+    ctd_expandable_arena_allocator expandable_arena = ctd_expandable_arena_allocator_create(BENCH_TRACE_ARENA_SIZE, &heap_allocator);
+    bench_trace_allocator_replay(trace, "expandable arena", &expandable_arena.allocator);
+    ctd_expandable_arena_allocator_destroy(&expandable_arena);
+
+    ctd_page_allocator page_allocator = ctd_page_allocator_create(BENCH_TRACE_PAGE_SIZE, &heap_allocator);
+    bench_trace_allocator_replay(trace, "page", &page_allocator.allocator);
+    ctd_page_allocator_destroy(&page_allocator);
+
+    fclose(trace);
+    printf("(sink %llu)\n", (unsigned long long)sink);
+    printf("---------- End ctd_trace_allocator Bench ----------\n\n");
+}
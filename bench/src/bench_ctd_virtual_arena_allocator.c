@@ -0,0 +1,76 @@
+#include <bench_ctd_virtual_arena_allocator.h>
+#include <ctd_virtual_arena_allocator.h>
+#include <ctd_expandable_arena_allocator.h>
+#include <bench.h>
+#include <stdalign.h>
+
+#define BENCH_GROWTH_TOTAL_SIZE ((ptrdiff_t)2 << 30)
+#define BENCH_GROWTH_STEP_SIZE ((ptrdiff_t)64 << 10)
+#define BENCH_PAGE_SIZE 4096
+
+/**
+ * Allocates BENCH_GROWTH_TOTAL_SIZE bytes in BENCH_GROWTH_STEP_SIZE chunks, writing to every page of each chunk.
+ */
+static uint64_t bench_arena_chunked_growth(ctd_allocator allocator)
+{
+    uint64_t sink = 0;
+    for (ptrdiff_t total = 0; total < BENCH_GROWTH_TOTAL_SIZE; total += BENCH_GROWTH_STEP_SIZE)
+    {
+        char* chunk = allocator.allocate(allocator.context, BENCH_GROWTH_STEP_SIZE, alignof(char));
+        if (chunk == NULL) return sink;
+        for (ptrdiff_t i = 0; i < BENCH_GROWTH_STEP_SIZE; i += BENCH_PAGE_SIZE)
+        {
+            chunk[i] = (char)i;
+        }
+        sink += (uintptr_t)chunk;
+    }
+
+    return sink;
+}
+
+/**
+ * Grows a single buffer to BENCH_GROWTH_TOTAL_SIZE bytes by BENCH_GROWTH_STEP_SIZE at a time, like a string builder or
+ * dynamic array that keeps being appended to.
+ */
+static uint64_t bench_arena_tail_growth(ctd_allocator allocator)
+{
+    ptrdiff_t size = BENCH_GROWTH_STEP_SIZE;
+    char* buffer = allocator.allocate(allocator.context, size, alignof(char));
+    if (buffer == NULL) return 0;
+    while (size < BENCH_GROWTH_TOTAL_SIZE)
+    {
+        char* new_buffer = allocator.reallocate(allocator.context, buffer, size, size + BENCH_GROWTH_STEP_SIZE, alignof(char));
+        if (new_buffer == NULL) break;
+        buffer = new_buffer;
+        for (ptrdiff_t i = size; i < size + BENCH_GROWTH_STEP_SIZE; i += BENCH_PAGE_SIZE)
+        {
+            buffer[i] = (char)i;
+        }
+        size += BENCH_GROWTH_STEP_SIZE;
+    }
+
+    return (uint64_t)size + (uint64_t)buffer[0];
+}
+
+void bench_ctd_virtual_arena_allocator_functions()
+{
+    uint64_t sink = 0;
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    printf("---------- Begin ctd_virtual_arena_allocator Bench ----------\n");
+
+    ctd_virtual_arena_allocator virtual_arena = ctd_virtual_arena_allocator_create(BENCH_GROWTH_TOTAL_SIZE * 2);
+    RUN_BENCH(arena_chunked_growth, "ctd_virtual_arena_allocator", sink, virtual_arena.allocator);
+    ctd_virtual_arena_allocator_reset(&virtual_arena);
+    RUN_BENCH(arena_tail_growth, "ctd_virtual_arena_allocator", sink, virtual_arena.allocator);
+    ctd_virtual_arena_allocator_destroy(&virtual_arena);
+
+    ctd_expandable_arena_allocator expandable_arena = ctd_expandable_arena_allocator_create(BENCH_GROWTH_STEP_SIZE, &heap_allocator);
+    RUN_BENCH(arena_chunked_growth, "ctd_expandable_arena_allocator", sink, expandable_arena.allocator);
+    ctd_expandable_arena_allocator_destroy(&expandable_arena);
+    expandable_arena = ctd_expandable_arena_allocator_create(BENCH_GROWTH_STEP_SIZE, &heap_allocator);
+    RUN_BENCH(arena_tail_growth, "ctd_expandable_arena_allocator", sink, expandable_arena.allocator);
+    ctd_expandable_arena_allocator_destroy(&expandable_arena);
+
+    printf("(sink %llu)\n", (unsigned long long)sink);
+    printf("---------- End ctd_virtual_arena_allocator Bench ----------\n\n");
+}
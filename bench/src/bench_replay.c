@@ -0,0 +1,271 @@
+#include <bench_replay.h>
+#include <ctd_trace_allocator.h>
+#include <bench.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BENCH_REPLAY_BATCH_SIZE 4096
+#define BENCH_REPLAY_INITIAL_CAPACITY 1024
+#define BENCH_REPLAY_EMPTY 0
+#define BENCH_REPLAY_TOMBSTONE UINT64_MAX
+
+/**
+ * Translates the addresses blocks had when the trace was recorded to the blocks handed out during the replay. It is an
+ * open addressing table with linear probing, since the replay spends most of its time looking addresses up.
+ */
+typedef struct bench_replay_block
+{
+    uint64_t recorded_address;
+    void* block;
+    ptrdiff_t size;
+} bench_replay_block;
+
+typedef struct bench_replay_map
+{
+    bench_replay_block* blocks;
+    ptrdiff_t capacity;
+    // Live blocks and tombstones, which both lengthen probes
+    ptrdiff_t used;
+} bench_replay_map;
+
+static inline ptrdiff_t bench_replay_map_slot(const bench_replay_map* map, const uint64_t recorded_address)
+{
+    return (ptrdiff_t)((recorded_address * 0x9E3779B97F4A7C15u) >> 32) & (map->capacity - 1);
+}
+
+static bench_replay_block* bench_replay_map_find(bench_replay_map* map, const uint64_t recorded_address)
+{
+    for (ptrdiff_t slot = bench_replay_map_slot(map, recorded_address);; slot = (slot + 1) & (map->capacity - 1))
+    {
+        bench_replay_block* entry = &map->blocks[slot];
+        if (entry->recorded_address == recorded_address)
+        {
+            return entry;
+        }
+        if (entry->recorded_address == BENCH_REPLAY_EMPTY)
+        {
+            return NULL;
+        }
+    }
+}
+
+static bool bench_replay_map_insert(bench_replay_map* map, uint64_t recorded_address, void* block, ptrdiff_t size);
+
+static bool bench_replay_map_grow(bench_replay_map* map)
+{
+    bench_replay_map old_map = *map;
+    ptrdiff_t live = 0;
+    for (ptrdiff_t i = 0; i < old_map.capacity; i++)
+    {
+        live += old_map.blocks[i].recorded_address != BENCH_REPLAY_EMPTY && old_map.blocks[i].recorded_address != BENCH_REPLAY_TOMBSTONE;
+    }
+    // Mostly tombstones only need to be cleared out, not more room
+    map->capacity = live * 4 > old_map.capacity ? old_map.capacity * 2 : old_map.capacity;
+    map->used = 0;
+    map->blocks = calloc(map->capacity, sizeof(bench_replay_block));
+    if (map->blocks == NULL)
+    {
+        *map = old_map;
+        return false;
+    }
+    for (ptrdiff_t i = 0; i < old_map.capacity; i++)
+    {
+        const bench_replay_block* entry = &old_map.blocks[i];
+        if (entry->recorded_address != BENCH_REPLAY_EMPTY && entry->recorded_address != BENCH_REPLAY_TOMBSTONE)
+        {
+            bench_replay_map_insert(map, entry->recorded_address, entry->block, entry->size);
+        }
+    }
+    free(old_map.blocks);
+    return true;
+}
+
+static bool bench_replay_map_insert(bench_replay_map* map, const uint64_t recorded_address, void* block, const ptrdiff_t size)
+{
+    if ((map->used + 1) * 2 > map->capacity && !bench_replay_map_grow(map))
+    {
+        return false;
+    }
+    // A recorded address is only reused once it was freed, so it can't already be in the map
+    ptrdiff_t slot = bench_replay_map_slot(map, recorded_address);
+    while (map->blocks[slot].recorded_address != BENCH_REPLAY_EMPTY && map->blocks[slot].recorded_address != BENCH_REPLAY_TOMBSTONE)
+    {
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    if (map->blocks[slot].recorded_address == BENCH_REPLAY_EMPTY)
+    {
+        map->used++;
+    }
+    map->blocks[slot] = (bench_replay_block) {recorded_address, block, size};
+    return true;
+}
+
+static inline void bench_replay_map_remove(bench_replay_block* entry)
+{
+    entry->recorded_address = BENCH_REPLAY_TOMBSTONE;
+}
+
+static ptrdiff_t bench_replay_rss_bytes()
+{
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == NULL)
+    {
+        return 0;
+    }
+    long long size = 0;
+    long long resident = 0;
+    if (fscanf(statm, "%lld %lld", &size, &resident) != 2)
+    {
+        resident = 0;
+    }
+    fclose(statm);
+    return (ptrdiff_t)resident * sysconf(_SC_PAGESIZE);
+}
+
+typedef struct bench_replay_state
+{
+    bench_replay_map map;
+    bench_replay_result result;
+    ptrdiff_t bytes_live;
+} bench_replay_state;
+
+static void bench_replay_add_live_bytes(bench_replay_state* state, const ptrdiff_t bytes)
+{
+    state->bytes_live += bytes;
+    if (state->bytes_live > state->result.peak_bytes_live)
+    {
+        state->result.peak_bytes_live = state->bytes_live;
+    }
+}
+
+/**
+ * Replays a single record. Calls that failed when recorded are skipped, as are calls on blocks that failed to allocate
+ * during the replay.
+ */
+static void bench_replay_record(bench_replay_state* state, ctd_allocator* allocator, const ctd_trace_record* record)
+{
+    switch (record->operation)
+    {
+    case CTD_TRACE_ALLOCATE:
+    {
+        if (record->result == 0) return;
+        void* block = allocator->allocate(allocator->context, record->size, record->align);
+        if (block == NULL || !bench_replay_map_insert(&state->map, record->result, block, record->size))
+        {
+            state->result.failed_operations++;
+            return;
+        }
+        bench_replay_add_live_bytes(state, record->size);
+        break;
+    }
+    case CTD_TRACE_REALLOCATE:
+    {
+        if (record->result == 0) return;
+        bench_replay_block* entry = bench_replay_map_find(&state->map, record->source);
+        if (entry == NULL) return;
+        void* block = allocator->reallocate(allocator->context, entry->block, entry->size, record->size, record->align);
+        if (block == NULL)
+        {
+            state->result.failed_operations++;
+            return;
+        }
+        bench_replay_add_live_bytes(state, record->size - entry->size);
+        if (record->result == record->source)
+        {
+            entry->block = block;
+            entry->size = record->size;
+        }
+        else
+        {
+            bench_replay_map_remove(entry);
+            if (!bench_replay_map_insert(&state->map, record->result, block, record->size))
+            {
+                allocator->deallocate(allocator->context, block, record->size);
+                state->bytes_live -= record->size;
+                state->result.failed_operations++;
+            }
+        }
+        break;
+    }
+    case CTD_TRACE_DEALLOCATE:
+    {
+        bench_replay_block* entry = bench_replay_map_find(&state->map, record->source);
+        if (entry == NULL) return;
+        allocator->deallocate(allocator->context, entry->block, entry->size);
+        state->bytes_live -= entry->size;
+        bench_replay_map_remove(entry);
+        break;
+    }
+    }
+    state->result.operations++;
+}
+
+bench_replay_result bench_replay_trace(FILE* stream, ctd_allocator* allocator, ctd_error* error)
+{
+    bench_replay_state state = {0};
+    ctd_trace_reader reader = ctd_trace_reader_create(stream, error);
+    ctd_trace_record* records = malloc(BENCH_REPLAY_BATCH_SIZE * sizeof(ctd_trace_record));
+    state.map.capacity = BENCH_REPLAY_INITIAL_CAPACITY;
+    state.map.blocks = calloc(state.map.capacity, sizeof(bench_replay_block));
+    if (records == NULL || state.map.blocks == NULL)
+    {
+        error->error_type = ALLOCATION_FAIL;
+        error->error_message = "Failed to allocate the replay's buffers";
+        goto cleanup;
+    }
+
+    const ptrdiff_t baseline_rss = bench_replay_rss_bytes();
+    while (error->error_type == NO_ERROR)
+    {
+        ptrdiff_t count = 0;
+        while (count < BENCH_REPLAY_BATCH_SIZE && ctd_trace_reader_next(&reader, &records[count], error))
+        {
+            count++;
+        }
+        if (count == 0)
+        {
+            break;
+        }
+
+        const uint64_t start = bench_now_ns();
+        for (ptrdiff_t i = 0; i < count; i++)
+        {
+            bench_replay_record(&state, allocator, &records[i]);
+        }
+        state.result.elapsed_ns += bench_now_ns() - start;
+
+        const ptrdiff_t rss = bench_replay_rss_bytes() - baseline_rss;
+        if (rss > state.result.peak_rss_bytes)
+        {
+            state.result.peak_rss_bytes = rss;
+        }
+    }
+    if (state.result.peak_bytes_live > 0)
+    {
+        state.result.fragmentation = (double)state.result.peak_rss_bytes / (double)state.result.peak_bytes_live;
+    }
+
+    for (ptrdiff_t i = 0; i < state.map.capacity; i++)
+    {
+        const bench_replay_block* entry = &state.map.blocks[i];
+        if (entry->recorded_address != BENCH_REPLAY_EMPTY && entry->recorded_address != BENCH_REPLAY_TOMBSTONE)
+        {
+            allocator->deallocate(allocator->context, entry->block, entry->size);
+        }
+    }
+
+cleanup:
+    free(state.map.blocks);
+    free(records);
+    return state.result;
+}
+
+void bench_replay_print_result(const char* label, const bench_replay_result result)
+{
+    const double ns_per_operation = result.operations > 0 ? (double)result.elapsed_ns / (double)result.operations : 0;
+    const double operations_per_second = result.elapsed_ns > 0 ? (double)result.operations * 1e9 / (double)result.elapsed_ns : 0;
+    printf("%-32s %10td ops %8.1f ns/op %12.0f ops/s %10.2f MiB peak live %10.2f MiB peak rss %6.2fx fragmentation %td failed\n",
+           label, result.operations, ns_per_operation, operations_per_second, (double)result.peak_bytes_live / (1 << 20),
+           (double)result.peak_rss_bytes / (1 << 20), result.fragmentation, result.failed_operations);
+}
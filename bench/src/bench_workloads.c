@@ -0,0 +1,613 @@
+#include <bench_workloads.h>
+#include <ctd_arena_allocator.h>
+#include <ctd_buddy_allocator.h>
+#include <ctd_concurrent_arena_allocator.h>
+#include <ctd_expandable_arena_allocator.h>
+#include <ctd_page_allocator.h>
+#include <ctd_routing_allocator.h>
+#include <ctd_slab_allocator.h>
+#include <ctd_string.h>
+#include <ctd_thread_cache_allocator.h>
+#include <ctd_virtual_arena_allocator.h>
+#include <bench.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_WORKLOAD_OPERATIONS ((ptrdiff_t)1 << 18)
+#define BENCH_WORKLOAD_LIFO_DEPTH 64
+#define BENCH_WORKLOAD_RANDOM_SLOTS 4096
+#define BENCH_WORKLOAD_CHURN_SLOTS 1024
+#define BENCH_WORKLOAD_MAX_GROW_SIZE ((ptrdiff_t)16 << 10)
+#define BENCH_WORKLOAD_MAX_STRING_LENGTH ((ptrdiff_t)64 << 10)
+// Arenas can't reuse memory that isn't at their tail, so they're given enough room for every workload up front.
+// Untouched parts of them never become resident, so this doesn't show up as peak memory.
+#define BENCH_WORKLOAD_ARENA_SIZE ((ptrdiff_t)1 << 30)
+#define BENCH_WORKLOAD_PAGE_SIZE ((ptrdiff_t)64 << 10)
+#define BENCH_WORKLOAD_SLAB_SIZE ((ptrdiff_t)64 << 10)
+#define BENCH_WORKLOAD_BUDDY_SIZE ((ptrdiff_t)256 << 20)
+#define BENCH_WORKLOAD_BUDDY_MIN_BLOCK_SIZE 64
+#define BENCH_WORKLOAD_ROUTING_SLAB_MAX_SIZE 1024
+
+/**
+ * What a workload did, filled in by the workload itself, so it doesn't depend on the allocator reporting anything.
+ */
+typedef struct bench_workload_counters
+{
+    ptrdiff_t operations;
+    ptrdiff_t failed_operations;
+    ptrdiff_t bytes_requested;
+    ptrdiff_t bytes_live;
+    ptrdiff_t peak_bytes_live;
+    uint64_t random;
+} bench_workload_counters;
+
+typedef struct bench_workload_result
+{
+    bench_workload_counters counters;
+    uint64_t elapsed_ns;
+    ptrdiff_t peak_rss_bytes;
+    bool completed;
+} bench_workload_result;
+
+static uint64_t bench_workload_random(bench_workload_counters* counters)
+{
+    counters->random ^= counters->random << 13;
+    counters->random ^= counters->random >> 7;
+    counters->random ^= counters->random << 17;
+    return counters->random;
+}
+
+static ptrdiff_t bench_workload_random_size(bench_workload_counters* counters, const ptrdiff_t min, const ptrdiff_t max)
+{
+    return min + (ptrdiff_t)(bench_workload_random(counters) % (uint64_t)(max - min + 1));
+}
+
+static char* bench_workload_allocate(ctd_allocator* allocator, bench_workload_counters* counters, const ptrdiff_t size)
+{
+    char* block = allocator->allocate(allocator->context, size, alignof(max_align_t));
+    counters->operations++;
+    if (block == NULL)
+    {
+        counters->failed_operations++;
+        return NULL;
+    }
+    // Touch the block like a caller would, so allocators that hand out untouched memory pay for faulting it in
+    block[0] = (char)size;
+    counters->bytes_requested += size;
+    counters->bytes_live += size;
+    if (counters->bytes_live > counters->peak_bytes_live)
+    {
+        counters->peak_bytes_live = counters->bytes_live;
+    }
+    return block;
+}
+
+static char* bench_workload_reallocate(ctd_allocator* allocator, bench_workload_counters* counters, char* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    char* reallocated = allocator->reallocate(allocator->context, block, old_size, new_size, alignof(max_align_t));
+    counters->operations++;
+    if (reallocated == NULL)
+    {
+        counters->failed_operations++;
+        return NULL;
+    }
+    reallocated[new_size - 1] = (char)new_size;
+    counters->bytes_requested += new_size - old_size;
+    counters->bytes_live += new_size - old_size;
+    if (counters->bytes_live > counters->peak_bytes_live)
+    {
+        counters->peak_bytes_live = counters->bytes_live;
+    }
+    return reallocated;
+}
+
+static void bench_workload_deallocate(ctd_allocator* allocator, bench_workload_counters* counters, char* block, const ptrdiff_t size)
+{
+    allocator->deallocate(allocator->context, block, size);
+    counters->operations++;
+    counters->bytes_live -= size;
+}
+
+/**
+ * Allocates small blocks of mixed sizes and never frees any of them, like a parser building a tree it throws away at
+ * once. The blocks are left for the allocator to free when it's destroyed, or for the process to when it exits.
+ */
+static void bench_workload_bump_only(ctd_allocator* allocator, bench_workload_counters* counters)
+{
+    for (ptrdiff_t i = 0; i < BENCH_WORKLOAD_OPERATIONS; i++)
+    {
+        bench_workload_allocate(allocator, counters, bench_workload_random_size(counters, 16, 256));
+    }
+}
+
+/**
+ * Allocates a stack of blocks and frees them newest first, over and over, like nested scratch buffers.
+ */
+static void bench_workload_lifo(ctd_allocator* allocator, bench_workload_counters* counters)
+{
+    char* blocks[BENCH_WORKLOAD_LIFO_DEPTH];
+    ptrdiff_t sizes[BENCH_WORKLOAD_LIFO_DEPTH];
+    while (counters->operations < BENCH_WORKLOAD_OPERATIONS)
+    {
+        for (ptrdiff_t i = 0; i < BENCH_WORKLOAD_LIFO_DEPTH; i++)
+        {
+            sizes[i] = bench_workload_random_size(counters, 16, 1024);
+            blocks[i] = bench_workload_allocate(allocator, counters, sizes[i]);
+        }
+        for (ptrdiff_t i = BENCH_WORKLOAD_LIFO_DEPTH - 1; i >= 0; i--)
+        {
+            if (blocks[i] != NULL)
+            {
+                bench_workload_deallocate(allocator, counters, blocks[i], sizes[i]);
+            }
+        }
+    }
+}
+
+/**
+ * Keeps a pool of live blocks and frees them in random order, like objects with unrelated lifetimes.
+ */
+static void bench_workload_random_free(ctd_allocator* allocator, bench_workload_counters* counters)
+{
+    char* blocks[BENCH_WORKLOAD_RANDOM_SLOTS] = {0};
+    ptrdiff_t sizes[BENCH_WORKLOAD_RANDOM_SLOTS] = {0};
+    while (counters->operations < BENCH_WORKLOAD_OPERATIONS)
+    {
+        const ptrdiff_t slot = (ptrdiff_t)(bench_workload_random(counters) % BENCH_WORKLOAD_RANDOM_SLOTS);
+        if (blocks[slot] != NULL)
+        {
+            bench_workload_deallocate(allocator, counters, blocks[slot], sizes[slot]);
+            blocks[slot] = NULL;
+        }
+        else
+        {
+            sizes[slot] = bench_workload_random_size(counters, 16, 512);
+            blocks[slot] = bench_workload_allocate(allocator, counters, sizes[slot]);
+        }
+    }
+    for (ptrdiff_t slot = 0; slot < BENCH_WORKLOAD_RANDOM_SLOTS; slot++)
+    {
+        if (blocks[slot] != NULL)
+        {
+            bench_workload_deallocate(allocator, counters, blocks[slot], sizes[slot]);
+        }
+    }
+}
+
+/**
+ * Grows two buffers by half their size at a time, taking turns, like two dynamic arrays being filled at once. Since
+ * they take turns, only one of them can be at the tail of an arena.
+ */
+static void bench_workload_realloc_grow(ctd_allocator* allocator, bench_workload_counters* counters)
+{
+    while (counters->operations < BENCH_WORKLOAD_OPERATIONS)
+    {
+        char* buffers[2];
+        ptrdiff_t sizes[2] = {16, 16};
+        buffers[0] = bench_workload_allocate(allocator, counters, sizes[0]);
+        buffers[1] = bench_workload_allocate(allocator, counters, sizes[1]);
+        while (counters->failed_operations == 0 && sizes[1] < BENCH_WORKLOAD_MAX_GROW_SIZE)
+        {
+            for (ptrdiff_t i = 0; i < 2; i++)
+            {
+                char* grown = bench_workload_reallocate(allocator, counters, buffers[i], sizes[i], sizes[i] + sizes[i] / 2);
+                if (grown == NULL) break;
+                buffers[i] = grown;
+                sizes[i] += sizes[i] / 2;
+            }
+        }
+        for (ptrdiff_t i = 1; i >= 0; i--)
+        {
+            if (buffers[i] != NULL)
+            {
+                bench_workload_deallocate(allocator, counters, buffers[i], sizes[i]);
+            }
+        }
+        if (counters->failed_operations > 0) return;
+    }
+}
+
+/**
+ * Builds strings out of short pieces with a string builder, which grows its buffer through the allocator.
+ */
+static void bench_workload_string_builder_append(ctd_allocator* allocator, bench_workload_counters* counters)
+{
+    static const ctd_string pieces[] = {
+        ctd_string_create_from_literal("GET "),
+        ctd_string_create_from_literal("/api/v1/allocators?name=page&size=65536"),
+        ctd_string_create_from_literal(" HTTP/1.1\r\n"),
+        ctd_string_create_from_literal("Content-Type: application/json\r\n"),
+    };
+    while (counters->operations < BENCH_WORKLOAD_OPERATIONS)
+    {
+        ctd_error error = {0};
+        ctd_string_builder builder = ctd_string_builder_create(16, allocator, &error);
+        if (error.error_type != NO_ERROR)
+        {
+            counters->failed_operations++;
+            return;
+        }
+        while (builder.length < BENCH_WORKLOAD_MAX_STRING_LENGTH && error.error_type == NO_ERROR)
+        {
+            const ctd_string piece = pieces[counters->operations % countof(pieces)];
+            ctd_string_builder_append(&builder, piece, &error);
+            counters->operations++;
+            counters->bytes_requested += piece.length;
+        }
+        if (error.error_type != NO_ERROR)
+        {
+            counters->failed_operations++;
+        }
+        if (builder.capacity > counters->peak_bytes_live)
+        {
+            counters->peak_bytes_live = builder.capacity;
+        }
+        ctd_string_builder_destroy(&builder);
+        if (counters->failed_operations > 0) return;
+    }
+}
+
+/**
+ * Keeps replacing blocks in a pool with blocks of a different size, mostly small with some up to 64 KB, so freed
+ * memory rarely fits the next request exactly.
+ */
+static void bench_workload_mixed_size_churn(ctd_allocator* allocator, bench_workload_counters* counters)
+{
+    char* blocks[BENCH_WORKLOAD_CHURN_SLOTS] = {0};
+    ptrdiff_t sizes[BENCH_WORKLOAD_CHURN_SLOTS] = {0};
+    while (counters->operations < BENCH_WORKLOAD_OPERATIONS)
+    {
+        const uint64_t value = bench_workload_random(counters);
+        const ptrdiff_t slot = (ptrdiff_t)(value % BENCH_WORKLOAD_CHURN_SLOTS);
+        if (blocks[slot] != NULL)
+        {
+            bench_workload_deallocate(allocator, counters, blocks[slot], sizes[slot]);
+        }
+        const uint64_t size_class = (value >> 32) % 100;
+        sizes[slot] = size_class < 80 ? bench_workload_random_size(counters, 16, 256)
+                      : size_class < 95 ? bench_workload_random_size(counters, 257, 4096)
+                                        : bench_workload_random_size(counters, 4097, 64 << 10);
+        blocks[slot] = bench_workload_allocate(allocator, counters, sizes[slot]);
+    }
+    for (ptrdiff_t slot = 0; slot < BENCH_WORKLOAD_CHURN_SLOTS; slot++)
+    {
+        if (blocks[slot] != NULL)
+        {
+            bench_workload_deallocate(allocator, counters, blocks[slot], sizes[slot]);
+        }
+    }
+}
+
+/**
+ * Like mixed_size_churn, but spread over every size an application asks for, from tiny nodes to buffers of a few MB
+ * that are rare but dominate the bytes.
+ */
+static void bench_workload_mixed_tiers(ctd_allocator* allocator, bench_workload_counters* counters)
+{
+    char* blocks[BENCH_WORKLOAD_CHURN_SLOTS] = {0};
+    ptrdiff_t sizes[BENCH_WORKLOAD_CHURN_SLOTS] = {0};
+    while (counters->operations < BENCH_WORKLOAD_OPERATIONS)
+    {
+        const uint64_t value = bench_workload_random(counters);
+        const ptrdiff_t slot = (ptrdiff_t)(value % BENCH_WORKLOAD_CHURN_SLOTS);
+        if (blocks[slot] != NULL)
+        {
+            bench_workload_deallocate(allocator, counters, blocks[slot], sizes[slot]);
+        }
+        const uint64_t size_class = (value >> 32) % 1000;
+        sizes[slot] = size_class < 890 ? bench_workload_random_size(counters, 16, 1024)
+                      : size_class < 998 ? bench_workload_random_size(counters, 1025, 256 << 10)
+                                         : bench_workload_random_size(counters, (1 << 20) + 1, 4 << 20);
+        blocks[slot] = bench_workload_allocate(allocator, counters, sizes[slot]);
+    }
+    for (ptrdiff_t slot = 0; slot < BENCH_WORKLOAD_CHURN_SLOTS; slot++)
+    {
+        if (blocks[slot] != NULL)
+        {
+            bench_workload_deallocate(allocator, counters, blocks[slot], sizes[slot]);
+        }
+    }
+}
+
+typedef struct bench_workload
+{
+    const char* name;
+    void (*run)(ctd_allocator* allocator, bench_workload_counters* counters);
+    // Allocates far more in total than it keeps live, so only allocators that reuse freed memory can run it
+    bool needs_reuse;
+} bench_workload;
+
+static const bench_workload bench_workloads[] = {
+    {"bump_only", bench_workload_bump_only, false},
+    {"lifo", bench_workload_lifo, false},
+    {"random_free", bench_workload_random_free, false},
+    {"realloc_grow", bench_workload_realloc_grow, false},
+    {"string_builder_append", bench_workload_string_builder_append, false},
+    {"mixed_size_churn", bench_workload_mixed_size_churn, false},
+    // Its MB-sized blocks add up to more than BENCH_WORKLOAD_ARENA_SIZE long before the workload ends
+    {"mixed_tiers", bench_workload_mixed_tiers, true},
+};
+
+/**
+ * Everything an allocator under test needs, so that it can be created and destroyed the same way for every workload.
+ */
+typedef struct bench_workload_allocator
+{
+    ctd_allocator allocator;
+    ctd_allocator heap_allocator;
+    ctd_arena_allocator arena;
+    ctd_buddy_allocator buddy_allocator;
+    ctd_concurrent_arena_allocator concurrent_arena;
+    ctd_expandable_arena_allocator expandable_arena;
+    ctd_page_allocator page_allocator;
+    ctd_routing_allocator routing_allocator;
+    ctd_slab_allocator slab_allocator;
+    ctd_thread_cache_allocator thread_cache_allocator;
+    ctd_virtual_arena_allocator virtual_arena;
+} bench_workload_allocator;
+
+static bool bench_workload_create_heap(bench_workload_allocator* self)
+{
+    self->allocator = self->heap_allocator;
+    return true;
+}
+
+static bool bench_workload_create_arena(bench_workload_allocator* self)
+{
+    self->arena = ctd_arena_allocator_create(BENCH_WORKLOAD_ARENA_SIZE, &self->heap_allocator);
+    self->allocator = self->arena.allocator;
+    return self->allocator.context != NULL;
+}
+
+static bool bench_workload_create_buddy(bench_workload_allocator* self)
+{
+    self->buddy_allocator = ctd_buddy_allocator_create(BENCH_WORKLOAD_BUDDY_SIZE, BENCH_WORKLOAD_BUDDY_MIN_BLOCK_SIZE, &self->heap_allocator);
+    self->allocator = self->buddy_allocator.allocator;
+    return self->allocator.context != NULL;
+}
+
+static bool bench_workload_create_concurrent_arena(bench_workload_allocator* self)
+{
+    self->concurrent_arena = ctd_concurrent_arena_allocator_create(BENCH_WORKLOAD_ARENA_SIZE, &self->heap_allocator);
+    self->allocator = self->concurrent_arena.allocator;
+    return self->allocator.context != NULL;
+}
+
+/**
+ * Growing an expandable arena moves every block in it, which would leave the workloads' pointers dangling, so it is
+ * created large enough to never grow.
+ */
+static bool bench_workload_create_expandable_arena(bench_workload_allocator* self)
+{
+    self->expandable_arena = ctd_expandable_arena_allocator_create(BENCH_WORKLOAD_ARENA_SIZE, &self->heap_allocator);
+    self->allocator = self->expandable_arena.allocator;
+    return self->allocator.context != NULL;
+}
+
+static bool bench_workload_create_page(bench_workload_allocator* self)
+{
+    self->page_allocator = ctd_page_allocator_create(BENCH_WORKLOAD_PAGE_SIZE, &self->heap_allocator);
+    self->allocator = self->page_allocator.allocator;
+    return self->allocator.context != NULL;
+}
+
+static bool bench_workload_create_slab(bench_workload_allocator* self)
+{
+    self->slab_allocator = ctd_slab_allocator_create(BENCH_WORKLOAD_SLAB_SIZE, &self->heap_allocator);
+    self->allocator = self->slab_allocator.allocator;
+    return self->allocator.context != NULL;
+}
+
+/**
+ * Tiny blocks go to a slab allocator, medium blocks to a buddy allocator, and blocks over 1 MB are mapped straight from
+ * the operating system. Like malloc, the tiers leave freed memory as is, since zeroing medium blocks would cost more
+ * than everything else combined.
+ */
+static bool bench_workload_create_routing(bench_workload_allocator* self)
+{
+    self->slab_allocator = ctd_slab_allocator_create_with_scrub_policy(BENCH_WORKLOAD_SLAB_SIZE, CTD_SCRUB_NONE, &self->heap_allocator);
+    self->buddy_allocator = ctd_buddy_allocator_create_with_scrub_policy(BENCH_WORKLOAD_BUDDY_SIZE, BENCH_WORKLOAD_BUDDY_MIN_BLOCK_SIZE, CTD_SCRUB_NONE, &self->heap_allocator);
+    if (self->slab_allocator.allocator.context == NULL || self->buddy_allocator.allocator.context == NULL) return false;
+    const ctd_routing_tier tiers[] = {
+        {.max_size = BENCH_WORKLOAD_ROUTING_SLAB_MAX_SIZE, .allocator = &self->slab_allocator.allocator},
+        {.max_size = CTD_ROUTING_DEFAULT_MMAP_THRESHOLD, .allocator = &self->buddy_allocator.allocator},
+    };
+    self->routing_allocator = ctd_routing_allocator_create(tiers, countof(tiers), &self->heap_allocator);
+    self->allocator = self->routing_allocator.allocator;
+    return self->allocator.context != NULL;
+}
+
+static bool bench_workload_create_thread_cache(bench_workload_allocator* self)
+{
+    if (!bench_workload_create_slab(self)) return false;
+    self->thread_cache_allocator = ctd_thread_cache_allocator_create(&self->slab_allocator.allocator);
+    self->allocator = self->thread_cache_allocator.allocator;
+    return self->allocator.context != NULL;
+}
+
+static bool bench_workload_create_virtual_arena(bench_workload_allocator* self)
+{
+    self->virtual_arena = ctd_virtual_arena_allocator_create(BENCH_WORKLOAD_ARENA_SIZE);
+    self->allocator = self->virtual_arena.allocator;
+    return self->allocator.context != NULL;
+}
+
+typedef struct bench_workload_allocator_type
+{
+    const char* name;
+    bool (*create)(bench_workload_allocator* self);
+    // Arenas only take back blocks at their tail, so workloads that free in random order use them up
+    bool reuses_freed_memory;
+} bench_workload_allocator_type;
+
+static const bench_workload_allocator_type bench_workload_allocator_types[] = {
+    {"heap", bench_workload_create_heap, true},
+    {"arena", bench_workload_create_arena, false},
+    {"buddy", bench_workload_create_buddy, true},
+    {"concurrent_arena", bench_workload_create_concurrent_arena, false},
+    {"expandable_arena", bench_workload_create_expandable_arena, false},
+    {"page", bench_workload_create_page, true},
+    {"routing", bench_workload_create_routing, true},
+    {"slab", bench_workload_create_slab, true},
+    {"thread_cache", bench_workload_create_thread_cache, true},
+    {"virtual_arena", bench_workload_create_virtual_arena, false},
+};
+
+static ptrdiff_t bench_workload_rss_bytes()
+{
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == NULL)
+    {
+        return 0;
+    }
+    long long size = 0;
+    long long resident = 0;
+    if (fscanf(statm, "%lld %lld", &size, &resident) != 2)
+    {
+        resident = 0;
+    }
+    fclose(statm);
+    return (ptrdiff_t)resident * sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * Runs a workload in the calling process. A freshly forked child's peak resident set starts out at its current
+ * resident set, so the peak measured here belongs to this run alone.
+ */
+static bench_workload_result bench_workload_run(const bench_workload* workload, const bench_workload_allocator_type* type)
+{
+    bench_workload_result result = {0};
+    result.counters.random = 0x2545F4914F6CDD1Du;
+    const ptrdiff_t baseline_rss = bench_workload_rss_bytes();
+
+    bench_workload_allocator allocator = {.heap_allocator = ctd_heap_allocator_create().allocator};
+    if (!type->create(&allocator))
+    {
+        return result;
+    }
+
+    const uint64_t start = bench_now_ns();
+    workload->run(&allocator.allocator, &result.counters);
+    result.elapsed_ns = bench_now_ns() - start;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peak_rss_bytes = (ptrdiff_t)usage.ru_maxrss * 1024 - baseline_rss;
+    result.completed = true;
+    // The child exits right after this, which releases everything the allocators hold
+    return result;
+}
+
+static bench_workload_result bench_workload_run_in_child(const bench_workload* workload, const bench_workload_allocator_type* type)
+{
+    bench_workload_result result = {0};
+    int pipe_ends[2];
+    if (pipe(pipe_ends) != 0)
+    {
+        return result;
+    }
+    fflush(stdout);
+    const pid_t child = fork();
+    if (child == 0)
+    {
+        close(pipe_ends[0]);
+        result = bench_workload_run(workload, type);
+        const ssize_t written = write(pipe_ends[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+    close(pipe_ends[1]);
+    if (child > 0)
+    {
+        if (read(pipe_ends[0], &result, sizeof(result)) != sizeof(result))
+        {
+            result = (bench_workload_result) {0};
+        }
+        waitpid(child, NULL, 0);
+    }
+    close(pipe_ends[0]);
+    return result;
+}
+
+/**
+ * Writes a result as JSON. Runs that didn't complete, or had operations fail, didn't do the same work as the others, so
+ * they're marked as not comparable.
+ */
+static void bench_workload_write_json(FILE* json, const bench_workload* workload, const bench_workload_allocator_type* type, const bench_workload_result* result, const bool first)
+{
+    const bench_workload_counters* counters = &result->counters;
+    const double operations = counters->operations > 0 ? (double)counters->operations : 1;
+    fprintf(json,
+            "%s\n    {\"workload\": \"%s\", \"allocator\": \"%s\", \"completed\": %s, \"comparable\": %s, "
+            "\"operations\": %td, \"failed_operations\": %td, \"ns_per_op\": %.3f, \"bytes_per_op\": %.3f, "
+            "\"peak_bytes_live\": %td, \"peak_rss_bytes\": %td}",
+            first ? "" : ",", workload->name, type->name, result->completed ? "true" : "false",
+            result->completed && counters->failed_operations == 0 ? "true" : "false", counters->operations,
+            counters->failed_operations, (double)result->elapsed_ns / operations, (double)counters->bytes_requested / operations,
+            counters->peak_bytes_live, result->peak_rss_bytes);
+}
+
+void bench_workloads_functions(const char* json_path)
+{
+    printf("---------- Begin allocator workloads Bench ----------\n");
+    FILE* json = json_path != NULL ? fopen(json_path, "w") : NULL;
+    if (json_path != NULL && json == NULL)
+    {
+        printf("Couldn't open %s, results are only printed\n", json_path);
+    }
+    if (json != NULL)
+    {
+        fprintf(json, "{\n  \"operations_per_workload\": %td,\n  \"results\": [", BENCH_WORKLOAD_OPERATIONS);
+    }
+
+    printf("%-22s %-17s %10s %10s %12s %14s %14s %8s\n", "workload", "allocator", "ns/op", "bytes/op", "operations",
+           "peak live", "peak rss", "failed");
+    bool first = true;
+    for (ptrdiff_t i = 0; i < countof(bench_workloads); i++)
+    {
+        for (ptrdiff_t j = 0; j < countof(bench_workload_allocator_types); j++)
+        {
+            const bench_workload* workload = &bench_workloads[i];
+            const bench_workload_allocator_type* type = &bench_workload_allocator_types[j];
+            if (workload->needs_reuse && !type->reuses_freed_memory)
+            {
+                printf("%-22s %-17s skipped, doesn't reuse freed memory\n", workload->name, type->name);
+                continue;
+            }
+            const bench_workload_result result = bench_workload_run_in_child(workload, type);
+            const bench_workload_counters* counters = &result.counters;
+            if (!result.completed)
+            {
+                printf("%-22s %-17s couldn't be run\n", workload->name, type->name);
+            }
+            else if (counters->failed_operations > 0)
+            {
+                // Failed operations return straight away, so the timings would look better than they are
+                printf("%-22s %-17s %10s %10s %12td %14s %14s %8td  not comparable\n", workload->name, type->name, "-", "-",
+                       counters->operations, "-", "-", counters->failed_operations);
+            }
+            else
+            {
+                const double operations = counters->operations > 0 ? (double)counters->operations : 1;
+                printf("%-22s %-17s %10.1f %10.1f %12td %14td %14td %8td\n", workload->name, type->name,
+                       (double)result.elapsed_ns / operations, (double)counters->bytes_requested / operations,
+                       counters->operations, counters->peak_bytes_live, result.peak_rss_bytes, counters->failed_operations);
+            }
+            if (json != NULL)
+            {
+                bench_workload_write_json(json, workload, type, &result, first);
+                first = false;
+            }
+        }
+    }
+
+    if (json != NULL)
+    {
+        fprintf(json, "\n  ]\n}\n");
+        fclose(json);
+        printf("Results written to %s\n", json_path);
+    }
+    printf("---------- End allocator workloads Bench ----------\n\n");
+}
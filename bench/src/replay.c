@@ -0,0 +1,84 @@
+#include <bench_replay.h>
+#include <ctd_arena_allocator.h>
+#include <ctd_expandable_arena_allocator.h>
+#include <ctd_page_allocator.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_DEFAULT_ARENA_SIZE ((ptrdiff_t)1 << 30)
+#define REPLAY_DEFAULT_PAGE_SIZE ((ptrdiff_t)64 << 10)
+
+/**
+ * Replays a trace recorded with ctd_trace_allocator against one of the library's allocators.
+ *
+ * Usage: ctdlib_replay <trace file or - for stdin> <heap|arena|expandable|page> [size in bytes]
+ * The size is the capacity of the arena or expandable arena, or the page allocator's page size. Growing an expandable
+ * arena moves every block in it, which a replay can't follow, so its size has to be large enough that it never grows.
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s <trace file or -> <heap|arena|expandable|page> [size in bytes]\n", argv[0]);
+        return 1;
+    }
+    const char* allocator_name = argv[2];
+    const ptrdiff_t size = argc > 3 ? (ptrdiff_t)strtoll(argv[3], NULL, 10) : 0;
+
+    FILE* trace = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "rb");
+    if (trace == NULL)
+    {
+        fprintf(stderr, "Couldn't open %s\n", argv[1]);
+        return 1;
+    }
+
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_error error = {0};
+    bench_replay_result result = {0};
+    if (strcmp(allocator_name, "heap") == 0)
+    {
+        result = bench_replay_trace(trace, &heap_allocator, &error);
+    }
+    else if (strcmp(allocator_name, "arena") == 0)
+    {
+        ctd_arena_allocator arena = ctd_arena_allocator_create(size > 0 ? size : REPLAY_DEFAULT_ARENA_SIZE, &heap_allocator);
+        if (arena.allocator.context == NULL) goto allocation_failed;
+        result = bench_replay_trace(trace, &arena.allocator, &error);
+        ctd_arena_allocator_destroy(&arena, &heap_allocator);
+    }
+    else if (strcmp(allocator_name, "expandable") == 0)
+    {
+        ctd_expandable_arena_allocator arena = ctd_expandable_arena_allocator_create(size > 0 ? size : REPLAY_DEFAULT_ARENA_SIZE, &heap_allocator);
+        if (arena.allocator.context == NULL) goto allocation_failed;
+        result = bench_replay_trace(trace, &arena.allocator, &error);
+        ctd_expandable_arena_allocator_destroy(&arena);
+    }
+    else if (strcmp(allocator_name, "page") == 0)
+    {
+        ctd_page_allocator page_allocator = ctd_page_allocator_create(size > 0 ? size : REPLAY_DEFAULT_PAGE_SIZE, &heap_allocator);
+        if (page_allocator.allocator.context == NULL) goto allocation_failed;
+        result = bench_replay_trace(trace, &page_allocator.allocator, &error);
+        ctd_page_allocator_destroy(&page_allocator);
+    }
+    else
+    {
+        fprintf(stderr, "Unknown allocator %s\n", allocator_name);
+        return 1;
+    }
+
+    if (trace != stdin)
+    {
+        fclose(trace);
+    }
+    bench_replay_print_result(allocator_name, result);
+    if (error.error_type != NO_ERROR)
+    {
+        fprintf(stderr, "%s\n", error.error_message);
+        return 1;
+    }
+    return 0;
+
+allocation_failed:
+    fprintf(stderr, "Couldn't create the %s allocator\n", allocator_name);
+    return 1;
+}
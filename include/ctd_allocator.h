@@ -1,5 +1,6 @@
 #ifndef CTD_ALLOCATOR_H
 #define CTD_ALLOCATOR_H
+#include <stdbool.h>
 #include <stddef.h>
 
 typedef struct ctd_allocator
@@ -8,8 +9,138 @@ typedef struct ctd_allocator
     void* (*reallocate)(void*, void*, ptrdiff_t, ptrdiff_t, ptrdiff_t); // context, pointer, old_size, new_size, align
     void (*deallocate)(void*, void*, ptrdiff_t); // context, pointer, size
     void* context;
+    // Optional, may be NULL. Entries after context are optional so that allocators written as {allocate, reallocate,
+    // deallocate, context} stay valid.
+    bool (*try_resize)(void*, void*, ptrdiff_t, ptrdiff_t); // context, pointer, old_size, new_size
+    // Optional, may be NULL. Like allocate and reallocate, but also store how many bytes the block can actually hold
+    void* (*allocate_sized)(void*, ptrdiff_t, ptrdiff_t, ptrdiff_t*); // context, size, align, usable_size
+    void* (*reallocate_sized)(void*, void*, ptrdiff_t, ptrdiff_t, ptrdiff_t, ptrdiff_t*); // context, pointer, old_size, new_size, align, usable_size
+    // Optional, may be NULL. Allocate or deallocate count blocks of the same size in a single call
+    bool (*allocate_batch)(void*, ptrdiff_t, ptrdiff_t, ptrdiff_t, void**); // context, count, size, align, blocks
+    void (*deallocate_batch)(void*, ptrdiff_t, ptrdiff_t, void**); // context, count, size, blocks
 } ctd_allocator;
 
+/**
+ * Grows or shrinks a block without moving it. Unlike reallocate, this fails fast instead of copying the block
+ * somewhere else, so callers can find out whether growing in place is possible before committing to a copy.
+ *
+ * @param allocator Allocator the block was allocated with
+ * @param block Pointer to the block
+ * @param old_size Current size of the block
+ * @param new_size Size the block should be resized to
+ * @return Whether the block was resized. If not, the block is left untouched, which is always the case for allocators
+ * that don't implement try_resize.
+ */
+static inline bool ctd_allocator_try_resize(const ctd_allocator* allocator, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    return allocator->try_resize != NULL && allocator->try_resize(allocator->context, block, old_size, new_size);
+}
+
+/**
+ * Allocates a block and finds out how much of it can be used. Allocators often hand out more than was asked for, e.g.
+ * to round up to a size class, and the whole block can be used as if that much had been requested. Its size is
+ * usable_size from then on, for reallocate, try_resize, and deallocate alike.
+ *
+ * @param allocator Allocator to allocate the block with
+ * @param size Minimum size of the block
+ * @param align Alignment of the block
+ * @param usable_size Set to the size of the block if successful, which is size for allocators that don't implement
+ * allocate_sized
+ * @return Pointer to the block if successful, otherwise NULL.
+ */
+static inline void* ctd_allocator_allocate_sized(const ctd_allocator* allocator, const ptrdiff_t size, const ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    if (allocator->allocate_sized != NULL)
+    {
+        return allocator->allocate_sized(allocator->context, size, align, usable_size);
+    }
+    *usable_size = size;
+    return allocator->allocate(allocator->context, size, align);
+}
+
+/**
+ * Reallocates a block and finds out how much of it can be used, the same way ctd_allocator_allocate_sized does.
+ *
+ * @param allocator Allocator the block was allocated with
+ * @param block Pointer to the block
+ * @param old_size Current size of the block
+ * @param new_size Minimum size of the reallocated block
+ * @param align Alignment of the block
+ * @param usable_size Set to the size of the reallocated block if successful
+ * @return Pointer to the reallocated block if successful, otherwise NULL and the block is left untouched.
+ */
+static inline void* ctd_allocator_reallocate_sized(const ctd_allocator* allocator, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    if (allocator->reallocate_sized != NULL)
+    {
+        return allocator->reallocate_sized(allocator->context, block, old_size, new_size, align, usable_size);
+    }
+    *usable_size = new_size;
+    return allocator->reallocate(allocator->context, block, old_size, new_size, align);
+}
+
+/**
+ * Allocates count blocks of the same size and alignment. Allocators that implement allocate_batch can hand out the
+ * whole batch at once, e.g. with a single bump of an arena, and the rest get one allocate call per block. Either way,
+ * each block is independent afterwards and can be reallocated or deallocated on its own.
+ *
+ * @param allocator Allocator to allocate the blocks with
+ * @param count Number of blocks to allocate
+ * @param size Size of each block
+ * @param align Alignment of each block
+ * @param blocks Array of at least count pointers, which is filled with the blocks
+ * @return Whether every block was allocated. If not, none of them are, and blocks is left unspecified.
+ */
+static inline bool ctd_allocator_allocate_batch(const ctd_allocator* allocator, const ptrdiff_t count, const ptrdiff_t size, const ptrdiff_t align, void** blocks)
+{
+    if (allocator->allocate_batch != NULL)
+    {
+        return allocator->allocate_batch(allocator->context, count, size, align, blocks);
+    }
+    for (ptrdiff_t i = 0; i < count; i++)
+    {
+        blocks[i] = allocator->allocate(allocator->context, size, align);
+        if (blocks[i] == NULL)
+        {
+            // Freed in reverse, so that arenas can take the blocks back
+            while (i-- > 0)
+            {
+                allocator->deallocate(allocator->context, blocks[i], size);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Deallocates count blocks of the same size, in reverse order so that arenas can take back as many of them as possible.
+ * The blocks don't have to come from the same ctd_allocator_allocate_batch call.
+ *
+ * @param allocator Allocator the blocks were allocated with
+ * @param count Number of blocks to deallocate
+ * @param size Size of each block
+ * @param blocks Array of the blocks
+ */
+static inline void ctd_allocator_deallocate_batch(const ctd_allocator* allocator, const ptrdiff_t count, const ptrdiff_t size, void** blocks)
+{
+    if (allocator->deallocate_batch != NULL)
+    {
+        allocator->deallocate_batch(allocator->context, count, size, blocks);
+        return;
+    }
+    for (ptrdiff_t i = count - 1; i >= 0; i--)
+    {
+        allocator->deallocate(allocator->context, blocks[i], size);
+    }
+}
+
+/**
+ * A wrapper around malloc, realloc, and free. Alignments above alignof(max_align_t) are honoured on both allocate
+ * and reallocate, and blocks from either can still be released with free. On glibc, try_resize succeeds whenever the
+ * new size fits in the block's malloc_usable_size, and the sized entry points report it. Batches are allocated and
+ * freed with direct calls to malloc and free.
+ */
 typedef struct ctd_heap_allocator
 {
     ctd_allocator allocator;
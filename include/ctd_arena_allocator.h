@@ -1,13 +1,36 @@
 #ifndef CTD_ARENA_H
 #define CTD_ARENA_H
 #include <ctd_allocator.h>
+#include <ctd_scrub.h>
+#include <stdbool.h>
 
 typedef struct ctd_arena_allocator
 {
     ctd_allocator allocator;
 } ctd_arena_allocator;
 
+/**
+ * A position inside an arena that can be returned to later. For allocators made of multiple arenas, page is the index
+ * of the arena the position is in and large_pages is how many dedicated pages for oversized allocations had been
+ * created, otherwise they are always 0.
+ */
+typedef struct ctd_arena_save_point
+{
+    ptrdiff_t page;
+    ptrdiff_t length;
+    ptrdiff_t large_pages;
+} ctd_arena_save_point;
+
 ctd_arena_allocator ctd_arena_allocator_create(ptrdiff_t size, ctd_allocator* alloc);
+ctd_arena_allocator ctd_arena_allocator_create_with_scrub_policy(ptrdiff_t size, ctd_scrub_policy scrub_policy, ctd_allocator* alloc);
+ctd_arena_allocator ctd_arena_allocator_create_in_buffer(void* buffer, ptrdiff_t size);
+ctd_arena_allocator ctd_arena_allocator_create_in_buffer_with_scrub_policy(void* buffer, ptrdiff_t size, ctd_scrub_policy scrub_policy);
 void ctd_arena_allocator_destroy(ctd_arena_allocator* self, ctd_allocator* allocator);
+ctd_arena_save_point ctd_arena_allocator_mark(ctd_arena_allocator* self);
+void ctd_arena_allocator_rewind(ctd_arena_allocator* self, ctd_arena_save_point save_point);
+void ctd_arena_allocator_reset(ctd_arena_allocator* self);
+bool ctd_arena_allocator_resize_tail(ctd_arena_allocator* self, void* source, ptrdiff_t old_size, ptrdiff_t new_size);
+ptrdiff_t ctd_arena_allocator_used(ctd_arena_allocator* self);
+ptrdiff_t ctd_arena_allocator_capacity(ctd_arena_allocator* self);
 
 #endif // CTD_ARENA_H
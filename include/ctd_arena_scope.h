@@ -0,0 +1,51 @@
+#ifndef CTD_ARENA_SCOPE_H
+#define CTD_ARENA_SCOPE_H
+#include <ctd_arena_allocator.h>
+#include <ctd_expandable_arena_allocator.h>
+#include <ctd_page_allocator.h>
+#include <ctd_virtual_arena_allocator.h>
+#include <ctd_macro_tools.h>
+
+/*
+ * Type inferring versions of the mark, rewind, and reset functions of every arena-like allocator.
+ * These take a pointer to a ctd_arena_allocator, ctd_expandable_arena_allocator, ctd_page_allocator, or
+ * ctd_virtual_arena_allocator.
+ */
+#define ctd_arena_mark(arena_ptr)                                                                                      \
+    _Generic((arena_ptr),                                                                                              \
+        ctd_arena_allocator*: ctd_arena_allocator_mark,                                                                \
+        ctd_expandable_arena_allocator*: ctd_expandable_arena_allocator_mark,                                          \
+        ctd_page_allocator*: ctd_page_allocator_mark,                                                                  \
+        ctd_virtual_arena_allocator*: ctd_virtual_arena_allocator_mark)(arena_ptr)
+
+#define ctd_arena_rewind(arena_ptr, save_point)                                                                        \
+    _Generic((arena_ptr),                                                                                              \
+        ctd_arena_allocator*: ctd_arena_allocator_rewind,                                                              \
+        ctd_expandable_arena_allocator*: ctd_expandable_arena_allocator_rewind,                                        \
+        ctd_page_allocator*: ctd_page_allocator_rewind,                                                                \
+        ctd_virtual_arena_allocator*: ctd_virtual_arena_allocator_rewind)(arena_ptr, save_point)
+
+#define ctd_arena_reset(arena_ptr)                                                                                     \
+    _Generic((arena_ptr),                                                                                              \
+        ctd_arena_allocator*: ctd_arena_allocator_reset,                                                               \
+        ctd_expandable_arena_allocator*: ctd_expandable_arena_allocator_reset,                                         \
+        ctd_page_allocator*: ctd_page_allocator_reset,                                                                 \
+        ctd_virtual_arena_allocator*: ctd_virtual_arena_allocator_reset)(arena_ptr)
+
+/*
+ * Marks an arena, runs the following block, and then rewinds the arena back to the mark, so everything allocated from
+ * the arena inside the block is freed without calling the underlying allocator.
+ * save_point is the name of the variable holding the mark, so that scopes can be nested.
+ * Note - leaving the block with break, goto, or return skips the rewind.
+ *
+ * Usage:
+ * ctd_arena_scope(request_mark, &arena)
+ * {
+ *     // Allocate scratch memory from arena.allocator
+ * }
+ */
+#define ctd_arena_scope(save_point, arena_ptr)                                                                         \
+    ctd_arena_save_point save_point = ctd_arena_mark(arena_ptr);                                                       \
+    defer(ctd_arena_rewind(arena_ptr, save_point))
+
+#endif // CTD_ARENA_SCOPE_H
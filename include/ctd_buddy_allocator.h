@@ -0,0 +1,68 @@
+#ifndef CTD_BUDDY_ALLOCATOR_H
+#define CTD_BUDDY_ALLOCATOR_H
+#include <ctd_allocator.h>
+#include <ctd_scrub.h>
+
+// Alignment of the region taken from the parent allocator, and so the largest alignment a block can have
+#define CTD_BUDDY_REGION_ALIGNMENT 4096
+
+/**
+ * This allocator is meant for medium sized blocks that are freed in any order, which arenas can't reuse and which
+ * fragment malloc. It manages a single contiguous region taken from a parent allocator, which is split in halves until
+ * a block is just big enough for a request. Every block has a buddy, the other half of the block it was split from,
+ * and when a block is freed it is merged with its buddy straight away if that is free too, so free memory never stays
+ * split up for longer than it has to.
+ *
+ * Free blocks of each size are kept in intrusive free lists, a bitmap of which lists are non-empty finds the smallest
+ * free block that fits a request in O(1), and another bitmap of which blocks are free lets blocks find their buddies.
+ * Allocation and deallocation are O(log n) in the number of block sizes. The most recent block doesn't have to be the
+ * one that grows, reallocate and try_resize grow any block in place as long as the buddies it would absorb are free.
+ *
+ * Since deallocate already receives the size of the block, the block's size is recomputed from it instead of being
+ * stored in a header. Blocks are aligned to their own size, up to CTD_BUDDY_REGION_ALIGNMENT, and requests with a
+ * larger alignment than that return NULL. allocate_sized reports the size of the whole block.
+ */
+typedef struct ctd_buddy_allocator
+{
+    ctd_allocator allocator;
+} ctd_buddy_allocator;
+
+/**
+ * Creates a buddy allocator.
+ *
+ * @param size Size of the region in bytes. It is rounded up to a power of two.
+ * @param min_block_size Size of the smallest block in bytes, which every request is rounded up to. It is rounded up to
+ * a power of two that can hold two pointers.
+ * @param allocator Allocator used to allocate the context and region of the buddy allocator.
+ * @return Buddy allocator if creation is successful, otherwise returns an empty object. This can be checked by seeing
+ * if the allocator's context pointer is NULL or not with buddy_allocator_name.allocator.context == NULL.
+ */
+ctd_buddy_allocator ctd_buddy_allocator_create(ptrdiff_t size, ptrdiff_t min_block_size, ctd_allocator* allocator);
+/**
+ * Creates a buddy allocator that treats freed blocks according to a scrub policy, instead of zeroing them.
+ *
+ * @param size Size of the region in bytes. It is rounded up to a power of two.
+ * @param min_block_size Size of the smallest block in bytes.
+ * @param scrub_policy What deallocate and shrinking reallocate do to the memory they free.
+ * @param allocator Allocator used to allocate the context and region of the buddy allocator.
+ * @return Buddy allocator if creation is successful, otherwise returns an empty object.
+ */
+ctd_buddy_allocator ctd_buddy_allocator_create_with_scrub_policy(ptrdiff_t size, ptrdiff_t min_block_size, ctd_scrub_policy scrub_policy, ctd_allocator* allocator);
+/**
+ * Destroys a buddy allocator and returns its region to the parent allocator.
+ *
+ * @param self Buddy allocator to be destroyed
+ */
+void ctd_buddy_allocator_destroy(ctd_buddy_allocator* self);
+/**
+ * @param self Buddy allocator
+ * @return Number of bytes in free blocks.
+ */
+ptrdiff_t ctd_buddy_allocator_free_bytes(ctd_buddy_allocator* self);
+/**
+ * @param self Buddy allocator
+ * @return Size of the largest free block in bytes, which is the largest request that can currently succeed.
+ */
+ptrdiff_t ctd_buddy_allocator_largest_free_block(ctd_buddy_allocator* self);
+
+#endif // CTD_BUDDY_ALLOCATOR_H
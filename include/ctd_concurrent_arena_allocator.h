@@ -0,0 +1,104 @@
+#ifndef CTD_CONCURRENT_ARENA_ALLOCATOR_H
+#define CTD_CONCURRENT_ARENA_ALLOCATOR_H
+#include <ctd_allocator.h>
+#include <ctd_scrub.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * An arena that many threads can allocate from at once without any locks. The arena's length is only ever advanced
+ * with a compare-and-swap loop, which checks that the allocation fits before publishing the new length, so a request
+ * that doesn't fit leaves the arena untouched.
+ *
+ * To keep requests aligned to at most CTD_CONCURRENT_ARENA_ALIGNMENT free of padding, the length is always kept at a
+ * multiple of it, so every allocation takes up its size rounded up to it. Threads that make many small
+ * allocations can instead claim a chunk of the arena once with ctd_concurrent_arena_allocator_reserve, and bump through
+ * it with no atomic operations at all.
+ *
+ * Deallocating or resizing the most recent allocation gives its memory back to the arena, just like the regular arena.
+ */
+typedef struct ctd_concurrent_arena_allocator
+{
+    ctd_allocator allocator;
+} ctd_concurrent_arena_allocator;
+
+#define CTD_CONCURRENT_ARENA_ALIGNMENT ((ptrdiff_t)alignof(max_align_t))
+
+/**
+ * A piece of a concurrent arena owned by a single thread. It is bumped through with
+ * ctd_concurrent_arena_chunk_allocate, and is freed along with the rest of the arena.
+ */
+typedef struct ctd_concurrent_arena_chunk
+{
+    char* data;
+    ptrdiff_t length;
+    ptrdiff_t capacity;
+} ctd_concurrent_arena_chunk;
+
+/**
+ * Creates a concurrent arena allocator.
+ *
+ * @param size Size of the arena in bytes.
+ * @param alloc Allocator used to allocate the context and memory of the arena.
+ * @return Concurrent arena allocator if creation is successful, otherwise returns an empty object. This can be checked
+ * by seeing if the allocator's context pointer is NULL or not with concurrent_arena_name.allocator.context == NULL.
+ */
+ctd_concurrent_arena_allocator ctd_concurrent_arena_allocator_create(ptrdiff_t size, ctd_allocator* alloc);
+/**
+ * Creates a concurrent arena allocator that treats freed memory according to a scrub policy, instead of zeroing it.
+ *
+ * @param size Size of the arena in bytes.
+ * @param scrub_policy What deallocate and shrinking reallocate do to the memory they free.
+ * @param alloc Allocator used to allocate the context and memory of the arena.
+ * @return Concurrent arena allocator if creation is successful, otherwise returns an empty object.
+ */
+ctd_concurrent_arena_allocator ctd_concurrent_arena_allocator_create_with_scrub_policy(ptrdiff_t size, ctd_scrub_policy scrub_policy, ctd_allocator* alloc);
+/**
+ * Destroys and frees the memory inside a concurrent arena allocator. No other thread may be using it.
+ *
+ * @param self The concurrent arena allocator you want to destroy.
+ * @param alloc The allocator you created self with.
+ */
+void ctd_concurrent_arena_allocator_destroy(ctd_concurrent_arena_allocator* self, ctd_allocator* alloc);
+/**
+ * Claims a chunk of the arena for the calling thread with a single atomic operation.
+ *
+ * @param self The concurrent arena to reserve from.
+ * @param size Size of the chunk in bytes. It is rounded up to a multiple of CTD_CONCURRENT_ARENA_ALIGNMENT.
+ * @return The chunk if there was room for it, otherwise a chunk with a NULL data pointer.
+ */
+ctd_concurrent_arena_chunk ctd_concurrent_arena_allocator_reserve(ctd_concurrent_arena_allocator* self, ptrdiff_t size);
+/**
+ * Frees everything inside a concurrent arena in O(1). No other thread may be using it. The freed memory is not zeroed.
+ *
+ * @param self The concurrent arena to reset.
+ */
+void ctd_concurrent_arena_allocator_reset(ctd_concurrent_arena_allocator* self);
+/**
+ * @param self The concurrent arena to query.
+ * @return Number of bytes handed out by the arena, including chunks and the rounding of every allocation.
+ */
+ptrdiff_t ctd_concurrent_arena_allocator_used(ctd_concurrent_arena_allocator* self);
+
+/**
+ * Allocates memory from a chunk owned by the calling thread.
+ *
+ * @param chunk Chunk returned by ctd_concurrent_arena_allocator_reserve
+ * @param size Size of memory to be allocated in bytes
+ * @param align Alignment of memory to be allocated
+ * @return Pointer to allocated memory if there is room in the chunk, otherwise returns NULL.
+ */
+static inline void* ctd_concurrent_arena_chunk_allocate(ctd_concurrent_arena_chunk* chunk, const ptrdiff_t size, const ptrdiff_t align)
+{
+    const ptrdiff_t padding = -(uintptr_t)(chunk->data + chunk->length) & (align - 1);
+    if (size > chunk->capacity - chunk->length - padding)
+    {
+        return NULL;
+    }
+    void* ptr = chunk->data + chunk->length + padding;
+    chunk->length += padding + size;
+    return ptr;
+}
+
+#endif // CTD_CONCURRENT_ARENA_ALLOCATOR_H
@@ -1,6 +1,7 @@
 #ifndef CTD_EXPANDABLE_ARENA_ALLOCATOR_H
 #define CTD_EXPANDABLE_ARENA_ALLOCATOR_H
 #include <ctd_allocator.h>
+#include <ctd_arena_allocator.h>
 
 typedef struct ctd_expandable_arena_allocator
 {
@@ -8,6 +9,12 @@ typedef struct ctd_expandable_arena_allocator
 } ctd_expandable_arena_allocator;
 
 ctd_expandable_arena_allocator ctd_expandable_arena_allocator_create(ptrdiff_t size, ctd_allocator* allocator);
+ctd_expandable_arena_allocator ctd_expandable_arena_allocator_create_with_scrub_policy(ptrdiff_t size, ctd_scrub_policy scrub_policy, ctd_allocator* allocator);
 void ctd_expandable_arena_allocator_destroy(ctd_expandable_arena_allocator* self);
+ctd_arena_save_point ctd_expandable_arena_allocator_mark(ctd_expandable_arena_allocator* self);
+void ctd_expandable_arena_allocator_rewind(ctd_expandable_arena_allocator* self, ctd_arena_save_point save_point);
+void ctd_expandable_arena_allocator_reset(ctd_expandable_arena_allocator* self);
+ptrdiff_t ctd_expandable_arena_allocator_used(ctd_expandable_arena_allocator* self);
+ptrdiff_t ctd_expandable_arena_allocator_capacity(ctd_expandable_arena_allocator* self);
 
 #endif // CTD_EXPANDABLE_ARENA_ALLOCATOR_H
@@ -0,0 +1,66 @@
+#ifndef CTD_FALLBACK_ALLOCATOR_H
+#define CTD_FALLBACK_ALLOCATOR_H
+#include <ctd_allocator.h>
+#include <ctd_scrub.h>
+#include <stdbool.h>
+
+/**
+ * An allocator over a fixed buffer owned by the caller, such as a local array, that spills to a parent allocator once
+ * the buffer is full. It is meant for short lived temporaries that usually fit in a few hundred bytes, which can then
+ * live on the stack without failing when they don't.
+ *
+ * The buffer is handed out like an arena: allocation bumps a position, and deallocating or shrinking the most recent
+ * block gives its memory back. Every other request goes to the parent allocator. The allocator's own bookkeeping is
+ * stored at the front of the buffer, so creating it never allocates.
+ *
+ * reallocate and deallocate tell which region a block is in from its address. A block in the buffer that can't grow
+ * in place is moved to another spot in the buffer if there is room, and to the parent allocator otherwise, while a
+ * block in the parent allocator stays there for the rest of its life.
+ */
+typedef struct ctd_fallback_allocator
+{
+    ctd_allocator allocator;
+} ctd_fallback_allocator;
+
+/**
+ * Creates a fallback allocator.
+ *
+ * @param buffer Memory the allocator hands out first. It must outlive the allocator and every block in it.
+ * @param size Size of the buffer in bytes, part of which holds the allocator's bookkeeping.
+ * @param allocator Allocator that requests which don't fit in the buffer are forwarded to.
+ * @return Fallback allocator if creation is successful, otherwise returns an empty object, which happens if the buffer
+ * can't hold the bookkeeping. This can be checked by seeing if the allocator's context pointer is NULL or not with
+ * fallback_allocator_name.allocator.context == NULL.
+ */
+ctd_fallback_allocator ctd_fallback_allocator_create(void* buffer, ptrdiff_t size, ctd_allocator* allocator);
+/**
+ * Creates a fallback allocator that treats blocks freed in the buffer according to a scrub policy, instead of zeroing
+ * them. Blocks in the parent allocator are scrubbed however the parent allocator does it.
+ *
+ * @param buffer Memory the allocator hands out first.
+ * @param size Size of the buffer in bytes.
+ * @param scrub_policy What deallocate and shrinking reallocate do to the memory they free in the buffer.
+ * @param allocator Allocator that requests which don't fit in the buffer are forwarded to.
+ * @return Fallback allocator if creation is successful, otherwise returns an empty object.
+ */
+ctd_fallback_allocator ctd_fallback_allocator_create_with_scrub_policy(void* buffer, ptrdiff_t size, ctd_scrub_policy scrub_policy, ctd_allocator* allocator);
+/**
+ * Destroys a fallback allocator. Nothing is freed, the buffer belongs to the caller and blocks that spilled to the
+ * parent allocator must be deallocated before this, like with any other allocator.
+ *
+ * @param self Fallback allocator to be destroyed
+ */
+void ctd_fallback_allocator_destroy(ctd_fallback_allocator* self);
+/**
+ * @param self Fallback allocator
+ * @param block Pointer to a block allocated with the fallback allocator
+ * @return Whether the block is in the buffer rather than in the parent allocator.
+ */
+bool ctd_fallback_allocator_owns(ctd_fallback_allocator* self, const void* block);
+/**
+ * @param self Fallback allocator
+ * @return Number of bytes of the buffer in use, including alignment padding but not the bookkeeping.
+ */
+ptrdiff_t ctd_fallback_allocator_used(ctd_fallback_allocator* self);
+
+#endif // CTD_FALLBACK_ALLOCATOR_H
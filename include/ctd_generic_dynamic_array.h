@@ -1,8 +1,10 @@
 #ifndef CTD_GENERIC_DYNAMIC_ARRAY_C
 #define CTD_GENERIC_DYNAMIC_ARRAY_C
+#include <ctd_allocator.h>
 #include <ctd_error.h>
 #include <ctd_define.h>
 #include <ctd_macro_tools.h>
+#include <stdalign.h>
 #include <stdlib.h>
 
 #define CTD_DEFAULT_DYNAMIC_ARRAY_TYPES(X)                                                                             \
@@ -110,6 +112,7 @@
     {                                                                                                                  \
         ptrdiff_t length;                                                                                              \
         ptrdiff_t capacity;                                                                                            \
+        ptrdiff_t allocated_size;                                                                                      \
         type* data;                                                                                                    \
     }                                                                                                                  \
     ctd_dynamic_array_##typename;                                                                                      \
@@ -160,8 +163,11 @@
                                                                                                                        \
         ctd_dynamic_array_##typename ctd_dynamic_array = {0};                                                          \
         ctd_dynamic_array.length = 0;                                                                                  \
-        ctd_dynamic_array.capacity = capacity;                                                                         \
-        ctd_dynamic_array.data = malloc(sizeof(type) * capacity);                                                      \
+        ptrdiff_t usable_size = 0;                                                                                     \
+        ctd_dynamic_array.data = ctd_allocator_allocate_sized(&ctd_heap_allocator_instance.allocator,                  \
+                                                              sizeof(type) * capacity, alignof(type), &usable_size);   \
+        ctd_dynamic_array.capacity = usable_size / sizeof(type);                                                       \
+        ctd_dynamic_array.allocated_size = usable_size;                                                                \
         if (ctd_dynamic_array.data == NULL)                                                                            \
         {                                                                                                              \
             error->error_type = ALLOCATION_FAIL;                                                                       \
@@ -481,14 +487,18 @@
     void ctd_dynamic_array_##                                                                                          \
         typename##_resize(ctd_dynamic_array_##typename* ctd_dynamic_array, const ptrdiff_t new_capacity, ctd_error* error) \
     {                                                                                                                  \
-        type* new_data = realloc(ctd_dynamic_array->data, new_capacity * sizeof(type));                                \
+        ptrdiff_t usable_size = 0;                                                                                     \
+        type* new_data = ctd_allocator_reallocate_sized(&ctd_heap_allocator_instance.allocator, ctd_dynamic_array->data,\
+                                                        ctd_dynamic_array->allocated_size,                             \
+                                                        new_capacity * sizeof(type), alignof(type), &usable_size);     \
         if (new_data == NULL)                                                                                          \
         {                                                                                                              \
             error->error_type = ALLOCATION_FAIL;                                                                       \
             error->error_message = "Realloc Failed.";                                                                  \
             return;                                                                                                    \
         }                                                                                                              \
-        ctd_dynamic_array->capacity = new_capacity;                                                                    \
+        ctd_dynamic_array->capacity = usable_size / sizeof(type);                                                      \
+        ctd_dynamic_array->allocated_size = usable_size;                                                               \
         ctd_dynamic_array->data = new_data;                                                                            \
     }                                                                                                                  \
                                                                                                                        \
@@ -1,5 +1,6 @@
 #ifndef CTD_INTERNAL_DYNAMIC_ARRAY_H
 #define CTD_INTERNAL_DYNAMIC_ARRAY_H
+#include <ctd_allocator.h>
 #include <stddef.h>
 
 #define ctd_internal_dynamic_array(type)                                                                               \
@@ -8,6 +9,7 @@
         type* data;                                                                                                    \
         ptrdiff_t length;                                                                                              \
         ptrdiff_t capacity;                                                                                            \
+        ptrdiff_t allocated_size; /* Size of data in bytes, which can be more than capacity * sizeof(type) */          \
     }
 
 #define ctd_internal_dynamic_array_append(array, type, item, error_ptr)                                                \
@@ -17,7 +19,8 @@
         if (array.length == array.capacity)                                                                            \
         {                                                                                                              \
             array.capacity *= 2;                                                                                       \
-            _new_data = realloc(array.data, array.capacity * sizeof(type));                                            \
+            array.allocated_size = array.capacity * sizeof(type);                                                      \
+            _new_data = realloc(array.data, array.allocated_size);                                                     \
             if (_new_data == NULL)                                                                                     \
             {                                                                                                          \
                 free(array.data);                                                                                      \
@@ -42,13 +45,22 @@
     do                                                                                                                 \
     {                                                                                                                  \
         void* _new_data;                                                                                               \
+        ptrdiff_t _usable_size;                                                                                        \
+        if ((array).length == (array).capacity &&                                                                      \
+            ctd_allocator_try_resize(&(allocator), (array).data, (array).allocated_size,                               \
+                                     ((array).capacity * 2 + 1) * sizeof(type)))                                       \
+        {                                                                                                              \
+            (array).capacity = (array).capacity * 2 + 1;                                                               \
+            (array).allocated_size = (array).capacity * sizeof(type);                                                  \
+        }                                                                                                              \
         if ((array).length == (array).capacity)                                                                        \
         {                                                                                                              \
-            _new_data = (allocator).reallocate((allocator).context, (array).data, (array).capacity * sizeof(type),     \
-                                             ((array).capacity * 2 + 1) * sizeof(type), alignof(type));                \
+            _new_data = ctd_allocator_reallocate_sized(&(allocator), (array).data, (array).allocated_size,             \
+                                                       ((array).capacity * 2 + 1) * sizeof(type), alignof(type),       \
+                                                       &_usable_size);                                                 \
             if (_new_data == NULL)                                                                                     \
             {                                                                                                          \
-                (allocator).deallocate((allocator).context, (array).data, (array).capacity * sizeof(type));            \
+                (allocator).deallocate((allocator).context, (array).data, (array).allocated_size);                     \
                 (error_ptr)->error_type = ALLOCATION_FAIL;                                                             \
                 (error_ptr)->error_message = "Realloc failed.";                                                        \
             }                                                                                                          \
@@ -57,7 +69,8 @@
                 (array).data = _new_data;                                                                              \
                 (array).data[(array).length] = item;                                                                   \
                 (array).length++;                                                                                      \
-                (array).capacity = (array).capacity * 2 + 1;                                                           \
+                (array).capacity = _usable_size / sizeof(type);                                                        \
+                (array).allocated_size = _usable_size;                                                                 \
             }                                                                                                          \
         }                                                                                                              \
         else                                                                                                           \
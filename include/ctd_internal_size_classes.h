@@ -0,0 +1,47 @@
+#ifndef CTD_INTERNAL_SIZE_CLASSES_H
+#define CTD_INTERNAL_SIZE_CLASSES_H
+#include <stddef.h>
+
+#define CTD_SIZE_CLASS_COUNT 13
+#define CTD_MAX_SIZE_CLASS 1024
+#define CTD_SIZE_CLASS_LOOKUP_GRANULARITY 8
+#define CTD_SIZE_CLASS_LOOKUP_LENGTH (CTD_MAX_SIZE_CLASS / CTD_SIZE_CLASS_LOOKUP_GRANULARITY + 1)
+
+// Powers of two with a class halfway between each pair, so that no more than a third of a block is wasted above 16 bytes
+static const ptrdiff_t ctd_size_classes[CTD_SIZE_CLASS_COUNT] = {8, 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+
+/**
+ * Fills a table that maps a size, divided by CTD_SIZE_CLASS_LOOKUP_GRANULARITY and rounded up, to the index of the
+ * smallest size class that fits it.
+ *
+ * @param class_lookup Table of CTD_SIZE_CLASS_LOOKUP_LENGTH entries
+ */
+static inline void ctd_size_class_fill_lookup(unsigned char* class_lookup)
+{
+    ptrdiff_t class_index = 0;
+    for (ptrdiff_t i = 0; i < CTD_SIZE_CLASS_LOOKUP_LENGTH; i++)
+    {
+        while (ctd_size_classes[class_index] < i * CTD_SIZE_CLASS_LOOKUP_GRANULARITY)
+        {
+            class_index++;
+        }
+        class_lookup[i] = (unsigned char)class_index;
+    }
+}
+
+static inline ptrdiff_t ctd_size_class_lookup(const unsigned char* class_lookup, const ptrdiff_t size)
+{
+    return class_lookup[(size + CTD_SIZE_CLASS_LOOKUP_GRANULARITY - 1) / CTD_SIZE_CLASS_LOOKUP_GRANULARITY];
+}
+
+/**
+ * Returns the largest power of two that divides the size of a size class, which is the alignment blocks of that class
+ * get when they're laid out back to back from an address aligned to it.
+ */
+static inline ptrdiff_t ctd_size_class_alignment(const ptrdiff_t class_index)
+{
+    const ptrdiff_t class_size = ctd_size_classes[class_index];
+    return class_size & -class_size;
+}
+
+#endif // CTD_INTERNAL_SIZE_CLASSES_H
@@ -0,0 +1,48 @@
+#ifndef CTD_INTERNAL_STRING_SEARCH_H
+#define CTD_INTERNAL_STRING_SEARCH_H
+#include <stddef.h>
+
+/**
+ * Instruction sets the substring search kernels are written for, from slowest to fastest. The SIMD kernels compare the
+ * first and last bytes of the needle against 16, 32, or 64 positions of the haystack at once, and only compare the
+ * rest of the needle at positions where both match. Levels the CPU or compiler doesn't support use the scalar kernels.
+ *
+ * CTD_STRING_SEARCH_SCALAR - memchr for the first byte, then memcmp.
+ * CTD_STRING_SEARCH_SSE2 - 16 positions at a time, always available on x86-64.
+ * CTD_STRING_SEARCH_AVX2 - 32 positions at a time.
+ * CTD_STRING_SEARCH_AVX512 - 64 positions at a time, with AVX-512BW.
+ */
+typedef enum ctd_string_search_level
+{
+    CTD_STRING_SEARCH_SCALAR,
+    CTD_STRING_SEARCH_SSE2,
+    CTD_STRING_SEARCH_AVX2,
+    CTD_STRING_SEARCH_AVX512,
+    CTD_STRING_SEARCH_LEVEL_COUNT,
+} ctd_string_search_level;
+
+/**
+ * Finds a needle in a haystack. find returns the first position the needle starts at, and reverse_find the last one.
+ *
+ * @return Index of the needle, or -1 if it isn't in the haystack. The needle must not be empty.
+ */
+typedef ptrdiff_t (*ctd_string_search_function)(const char* haystack, ptrdiff_t haystack_length, const char* needle, ptrdiff_t needle_length);
+
+/**
+ * Kernels indexed by ctd_string_search_level. Only levels up to ctd_string_search_supported_level can be called.
+ */
+extern const ctd_string_search_function ctd_string_find_functions[CTD_STRING_SEARCH_LEVEL_COUNT];
+extern const ctd_string_search_function ctd_string_reverse_find_functions[CTD_STRING_SEARCH_LEVEL_COUNT];
+
+/**
+ * @return The fastest level both the CPU and the compiler support, found with CPUID the first time it is called.
+ */
+ctd_string_search_level ctd_string_search_supported_level();
+
+/**
+ * Finds a needle with the fastest kernel the CPU supports.
+ */
+ptrdiff_t ctd_internal_string_find(const char* haystack, ptrdiff_t haystack_length, const char* needle, ptrdiff_t needle_length);
+ptrdiff_t ctd_internal_string_reverse_find(const char* haystack, ptrdiff_t haystack_length, const char* needle, ptrdiff_t needle_length);
+
+#endif // CTD_INTERNAL_STRING_SEARCH_H
@@ -0,0 +1,91 @@
+#ifndef CTD_MULTI_MATCHER_H
+#define CTD_MULTI_MATCHER_H
+#include <ctd_string.h>
+#include <ctd_generic_dynamic_array.h>
+
+/**
+ * A match of one of a multi matcher's patterns.
+ */
+typedef struct ctd_multi_match
+{
+    // Index of the pattern in the array the matcher was created from
+    ptrdiff_t pattern_id;
+    // Index the match starts at
+    ptrdiff_t offset;
+} ctd_multi_match;
+
+CTD_DYNAMIC_ARRAY_TYPE_DECL(ctd_multi_match, ctd_multi_match)
+CTD_DYNAMIC_ARRAY_FUNCTIONS_DECL(ctd_multi_match, ctd_multi_match)
+
+/**
+ * Finds every instance of many patterns in a single pass over a string, with an Aho-Corasick automaton.
+ *
+ * The automaton is a dense transition table with one row per state, where every byte of the string moves to the next
+ * state with a single lookup, so a string is scanned in linear time no matter how many patterns there are. To keep the
+ * table small enough to stay in cache, its columns aren't bytes but classes of bytes: every byte that appears in the
+ * patterns has its own class, and all the others share one. Every row also has a column with the first pattern that
+ * ends in its state, so bytes where nothing ends only cost the lookup.
+ *
+ * Matches can overlap, and are reported in the order they end, e.g. "she" and "he" are both found in "she" at 0 and 1.
+ * Patterns that are equal are each reported, in the order they were given.
+ */
+typedef struct ctd_multi_matcher
+{
+    ptrdiff_t pattern_count;
+    ptrdiff_t state_count;
+    // Number of byte classes, which is the width of a row in the transition table without its output column
+    ptrdiff_t class_count;
+    // Transition table and pattern lists, in a single block
+    void* tables;
+    ptrdiff_t tables_size;
+    ctd_allocator* allocator;
+} ctd_multi_matcher;
+
+/**
+ * Called for every match found by ctd_multi_matcher_find_all.
+ *
+ * @param user_data Pointer passed to ctd_multi_matcher_find_all.
+ * @param pattern_id Index of the pattern that was found.
+ * @param offset Index the match starts at.
+ * @return Whether to keep searching.
+ */
+typedef bool (*ctd_multi_matcher_callback)(void* user_data, ptrdiff_t pattern_id, ptrdiff_t offset);
+
+/**
+ * Creates a multi matcher.
+ *
+ * @param patterns Patterns to find. They are only read while the matcher is created, so they don't have to outlive it.
+ * @param pattern_count Number of patterns.
+ * @param allocator Allocator used for the automaton, and for the memory it is built in.
+ * @param error Pointer to error struct. Set to INVALID_ARGUMENT if a pattern is empty or there are too many of them to
+ * fit in the table, and to ALLOCATION_FAIL if allocation failed.
+ * @return Multi matcher, or an empty object if creation failed.
+ */
+ctd_multi_matcher ctd_multi_matcher_create(const ctd_string* patterns, ptrdiff_t pattern_count, ctd_allocator* allocator, ctd_error* error);
+/**
+ * Destroys a multi matcher.
+ *
+ * @param self Multi matcher to be destroyed.
+ */
+void ctd_multi_matcher_destroy(ctd_multi_matcher* self);
+/**
+ * Finds every instance of every pattern in a string.
+ *
+ * @param self Multi matcher.
+ * @param str String to be searched.
+ * @param callback Called for every match, until it returns false. Can be NULL to only count them.
+ * @param user_data Passed to the callback.
+ * @return Number of matches found, including the one the callback stopped the search at.
+ */
+ptrdiff_t ctd_multi_matcher_find_all(const ctd_multi_matcher* self, ctd_string str, ctd_multi_matcher_callback callback, void* user_data);
+/**
+ * Finds every instance of every pattern in a string, and appends them to a dynamic array.
+ *
+ * @param self Multi matcher.
+ * @param str String to be searched.
+ * @param matches Dynamic array the matches are appended to.
+ * @param error Pointer to error struct. Set to ALLOCATION_FAIL if the array couldn't grow, which stops the search.
+ */
+void ctd_multi_matcher_find_all_into(const ctd_multi_matcher* self, ctd_string str, ctd_dynamic_array_ctd_multi_match* matches, ctd_error* error);
+
+#endif // CTD_MULTI_MATCHER_H
@@ -1,6 +1,7 @@
 #ifndef CTD_PAGE_ALLOCATOR_H
 #define CTD_PAGE_ALLOCATOR_H
 #include <ctd_allocator.h>
+#include <ctd_arena_allocator.h>
 
 /**
  * This allocator aims to solve the problem of using arena allocators that need to grow. Specifically, uses where having
@@ -9,6 +10,10 @@
  * in one arena, instead of reallocing and potentially changing the memory adresses of your data, you simply make a new
  * arena somewhere while keeping the old to free later.
  *
+ * Allocations too large to fit in a default page get a dedicated page of their own, so the current page keeps being
+ * filled. Pages that are freed or rewound go into a bounded free page cache and are reused before any new page is
+ * allocated.
+ *
  * This should primarily be used in conjunction with a heap allocator to avoid running out of memory for new arenas.
  */
 typedef struct ctd_page_allocator
@@ -16,6 +21,30 @@ typedef struct ctd_page_allocator
     ctd_allocator allocator;
 } ctd_page_allocator;
 
+/**
+ * Number of empty pages a page allocator keeps for reuse by default, instead of returning them to the underlying
+ * allocator.
+ */
+#define CTD_PAGE_ALLOCATOR_DEFAULT_CACHED_PAGES 8
+
+typedef struct ctd_page_allocator_stats
+{
+    // Number of pages that had to be allocated from the underlying allocator
+    ptrdiff_t pages_allocated;
+    // Number of empty pages waiting in the free page cache
+    ptrdiff_t cached_pages;
+    // Number of dedicated pages holding allocations too large for a default page
+    ptrdiff_t large_pages;
+    // Unused bytes at the end of pages that were filled up and left behind
+    ptrdiff_t stranded_bytes;
+    // Bytes handed out by every page in use, including alignment padding
+    ptrdiff_t used_bytes;
+    // Total size of every page in use, not counting cached pages
+    ptrdiff_t capacity_bytes;
+    // Total size of the pages in the free page cache
+    ptrdiff_t cached_bytes;
+} ctd_page_allocator_stats;
+
 /**
  * Creates a page allocator.
  *
@@ -25,11 +54,69 @@ typedef struct ctd_page_allocator
  * the allocator's context pointer is NULL or not with page_allocator_name.allocator.context == NULL.
  */
 ctd_page_allocator ctd_page_allocator_create(ptrdiff_t default_page_size, ctd_allocator* allocator);
+/**
+ * Creates a page allocator with a free page cache of a given size.
+ *
+ * @param default_page_size Default size of each arena in bytes.
+ * @param max_cached_pages Maximum number of empty pages kept for reuse after they're freed or rewound. 0 disables the
+ * cache, so every freed page is returned to the underlying allocator.
+ * @param allocator Allocator used to allocate the context of and each arena in the page allocator.
+ * @return Page allocator if creation is successful, otherwise returns an empty object.
+ */
+ctd_page_allocator ctd_page_allocator_create_with_page_cache(ptrdiff_t default_page_size, ptrdiff_t max_cached_pages, ctd_allocator* allocator);
+/**
+ * Creates a page allocator with every setting given explicitly.
+ *
+ * @param default_page_size Default size of each arena in bytes.
+ * @param max_cached_pages Maximum number of empty pages kept for reuse after they're freed or rewound.
+ * @param scrub_policy What deallocate and shrinking reallocate do to the memory they free. Pages are created with the
+ * same policy.
+ * @param allocator Allocator used to allocate the context of and each arena in the page allocator.
+ * @return Page allocator if creation is successful, otherwise returns an empty object.
+ */
+ctd_page_allocator ctd_page_allocator_create_with_options(ptrdiff_t default_page_size, ptrdiff_t max_cached_pages, ctd_scrub_policy scrub_policy, ctd_allocator* allocator);
 /**
  * Destroys a page allocator.
  *
  * @param self Page allocator to be destroyed
  */
 void ctd_page_allocator_destroy(ctd_page_allocator* self);
+/**
+ * Records the current position of a page allocator so that everything allocated after it can be freed at once with
+ * ctd_page_allocator_rewind.
+ *
+ * @param self Page allocator to be marked
+ * @return Save point of the page allocator's current position.
+ */
+ctd_arena_save_point ctd_page_allocator_mark(ctd_page_allocator* self);
+/**
+ * Frees everything allocated after a save point. Arenas that were added after the save point are emptied and put into
+ * the free page cache, where they're reused by later allocations instead of allocating new arenas from the underlying
+ * allocator. The freed memory is not zeroed.
+ *
+ * @param self Page allocator to be rewound
+ * @param save_point Save point returned by ctd_page_allocator_mark on the same page allocator.
+ */
+void ctd_page_allocator_rewind(ctd_page_allocator* self, ctd_arena_save_point save_point);
+/**
+ * Frees everything inside a page allocator. The first arena is kept, and the others are put into the free page cache.
+ *
+ * @param self Page allocator to be reset
+ */
+void ctd_page_allocator_reset(ctd_page_allocator* self);
+/**
+ * Returns how many reallocations were done in place, without copying the data into a new chunk of memory.
+ *
+ * @param self Page allocator to be queried
+ * @return Number of reallocations that avoided a copy since the page allocator was created.
+ */
+ptrdiff_t ctd_page_allocator_in_place_reallocations(ctd_page_allocator* self);
+/**
+ * Returns page usage and fragmentation statistics.
+ *
+ * @param self Page allocator to be queried
+ * @return Statistics of the page allocator.
+ */
+ctd_page_allocator_stats ctd_page_allocator_get_stats(ctd_page_allocator* self);
 
 #endif //CTD_PAGE_ALLOCATOR_H
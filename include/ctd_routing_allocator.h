@@ -0,0 +1,59 @@
+#ifndef CTD_ROUTING_ALLOCATOR_H
+#define CTD_ROUTING_ALLOCATOR_H
+#include <ctd_allocator.h>
+
+/**
+ * An allocator that sends every request to one of several allocators according to its size, so that each size is
+ * served by the allocator that is cheapest for it, e.g. a slab allocator for tiny blocks, a buddy allocator for medium
+ * blocks, and the operating system for huge ones.
+ *
+ * Every tier serves the requests up to its max_size that no earlier tier serves. Requests larger than the last tier's
+ * max_size are mapped straight from the operating system with mmap, and unmapped with munmap when they are freed.
+ * allocate, reallocate and deallocate all receive the size of the block, so the tier a block belongs to is found again
+ * from its size alone, without headers or lookups. Reallocating a block into a different tier moves it.
+ *
+ * For the same reason, the usable sizes reported by the tiers aren't passed on, since a block used up to its usable
+ * size could be routed to a different tier than the one it came from.
+ *
+ * The allocator doesn't own its tiers. They must outlive it, and are destroyed by whoever created them. Huge blocks
+ * are aligned to the system's page size, and requests for huge blocks with a larger alignment return NULL. This
+ * allocator is built on mmap, so it's only available on POSIX systems.
+ */
+typedef struct ctd_routing_allocator
+{
+    ctd_allocator allocator;
+} ctd_routing_allocator;
+
+#define CTD_ROUTING_MAX_TIERS 8
+// A good max_size for the last tier, above which blocks are big enough that mapping them is cheaper than managing them
+#define CTD_ROUTING_DEFAULT_MMAP_THRESHOLD ((ptrdiff_t)1024 * 1024)
+
+typedef struct ctd_routing_tier
+{
+    // Largest request in bytes that is sent to this tier
+    ptrdiff_t max_size;
+    ctd_allocator* allocator;
+} ctd_routing_tier;
+
+/**
+ * Creates a routing allocator.
+ *
+ * @param tiers Tiers in order of increasing max_size. They are copied, so the array doesn't have to outlive the
+ * routing allocator.
+ * @param tier_count Number of tiers, at most CTD_ROUTING_MAX_TIERS. With no tiers at all, every request is mapped from
+ * the operating system.
+ * @param allocator Allocator used to allocate the context of the routing allocator.
+ * @return Routing allocator if creation is successful, otherwise returns an empty object, which also happens if the
+ * tiers aren't in order of increasing max_size. This can be checked by seeing if the allocator's context pointer is
+ * NULL or not with routing_allocator_name.allocator.context == NULL.
+ */
+ctd_routing_allocator ctd_routing_allocator_create(const ctd_routing_tier* tiers, ptrdiff_t tier_count, ctd_allocator* allocator);
+/**
+ * Destroys a routing allocator. Blocks in the tiers belong to the tiers and aren't freed, but huge blocks mapped from
+ * the operating system must be deallocated before this, like with any other allocator.
+ *
+ * @param self Routing allocator to be destroyed
+ */
+void ctd_routing_allocator_destroy(ctd_routing_allocator* self);
+
+#endif // CTD_ROUTING_ALLOCATOR_H
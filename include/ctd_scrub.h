@@ -0,0 +1,90 @@
+#ifndef CTD_SCRUB_H
+#define CTD_SCRUB_H
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * What an allocator does to memory that is deallocated, or cut off the end of a block by a shrinking reallocate.
+ * The policy is chosen when the allocator is created, and each policy gets its own specialized reallocate and
+ * deallocate functions, so freeing memory never has to check which policy is in use.
+ *
+ * CTD_SCRUB_ZERO - The memory is set to zero. This is the default, and is what every allocator did before policies
+ * existed.
+ * CTD_SCRUB_NONE - The memory is left as is. Freeing memory no longer costs memory bandwidth proportional to its size.
+ * CTD_SCRUB_POISON - The memory is filled with CTD_SCRUB_POISON_BYTE, so that use after free shows up as garbage
+ * instead of valid looking zeroes.
+ * CTD_SCRUB_RELEASE_PAGES - Like CTD_SCRUB_ZERO, but the whole pages inside regions of at least
+ * CTD_SCRUB_RELEASE_PAGES_THRESHOLD bytes are handed back to the operating system with madvise(MADV_DONTNEED) instead
+ * of being written to. This only reads back as zeroes for private anonymous memory, which is what malloc and the other
+ * allocators in this library hand out. This policy is only available on POSIX systems.
+ */
+typedef enum ctd_scrub_policy
+{
+    CTD_SCRUB_ZERO,
+    CTD_SCRUB_NONE,
+    CTD_SCRUB_POISON,
+    CTD_SCRUB_RELEASE_PAGES,
+} ctd_scrub_policy;
+
+#define CTD_SCRUB_POISON_BYTE 0xDD
+#define CTD_SCRUB_RELEASE_PAGES_THRESHOLD (64 * 1024)
+
+typedef void (*ctd_scrub_function)(void* block, ptrdiff_t size);
+
+static inline void ctd_scrub_zero(void* block, const ptrdiff_t size)
+{
+    memset(block, 0, size);
+}
+
+static inline void ctd_scrub_none(void* block, const ptrdiff_t size)
+{
+    (void)block;
+    (void)size;
+}
+
+static inline void ctd_scrub_poison(void* block, const ptrdiff_t size)
+{
+    memset(block, CTD_SCRUB_POISON_BYTE, size);
+}
+
+void ctd_scrub_release_pages(void* block, ptrdiff_t size);
+
+/**
+ * Scrub functions indexed by ctd_scrub_policy, for code that isn't worth specializing.
+ */
+extern const ctd_scrub_function ctd_scrub_functions[];
+
+/**
+ * Defines a reallocate and deallocate function for every scrub policy, and a table of allocators indexed by
+ * ctd_scrub_policy that holds them, named prefix##_scrub_vtables. The table's contexts are NULL, so an allocator should
+ * be created by copying its entry and setting the context.
+ *
+ * prefix##_allocate, prefix##_reallocate_with_scrub and prefix##_deallocate_with_scrub must already be defined, where
+ * the latter two are the regular reallocate and deallocate functions with an extra ctd_scrub_function parameter at the
+ * end. They should be static inline, so that every specialization is compiled with its scrub function inlined.
+ */
+#define ctd_scrub_specialize(prefix)                                                                                   \
+    ctd_internal_scrub_specialize(prefix, zero)                                                                        \
+    ctd_internal_scrub_specialize(prefix, none)                                                                        \
+    ctd_internal_scrub_specialize(prefix, poison)                                                                      \
+    ctd_internal_scrub_specialize(prefix, release_pages)                                                               \
+    static const ctd_allocator prefix##_scrub_vtables[] = {                                                            \
+        [CTD_SCRUB_ZERO] = {prefix##_allocate, prefix##_reallocate_zero, prefix##_deallocate_zero, NULL},              \
+        [CTD_SCRUB_NONE] = {prefix##_allocate, prefix##_reallocate_none, prefix##_deallocate_none, NULL},              \
+        [CTD_SCRUB_POISON] = {prefix##_allocate, prefix##_reallocate_poison, prefix##_deallocate_poison, NULL},        \
+        [CTD_SCRUB_RELEASE_PAGES] = {prefix##_allocate, prefix##_reallocate_release_pages,                             \
+                                     prefix##_deallocate_release_pages, NULL},                                         \
+    };
+
+#define ctd_internal_scrub_specialize(prefix, policy)                                                                  \
+    static void* prefix##_reallocate_##policy(void* context, void* source, ptrdiff_t old_size, ptrdiff_t new_size,    \
+                                              ptrdiff_t align)                                                         \
+    {                                                                                                                  \
+        return prefix##_reallocate_with_scrub(context, source, old_size, new_size, align, ctd_scrub_##policy);        \
+    }                                                                                                                  \
+    static void prefix##_deallocate_##policy(void* context, void* block, ptrdiff_t size)                              \
+    {                                                                                                                  \
+        prefix##_deallocate_with_scrub(context, block, size, ctd_scrub_##policy);                                      \
+    }
+
+#endif // CTD_SCRUB_H
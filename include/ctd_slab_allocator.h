@@ -0,0 +1,53 @@
+#ifndef CTD_SLAB_ALLOCATOR_H
+#define CTD_SLAB_ALLOCATOR_H
+#include <ctd_allocator.h>
+#include <ctd_scrub.h>
+
+/**
+ * This allocator is meant for large numbers of small objects that are allocated and freed in any order, which arenas
+ * can't reuse. Requests are rounded up to one of a fixed set of size classes, and each size class keeps an intrusive
+ * free list of blocks that have been deallocated, so allocation and deallocation are both O(1).
+ *
+ * Blocks are carved out of slabs that are taken from a parent allocator, such as a page allocator. Since deallocate
+ * already receives the size of the block, the size class is recomputed from it instead of being stored in a header.
+ * Requests larger than the biggest size class are forwarded to the parent allocator.
+ *
+ * Note - because the size class is derived from size alone, align must divide the natural alignment of the size class
+ * (which is always true when size is a multiple of align, as it is for sizeof(type) and alignof(type)). Requests that
+ * don't satisfy this return NULL.
+ */
+typedef struct ctd_slab_allocator
+{
+    ctd_allocator allocator;
+} ctd_slab_allocator;
+
+/**
+ * Creates a slab allocator.
+ *
+ * @param slab_size Size of each slab taken from the parent allocator in bytes. It is rounded up to fit at least one
+ * block of the largest size class.
+ * @param allocator Allocator used to allocate the context of and each slab in the slab allocator.
+ * @return Slab allocator if creation is successful, otherwise returns an empty object. This can be checked by seeing if
+ * the allocator's context pointer is NULL or not with slab_allocator_name.allocator.context == NULL.
+ */
+ctd_slab_allocator ctd_slab_allocator_create(ptrdiff_t slab_size, ctd_allocator* allocator);
+/**
+ * Creates a slab allocator that treats freed blocks according to a scrub policy, instead of zeroing them.
+ *
+ * @param slab_size Size of each slab taken from the parent allocator in bytes.
+ * @param scrub_policy What deallocate and shrinking reallocate do to the memory they free. Blocks larger than the
+ * biggest size class are freed by the parent allocator, and follow its policy instead.
+ * @param allocator Allocator used to allocate the context of and each slab in the slab allocator.
+ * @return Slab allocator if creation is successful, otherwise returns an empty object.
+ */
+ctd_slab_allocator ctd_slab_allocator_create_with_scrub_policy(ptrdiff_t slab_size, ctd_scrub_policy scrub_policy, ctd_allocator* allocator);
+/**
+ * Destroys a slab allocator and returns every slab to the parent allocator.
+ * Note - blocks larger than the biggest size class were allocated directly from the parent allocator, and must be
+ * deallocated before the slab allocator is destroyed.
+ *
+ * @param self Slab allocator to be destroyed
+ */
+void ctd_slab_allocator_destroy(ctd_slab_allocator* self);
+
+#endif // CTD_SLAB_ALLOCATOR_H
@@ -0,0 +1,78 @@
+#ifndef CTD_STATS_ALLOCATOR_H
+#define CTD_STATS_ALLOCATOR_H
+#include <ctd_allocator.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * A wrapper around any allocator that records how it is used: how many calls were made, how many bytes are live and
+ * the most that ever were, and a histogram of request sizes. It can also time every call, which is chosen at creation
+ * so that an allocator that doesn't record latency never reads the clock.
+ *
+ * The optional entries of the wrapped allocator, like try_resize and the batch calls, are forwarded and recorded too,
+ * so wrapping an allocator doesn't change how it is used. A resize in place counts as a reallocation, and a batch counts
+ * as one call per block.
+ *
+ * Like the allocators it wraps, this allocator isn't thread-safe.
+ */
+typedef struct ctd_stats_allocator
+{
+    ctd_allocator allocator;
+} ctd_stats_allocator;
+
+/**
+ * Number of buckets in the size histogram. Bucket 0 counts requests of 0 bytes, bucket i counts requests of at least
+ * 2^(i-1) and less than 2^i bytes, and the last bucket also counts every larger request.
+ */
+#define CTD_STATS_HISTOGRAM_BUCKETS 32
+
+typedef struct ctd_allocator_stats
+{
+    ptrdiff_t allocations;
+    ptrdiff_t reallocations;
+    ptrdiff_t deallocations;
+    // Allocations and reallocations that returned NULL
+    ptrdiff_t failed_allocations;
+    // Bytes currently allocated, as reported by the sizes passed to the allocator
+    ptrdiff_t bytes_live;
+    // The most bytes that were ever live at once
+    ptrdiff_t peak_bytes_live;
+    // Every byte ever allocated, counting reallocations by how much they grew
+    ptrdiff_t bytes_allocated;
+    ptrdiff_t size_histogram[CTD_STATS_HISTOGRAM_BUCKETS];
+    // Time spent in each kind of call in nanoseconds. These stay 0 unless latency is recorded
+    int64_t allocate_ns;
+    int64_t reallocate_ns;
+    int64_t deallocate_ns;
+} ctd_allocator_stats;
+
+/**
+ * Creates a stats allocator.
+ *
+ * @param allocator Allocator whose usage is recorded. Every call is forwarded to it, and it is also used to allocate
+ * the stats allocator's context.
+ * @param record_latency Whether to time every call.
+ * @return Stats allocator if creation is successful, otherwise returns an empty object. This can be checked by seeing
+ * if the allocator's context pointer is NULL or not with stats_allocator_name.allocator.context == NULL.
+ */
+ctd_stats_allocator ctd_stats_allocator_create(ctd_allocator* allocator, bool record_latency);
+/**
+ * Destroys a stats allocator. Memory allocated through it belongs to the wrapped allocator, and isn't freed.
+ *
+ * @param self Stats allocator to be destroyed
+ */
+void ctd_stats_allocator_destroy(ctd_stats_allocator* self);
+/**
+ * @param self Stats allocator to be queried
+ * @return Everything recorded since the stats allocator was created or its stats were last reset.
+ */
+ctd_allocator_stats ctd_stats_allocator_get_stats(ctd_stats_allocator* self);
+/**
+ * Clears every counter except the live bytes, which still describe memory that is allocated. The peak is set to the
+ * current live bytes.
+ *
+ * @param self Stats allocator to be reset
+ */
+void ctd_stats_allocator_reset_stats(ctd_stats_allocator* self);
+
+#endif // CTD_STATS_ALLOCATOR_H
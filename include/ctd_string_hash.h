@@ -0,0 +1,72 @@
+#ifndef CTD_STRING_HASH_H
+#define CTD_STRING_HASH_H
+#include <ctd_string.h>
+
+/**
+ * 64 bit string hashing built the way wyhash is: 8 bytes are read at a time and mixed with 64 by 64 bit multiplications,
+ * folding the high half of every product into the low half. Strings of 48 bytes or more are split between three
+ * independent lanes, so the multiplications of a block overlap. Every bit of the result depends on every bit of the
+ * string, which makes it suitable for hash tables, unlike ctd_string_hash.
+ *
+ * The hash isn't cryptographic. Where the strings come from outside, a random seed keeps the hashes unpredictable to
+ * whoever chose them, so they can't pick strings that all land in the same bucket.
+ */
+
+// Bytes a lane of the hash reads per step, times the three lanes
+#define CTD_STRING_HASH_BLOCK 48
+// Bytes before the unprocessed ones that the end of the hash can read again
+#define CTD_STRING_HASH_HISTORY 16
+
+/**
+ * Hashes a string made of several pieces, one piece at a time, without copying them together. The result is the same as
+ * hashing the pieces joined into a single string, no matter how it is split.
+ */
+typedef struct ctd_string_hasher
+{
+    uint64_t seed;
+    uint64_t lanes[3];
+    // Total number of bytes hashed
+    uint64_t length;
+    // The last bytes of the block that was processed last, followed by the bytes that haven't been processed yet
+    char buffer[CTD_STRING_HASH_HISTORY + CTD_STRING_HASH_BLOCK];
+    ptrdiff_t buffered;
+} ctd_string_hasher;
+
+/**
+ * Hashes a string with a seed of 0.
+ *
+ * @param str String to be hashed.
+ * @return 64 bit hash.
+ */
+uint64_t ctd_string_hash64(ctd_string str);
+/**
+ * Hashes a string with a seed, so that the same string has an unrelated hash for every seed.
+ *
+ * @param str String to be hashed.
+ * @param seed Seed of the hash. Should be random when the strings come from outside.
+ * @return 64 bit hash.
+ */
+uint64_t ctd_string_hash64_seeded(ctd_string str, uint64_t seed);
+/**
+ * Creates a hasher for a string made of several pieces.
+ *
+ * @param seed Seed of the hash. 0 gives the same hash as ctd_string_hash64.
+ * @return Hasher without any bytes hashed.
+ */
+ctd_string_hasher ctd_string_hasher_create(uint64_t seed);
+/**
+ * Adds the next piece of the string.
+ *
+ * @param self Hasher.
+ * @param str Piece to be hashed after the ones added before it. Can be empty.
+ */
+void ctd_string_hasher_update(ctd_string_hasher* self, ctd_string str);
+/**
+ * Finishes the hash. The hasher isn't changed, so more pieces can be added afterwards.
+ *
+ * @param self Hasher.
+ * @return Hash of every piece added so far, joined.
+ */
+uint64_t ctd_string_hasher_finish(const ctd_string_hasher* self);
+
+#endif // CTD_STRING_HASH_H
@@ -0,0 +1,65 @@
+#ifndef CTD_STRING_SEARCHER_H
+#define CTD_STRING_SEARCHER_H
+#include <ctd_string.h>
+
+/**
+ * How a searcher looks for its needle, chosen when it is created.
+ *
+ * CTD_STRING_SEARCHER_SIMD - For short needles, and for needles made of many different bytes up to
+ * CTD_STRING_SEARCHER_LONG_NEEDLE bytes. The first and last bytes of the first CTD_STRING_SEARCHER_SHORT_NEEDLE bytes
+ * are compared against 16 to 64 positions at once, the same way ctd_string_find does, and the rest of the needle only
+ * where they match.
+ * CTD_STRING_SEARCHER_HORSPOOL - For needles made of many different bytes that are longer than that. The last two bytes
+ * of the window decide how far it can skip, and with needles this long it skips whole cache lines, so most of the
+ * haystack is never read.
+ * CTD_STRING_SEARCHER_TWO_WAY - For long needles made of few different bytes, where the others would find their first
+ * bytes or last two bytes almost everywhere. Two-Way never reads a byte of the haystack more than a couple of times,
+ * and also skips ahead by the last byte of the window.
+ *
+ * The SIMD filter and Horspool carry on with Two-Way if they have compared too many bytes for how far they have gotten,
+ * so every search takes linear time at worst.
+ */
+typedef enum ctd_string_searcher_algorithm
+{
+    CTD_STRING_SEARCHER_SIMD,
+    CTD_STRING_SEARCHER_HORSPOOL,
+    CTD_STRING_SEARCHER_TWO_WAY,
+} ctd_string_searcher_algorithm;
+
+// Longest needle that is searched for with the SIMD kernels alone, and the length of the prefix longer needles are filtered by
+#define CTD_STRING_SEARCHER_SHORT_NEEDLE 32
+// Shortest needle that is searched for with CTD_STRING_SEARCHER_HORSPOOL
+#define CTD_STRING_SEARCHER_LONG_NEEDLE 2048
+// Fewest distinct bytes a needle longer than CTD_STRING_SEARCHER_SHORT_NEEDLE needs to not use CTD_STRING_SEARCHER_TWO_WAY
+#define CTD_STRING_SEARCHER_MIN_ALPHABET 8
+
+/**
+ * A needle that has been preprocessed once, so that it can be searched for in any number of strings without starting
+ * from scratch every time. The needle is copied, so the string it was created from doesn't have to outlive it.
+ */
+typedef struct ctd_string_searcher
+{
+    ctd_string needle;
+    ctd_string_searcher_algorithm algorithm;
+    // Copy of the needle and the tables of the algorithm, in a single block
+    void* tables;
+    ptrdiff_t tables_size;
+    ctd_allocator* allocator;
+} ctd_string_searcher;
+
+/**
+ * Called for every match found by ctd_string_searcher_find_all.
+ *
+ * @param user_data Pointer passed to ctd_string_searcher_find_all.
+ * @param index Index the match starts at.
+ * @return Whether to keep searching.
+ */
+typedef bool (*ctd_string_searcher_callback)(void* user_data, ptrdiff_t index);
+
+ctd_string_searcher ctd_string_searcher_create(ctd_string needle, ctd_allocator* allocator, ctd_error* error);
+void ctd_string_searcher_destroy(ctd_string_searcher* self);
+ctd_option(ptrdiff_t) ctd_string_searcher_find(const ctd_string_searcher* self, ctd_string str, ptrdiff_t start, ctd_error* error);
+ctd_option(ptrdiff_t) ctd_string_searcher_reverse_find(const ctd_string_searcher* self, ctd_string str, ptrdiff_t end, ctd_error* error);
+ptrdiff_t ctd_string_searcher_find_all(const ctd_string_searcher* self, ctd_string str, ctd_string_searcher_callback callback, void* user_data);
+
+#endif // CTD_STRING_SEARCHER_H
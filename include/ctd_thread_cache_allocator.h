@@ -0,0 +1,64 @@
+#ifndef CTD_THREAD_CACHE_ALLOCATOR_H
+#define CTD_THREAD_CACHE_ALLOCATOR_H
+#include <ctd_allocator.h>
+
+/**
+ * A thread-safe front-end for an allocator that isn't. Every thread that uses the allocator gets its own cache of
+ * recently freed blocks for each size class, called a magazine, and small allocations and deallocations are served from
+ * it without any locking. Only when a magazine runs empty or fills up does the thread take the lock around the backing
+ * allocator, and it then refills or flushes a whole batch of blocks at once.
+ *
+ * Requests are rounded up to the same size classes as the slab allocator, and blocks are always taken from and returned
+ * to the backing allocator at their class size. Requests larger than the biggest size class, or more aligned than
+ * alignof(max_align_t), go straight to the backing allocator under the lock.
+ *
+ * Blocks sitting in a magazine aren't scrubbed, since they haven't been returned to the backing allocator yet; its scrub
+ * policy applies once they're flushed. When a thread exits, its magazines are flushed automatically.
+ * This allocator is built on pthreads, and is only available on POSIX systems.
+ */
+typedef struct ctd_thread_cache_allocator
+{
+    ctd_allocator allocator;
+} ctd_thread_cache_allocator;
+
+/**
+ * Maximum number of blocks each thread caches per size class.
+ */
+#define CTD_THREAD_CACHE_MAGAZINE_SIZE 64
+/**
+ * Number of blocks moved between a magazine and the backing allocator per lock acquisition.
+ */
+#define CTD_THREAD_CACHE_BATCH_SIZE (CTD_THREAD_CACHE_MAGAZINE_SIZE / 2)
+
+/**
+ * Creates a thread cache allocator.
+ *
+ * @param backing_allocator Allocator that blocks are taken from and returned to. It is only ever used by one thread at a
+ * time, so it doesn't need to be thread-safe, and is also used to allocate the context and each thread's cache.
+ * @return Thread cache allocator if creation is successful, otherwise returns an empty object. This can be checked by
+ * seeing if the allocator's context pointer is NULL or not with thread_cache_allocator_name.allocator.context == NULL.
+ */
+ctd_thread_cache_allocator ctd_thread_cache_allocator_create(ctd_allocator* backing_allocator);
+/**
+ * Destroys a thread cache allocator, returning every thread's cached blocks to the backing allocator.
+ * Note - no other thread may be using the allocator while it is destroyed.
+ *
+ * @param self Thread cache allocator to be destroyed
+ */
+void ctd_thread_cache_allocator_destroy(ctd_thread_cache_allocator* self);
+/**
+ * Returns every block cached by the calling thread to the backing allocator.
+ *
+ * @param self Thread cache allocator to be flushed
+ */
+void ctd_thread_cache_allocator_flush(ctd_thread_cache_allocator* self);
+/**
+ * Returns how many times the lock around the backing allocator has been taken, which shows how well the magazines are
+ * absorbing allocations.
+ *
+ * @param self Thread cache allocator to be queried
+ * @return Number of lock acquisitions since the thread cache allocator was created.
+ */
+ptrdiff_t ctd_thread_cache_allocator_lock_acquisitions(ctd_thread_cache_allocator* self);
+
+#endif // CTD_THREAD_CACHE_ALLOCATOR_H
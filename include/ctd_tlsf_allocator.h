@@ -0,0 +1,59 @@
+#ifndef CTD_TLSF_ALLOCATOR_H
+#define CTD_TLSF_ALLOCATOR_H
+#include <ctd_allocator.h>
+#include <ctd_scrub.h>
+
+/**
+ * A Two-Level Segregated Fit allocator, meant for code that needs every allocation and deallocation to finish in a
+ * bounded amount of time while still reusing freed memory.
+ *
+ * It manages a single region taken from a parent allocator. Free blocks are kept in lists segregated by size: the first
+ * level splits sizes by powers of two, and the second level splits each power of two into CTD_TLSF_SECOND_LEVEL_COUNT
+ * linear steps. A bitmap per level records which lists are non-empty, so finding a list with a block that fits takes a
+ * couple of bit scans, and every block has a small header that lets a freed block merge with its free neighbours
+ * straight away. Allocation, deallocation, and in place resizing are all O(1), with no loops that depend on how many
+ * blocks there are.
+ *
+ * Blocks are aligned to 16 bytes, which is enough for any type. Larger alignments are supported, at the cost of
+ * searching for a block that is bigger by the alignment. allocate_sized reports the whole block, which is rounded up to
+ * a multiple of 16 bytes.
+ */
+typedef struct ctd_tlsf_allocator
+{
+    ctd_allocator allocator;
+} ctd_tlsf_allocator;
+
+#define CTD_TLSF_SECOND_LEVEL_COUNT_LOG2 5
+#define CTD_TLSF_SECOND_LEVEL_COUNT (1 << CTD_TLSF_SECOND_LEVEL_COUNT_LOG2)
+
+/**
+ * Creates a TLSF allocator.
+ *
+ * @param size Size of the region in bytes, including the headers of blocks.
+ * @param allocator Allocator used to allocate the context and region of the TLSF allocator.
+ * @return TLSF allocator if creation is successful, otherwise returns an empty object. This can be checked by seeing
+ * if the allocator's context pointer is NULL or not with tlsf_allocator_name.allocator.context == NULL.
+ */
+ctd_tlsf_allocator ctd_tlsf_allocator_create(ptrdiff_t size, ctd_allocator* allocator);
+/**
+ * Creates a TLSF allocator that treats freed blocks according to a scrub policy, instead of zeroing them.
+ *
+ * @param size Size of the region in bytes, including the headers of blocks.
+ * @param scrub_policy What deallocate and shrinking reallocate do to the memory they free.
+ * @param allocator Allocator used to allocate the context and region of the TLSF allocator.
+ * @return TLSF allocator if creation is successful, otherwise returns an empty object.
+ */
+ctd_tlsf_allocator ctd_tlsf_allocator_create_with_scrub_policy(ptrdiff_t size, ctd_scrub_policy scrub_policy, ctd_allocator* allocator);
+/**
+ * Destroys a TLSF allocator and returns its region to the parent allocator.
+ *
+ * @param self TLSF allocator to be destroyed
+ */
+void ctd_tlsf_allocator_destroy(ctd_tlsf_allocator* self);
+/**
+ * @param self TLSF allocator
+ * @return Number of bytes in free blocks, not counting their headers.
+ */
+ptrdiff_t ctd_tlsf_allocator_free_bytes(ctd_tlsf_allocator* self);
+
+#endif // CTD_TLSF_ALLOCATOR_H
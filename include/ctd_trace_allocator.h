@@ -0,0 +1,116 @@
+#ifndef CTD_TRACE_ALLOCATOR_H
+#define CTD_TRACE_ALLOCATOR_H
+#include <ctd_allocator.h>
+#include <ctd_error.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * A wrapper around any allocator that records every call made to it into a binary trace, so that the allocation
+ * pattern of a real program can be replayed against other allocators later.
+ *
+ * The trace is a stream of variable length records that is written through a buffer, so recording costs a few bytes of
+ * encoding per call plus an occasional fwrite. Timestamps and addresses are stored as the difference to the previous
+ * record's, so a typical record takes 5 to 10 bytes. Nothing is ever seeked back to or kept besides the buffer, so the
+ * trace can be written to a pipe or socket and read back while it is still being recorded, for as long as needed.
+ *
+ * The optional entries of the wrapped allocator are forwarded too, and recorded as the basic calls they stand for: a
+ * resize in place is a reallocation that returns the same block, sized calls record the usable size, and a batch is one
+ * record per block.
+ *
+ * Like the allocators it wraps, this allocator isn't thread-safe.
+ */
+typedef struct ctd_trace_allocator
+{
+    ctd_allocator allocator;
+} ctd_trace_allocator;
+
+/**
+ * Size of the buffer records are collected in before they're written to the stream.
+ */
+#define CTD_TRACE_BUFFER_SIZE (64 * 1024)
+
+typedef enum ctd_trace_operation
+{
+    CTD_TRACE_ALLOCATE = 1,
+    CTD_TRACE_REALLOCATE = 2,
+    CTD_TRACE_DEALLOCATE = 3,
+} ctd_trace_operation;
+
+/**
+ * A single call read back from a trace. Blocks are identified by the addresses the recorded allocator returned, which
+ * are 0 for calls that failed. Fields that don't apply to an operation are 0.
+ */
+typedef struct ctd_trace_record
+{
+    ctd_trace_operation operation;
+    // Nanoseconds since the trace allocator was created
+    uint64_t timestamp_ns;
+    // The block passed to reallocate or deallocate
+    uint64_t source;
+    // The block returned by allocate or reallocate
+    uint64_t result;
+    ptrdiff_t old_size;
+    // The size passed to allocate or deallocate, or the new size passed to reallocate
+    ptrdiff_t size;
+    ptrdiff_t align;
+} ctd_trace_record;
+
+/**
+ * Creates a trace allocator, and writes the trace's header to the stream.
+ *
+ * @param allocator Allocator whose calls are recorded. Every call is forwarded to it, and it is also used to allocate
+ * the trace allocator's context and buffer.
+ * @param stream Stream the trace is written to. It must be opened in binary mode, and stays open after the trace
+ * allocator is destroyed.
+ * @return Trace allocator if creation is successful, otherwise returns an empty object. This can be checked by seeing
+ * if the allocator's context pointer is NULL or not with trace_allocator_name.allocator.context == NULL.
+ */
+ctd_trace_allocator ctd_trace_allocator_create(ctd_allocator* allocator, FILE* stream);
+/**
+ * Writes out every buffered record and destroys a trace allocator. Memory allocated through it belongs to the wrapped
+ * allocator, and isn't freed.
+ *
+ * @param self Trace allocator to be destroyed
+ */
+void ctd_trace_allocator_destroy(ctd_trace_allocator* self);
+/**
+ * Writes out every buffered record and flushes the stream.
+ *
+ * @param self Trace allocator to be flushed
+ * @return Whether every record so far made it to the stream.
+ */
+bool ctd_trace_allocator_flush(ctd_trace_allocator* self);
+
+/**
+ * Reads a trace back one record at a time. A record only stores the difference to the previous record's timestamp and
+ * addresses, so the reader keeps track of them.
+ */
+typedef struct ctd_trace_reader
+{
+    FILE* stream;
+    uint64_t timestamp_ns;
+    uint64_t last_address;
+} ctd_trace_reader;
+
+/**
+ * Creates a trace reader, and checks that the stream starts with a trace header.
+ *
+ * @param stream Stream the trace is read from, opened in binary mode
+ * @param error Pointer to error struct, which is set if the stream doesn't start with a trace header
+ * @return The trace reader, positioned at the first record.
+ */
+ctd_trace_reader ctd_trace_reader_create(FILE* stream, ctd_error* error);
+/**
+ * Reads the next record of a trace.
+ *
+ * @param self Trace reader to read from
+ * @param record Where the record is stored
+ * @param error Pointer to error struct, which is set if the stream ends partway through a record or the record is
+ * malformed
+ * @return Whether a record was read. This is false once the trace ends, or if an error occurred.
+ */
+bool ctd_trace_reader_next(ctd_trace_reader* self, ctd_trace_record* record, ctd_error* error);
+
+#endif // CTD_TRACE_ALLOCATOR_H
@@ -0,0 +1,65 @@
+#ifndef CTD_VIRTUAL_ARENA_ALLOCATOR_H
+#define CTD_VIRTUAL_ARENA_ALLOCATOR_H
+#include <ctd_allocator.h>
+#include <ctd_arena_allocator.h>
+
+/**
+ * An arena that can grow without ever moving. Instead of reallocating its buffer like the expandable arena, this
+ * allocator reserves a large range of virtual address space up front and only commits pages of it as the arena grows,
+ * so pointers handed out by it stay valid and growing never copies any data.
+ *
+ * The context of the allocator lives at the start of the reserved range, so no other allocator is needed.
+ * This allocator is built on mmap, and is only available on POSIX systems.
+ */
+typedef struct ctd_virtual_arena_allocator
+{
+    ctd_allocator allocator;
+} ctd_virtual_arena_allocator;
+
+/**
+ * Creates a virtual arena allocator.
+ *
+ * @param reserve_size Size of the virtual address range to reserve in bytes. This is the most the arena can ever hold,
+ * but only the parts of it that are used take up physical memory, so it can be far larger than the expected usage.
+ * @return Virtual arena allocator if creation is successful, otherwise returns an empty object. This can be checked by
+ * seeing if the allocator's context pointer is NULL or not with virtual_arena_name.allocator.context == NULL.
+ */
+ctd_virtual_arena_allocator ctd_virtual_arena_allocator_create(ptrdiff_t reserve_size);
+/**
+ * Creates a virtual arena allocator that treats freed memory according to a scrub policy, instead of zeroing it.
+ *
+ * @param reserve_size Size of the virtual address range to reserve in bytes.
+ * @param scrub_policy What deallocate and shrinking reallocate do to the memory they free.
+ * @return Virtual arena allocator if creation is successful, otherwise returns an empty object.
+ */
+ctd_virtual_arena_allocator ctd_virtual_arena_allocator_create_with_scrub_policy(ptrdiff_t reserve_size, ctd_scrub_policy scrub_policy);
+/**
+ * Destroys a virtual arena allocator and releases its address range.
+ *
+ * @param self Virtual arena allocator to be destroyed
+ */
+void ctd_virtual_arena_allocator_destroy(ctd_virtual_arena_allocator* self);
+/**
+ * Records the current position of a virtual arena so that everything allocated after it can be freed at once with
+ * ctd_virtual_arena_allocator_rewind.
+ *
+ * @param self Virtual arena allocator to be marked
+ * @return Save point of the virtual arena's current position.
+ */
+ctd_arena_save_point ctd_virtual_arena_allocator_mark(ctd_virtual_arena_allocator* self);
+/**
+ * Frees everything allocated after a save point in O(1). The freed pages stay committed for reuse, and are not zeroed.
+ *
+ * @param self Virtual arena allocator to be rewound
+ * @param save_point Save point returned by ctd_virtual_arena_allocator_mark on the same virtual arena.
+ */
+void ctd_virtual_arena_allocator_rewind(ctd_virtual_arena_allocator* self, ctd_arena_save_point save_point);
+/**
+ * Frees everything inside a virtual arena and decommits its pages, returning the physical memory to the operating
+ * system while keeping the address range reserved.
+ *
+ * @param self Virtual arena allocator to be reset
+ */
+void ctd_virtual_arena_allocator_reset(ctd_virtual_arena_allocator* self);
+
+#endif // CTD_VIRTUAL_ARENA_ALLOCATOR_H
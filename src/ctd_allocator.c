@@ -1,37 +1,145 @@
-#include <stdlib.h>
-#include <ctd_allocator.h>
-
-static void* ctd_malloc(void* context, ptrdiff_t size, ptrdiff_t align)
-{
-    (void)context;
-    return malloc(size);
-}
-
-static void* ctd_calloc(void* context, ptrdiff_t size, ptrdiff_t count, ptrdiff_t align)
-{
-    (void)context;
-    return calloc(count, size);
-}
-
-static void* ctd_realloc(void* context, void* source, ptrdiff_t old_size, ptrdiff_t new_size, ptrdiff_t align)
-{
-    (void)context;
-    (void)old_size;
-    return realloc(source, new_size);
-}
-
-static void ctd_free(void* context, void* block, ptrdiff_t size)
-{
-    (void)context;
-    (void)size;
-    free(block);
-}
-
-ctd_heap_allocator ctd_heap_allocator_instance = {.allocator = {.context = NULL, .allocate = ctd_malloc, .reallocate = ctd_realloc, .deallocate = ctd_free}};
-
-ctd_heap_allocator ctd_heap_allocator_create()
-{
-    ctd_allocator allocator = {.allocate = ctd_malloc, .reallocate = ctd_realloc, .deallocate = ctd_free, .context = NULL};
-    return (ctd_heap_allocator){.allocator = allocator};
-}
-
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdalign.h>
+#include <ctd_allocator.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+/**
+ * Allocates a block aligned to more than malloc guarantees. aligned_alloc requires size to be a multiple of align, so
+ * the size is rounded up here.
+ */
+static void* ctd_aligned_malloc(ptrdiff_t size, ptrdiff_t align)
+{
+    const ptrdiff_t rounded_size = (size + align - 1) & ~(align - 1);
+    return aligned_alloc(align, rounded_size);
+}
+
+static void* ctd_malloc(void* context, ptrdiff_t size, ptrdiff_t align)
+{
+    (void)context;
+    if (align <= (ptrdiff_t)alignof(max_align_t))
+    {
+        return malloc(size);
+    }
+
+    return ctd_aligned_malloc(size, align);
+}
+
+static void* ctd_calloc(void* context, ptrdiff_t size, ptrdiff_t count, ptrdiff_t align)
+{
+    (void)context;
+    return calloc(count, size);
+}
+
+/**
+ * Reallocates a block while preserving its alignment. realloc can't be used for over-aligned blocks, since it may move
+ * them to an address that doesn't satisfy align after the original block is already gone, so they're copied into a
+ * fresh aligned block instead. On glibc, blocks that still fit in their chunk are kept where they are.
+ */
+static void* ctd_realloc(void* context, void* source, ptrdiff_t old_size, ptrdiff_t new_size, ptrdiff_t align)
+{
+    (void)context;
+    if (align <= (ptrdiff_t)alignof(max_align_t))
+    {
+        return realloc(source, new_size);
+    }
+
+#if defined(__GLIBC__)
+    if (new_size <= (ptrdiff_t)malloc_usable_size(source)) return source;
+#endif
+
+    char* aligned = ctd_aligned_malloc(new_size, align);
+    if (aligned == NULL) return NULL;
+    memcpy(aligned, source, old_size < new_size ? old_size : new_size);
+    free(source);
+
+    return aligned;
+}
+
+static void ctd_free(void* context, void* block, ptrdiff_t size)
+{
+    (void)context;
+    (void)size;
+    free(block);
+}
+
+/**
+ * Calls malloc directly for every block, instead of through the allocator interface.
+ */
+static bool ctd_malloc_batch(void* context, ptrdiff_t count, ptrdiff_t size, ptrdiff_t align, void** blocks)
+{
+    for (ptrdiff_t i = 0; i < count; i++)
+    {
+        blocks[i] = ctd_malloc(context, size, align);
+        if (blocks[i] == NULL)
+        {
+            while (i-- > 0)
+            {
+                free(blocks[i]);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+static void ctd_free_batch(void* context, ptrdiff_t count, ptrdiff_t size, void** blocks)
+{
+    (void)context;
+    (void)size;
+    for (ptrdiff_t i = 0; i < count; i++)
+    {
+        free(blocks[i]);
+    }
+}
+
+#if defined(__GLIBC__)
+/**
+ * malloc rounds requests up to its own size classes, so a block can grow into the rest of its chunk, and shrink within
+ * it, without being moved.
+ */
+static bool ctd_heap_try_resize(void* context, void* block, ptrdiff_t old_size, ptrdiff_t new_size)
+{
+    (void)context;
+    (void)old_size;
+    return new_size <= (ptrdiff_t)malloc_usable_size(block);
+}
+
+static void* ctd_malloc_sized(void* context, ptrdiff_t size, ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    void* block = ctd_malloc(context, size, align);
+    if (block != NULL)
+    {
+        *usable_size = (ptrdiff_t)malloc_usable_size(block);
+    }
+    return block;
+}
+
+static void* ctd_realloc_sized(void* context, void* source, ptrdiff_t old_size, ptrdiff_t new_size, ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    void* block = ctd_realloc(context, source, old_size, new_size, align);
+    if (block != NULL)
+    {
+        *usable_size = (ptrdiff_t)malloc_usable_size(block);
+    }
+    return block;
+}
+#define CTD_HEAP_TRY_RESIZE ctd_heap_try_resize
+#define CTD_HEAP_ALLOCATE_SIZED ctd_malloc_sized
+#define CTD_HEAP_REALLOCATE_SIZED ctd_realloc_sized
+#else
+#define CTD_HEAP_TRY_RESIZE NULL
+#define CTD_HEAP_ALLOCATE_SIZED NULL
+#define CTD_HEAP_REALLOCATE_SIZED NULL
+#endif
+
+ctd_heap_allocator ctd_heap_allocator_instance = {.allocator = {.context = NULL, .allocate = ctd_malloc, .reallocate = ctd_realloc, .deallocate = ctd_free, .try_resize = CTD_HEAP_TRY_RESIZE, .allocate_sized = CTD_HEAP_ALLOCATE_SIZED, .reallocate_sized = CTD_HEAP_REALLOCATE_SIZED, .allocate_batch = ctd_malloc_batch, .deallocate_batch = ctd_free_batch}};
+
+ctd_heap_allocator ctd_heap_allocator_create()
+{
+    ctd_allocator allocator = {.allocate = ctd_malloc, .reallocate = ctd_realloc, .deallocate = ctd_free, .context = NULL, .try_resize = CTD_HEAP_TRY_RESIZE, .allocate_sized = CTD_HEAP_ALLOCATE_SIZED, .reallocate_sized = CTD_HEAP_REALLOCATE_SIZED, .allocate_batch = ctd_malloc_batch, .deallocate_batch = ctd_free_batch};
+    return (ctd_heap_allocator){.allocator = allocator};
+}
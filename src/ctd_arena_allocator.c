@@ -3,12 +3,15 @@
 #include <string.h>
 #include <stdalign.h>
 #include <ctd_define.h>
+#include <ctd_scrub.h>
 
 typedef struct ctd_arena_context
 {
     ptrdiff_t length;
     ptrdiff_t capacity;
     char* data;
+    // Used outside of reallocate and deallocate, which are specialized for the scrub policy instead
+    ctd_scrub_function scrub;
 } ctd_arena_context;
 
 // TODO maybe make size and count to overflow check?
@@ -27,7 +30,7 @@ static void* ctd_arena_allocator_allocate(void* context, ptrdiff_t size, ptrdiff
     return ptr;
 }
 
-static void* ctd_arena_allocator_reallocate(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align)
+static inline void* ctd_arena_allocator_reallocate_with_scrub(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const ctd_scrub_function scrub)
 {
     ctd_arena_context* arena = context;
 
@@ -46,7 +49,7 @@ static void* ctd_arena_allocator_reallocate(void* context, void* source, const p
     {
         if (difference < 0)
         {
-            memset(arena->data + arena->length + difference, 0, abs_difference);
+            scrub(arena->data + arena->length + difference, abs_difference);
         }
         if (difference > 0 && available_space < difference)
         {
@@ -57,10 +60,10 @@ static void* ctd_arena_allocator_reallocate(void* context, void* source, const p
         return source;
     }
     // Otherwise,
-    // If the object is shrinked, we zero out the memory but we don't change the position of arena->beginning
+    // If the object is shrinked, we scrub the memory but we don't change the position of arena->beginning
     if (difference < 0)
     {
-        memset(arena->data + arena->length + difference, 0, abs_difference);
+        scrub((char*)source + new_size, abs_difference);
         return source;
     }
 
@@ -75,17 +78,113 @@ static void* ctd_arena_allocator_reallocate(void* context, void* source, const p
     return destination;
 }
 
-static void ctd_arena_allocator_deallocate(void* context, void* block, ptrdiff_t size)
+static inline void ctd_arena_allocator_deallocate_with_scrub(void* context, void* block, ptrdiff_t size, const ctd_scrub_function scrub)
 {
     ctd_arena_context* arena = (ctd_arena_context* )context;
-    memset(block, 0, size);
+    scrub(block, size);
     if (block == arena->data + arena->length - size)
     {
         arena->length -= size;
     }
 }
 
+static bool ctd_arena_context_resize_tail(ctd_arena_context* arena, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    const ptrdiff_t difference = new_size - old_size;
+
+    if (arena->data + arena->length - old_size != source)
+    {
+        return false;
+    }
+    if (difference > arena->capacity - arena->length)
+    {
+        return false;
+    }
+    if (difference < 0)
+    {
+        arena->scrub(arena->data + arena->length + difference, -difference);
+    }
+    arena->length += difference;
+
+    return true;
+}
+
+/**
+ * Resizes a block without moving it. Blocks can always be shrunk in place, but only the most recent allocation can
+ * grow, and only while there is room left in the arena.
+ */
+static bool ctd_arena_allocator_try_resize(void* context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    ctd_arena_context* arena = context;
+    if (ctd_arena_context_resize_tail(arena, block, old_size, new_size))
+    {
+        return true;
+    }
+    if (new_size <= old_size)
+    {
+        arena->scrub((char*)block + new_size, old_size - new_size);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Allocates a batch of blocks with a single bump. The blocks are laid out back to back, each one rounded up to align so
+ * that the next one is aligned too.
+ */
+static bool ctd_arena_allocator_allocate_batch(void* context, const ptrdiff_t count, const ptrdiff_t size, const ptrdiff_t align, void** blocks)
+{
+    ctd_arena_context* arena = context;
+    if (count <= 0)
+    {
+        return true;
+    }
+
+    const ptrdiff_t stride = (size + align - 1) & ~(align - 1);
+    const ptrdiff_t padding = -(uintptr_t)(arena->data + arena->length) & (align-1);
+    const ptrdiff_t available_space = arena->capacity - arena->length - padding;
+    // Checked without multiplying count, so that a huge count can't overflow
+    if (size > available_space || (stride != 0 && (available_space - size) / stride < count - 1))
+    {
+        return false;
+    }
+
+    char* block = arena->data + arena->length + padding;
+    for (ptrdiff_t i = 0; i < count; i++)
+    {
+        blocks[i] = block + i * stride;
+    }
+    arena->length += padding + (count - 1) * stride + size;
+
+    return true;
+}
+
+/**
+ * Deallocates a batch of blocks in reverse, so that a batch at the end of the arena is taken back as long as its blocks
+ * weren't padded.
+ */
+static void ctd_arena_allocator_deallocate_batch(void* context, const ptrdiff_t count, const ptrdiff_t size, void** blocks)
+{
+    ctd_arena_context* arena = context;
+    for (ptrdiff_t i = count - 1; i >= 0; i--)
+    {
+        arena->scrub(blocks[i], size);
+        if ((char*)blocks[i] == arena->data + arena->length - size)
+        {
+            arena->length -= size;
+        }
+    }
+}
+
+ctd_scrub_specialize(ctd_arena_allocator)
+
 ctd_arena_allocator ctd_arena_allocator_create(ptrdiff_t size, ctd_allocator* alloc)
+{
+    return ctd_arena_allocator_create_with_scrub_policy(size, CTD_SCRUB_ZERO, alloc);
+}
+
+ctd_arena_allocator ctd_arena_allocator_create_with_scrub_policy(ptrdiff_t size, ctd_scrub_policy scrub_policy, ctd_allocator* alloc)
 {
     ctd_arena_allocator arena = {0};
     ctd_arena_context* context = alloc->allocate(alloc->context, sizeof(ctd_arena_context), alignof(ctd_arena_context));
@@ -94,10 +193,48 @@ ctd_arena_allocator ctd_arena_allocator_create(ptrdiff_t size, ctd_allocator* al
     if (context->data == NULL) return arena;
     context->length = 0;
     context->capacity = size;
-    arena.allocator.allocate = ctd_arena_allocator_allocate;
-    arena.allocator.reallocate = ctd_arena_allocator_reallocate;
-    arena.allocator.deallocate = ctd_arena_allocator_deallocate;
+    context->scrub = ctd_scrub_functions[scrub_policy];
+    arena.allocator = ctd_arena_allocator_scrub_vtables[scrub_policy];
+    arena.allocator.context = context;
+    arena.allocator.try_resize = ctd_arena_allocator_try_resize;
+    arena.allocator.allocate_batch = ctd_arena_allocator_allocate_batch;
+    arena.allocator.deallocate_batch = ctd_arena_allocator_deallocate_batch;
+
+    return arena;
+}
+
+/**
+ * Creates an arena over memory the caller already owns, such as a stack array, a static region or a shared memory
+ * segment. The arena's context is stored at the front of the buffer and the rest of it is handed out, so creation
+ * doesn't allocate, and the context shares cache lines with the first allocations. There is nothing to destroy, the
+ * arena is gone once the buffer is, so don't call ctd_arena_allocator_destroy on it.
+ *
+ * @param buffer Memory the arena lives in. It must outlive the arena and every block allocated from it.
+ * @param size Size of the buffer in bytes, including the context.
+ * @return Arena if the buffer can hold the context, otherwise returns an empty object. This can be checked by seeing
+ * if the allocator's context pointer is NULL or not with arena_name.allocator.context == NULL.
+ */
+ctd_arena_allocator ctd_arena_allocator_create_in_buffer(void* buffer, ptrdiff_t size)
+{
+    return ctd_arena_allocator_create_in_buffer_with_scrub_policy(buffer, size, CTD_SCRUB_ZERO);
+}
+
+ctd_arena_allocator ctd_arena_allocator_create_in_buffer_with_scrub_policy(void* buffer, ptrdiff_t size, ctd_scrub_policy scrub_policy)
+{
+    ctd_arena_allocator arena = {0};
+    const ptrdiff_t padding = -(uintptr_t)buffer & (alignof(ctd_arena_context)-1);
+    if (buffer == NULL || size < 0 || size < padding + (ptrdiff_t)sizeof(ctd_arena_context)) return arena;
+
+    ctd_arena_context* context = (ctd_arena_context*)((char*)buffer + padding);
+    context->data = (char*)(context + 1);
+    context->length = 0;
+    context->capacity = size - padding - sizeof(ctd_arena_context);
+    context->scrub = ctd_scrub_functions[scrub_policy];
+    arena.allocator = ctd_arena_allocator_scrub_vtables[scrub_policy];
     arena.allocator.context = context;
+    arena.allocator.try_resize = ctd_arena_allocator_try_resize;
+    arena.allocator.allocate_batch = ctd_arena_allocator_allocate_batch;
+    arena.allocator.deallocate_batch = ctd_arena_allocator_deallocate_batch;
 
     return arena;
 }
@@ -114,4 +251,78 @@ void ctd_arena_allocator_destroy(ctd_arena_allocator* self, ctd_allocator* alloc
     allocator->deallocate(allocator->context, arena->data, arena->capacity);
     allocator->deallocate(allocator->context, arena, sizeof(ctd_arena_context));
     *self = (ctd_arena_allocator){0};
-}
\ No newline at end of file
+}
+
+/**
+ * Records the current position of an arena so that everything allocated after it can be freed at once with
+ * ctd_arena_allocator_rewind.
+ *
+ * @param self The arena to mark.
+ * @return Save point of the arena's current position.
+ */
+ctd_arena_save_point ctd_arena_allocator_mark(ctd_arena_allocator* self)
+{
+    ctd_arena_context* arena = self->allocator.context;
+    return (ctd_arena_save_point){.page = 0, .length = arena->length};
+}
+
+/**
+ * Frees everything allocated after a save point in O(1). The freed memory is not zeroed.
+ *
+ * @param self The arena to rewind.
+ * @param save_point Save point returned by ctd_arena_allocator_mark on the same arena.
+ */
+void ctd_arena_allocator_rewind(ctd_arena_allocator* self, ctd_arena_save_point save_point)
+{
+    ctd_arena_context* arena = self->allocator.context;
+    if (save_point.length < arena->length)
+    {
+        arena->length = save_point.length;
+    }
+}
+
+/**
+ * Frees everything inside an arena in O(1) while keeping its memory around for reuse. The freed memory is not zeroed.
+ *
+ * @param self The arena to reset.
+ */
+void ctd_arena_allocator_reset(ctd_arena_allocator* self)
+{
+    ctd_arena_context* arena = self->allocator.context;
+    arena->length = 0;
+}
+
+/**
+ * Grows or shrinks a block in place if it is the most recent allocation in the arena. Unlike reallocate, this never
+ * moves the block, so it can be used on pointers that might not belong to the arena at all.
+ *
+ * @param self The arena the block may belong to.
+ * @param source Pointer to the block.
+ * @param old_size Current size of the block.
+ * @param new_size Size the block should be resized to.
+ * @return Whether the block was resized.
+ */
+bool ctd_arena_allocator_resize_tail(ctd_arena_allocator* self, void* source, ptrdiff_t old_size, ptrdiff_t new_size)
+{
+    return ctd_arena_context_resize_tail(self->allocator.context, source, old_size, new_size);
+}
+
+/**
+ * @param self The arena to query.
+ * @return Number of bytes handed out by the arena, including alignment padding.
+ */
+ptrdiff_t ctd_arena_allocator_used(ctd_arena_allocator* self)
+{
+    ctd_arena_context* arena = self->allocator.context;
+    return arena->length;
+}
+
+/**
+ * @param self The arena to query.
+ * @return Total number of bytes the arena can hand out.
+ */
+ptrdiff_t ctd_arena_allocator_capacity(ctd_arena_allocator* self)
+{
+    ctd_arena_context* arena = self->allocator.context;
+    return arena->capacity;
+}
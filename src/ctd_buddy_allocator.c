@@ -0,0 +1,358 @@
+#include <ctd_buddy_allocator.h>
+#include <ctd_define.h>
+#include <ctd_scrub.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+
+// Enough orders for any region that fits in a ptrdiff_t
+#define CTD_BUDDY_MAX_ORDERS 64
+
+typedef struct ctd_buddy_free_block
+{
+    struct ctd_buddy_free_block* next;
+    struct ctd_buddy_free_block* previous;
+} ctd_buddy_free_block;
+
+typedef struct ctd_buddy_context
+{
+    char* data;
+    ptrdiff_t size;
+    // Blocks of order n are min_block_size << n bytes, and the whole region is a single block of max_order
+    int min_block_shift;
+    int max_order;
+    // Bit n is set when free_lists[n] isn't empty
+    uint64_t free_orders;
+    ctd_buddy_free_block* free_lists[CTD_BUDDY_MAX_ORDERS];
+    // One bit per node of the tree of blocks, set while the block is in a free list. The root comes first, followed by
+    // each level of smaller blocks
+    uint64_t* free_blocks;
+    ptrdiff_t free_blocks_length;
+    ptrdiff_t free_bytes;
+    ctd_allocator* allocator;
+    // Used outside of reallocate and deallocate, which are specialized for the scrub policy instead
+    ctd_scrub_function scrub;
+} ctd_buddy_context;
+
+static inline int ctd_buddy_log2_ceil(const ptrdiff_t value)
+{
+    return value <= 1 ? 0 : 64 - __builtin_clzll((unsigned long long)(value - 1));
+}
+
+/**
+ * Returns the order of the smallest block that can hold size bytes, or -1 if size is bigger than the region.
+ */
+static inline int ctd_buddy_order(const ctd_buddy_context* buddy, const ptrdiff_t size)
+{
+    const int order = ctd_buddy_log2_ceil(size) - buddy->min_block_shift;
+    if (order > buddy->max_order)
+    {
+        return -1;
+    }
+    return order < 0 ? 0 : order;
+}
+
+static inline ptrdiff_t ctd_buddy_node(const ctd_buddy_context* buddy, const char* block, const int order)
+{
+    const int level = buddy->max_order - order;
+    return ((ptrdiff_t)1 << level) - 1 + ((block - buddy->data) >> (buddy->min_block_shift + order));
+}
+
+static inline bool ctd_buddy_is_free(const ctd_buddy_context* buddy, const ptrdiff_t node)
+{
+    return (buddy->free_blocks[node / 64] >> (node % 64)) & 1;
+}
+
+static inline void ctd_buddy_push(ctd_buddy_context* buddy, char* block, const int order)
+{
+    ctd_buddy_free_block* free_block = (ctd_buddy_free_block*)block;
+    free_block->previous = NULL;
+    free_block->next = buddy->free_lists[order];
+    if (free_block->next != NULL)
+    {
+        free_block->next->previous = free_block;
+    }
+    buddy->free_lists[order] = free_block;
+    buddy->free_orders |= (uint64_t)1 << order;
+
+    const ptrdiff_t node = ctd_buddy_node(buddy, block, order);
+    buddy->free_blocks[node / 64] |= (uint64_t)1 << (node % 64);
+    buddy->free_bytes += (ptrdiff_t)1 << (buddy->min_block_shift + order);
+}
+
+static inline void ctd_buddy_remove(ctd_buddy_context* buddy, char* block, const int order)
+{
+    ctd_buddy_free_block* free_block = (ctd_buddy_free_block*)block;
+    if (free_block->previous != NULL)
+    {
+        free_block->previous->next = free_block->next;
+    }
+    else
+    {
+        buddy->free_lists[order] = free_block->next;
+    }
+    if (free_block->next != NULL)
+    {
+        free_block->next->previous = free_block->previous;
+    }
+    if (buddy->free_lists[order] == NULL)
+    {
+        buddy->free_orders &= ~((uint64_t)1 << order);
+    }
+
+    const ptrdiff_t node = ctd_buddy_node(buddy, block, order);
+    buddy->free_blocks[node / 64] &= ~((uint64_t)1 << (node % 64));
+    buddy->free_bytes -= (ptrdiff_t)1 << (buddy->min_block_shift + order);
+}
+
+static inline char* ctd_buddy_of(const ctd_buddy_context* buddy, char* block, const int order)
+{
+    return buddy->data + ((block - buddy->data) ^ ((ptrdiff_t)1 << (buddy->min_block_shift + order)));
+}
+
+/**
+ * Frees a block, merging it with its buddy for as long as the buddy is free as well.
+ */
+static void ctd_buddy_release(ctd_buddy_context* buddy, char* block, int order)
+{
+    while (order < buddy->max_order)
+    {
+        char* buddy_block = ctd_buddy_of(buddy, block, order);
+        if (!ctd_buddy_is_free(buddy, ctd_buddy_node(buddy, buddy_block, order)))
+        {
+            break;
+        }
+        ctd_buddy_remove(buddy, buddy_block, order);
+        block = block < buddy_block ? block : buddy_block;
+        order++;
+    }
+    ctd_buddy_push(buddy, block, order);
+}
+
+/**
+ * Allocates a block from a buddy allocator. The smallest free block that fits is taken, and split in halves until it's
+ * as small as it can be, with the halves that aren't needed going into the free lists.
+ *
+ * @param context Context of buddy allocator
+ * @param size Size of memory to be allocated in bytes
+ * @param align Alignment of memory to be allocated
+ * @param usable_size Set to the size of the block if allocation is successful
+ * @return Pointer to allocated memory if allocation is successful, otherwise returns NULL.
+ */
+static void* ctd_buddy_allocator_allocate_sized(void* context, const ptrdiff_t size, const ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    ctd_buddy_context* buddy = context;
+    const int order = ctd_buddy_order(buddy, size);
+    if (order < 0)
+    {
+        return NULL;
+    }
+    const ptrdiff_t block_size = (ptrdiff_t)1 << (buddy->min_block_shift + order);
+    if (align > block_size || align > CTD_BUDDY_REGION_ALIGNMENT)
+    {
+        return NULL;
+    }
+
+    const uint64_t candidates = buddy->free_orders >> order << order;
+    if (candidates == 0)
+    {
+        return NULL;
+    }
+    int free_order = __builtin_ctzll(candidates);
+    char* block = (char*)buddy->free_lists[free_order];
+    ctd_buddy_remove(buddy, block, free_order);
+    while (free_order > order)
+    {
+        free_order--;
+        ctd_buddy_push(buddy, block + ((ptrdiff_t)1 << (buddy->min_block_shift + free_order)), free_order);
+    }
+
+    *usable_size = block_size;
+    return block;
+}
+
+static void* ctd_buddy_allocator_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ptrdiff_t usable_size;
+    return ctd_buddy_allocator_allocate_sized(context, size, align, &usable_size);
+}
+
+/**
+ * Resizes a block without moving it. Shrinking a block splits it, freeing the halves it no longer needs. Growing a
+ * block absorbs its buddies, which only works if the block is the first half at every order it grows through, and every
+ * buddy it would absorb is free as a whole.
+ *
+ * @param buddy Context of buddy allocator
+ * @param block Pointer to the block to be resized
+ * @param old_size Current size of the block
+ * @param new_size Size the block should be resized to
+ * @param scrub Scrub function used on memory that is given up
+ * @return Whether the block was resized.
+ */
+static bool ctd_buddy_context_try_resize(ctd_buddy_context* buddy, char* block, const ptrdiff_t old_size, const ptrdiff_t new_size, const ctd_scrub_function scrub)
+{
+    const int old_order = ctd_buddy_order(buddy, old_size);
+    const int new_order = ctd_buddy_order(buddy, new_size);
+    if (new_order < 0)
+    {
+        return false;
+    }
+    if (new_size < old_size)
+    {
+        scrub(block + new_size, old_size - new_size);
+    }
+    if (new_order <= old_order)
+    {
+        for (int order = old_order - 1; order >= new_order; order--)
+        {
+            ctd_buddy_push(buddy, block + ((ptrdiff_t)1 << (buddy->min_block_shift + order)), order);
+        }
+        return true;
+    }
+
+    if (((block - buddy->data) & (((ptrdiff_t)1 << (buddy->min_block_shift + new_order)) - 1)) != 0)
+    {
+        return false;
+    }
+    for (int order = old_order; order < new_order; order++)
+    {
+        if (!ctd_buddy_is_free(buddy, ctd_buddy_node(buddy, ctd_buddy_of(buddy, block, order), order)))
+        {
+            return false;
+        }
+    }
+    for (int order = old_order; order < new_order; order++)
+    {
+        ctd_buddy_remove(buddy, ctd_buddy_of(buddy, block, order), order);
+    }
+
+    return true;
+}
+
+static bool ctd_buddy_allocator_try_resize(void* context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    ctd_buddy_context* buddy = context;
+    return ctd_buddy_context_try_resize(buddy, block, old_size, new_size, buddy->scrub);
+}
+
+/**
+ * Deallocates a block by scrubbing it and merging it back into the free lists.
+ *
+ * @param context Context of buddy allocator
+ * @param block Pointer to memory to be deallocated
+ * @param size Size of memory to be deallocated
+ * @param scrub Scrub function of the buddy allocator's scrub policy
+ */
+static inline void ctd_buddy_allocator_deallocate_with_scrub(void* context, void* block, const ptrdiff_t size, const ctd_scrub_function scrub)
+{
+    ctd_buddy_context* buddy = context;
+    scrub(block, size);
+    ctd_buddy_release(buddy, block, ctd_buddy_order(buddy, size));
+}
+
+/**
+ * Reallocates a region of memory. It is resized in place if possible, see ctd_buddy_context_try_resize, otherwise the
+ * data is copied into a new block and the old block is deallocated.
+ *
+ * @param context Buddy allocator's context
+ * @param source Pointer to the memory to be reallocated
+ * @param old_size The size of the memory to be reallocated
+ * @param new_size The size the memory will be reallocated to
+ * @param align The alignment of the region of memory
+ * @param scrub Scrub function of the buddy allocator's scrub policy
+ * @return Pointer to the reallocated memory if reallocation succeeds, otherwise returns NULL pointer.
+ */
+static inline void* ctd_buddy_allocator_reallocate_with_scrub(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const ctd_scrub_function scrub)
+{
+    if (ctd_buddy_context_try_resize(context, source, old_size, new_size, scrub))
+    {
+        return source;
+    }
+
+    void* destination = ctd_buddy_allocator_allocate(context, new_size, align);
+    if (destination == NULL) return NULL;
+
+    memcpy(destination, source, ctd_min(old_size, new_size));
+    ctd_buddy_allocator_deallocate_with_scrub(context, source, old_size, scrub);
+
+    return destination;
+}
+
+ctd_scrub_specialize(ctd_buddy_allocator)
+
+ctd_buddy_allocator ctd_buddy_allocator_create(ptrdiff_t size, ptrdiff_t min_block_size, ctd_allocator* allocator)
+{
+    return ctd_buddy_allocator_create_with_scrub_policy(size, min_block_size, CTD_SCRUB_ZERO, allocator);
+}
+
+ctd_buddy_allocator ctd_buddy_allocator_create_with_scrub_policy(ptrdiff_t size, ptrdiff_t min_block_size, ctd_scrub_policy scrub_policy, ctd_allocator* allocator)
+{
+    const int min_block_shift = ctd_buddy_log2_ceil(ctd_max(min_block_size, sizeof(ctd_buddy_free_block)));
+    const int region_shift = ctd_max(ctd_buddy_log2_ceil(size), min_block_shift);
+    if (region_shift >= CTD_BUDDY_MAX_ORDERS - 1)
+    {
+        return (ctd_buddy_allocator) {0};
+    }
+
+    ctd_buddy_context* context = allocator->allocate(allocator->context, sizeof(ctd_buddy_context), alignof(ctd_buddy_context));
+    if (context == NULL) goto context_alloc_failed_cleanup;
+    *context = (ctd_buddy_context) {0};
+    context->size = (ptrdiff_t)1 << region_shift;
+    context->min_block_shift = min_block_shift;
+    context->max_order = region_shift - min_block_shift;
+    context->allocator = allocator;
+    context->scrub = ctd_scrub_functions[scrub_policy];
+
+    // A tree with 2^max_order leaves has twice as many nodes, minus one
+    context->free_blocks_length = (((ptrdiff_t)2 << context->max_order) + 63) / 64;
+    context->free_blocks = allocator->allocate(allocator->context, context->free_blocks_length * sizeof(uint64_t), alignof(uint64_t));
+    if (context->free_blocks == NULL) goto free_blocks_alloc_failed_cleanup;
+    memset(context->free_blocks, 0, context->free_blocks_length * sizeof(uint64_t));
+
+    context->data = allocator->allocate(allocator->context, context->size, ctd_min(context->size, CTD_BUDDY_REGION_ALIGNMENT));
+    if (context->data == NULL) goto region_alloc_failed_cleanup;
+    ctd_buddy_push(context, context->data, context->max_order);
+
+    ctd_buddy_allocator buddy_allocator = {0};
+    buddy_allocator.allocator = ctd_buddy_allocator_scrub_vtables[scrub_policy];
+    buddy_allocator.allocator.context = context;
+    buddy_allocator.allocator.try_resize = ctd_buddy_allocator_try_resize;
+    buddy_allocator.allocator.allocate_sized = ctd_buddy_allocator_allocate_sized;
+
+    return buddy_allocator;
+
+region_alloc_failed_cleanup:
+    allocator->deallocate(allocator->context, context->free_blocks, context->free_blocks_length * sizeof(uint64_t));
+free_blocks_alloc_failed_cleanup:
+    allocator->deallocate(allocator->context, context, sizeof(ctd_buddy_context));
+context_alloc_failed_cleanup:
+    return (ctd_buddy_allocator) {0};
+}
+
+void ctd_buddy_allocator_destroy(ctd_buddy_allocator* self)
+{
+    ctd_buddy_context* context = self->allocator.context;
+    ctd_allocator* underlying_allocator = context->allocator;
+
+    underlying_allocator->deallocate(underlying_allocator->context, context->data, context->size);
+    underlying_allocator->deallocate(underlying_allocator->context, context->free_blocks, context->free_blocks_length * sizeof(uint64_t));
+    underlying_allocator->deallocate(underlying_allocator->context, context, sizeof(ctd_buddy_context));
+
+    *self = (ctd_buddy_allocator) {0};
+}
+
+ptrdiff_t ctd_buddy_allocator_free_bytes(ctd_buddy_allocator* self)
+{
+    const ctd_buddy_context* context = self->allocator.context;
+    return context->free_bytes;
+}
+
+ptrdiff_t ctd_buddy_allocator_largest_free_block(ctd_buddy_allocator* self)
+{
+    const ctd_buddy_context* context = self->allocator.context;
+    if (context->free_orders == 0)
+    {
+        return 0;
+    }
+    return (ptrdiff_t)1 << (context->min_block_shift + 63 - __builtin_clzll(context->free_orders));
+}
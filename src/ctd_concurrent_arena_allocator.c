@@ -0,0 +1,162 @@
+#include <ctd_concurrent_arena_allocator.h>
+#include <ctd_scrub.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct ctd_concurrent_arena_context
+{
+    // Always a multiple of CTD_CONCURRENT_ARENA_ALIGNMENT, and never more than capacity
+    _Atomic ptrdiff_t length;
+    ptrdiff_t capacity;
+    char* data;
+} ctd_concurrent_arena_context;
+
+static inline ptrdiff_t ctd_concurrent_arena_round_up(const ptrdiff_t size)
+{
+    return (size + CTD_CONCURRENT_ARENA_ALIGNMENT - 1) & -CTD_CONCURRENT_ARENA_ALIGNMENT;
+}
+
+/**
+ * Allocates memory from a concurrent arena. Memory is never handed out twice, since every allocation claims its range
+ * by atomically moving the arena's length past it, and only does so if the range fits in the arena.
+ *
+ * @param context Context of concurrent arena allocator
+ * @param size Size of memory to be allocated in bytes
+ * @param align Alignment of memory to be allocated
+ * @return Pointer to allocated memory if allocation is successful, otherwise returns NULL.
+ */
+static void* ctd_concurrent_arena_allocator_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ctd_concurrent_arena_context* concurrent_arena = context;
+    const ptrdiff_t rounded_size = ctd_concurrent_arena_round_up(size);
+
+    // The length is only published once the allocation is known to fit, so a failed request never uses up the arena.
+    // It is always aligned, so requests aligned to at most CTD_CONCURRENT_ARENA_ALIGNMENT never need padding
+    ptrdiff_t length = atomic_load_explicit(&concurrent_arena->length, memory_order_relaxed);
+    ptrdiff_t padding;
+    do
+    {
+        padding = align <= CTD_CONCURRENT_ARENA_ALIGNMENT ? 0 : -(uintptr_t)(concurrent_arena->data + length) & (align-1);
+        if (length > concurrent_arena->capacity - padding - rounded_size)
+        {
+            return NULL;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&concurrent_arena->length, &length, length + padding + rounded_size,
+                                                    memory_order_relaxed, memory_order_relaxed));
+
+    return concurrent_arena->data + length + padding;
+}
+
+/**
+ * Moves the end of the arena from one offset to another, if nothing else was allocated in between.
+ */
+static inline bool ctd_concurrent_arena_move_tail(ctd_concurrent_arena_context* concurrent_arena, ptrdiff_t old_end, const ptrdiff_t new_end)
+{
+    return atomic_compare_exchange_strong_explicit(&concurrent_arena->length, &old_end, new_end, memory_order_relaxed, memory_order_relaxed);
+}
+
+static inline void* ctd_concurrent_arena_allocator_reallocate_with_scrub(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const ctd_scrub_function scrub)
+{
+    ctd_concurrent_arena_context* concurrent_arena = context;
+    const ptrdiff_t source_offset = (char*)source - concurrent_arena->data;
+    const ptrdiff_t old_end = source_offset + ctd_concurrent_arena_round_up(old_size);
+    const ptrdiff_t new_end = source_offset + ctd_concurrent_arena_round_up(new_size);
+
+    // If there isn't any change, simply return the source pointer
+    if (new_size == old_size)
+    {
+        return source;
+    }
+    // Shrinking always happens in place, and gives the memory back if the object is at the end of the arena
+    if (new_size < old_size)
+    {
+        scrub((char*)source + new_size, old_size - new_size);
+        ctd_concurrent_arena_move_tail(concurrent_arena, old_end, new_end);
+        return source;
+    }
+    // If the object is at the end of the arena, it can grow in place as long as no other thread allocates first
+    if (new_end <= concurrent_arena->capacity && ctd_concurrent_arena_move_tail(concurrent_arena, old_end, new_end))
+    {
+        return source;
+    }
+
+    // Otherwise, the object is copied to a new allocation
+    void* destination = ctd_concurrent_arena_allocator_allocate(context, new_size, align);
+    if (destination == NULL)
+    {
+        return NULL;
+    }
+    memcpy(destination, source, old_size);
+    return destination;
+}
+
+static inline void ctd_concurrent_arena_allocator_deallocate_with_scrub(void* context, void* block, const ptrdiff_t size, const ctd_scrub_function scrub)
+{
+    ctd_concurrent_arena_context* concurrent_arena = context;
+    const ptrdiff_t block_offset = (char*)block - concurrent_arena->data;
+    scrub(block, size);
+    ctd_concurrent_arena_move_tail(concurrent_arena, block_offset + ctd_concurrent_arena_round_up(size), block_offset);
+}
+
+ctd_scrub_specialize(ctd_concurrent_arena_allocator)
+
+ctd_concurrent_arena_allocator ctd_concurrent_arena_allocator_create(ptrdiff_t size, ctd_allocator* alloc)
+{
+    return ctd_concurrent_arena_allocator_create_with_scrub_policy(size, CTD_SCRUB_ZERO, alloc);
+}
+
+ctd_concurrent_arena_allocator ctd_concurrent_arena_allocator_create_with_scrub_policy(ptrdiff_t size, ctd_scrub_policy scrub_policy, ctd_allocator* alloc)
+{
+    ctd_concurrent_arena_allocator concurrent_arena = {0};
+    ctd_concurrent_arena_context* context = alloc->allocate(alloc->context, sizeof(ctd_concurrent_arena_context), alignof(ctd_concurrent_arena_context));
+    if (context == NULL) goto context_alloc_failed_cleanup;
+    context->data = alloc->allocate(alloc->context, size, CTD_CONCURRENT_ARENA_ALIGNMENT);
+    if (context->data == NULL) goto data_alloc_failed_cleanup;
+    atomic_init(&context->length, 0);
+    context->capacity = size;
+
+    concurrent_arena.allocator = ctd_concurrent_arena_allocator_scrub_vtables[scrub_policy];
+    concurrent_arena.allocator.context = context;
+
+    return concurrent_arena;
+
+data_alloc_failed_cleanup:
+    alloc->deallocate(alloc->context, context, sizeof(ctd_concurrent_arena_context));
+context_alloc_failed_cleanup:
+    return (ctd_concurrent_arena_allocator) {0};
+}
+
+void ctd_concurrent_arena_allocator_destroy(ctd_concurrent_arena_allocator* self, ctd_allocator* alloc)
+{
+    ctd_concurrent_arena_context* concurrent_arena = self->allocator.context;
+    alloc->deallocate(alloc->context, concurrent_arena->data, concurrent_arena->capacity);
+    alloc->deallocate(alloc->context, concurrent_arena, sizeof(ctd_concurrent_arena_context));
+    *self = (ctd_concurrent_arena_allocator) {0};
+}
+
+ctd_concurrent_arena_chunk ctd_concurrent_arena_allocator_reserve(ctd_concurrent_arena_allocator* self, ptrdiff_t size)
+{
+    size = ctd_concurrent_arena_round_up(size);
+    char* data = ctd_concurrent_arena_allocator_allocate(self->allocator.context, size, CTD_CONCURRENT_ARENA_ALIGNMENT);
+    if (data == NULL)
+    {
+        return (ctd_concurrent_arena_chunk) {0};
+    }
+
+    return (ctd_concurrent_arena_chunk) {.data = data, .length = 0, .capacity = size};
+}
+
+void ctd_concurrent_arena_allocator_reset(ctd_concurrent_arena_allocator* self)
+{
+    ctd_concurrent_arena_context* concurrent_arena = self->allocator.context;
+    atomic_store_explicit(&concurrent_arena->length, 0, memory_order_relaxed);
+}
+
+ptrdiff_t ctd_concurrent_arena_allocator_used(ctd_concurrent_arena_allocator* self)
+{
+    ctd_concurrent_arena_context* concurrent_arena = self->allocator.context;
+    return atomic_load_explicit(&concurrent_arena->length, memory_order_relaxed);
+}
@@ -1,6 +1,8 @@
 #include <ctd_expandable_arena_allocator.h>
 #include <ctd_define.h>
+#include <ctd_scrub.h>
 #include <stdalign.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -10,19 +12,22 @@ typedef struct ctd_expandable_arena_context
     ptrdiff_t capacity;
     char* data;
     ctd_allocator* allocator;
+    // Used outside of reallocate and deallocate, which are specialized for the scrub policy instead
+    ctd_scrub_function scrub;
 } ctd_expandable_arena_context;
 
-static void ctd_expandable_arena_allocator_expand(ctd_expandable_arena_context* context, const ptrdiff_t expand_by)
+static bool ctd_expandable_arena_allocator_expand(ctd_expandable_arena_context* context, const ptrdiff_t expand_by)
 {
     const ptrdiff_t new_capacity = ctd_max(context->capacity * 2 + 1, context->capacity + expand_by);
     char* new_data = context->allocator->reallocate(context->allocator->context, context->data, context->capacity, new_capacity, alignof(char));
     if (new_data == NULL)
     {
-        // TODO handle error
-        return;
+        return false;
     }
     context->data = new_data;
     context->capacity = new_capacity;
+
+    return true;
 }
 
 // TODO maybe make size and count to overflow check?
@@ -32,16 +37,16 @@ static void* ctd_expandable_arena_allocator_allocate(void* context, const ptrdif
 
     const ptrdiff_t padding = -(uintptr_t)(expandable_arena->data + expandable_arena->length) & (align-1);
     const ptrdiff_t available_space = expandable_arena->capacity - expandable_arena->length - padding;
-    if (size > available_space)
+    if (size > available_space && !ctd_expandable_arena_allocator_expand(expandable_arena, size - available_space))
     {
-        ctd_expandable_arena_allocator_expand(expandable_arena, size - available_space);
+        return NULL;
     }
     void* ptr = expandable_arena->data + expandable_arena->length + padding;
     expandable_arena->length += size + padding;
     return ptr;
 }
 
-static void* ctd_expandable_arena_allocator_reallocate(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align)
+static inline void* ctd_expandable_arena_allocator_reallocate_with_scrub(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const ctd_scrub_function scrub)
 {
     ctd_expandable_arena_context* expandable_arena = context;
 
@@ -49,6 +54,8 @@ static void* ctd_expandable_arena_allocator_reallocate(void* context, void* sour
     const ptrdiff_t difference = new_size - old_size;
     const ptrdiff_t abs_difference = difference >= 0 ? difference : -difference;
     const ptrdiff_t available_space = expandable_arena->capacity - expandable_arena->length - padding;
+    // Expanding can move the arena's data, so the source is tracked by its offset into the arena
+    const ptrdiff_t source_offset = (char*)source - expandable_arena->data;
 
     // If there isn't any change, simply return the source pointer
     if (difference == 0)
@@ -60,46 +67,81 @@ static void* ctd_expandable_arena_allocator_reallocate(void* context, void* sour
     {
         if (difference < 0)
         {
-            memset(expandable_arena->data + expandable_arena->length + difference, 0, abs_difference);
+            scrub(expandable_arena->data + expandable_arena->length + difference, abs_difference);
         }
-        else if (available_space < difference)
+        else if (available_space < difference && !ctd_expandable_arena_allocator_expand(expandable_arena, difference - available_space))
         {
-            ctd_expandable_arena_allocator_expand(expandable_arena, difference - available_space);
+            return NULL;
         }
         expandable_arena->length += difference;
 
-        return source;
+        return expandable_arena->data + source_offset;
     }
     // Otherwise,
-    // If the object is shrinked, we zero out the memory but we don't change the position of expandable_arena->beginning
+    // If the object is shrinked, we scrub the memory but we don't change the position of expandable_arena->beginning
     if (difference < 0)
     {
-        memset(expandable_arena->data + expandable_arena->length + difference, 0, abs_difference);
+        scrub((char*)source + new_size, abs_difference);
         return source;
     }
 
     // If the object is expanded, we move it to the front of the expandable_arena, and we change expandable_arena->beginning by new_size instead of difference
-    if (available_space < new_size)
+    if (available_space < new_size && !ctd_expandable_arena_allocator_expand(expandable_arena, new_size - available_space))
     {
-        ctd_expandable_arena_allocator_expand(expandable_arena, new_size - available_space);
+        return NULL;
     }
-    char* destination = expandable_arena->data + expandable_arena->length + padding;
-    memmove(destination, source, old_size);
-    expandable_arena->length += padding + new_size;
+    const ptrdiff_t destination_padding = -(uintptr_t)(expandable_arena->data + expandable_arena->length) & (align-1);
+    char* destination = expandable_arena->data + expandable_arena->length + destination_padding;
+    memmove(destination, expandable_arena->data + source_offset, old_size);
+    expandable_arena->length += destination_padding + new_size;
     return destination;
 }
 
-static void ctd_expandable_arena_allocator_deallocate(void* context, void* block, const ptrdiff_t size)
+static inline void ctd_expandable_arena_allocator_deallocate_with_scrub(void* context, void* block, const ptrdiff_t size, const ctd_scrub_function scrub)
 {
     ctd_expandable_arena_context* expandable_arena = context;
-    memset(block, 0, size);
+    scrub(block, size);
     if (block == expandable_arena->data + expandable_arena->length - size)
     {
         expandable_arena->length -= size;
     }
 }
 
+/**
+ * Resizes a block without moving it. Blocks can always be shrunk in place, but only the most recent allocation can
+ * grow, and only into the arena's current capacity, since expanding the arena can move all of its data.
+ */
+static bool ctd_expandable_arena_allocator_try_resize(void* context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    ctd_expandable_arena_context* expandable_arena = context;
+    const ptrdiff_t difference = new_size - old_size;
+
+    if (expandable_arena->data + expandable_arena->length - old_size == block && difference <= expandable_arena->capacity - expandable_arena->length)
+    {
+        if (difference < 0)
+        {
+            expandable_arena->scrub(expandable_arena->data + expandable_arena->length + difference, -difference);
+        }
+        expandable_arena->length += difference;
+        return true;
+    }
+    if (difference <= 0)
+    {
+        expandable_arena->scrub((char*)block + new_size, -difference);
+        return true;
+    }
+
+    return false;
+}
+
+ctd_scrub_specialize(ctd_expandable_arena_allocator)
+
 ctd_expandable_arena_allocator ctd_expandable_arena_allocator_create(const ptrdiff_t size, ctd_allocator* allocator)
+{
+    return ctd_expandable_arena_allocator_create_with_scrub_policy(size, CTD_SCRUB_ZERO, allocator);
+}
+
+ctd_expandable_arena_allocator ctd_expandable_arena_allocator_create_with_scrub_policy(const ptrdiff_t size, const ctd_scrub_policy scrub_policy, ctd_allocator* allocator)
 {
     ctd_expandable_arena_allocator expandable_arena = {0};
     ctd_expandable_arena_context* context = allocator->allocate(allocator->context, sizeof(ctd_expandable_arena_context), alignof(ctd_expandable_arena_context));
@@ -109,10 +151,10 @@ ctd_expandable_arena_allocator ctd_expandable_arena_allocator_create(const ptrdi
     context->length = 0;
     context->capacity = size;
     context->allocator = allocator;
-    expandable_arena.allocator.allocate = ctd_expandable_arena_allocator_allocate;
-    expandable_arena.allocator.reallocate = ctd_expandable_arena_allocator_reallocate;
-    expandable_arena.allocator.deallocate = ctd_expandable_arena_allocator_deallocate;
+    context->scrub = ctd_scrub_functions[scrub_policy];
+    expandable_arena.allocator = ctd_expandable_arena_allocator_scrub_vtables[scrub_policy];
     expandable_arena.allocator.context = context;
+    expandable_arena.allocator.try_resize = ctd_expandable_arena_allocator_try_resize;
 
     return expandable_arena;
 }
@@ -128,6 +170,66 @@ void ctd_expandable_arena_allocator_destroy(ctd_expandable_arena_allocator* self
     ctd_allocator* allocator = expandable_arena->allocator;
     allocator->deallocate(allocator->context, expandable_arena->data, expandable_arena->capacity);
     allocator->deallocate(allocator->context, expandable_arena, sizeof(ctd_expandable_arena_context));
-    *expandable_arena = (ctd_expandable_arena_context){0};
     *self = (ctd_expandable_arena_allocator){0};
-}
\ No newline at end of file
+}
+
+/**
+ * Records the current position of an expandable arena so that everything allocated after it can be freed at once with
+ * ctd_expandable_arena_allocator_rewind.
+ *
+ * @param self The expandable arena to mark.
+ * @return Save point of the expandable arena's current position.
+ */
+ctd_arena_save_point ctd_expandable_arena_allocator_mark(ctd_expandable_arena_allocator* self)
+{
+    ctd_expandable_arena_context* expandable_arena = self->allocator.context;
+    return (ctd_arena_save_point){.page = 0, .length = expandable_arena->length};
+}
+
+/**
+ * Frees everything allocated after a save point in O(1). The freed memory is not zeroed, and the expandable arena keeps
+ * its current capacity.
+ *
+ * @param self The expandable arena to rewind.
+ * @param save_point Save point returned by ctd_expandable_arena_allocator_mark on the same expandable arena.
+ */
+void ctd_expandable_arena_allocator_rewind(ctd_expandable_arena_allocator* self, ctd_arena_save_point save_point)
+{
+    ctd_expandable_arena_context* expandable_arena = self->allocator.context;
+    if (save_point.length < expandable_arena->length)
+    {
+        expandable_arena->length = save_point.length;
+    }
+}
+
+/**
+ * Frees everything inside an expandable arena in O(1) while keeping its memory around for reuse. The freed memory is
+ * not zeroed.
+ *
+ * @param self The expandable arena to reset.
+ */
+void ctd_expandable_arena_allocator_reset(ctd_expandable_arena_allocator* self)
+{
+    ctd_expandable_arena_context* expandable_arena = self->allocator.context;
+    expandable_arena->length = 0;
+}
+
+/**
+ * @param self The expandable arena to query.
+ * @return Number of bytes handed out by the expandable arena, including alignment padding.
+ */
+ptrdiff_t ctd_expandable_arena_allocator_used(ctd_expandable_arena_allocator* self)
+{
+    ctd_expandable_arena_context* expandable_arena = self->allocator.context;
+    return expandable_arena->length;
+}
+
+/**
+ * @param self The expandable arena to query.
+ * @return Number of bytes the expandable arena can hand out before it has to expand.
+ */
+ptrdiff_t ctd_expandable_arena_allocator_capacity(ctd_expandable_arena_allocator* self)
+{
+    ctd_expandable_arena_context* expandable_arena = self->allocator.context;
+    return expandable_arena->capacity;
+}
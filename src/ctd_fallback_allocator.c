@@ -0,0 +1,182 @@
+#include <ctd_fallback_allocator.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdalign.h>
+#include <ctd_define.h>
+#include <ctd_scrub.h>
+
+typedef struct ctd_fallback_context
+{
+    ptrdiff_t length;
+    ptrdiff_t capacity;
+    char* data;
+    ctd_allocator* allocator;
+    // Used outside of reallocate and deallocate, which are specialized for the scrub policy instead
+    ctd_scrub_function scrub;
+} ctd_fallback_context;
+
+static inline bool ctd_fallback_context_owns(const ctd_fallback_context* fallback, const void* block)
+{
+    return (uintptr_t)block - (uintptr_t)fallback->data < (uintptr_t)fallback->capacity;
+}
+
+static inline bool ctd_fallback_context_resize_tail(ctd_fallback_context* fallback, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ctd_scrub_function scrub)
+{
+    const ptrdiff_t difference = new_size - old_size;
+
+    if (fallback->data + fallback->length - old_size != source)
+    {
+        return false;
+    }
+    // The buffer is never filled up to its last byte, so that every block in it starts inside of it
+    if (difference >= fallback->capacity - fallback->length)
+    {
+        return false;
+    }
+    if (difference < 0)
+    {
+        scrub(fallback->data + fallback->length + difference, -difference);
+    }
+    fallback->length += difference;
+
+    return true;
+}
+
+static void* ctd_fallback_allocator_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ctd_fallback_context* fallback = context;
+
+    const ptrdiff_t padding = -(uintptr_t)(fallback->data + fallback->length) & (align-1);
+    const ptrdiff_t available_space = fallback->capacity - fallback->length - padding;
+    // Blocks that would end at the last byte of the buffer spill too, since a zero sized block there would start
+    // outside of the buffer and look like it belongs to the parent allocator
+    if (size >= available_space)
+    {
+        ctd_allocator* allocator = fallback->allocator;
+        return allocator->allocate(allocator->context, size, align);
+    }
+    void* ptr = fallback->data + fallback->length + padding;
+    fallback->length += padding + size;
+    return ptr;
+}
+
+static inline void ctd_fallback_allocator_deallocate_with_scrub(void* context, void* block, const ptrdiff_t size, const ctd_scrub_function scrub)
+{
+    ctd_fallback_context* fallback = context;
+    if (!ctd_fallback_context_owns(fallback, block))
+    {
+        ctd_allocator* allocator = fallback->allocator;
+        allocator->deallocate(allocator->context, block, size);
+        return;
+    }
+
+    scrub(block, size);
+    if ((char*)block == fallback->data + fallback->length - size)
+    {
+        fallback->length -= size;
+    }
+}
+
+static inline void* ctd_fallback_allocator_reallocate_with_scrub(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const ctd_scrub_function scrub)
+{
+    ctd_fallback_context* fallback = context;
+    if (!ctd_fallback_context_owns(fallback, source))
+    {
+        ctd_allocator* allocator = fallback->allocator;
+        return allocator->reallocate(allocator->context, source, old_size, new_size, align);
+    }
+
+    if (ctd_fallback_context_resize_tail(fallback, source, old_size, new_size, scrub))
+    {
+        return source;
+    }
+    if (new_size <= old_size)
+    {
+        scrub((char*)source + new_size, old_size - new_size);
+        return source;
+    }
+
+    // The block can't grow where it is, so it moves to the end of the buffer if it fits there, or to the parent
+    // allocator otherwise. Either way the destination doesn't overlap the source
+    void* destination = ctd_fallback_allocator_allocate(fallback, new_size, align);
+    if (destination == NULL)
+    {
+        return NULL;
+    }
+    memcpy(destination, source, old_size);
+    ctd_fallback_allocator_deallocate_with_scrub(fallback, source, old_size, scrub);
+
+    return destination;
+}
+
+/**
+ * Resizes a block without moving it. Blocks in the buffer follow the same rules as in an arena, and blocks in the
+ * parent allocator are resized by the parent allocator if it can.
+ */
+static bool ctd_fallback_allocator_try_resize(void* context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    ctd_fallback_context* fallback = context;
+    if (!ctd_fallback_context_owns(fallback, block))
+    {
+        return ctd_allocator_try_resize(fallback->allocator, block, old_size, new_size);
+    }
+
+    if (ctd_fallback_context_resize_tail(fallback, block, old_size, new_size, fallback->scrub))
+    {
+        return true;
+    }
+    if (new_size <= old_size)
+    {
+        fallback->scrub((char*)block + new_size, old_size - new_size);
+        return true;
+    }
+
+    return false;
+}
+
+ctd_scrub_specialize(ctd_fallback_allocator)
+
+ctd_fallback_allocator ctd_fallback_allocator_create(void* buffer, const ptrdiff_t size, ctd_allocator* allocator)
+{
+    return ctd_fallback_allocator_create_with_scrub_policy(buffer, size, CTD_SCRUB_ZERO, allocator);
+}
+
+ctd_fallback_allocator ctd_fallback_allocator_create_with_scrub_policy(void* buffer, const ptrdiff_t size, const ctd_scrub_policy scrub_policy, ctd_allocator* allocator)
+{
+    ctd_fallback_allocator fallback_allocator = {0};
+
+    const ptrdiff_t padding = -(uintptr_t)buffer & (alignof(ctd_fallback_context)-1);
+    if (buffer == NULL || size < 0 || size < padding + (ptrdiff_t)sizeof(ctd_fallback_context))
+    {
+        return fallback_allocator;
+    }
+
+    ctd_fallback_context* context = (ctd_fallback_context*)((char*)buffer + padding);
+    context->length = 0;
+    context->capacity = size - padding - sizeof(ctd_fallback_context);
+    context->data = (char*)(context + 1);
+    context->allocator = allocator;
+    context->scrub = ctd_scrub_functions[scrub_policy];
+
+    fallback_allocator.allocator = ctd_fallback_allocator_scrub_vtables[scrub_policy];
+    fallback_allocator.allocator.context = context;
+    fallback_allocator.allocator.try_resize = ctd_fallback_allocator_try_resize;
+
+    return fallback_allocator;
+}
+
+void ctd_fallback_allocator_destroy(ctd_fallback_allocator* self)
+{
+    *self = (ctd_fallback_allocator){0};
+}
+
+bool ctd_fallback_allocator_owns(ctd_fallback_allocator* self, const void* block)
+{
+    return ctd_fallback_context_owns(self->allocator.context, block);
+}
+
+ptrdiff_t ctd_fallback_allocator_used(ctd_fallback_allocator* self)
+{
+    ctd_fallback_context* fallback = self->allocator.context;
+    return fallback->length;
+}
@@ -0,0 +1,251 @@
+#include <ctd_multi_matcher.h>
+#include <limits.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+
+CTD_DYNAMIC_ARRAY_IMPL(ctd_multi_match, ctd_multi_match)
+
+/**
+ * The automaton of a multi matcher, in a single block. data holds the length of every pattern, then the pattern to
+ * report after every pattern, then the transition table.
+ *
+ * States are stored premultiplied by the width of a row, so that the next state is found with a single addition. The
+ * last column of every row holds the first pattern to report in its state, or -1, and every pattern links to the next
+ * one, which starts with the patterns that end in the state and carries on with those of its longest suffix that is
+ * also a state.
+ */
+typedef struct ctd_multi_matcher_tables
+{
+    uint16_t classes[UCHAR_MAX + 1];
+    int32_t data[];
+} ctd_multi_matcher_tables;
+
+static inline ptrdiff_t ctd_multi_matcher_tables_size(const ptrdiff_t pattern_count, const ptrdiff_t state_count, const ptrdiff_t row_width)
+{
+    return sizeof(ctd_multi_matcher_tables) + (2 * pattern_count + state_count * row_width) * sizeof(int32_t);
+}
+
+/**
+ * Turns the trie of the patterns into the automaton, by visiting its states in breadth first order. Every state's
+ * missing transitions are copied from its failure state, the longest proper suffix of it that is also a state, which is
+ * always shallower and so already complete.
+ *
+ * @param self Multi matcher whose table holds the trie.
+ * @param queue Room for every state, for the breadth first order.
+ * @param failures Room for every state, for the failure state of each.
+ */
+static void ctd_multi_matcher_link(ctd_multi_matcher* self, int32_t* queue, int32_t* failures)
+{
+    ctd_multi_matcher_tables* tables = self->tables;
+    int32_t* next_outputs = tables->data + self->pattern_count;
+    int32_t* transitions = next_outputs + self->pattern_count;
+    const ptrdiff_t row_width = self->class_count + 1;
+
+    ptrdiff_t head = 0, tail = 0;
+    for (ptrdiff_t c = 0; c < self->class_count; c++)
+    {
+        if (transitions[c] < 0)
+        {
+            transitions[c] = 0;
+        }
+        else
+        {
+            failures[transitions[c] / row_width] = 0;
+            queue[tail++] = transitions[c];
+        }
+    }
+
+    while (head < tail)
+    {
+        const int32_t state = queue[head++];
+        const int32_t failure = failures[state / row_width];
+
+        // Patterns that end in the state are reported before those that end in its failure state
+        int32_t* output = &transitions[state + self->class_count];
+        while (*output >= 0)
+        {
+            output = &next_outputs[*output];
+        }
+        *output = transitions[failure + self->class_count];
+
+        for (ptrdiff_t c = 0; c < self->class_count; c++)
+        {
+            const int32_t next = transitions[state + c];
+            if (next < 0)
+            {
+                transitions[state + c] = transitions[failure + c];
+            }
+            else
+            {
+                failures[next / row_width] = transitions[failure + c];
+                queue[tail++] = next;
+            }
+        }
+    }
+}
+
+ctd_multi_matcher ctd_multi_matcher_create(const ctd_string* patterns, const ptrdiff_t pattern_count, ctd_allocator* allocator, ctd_error* error)
+{
+    ctd_multi_matcher matcher = {.pattern_count = pattern_count, .allocator = allocator};
+    bool used[UCHAR_MAX + 1] = {0};
+    ptrdiff_t total_length = 0;
+    for (ptrdiff_t i = 0; i < pattern_count; i++)
+    {
+        if (patterns[i].length <= 0 || patterns[i].length > INT32_MAX - total_length)
+        {
+            error->error_type = INVALID_ARGUMENT;
+            error->error_message = "Patterns of ctd_multi_matcher must not be empty, and must fit in its table.";
+
+            return (ctd_multi_matcher) {0};
+        }
+        total_length += patterns[i].length;
+        for (ptrdiff_t j = 0; j < patterns[i].length; j++)
+        {
+            used[(unsigned char)patterns[i].data[j]] = true;
+        }
+    }
+
+    // Class 0 is every byte that isn't in any pattern
+    uint16_t classes[UCHAR_MAX + 1];
+    matcher.class_count = 1;
+    for (ptrdiff_t i = 0; i < countof(classes); i++)
+    {
+        classes[i] = used[i] ? matcher.class_count++ : 0;
+    }
+    const ptrdiff_t row_width = matcher.class_count + 1;
+    // The trie has a state for every byte of the patterns at most, plus the root
+    const ptrdiff_t max_state_count = total_length + 1;
+    if (pattern_count < 0 || pattern_count > INT32_MAX || max_state_count > INT32_MAX / row_width)
+    {
+        error->error_type = INVALID_ARGUMENT;
+        error->error_message = "Patterns of ctd_multi_matcher must not be empty, and must fit in its table.";
+
+        return (ctd_multi_matcher) {0};
+    }
+
+    matcher.tables_size = ctd_multi_matcher_tables_size(pattern_count, max_state_count, row_width);
+    ctd_multi_matcher_tables* tables = allocator->allocate(allocator->context, matcher.tables_size, alignof(ctd_multi_matcher_tables));
+    int32_t* queue = allocator->allocate(allocator->context, 2 * max_state_count * sizeof(int32_t), alignof(int32_t));
+    if (tables == NULL || queue == NULL)
+    {
+        if (tables != NULL)
+        {
+            allocator->deallocate(allocator->context, tables, matcher.tables_size);
+        }
+        if (queue != NULL)
+        {
+            allocator->deallocate(allocator->context, queue, 2 * max_state_count * sizeof(int32_t));
+        }
+        error->error_type = ALLOCATION_FAIL;
+        error->error_message = "Allocation of ctd_multi_matcher failed.";
+
+        return (ctd_multi_matcher) {0};
+    }
+    memcpy(tables->classes, classes, sizeof(classes));
+    int32_t* pattern_lengths = tables->data;
+    int32_t* next_outputs = pattern_lengths + pattern_count;
+    int32_t* transitions = next_outputs + pattern_count;
+    // Every byte of -1 is 0xFF
+    memset(transitions, 0xFF, max_state_count * row_width * sizeof(int32_t));
+
+    matcher.state_count = 1;
+    for (ptrdiff_t i = 0; i < pattern_count; i++)
+    {
+        int32_t state = 0;
+        for (ptrdiff_t j = 0; j < patterns[i].length; j++)
+        {
+            int32_t* next = &transitions[state + classes[(unsigned char)patterns[i].data[j]]];
+            if (*next < 0)
+            {
+                *next = (int32_t)(matcher.state_count++ * row_width);
+            }
+            state = *next;
+        }
+        pattern_lengths[i] = (int32_t)patterns[i].length;
+        next_outputs[i] = -1;
+        // Equal patterns are reported in the order they were given
+        int32_t* output = &transitions[state + matcher.class_count];
+        while (*output >= 0)
+        {
+            output = &next_outputs[*output];
+        }
+        *output = (int32_t)i;
+    }
+
+    matcher.tables = tables;
+    ctd_multi_matcher_link(&matcher, queue, queue + max_state_count);
+    allocator->deallocate(allocator->context, queue, 2 * max_state_count * sizeof(int32_t));
+
+    // Patterns that share prefixes leave rows at the end of the table unused
+    const ptrdiff_t tables_size = ctd_multi_matcher_tables_size(pattern_count, matcher.state_count, row_width);
+    if (tables_size < matcher.tables_size)
+    {
+        void* shrunk_tables = allocator->reallocate(allocator->context, tables, matcher.tables_size, tables_size, alignof(ctd_multi_matcher_tables));
+        if (shrunk_tables != NULL)
+        {
+            matcher.tables = shrunk_tables;
+            matcher.tables_size = tables_size;
+        }
+    }
+    return matcher;
+}
+
+void ctd_multi_matcher_destroy(ctd_multi_matcher* self)
+{
+    if (self->tables != NULL)
+    {
+        self->allocator->deallocate(self->allocator->context, self->tables, self->tables_size);
+    }
+
+    *self = (ctd_multi_matcher) {0};
+}
+
+ptrdiff_t ctd_multi_matcher_find_all(const ctd_multi_matcher* self, ctd_string str, ctd_multi_matcher_callback callback, void* user_data)
+{
+    const ctd_multi_matcher_tables* tables = self->tables;
+    if (tables == NULL)
+    {
+        return 0;
+    }
+    const int32_t* pattern_lengths = tables->data;
+    const int32_t* next_outputs = pattern_lengths + self->pattern_count;
+    const int32_t* transitions = next_outputs + self->pattern_count;
+    const ptrdiff_t output_column = self->class_count;
+
+    ptrdiff_t count = 0;
+    int32_t state = 0;
+    for (ptrdiff_t i = 0; i < str.length; i++)
+    {
+        state = transitions[state + tables->classes[(unsigned char)str.data[i]]];
+        for (int32_t pattern = transitions[state + output_column]; pattern >= 0; pattern = next_outputs[pattern])
+        {
+            count++;
+            if (callback != NULL && !callback(user_data, pattern, i - pattern_lengths[pattern] + 1))
+            {
+                return count;
+            }
+        }
+    }
+    return count;
+}
+
+typedef struct ctd_multi_matcher_array_context
+{
+    ctd_dynamic_array_ctd_multi_match* matches;
+    ctd_error* error;
+} ctd_multi_matcher_array_context;
+
+static bool ctd_multi_matcher_append(void* user_data, const ptrdiff_t pattern_id, const ptrdiff_t offset)
+{
+    ctd_multi_matcher_array_context* context = user_data;
+    const ctd_multi_match match = {.pattern_id = pattern_id, .offset = offset};
+    ctd_dynamic_array_ctd_multi_match_append(context->matches, match, context->error);
+    return context->error->error_type == NO_ERROR;
+}
+
+void ctd_multi_matcher_find_all_into(const ctd_multi_matcher* self, ctd_string str, ctd_dynamic_array_ctd_multi_match* matches, ctd_error* error)
+{
+    ctd_multi_matcher_array_context context = {.matches = matches, .error = error};
+    ctd_multi_matcher_find_all(self, str, ctd_multi_matcher_append, &context);
+}
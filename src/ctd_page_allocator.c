@@ -2,36 +2,314 @@
 #include <ctd_arena_allocator.h>
 #include <ctd_internal_dynamic_array.h>
 #include <stdalign.h>
+#include <stdbool.h>
 #include <ctd_define.h>
+#include <ctd_scrub.h>
+#include <stdint.h>
 #include <string.h>
 #include <ctd_error.h>
 
+#define CTD_LARGE_PAGE_INITIAL_CAPACITY 8
+
+typedef struct ctd_large_page
+{
+    // Block the page is dedicated to. Slots without a block are empty, and slots with a block but no page are tombstones
+    void* block;
+    ctd_arena_allocator page;
+    // How many large pages were created before this one, which save points are compared against
+    ptrdiff_t sequence;
+} ctd_large_page;
+
 typedef struct ctd_page_context
 {
+    // Pages for regular allocations. The last one is the current page, which allocations come from
     ctd_internal_dynamic_array(ctd_arena_allocator) arenas;
     ptrdiff_t default_page_size;
     ctd_allocator* allocator;
+    ptrdiff_t in_place_reallocations;
+    // Dedicated pages for allocations too big for a default page. They are kept in an open addressing table keyed on
+    // the block each page holds, so that freeing a block finds its page without going through every page
+    ctd_large_page* large_pages;
+    ptrdiff_t large_pages_capacity;
+    // Live pages and tombstones, which both lengthen probes
+    ptrdiff_t large_pages_used;
+    ptrdiff_t large_pages_live;
+    ptrdiff_t large_pages_created;
+    // Empty pages kept for reuse instead of being returned to the underlying allocator. Its capacity is fixed at creation
+    ctd_internal_dynamic_array(ctd_arena_allocator) free_pages;
+    ptrdiff_t pages_allocated;
+    // Every page is created with this policy, so that freeing memory through a page scrubs it the same way
+    ctd_scrub_policy scrub_policy;
 } ctd_page_context;
 
 /**
- * Adds a new arena to the end of a page allocator
+ * Takes the smallest cached page that can hold size bytes out of the free page cache. Among pages of the same size,
+ * the most recently cached one is taken.
+ *
+ * @param page_context Context of page allocator
+ * @param size Minimum capacity of the page in bytes
+ * @return The page if one was found, otherwise an empty object.
+ */
+static ctd_arena_allocator take_free_page(ctd_page_context* page_context, const ptrdiff_t size)
+{
+    ptrdiff_t best_index = -1;
+    ptrdiff_t best_capacity = 0;
+    for (ptrdiff_t i = page_context->free_pages.length - 1; i >= 0; i--)
+    {
+        const ptrdiff_t capacity = ctd_arena_allocator_capacity(&page_context->free_pages.data[i]);
+        if (capacity >= size && (best_index == -1 || capacity < best_capacity))
+        {
+            best_index = i;
+            best_capacity = capacity;
+        }
+    }
+    if (best_index == -1)
+    {
+        return (ctd_arena_allocator) {0};
+    }
+
+    ctd_arena_allocator page = page_context->free_pages.data[best_index];
+    page_context->free_pages.length--;
+    page_context->free_pages.data[best_index] = page_context->free_pages.data[page_context->free_pages.length];
+
+    return page;
+}
+
+/**
+ * Empties a page and puts it into the free page cache, or gives it back to the underlying allocator if the cache is
+ * full.
  *
  * @param page_context Context of page allocator
- * @param size Size of the new arena in bytes
+ * @param page Page to be released
+ */
+static void release_page(ctd_page_context* page_context, ctd_arena_allocator page)
+{
+    if (page_context->free_pages.length < page_context->free_pages.capacity)
+    {
+        ctd_arena_allocator_reset(&page);
+        page_context->free_pages.data[page_context->free_pages.length] = page;
+        page_context->free_pages.length++;
+
+        return;
+    }
+
+    ctd_arena_allocator_destroy(&page, page_context->allocator);
+}
+
+/**
+ * Gets a page that can hold at least size bytes, from the free page cache if possible, otherwise from the underlying
+ * allocator.
+ *
+ * @param page_context Context of page allocator
+ * @param size Minimum capacity of the page in bytes
  * @param error Pointer to error struct
+ * @return The page if successful, otherwise an empty object.
  */
-static void add_new_arena(ctd_page_context* page_context, const ptrdiff_t size, ctd_error* error)
+static ctd_arena_allocator get_page(ctd_page_context* page_context, const ptrdiff_t size, ctd_error* error)
 {
-    const ptrdiff_t new_arena_size = ctd_max(size, page_context->default_page_size);
-    ctd_arena_allocator new_arena = ctd_arena_allocator_create(new_arena_size, page_context->allocator);
-    // We shouldn't deallocate the arena list's data because that could have catastrophic consequences to the user
-    if (new_arena.allocator.context == NULL)
+    ctd_arena_allocator page = take_free_page(page_context, size);
+    if (page.allocator.context != NULL)
+    {
+        return page;
+    }
+
+    page = ctd_arena_allocator_create_with_scrub_policy(size, page_context->scrub_policy, page_context->allocator);
+    if (page.allocator.context == NULL)
     {
         error->error_type = ALLOCATION_FAIL;
         error->error_message = "Failed to allocate new arena";
+
+        return page;
+    }
+    page_context->pages_allocated++;
+
+    return page;
+}
+
+/**
+ * Adds a new arena to the end of a page allocator, making it the current page
+ *
+ * @param page_context Context of page allocator
+ * @param error Pointer to error struct
+ */
+static void add_new_arena(ctd_page_context* page_context, ctd_error* error)
+{
+    ctd_arena_allocator new_arena = get_page(page_context, page_context->default_page_size, error);
+    // We shouldn't deallocate the arena list's data because that could have catastrophic consequences to the user
+    if (error->error_type != NO_ERROR)
+    {
+        return;
     }
 
     ctd_internal_dynamic_array_append_with_allocator(page_context->arenas, ctd_arena_allocator, new_arena, *page_context->allocator, error);
+    if (error->error_type != NO_ERROR)
+    {
+        ctd_arena_allocator_destroy(&new_arena, page_context->allocator);
+    }
+}
+
+static inline ptrdiff_t large_page_slot(const ctd_page_context* page_context, const void* block)
+{
+    return (ptrdiff_t)(((uint64_t)(uintptr_t)block * 0x9E3779B97F4A7C15u) >> 32) & (page_context->large_pages_capacity - 1);
+}
+
+/**
+ * Finds the dedicated large page a block has to itself.
+ *
+ * @param page_context Context of page allocator
+ * @param block Pointer to the block
+ * @return The page's slot, or NULL if the block doesn't have a page to itself.
+ */
+static ctd_large_page* find_large_page(ctd_page_context* page_context, const void* block)
+{
+    if (page_context->large_pages_live == 0)
+    {
+        return NULL;
+    }
+
+    for (ptrdiff_t slot = large_page_slot(page_context, block);; slot = (slot + 1) & (page_context->large_pages_capacity - 1))
+    {
+        ctd_large_page* large_page = &page_context->large_pages[slot];
+        if (large_page->block == block && large_page->page.allocator.context != NULL)
+        {
+            return large_page;
+        }
+        if (large_page->block == NULL)
+        {
+            return NULL;
+        }
+    }
+}
+
+/**
+ * Puts a large page into the first empty slot or tombstone along its block's probe sequence. There must be room for it.
+ */
+static void place_large_page(ctd_page_context* page_context, const ctd_large_page large_page)
+{
+    ptrdiff_t slot = large_page_slot(page_context, large_page.block);
+    while (page_context->large_pages[slot].block != NULL && page_context->large_pages[slot].page.allocator.context != NULL)
+    {
+        slot = (slot + 1) & (page_context->large_pages_capacity - 1);
+    }
+    if (page_context->large_pages[slot].block == NULL)
+    {
+        page_context->large_pages_used++;
+    }
+    page_context->large_pages[slot] = large_page;
+    page_context->large_pages_live++;
+}
+
+/**
+ * Rebuilds the large page table, doubling it if it is filling up with live pages, and otherwise only clearing out its
+ * tombstones.
+ *
+ * @param page_context Context of page allocator
+ * @return Whether the table could be allocated. If not, the old table is left as it was.
+ */
+static bool grow_large_pages(ctd_page_context* page_context)
+{
+    ctd_allocator* allocator = page_context->allocator;
+    ctd_large_page* old_pages = page_context->large_pages;
+    const ptrdiff_t old_capacity = page_context->large_pages_capacity;
+    ptrdiff_t new_capacity = CTD_LARGE_PAGE_INITIAL_CAPACITY;
+    if (old_capacity != 0)
+    {
+        new_capacity = page_context->large_pages_live * 4 > old_capacity ? old_capacity * 2 : old_capacity;
+    }
+
+    ctd_large_page* new_pages = allocator->allocate(allocator->context, new_capacity * sizeof(ctd_large_page), alignof(ctd_large_page));
+    if (new_pages == NULL) return false;
+    memset(new_pages, 0, new_capacity * sizeof(ctd_large_page));
+
+    page_context->large_pages = new_pages;
+    page_context->large_pages_capacity = new_capacity;
+    page_context->large_pages_used = 0;
+    page_context->large_pages_live = 0;
+    for (ptrdiff_t i = 0; i < old_capacity; i++)
+    {
+        if (old_pages[i].page.allocator.context != NULL)
+        {
+            place_large_page(page_context, old_pages[i]);
+        }
+    }
+    if (old_pages != NULL)
+    {
+        allocator->deallocate(allocator->context, old_pages, old_capacity * sizeof(ctd_large_page));
+    }
+
+    return true;
+}
+
+/**
+ * Releases a dedicated large page into the free page cache, and leaves a tombstone in its slot.
+ */
+static void remove_large_page(ctd_page_context* page_context, ctd_large_page* large_page)
+{
+    release_page(page_context, large_page->page);
+    large_page->page = (ctd_arena_allocator) {0};
+    page_context->large_pages_live--;
+}
+
+/**
+ * Allocates memory from a dedicated page that is sized to fit it, leaving the current page untouched.
+ *
+ * @param page_context Context of page allocator
+ * @param size Size of memory to be allocated in bytes
+ * @param align Alignment of memory to be allocated
+ * @return Pointer to allocated memory if allocation is successful, otherwise returns NULL.
+ */
+static void* allocate_large(ctd_page_context* page_context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ctd_error error = {0};
+    if ((page_context->large_pages_used + 1) * 2 > page_context->large_pages_capacity && !grow_large_pages(page_context))
+    {
+        return NULL;
+    }
+    ctd_arena_allocator large_arena = get_page(page_context, size + align - 1, &error);
+    if (error.error_type != NO_ERROR) return NULL;
+
+    void* block = large_arena.allocator.allocate(large_arena.allocator.context, size, align);
+    place_large_page(page_context, (ctd_large_page) {.block = block, .page = large_arena, .sequence = page_context->large_pages_created});
+    page_context->large_pages_created++;
+
+    return block;
+}
+
+/**
+ * Grows or shrinks a block in place if it has a dedicated large page to itself. Any block can have one, since small
+ * blocks do too when they are heavily over-aligned.
+ *
+ * @param page_context Context of page allocator
+ * @param block Pointer to the block to be resized
+ * @param old_size Current size of the block
+ * @param new_size Size the block should be resized to
+ * @return Whether the block was resized.
+ */
+static bool resize_large_page(ctd_page_context* page_context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    ctd_large_page* large_page = find_large_page(page_context, block);
+    return large_page != NULL && ctd_arena_allocator_resize_tail(&large_page->page, block, old_size, new_size);
+}
+
+/**
+ * If block is the only allocation in a dedicated large page, releases that page.
+ *
+ * @param page_context Context of page allocator
+ * @param block Pointer to the memory being freed
+ * @param size Size of the memory being freed
+ * @return Whether a page was released.
+ */
+static bool release_large_page(ctd_page_context* page_context, void* block, const ptrdiff_t size)
+{
+    ctd_large_page* large_page = find_large_page(page_context, block);
+    // Shrinking the block to nothing scrubs it, and makes sure it was freed with the size it has
+    if (large_page == NULL || !ctd_arena_allocator_resize_tail(&large_page->page, block, size, 0))
+    {
+        return false;
+    }
+    remove_large_page(page_context, large_page);
+
+    return true;
 }
 
 /**
@@ -46,64 +324,241 @@ static void* ctd_page_allocator_allocate(void* context, const ptrdiff_t size, co
 {
     ctd_error error = {0};
     ctd_page_context* page_context = context;
-    ctd_allocator current_arena = page_context->arenas.data[page_context->arenas.length - 1].allocator;
 
+    // Allocations that wouldn't fit in an empty default page get their own page, so the current page isn't abandoned
+    if (size + align - 1 > page_context->default_page_size)
+    {
+        return allocate_large(page_context, size, align);
+    }
+
+    ctd_allocator current_arena = page_context->arenas.data[page_context->arenas.length - 1].allocator;
     void* data = current_arena.allocate(current_arena.context, size, align);
     if (data != NULL) return data;
 
     // Otherwise, the arena is full, and we need to make a new one
-    add_new_arena(page_context, size, &error);
+    add_new_arena(page_context, &error);
     if (error.error_type != NO_ERROR) return NULL;
 
     ctd_allocator new_arena = page_context->arenas.data[page_context->arenas.length - 1].allocator;
     return new_arena.allocate(new_arena.context, size, align);
 }
 
+/**
+ * Allocates memory from a page allocator, and reports how much of it can be used. A block with a dedicated large page
+ * to itself is handed the rest of that page, which can be much more than was asked for when the page came from the free
+ * page cache.
+ *
+ * @param context Context of page allocator
+ * @param size Size of memory to be allocated in bytes
+ * @param align Alignment of memory to be allocated
+ * @param usable_size Set to the size of the allocated memory if allocation is successful
+ * @return Pointer to allocated memory if allocation is successful, otherwise returns NULL.
+ */
+static void* ctd_page_allocator_allocate_sized(void* context, const ptrdiff_t size, const ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    ctd_page_context* page_context = context;
+    void* data = ctd_page_allocator_allocate(context, size, align);
+    if (data == NULL) return NULL;
+
+    *usable_size = size;
+    if (size + align - 1 > page_context->default_page_size)
+    {
+        ctd_arena_allocator* large_arena = &find_large_page(page_context, data)->page;
+        const ptrdiff_t page_tail = ctd_arena_allocator_capacity(large_arena) - ctd_arena_allocator_used(large_arena);
+        if (ctd_arena_allocator_resize_tail(large_arena, data, size, size + page_tail))
+        {
+            *usable_size = size + page_tail;
+        }
+    }
+
+    return data;
+}
+
 /**
  * Reallocates a region of memory.
- * Note - since it is undefined behavior to compare pointers not in the same region of memory, and the page allocator
- * operates with a bunch of distinct memory regions, reallocation will never resize a region of memory in-place - it
- * will always allocate a new chunk of memory. However, reallocation will copy the old data into the new chunk of
- * memory.
+ * If the region is the most recent allocation in the current arena, or has a dedicated large page to itself, and
+ * there's room for it to grow, it is resized in place, and regions are always shrunk in place. Otherwise, a new chunk of memory is allocated and the old data is
+ * copied into it. Only equality comparisons are made against the region's pointer, since ordering pointers from
+ * distinct arenas is undefined behavior.
  *
  * @param context Page allocator's context
  * @param source Pointer to the memory to be reallocated
  * @param old_size The size of the memory to be reallocated
  * @param new_size The size the memory will be reallocated to
  * @param align The alignment of the region of memory
+ * @param scrub Scrub function of the page allocator's scrub policy
  * @return Pointer to the reallocated memory if reallocation succeeds, otherwise returns NULL pointer.
  */
-static void* ctd_page_allocator_reallocate(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align)
+static inline void* ctd_page_allocator_reallocate_with_scrub(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const ctd_scrub_function scrub)
 {
+    ctd_page_context* page_context = context;
+    if (ctd_arena_allocator_resize_tail(&page_context->arenas.data[page_context->arenas.length - 1], source, old_size, new_size))
+    {
+        page_context->in_place_reallocations++;
+        return source;
+    }
+    // Large pages are resized through their own arena, so that deallocating the block at its new size releases the page
+    if (resize_large_page(page_context, source, old_size, new_size))
+    {
+        page_context->in_place_reallocations++;
+        return source;
+    }
+    if (new_size <= old_size)
+    {
+        scrub((char*)source + new_size, old_size - new_size);
+        page_context->in_place_reallocations++;
+        return source;
+    }
+
     void* new_data = ctd_page_allocator_allocate(context, new_size, align);
     if (new_data == NULL) return NULL;
 
     memcpy(new_data, source, old_size);
+    release_large_page(page_context, source, old_size);
 
     return new_data;
 }
 
 /**
  * Deallocates a region of memory.
- * Note - it is too expensive to individually go through each arena and run the deallocate function, since each
- * arena.deallocate call sets the memory to zero, so this function doesn't try and deallocate the memory - it simply
- * sets the memory to zero.
+ * Note - it is too expensive to individually go through each arena and run the deallocate function, so this function
+ * doesn't try and deallocate the memory - it simply scrubs it. The exception is memory that has a dedicated large page
+ * to itself, which is looked up by its address, and whose page is released into the free page cache.
  * TODO add flag to allow this to occur.
  *
  * @param context Page allocator's context
  * @param block Pointer to memory to be deallocated
  * @param size Size of memory to be deallocated
+ * @param scrub Scrub function of the page allocator's scrub policy
+ */
+static inline void ctd_page_allocator_deallocate_with_scrub(void* context, void* block, ptrdiff_t size, const ctd_scrub_function scrub)
+{
+    if (release_large_page(context, block, size))
+    {
+        return;
+    }
+    scrub(block, size);
+}
+
+/**
+ * Resizes a block without moving it. Blocks can always be shrunk in place, and the most recent allocation of the
+ * current page, or a block with a dedicated large page to itself, can grow into the rest of its page.
+ *
+ * @param context Page allocator's context
+ * @param block Pointer to the block to be resized
+ * @param old_size Current size of the block
+ * @param new_size Size the block should be resized to
+ * @return Whether the block was resized.
  */
-static void ctd_page_allocator_deallocate(void* context, void* block, ptrdiff_t size)
+static bool ctd_page_allocator_try_resize(void* context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
 {
-    memset(block, 0, size);
+    ctd_page_context* page_context = context;
+    if (ctd_arena_allocator_resize_tail(&page_context->arenas.data[page_context->arenas.length - 1], block, old_size, new_size))
+    {
+        return true;
+    }
+    if (resize_large_page(page_context, block, old_size, new_size))
+    {
+        return true;
+    }
+    if (new_size <= old_size)
+    {
+        ctd_scrub_functions[page_context->scrub_policy]((char*)block + new_size, old_size - new_size);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Deallocates a batch of blocks.
+ *
+ * @param context Page allocator's context
+ * @param count Number of blocks to be deallocated
+ * @param size Size of each block
+ * @param blocks Pointers to the blocks
+ */
+static void ctd_page_allocator_deallocate_batch(void* context, const ptrdiff_t count, const ptrdiff_t size, void** blocks)
+{
+    const ctd_scrub_function scrub = ctd_scrub_functions[((ctd_page_context*)context)->scrub_policy];
+    for (ptrdiff_t i = count - 1; i >= 0; i--)
+    {
+        ctd_page_allocator_deallocate_with_scrub(context, blocks[i], size, scrub);
+    }
+}
+
+/**
+ * Allocates a batch of blocks. The current page hands out as much of the batch as it can with a single bump, and
+ * the rest comes from new pages. Blocks too big for a default page each get their own page instead.
+ *
+ * @param context Page allocator's context
+ * @param count Number of blocks to be allocated
+ * @param size Size of each block
+ * @param align Alignment of each block
+ * @param blocks Filled with pointers to the blocks
+ * @return Whether every block was allocated. If not, the blocks that were are deallocated again.
+ */
+static bool ctd_page_allocator_allocate_batch(void* context, const ptrdiff_t count, const ptrdiff_t size, const ptrdiff_t align, void** blocks)
+{
+    ctd_page_context* page_context = context;
+    ctd_error error = {0};
+    ptrdiff_t allocated = 0;
+    if (size + align - 1 > page_context->default_page_size)
+    {
+        for (; allocated < count; allocated++)
+        {
+            blocks[allocated] = allocate_large(page_context, size, align);
+            if (blocks[allocated] == NULL) goto fail;
+        }
+        return true;
+    }
+
+    // Halving the number of blocks until they fit takes a few tries per page, rather than one per block
+    ptrdiff_t batch_count = count;
+    while (allocated < count)
+    {
+        ctd_arena_allocator* current_arena = &page_context->arenas.data[page_context->arenas.length - 1];
+        if (ctd_allocator_allocate_batch(&current_arena->allocator, batch_count, size, align, blocks + allocated))
+        {
+            allocated += batch_count;
+            batch_count = count - allocated;
+        }
+        else if (batch_count > 1)
+        {
+            batch_count /= 2;
+        }
+        else
+        {
+            add_new_arena(page_context, &error);
+            if (error.error_type != NO_ERROR) goto fail;
+            batch_count = count - allocated;
+        }
+    }
+    return true;
+
+fail:
+    ctd_page_allocator_deallocate_batch(context, allocated, size, blocks);
+    return false;
 }
 
+ctd_scrub_specialize(ctd_page_allocator)
+
 ctd_page_allocator ctd_page_allocator_create(ptrdiff_t default_page_size, ctd_allocator* allocator)
+{
+    return ctd_page_allocator_create_with_page_cache(default_page_size, CTD_PAGE_ALLOCATOR_DEFAULT_CACHED_PAGES, allocator);
+}
+
+ctd_page_allocator ctd_page_allocator_create_with_page_cache(ptrdiff_t default_page_size, ptrdiff_t max_cached_pages, ctd_allocator* allocator)
+{
+    return ctd_page_allocator_create_with_options(default_page_size, max_cached_pages, CTD_SCRUB_ZERO, allocator);
+}
+
+ctd_page_allocator ctd_page_allocator_create_with_options(ptrdiff_t default_page_size, ptrdiff_t max_cached_pages, ctd_scrub_policy scrub_policy, ctd_allocator* allocator)
 {
     ctd_page_allocator page_allocator = {0};
     ctd_page_context* context = allocator->allocate(allocator->context, sizeof(ctd_page_context), alignof(ctd_page_context));
     if (context == NULL) goto context_alloc_failed_cleanup;
+    *context = (ctd_page_context) {0};
 
     context->arenas.data = allocator->allocate(allocator->context, sizeof(ctd_arena_allocator), alignof(ctd_arena_allocator));
     if (context->arenas.data == NULL) goto arena_array_alloc_failed_cleanup;
@@ -111,18 +566,37 @@ ctd_page_allocator ctd_page_allocator_create(ptrdiff_t default_page_size, ctd_al
     context->allocator = allocator;
     context->arenas.length = 1;
     context->arenas.capacity = 1;
+    context->arenas.allocated_size = sizeof(ctd_arena_allocator);
+    context->in_place_reallocations = 0;
+    context->scrub_policy = scrub_policy;
+
+    if (max_cached_pages > 0)
+    {
+        context->free_pages.data = allocator->allocate(allocator->context, max_cached_pages * sizeof(ctd_arena_allocator), alignof(ctd_arena_allocator));
+        if (context->free_pages.data == NULL) goto free_page_array_alloc_failed_cleanup;
+        context->free_pages.capacity = max_cached_pages;
+        context->free_pages.allocated_size = max_cached_pages * sizeof(ctd_arena_allocator);
+    }
 
-    context->arenas.data[0] = ctd_arena_allocator_create(default_page_size, allocator);
+    context->arenas.data[0] = ctd_arena_allocator_create_with_scrub_policy(default_page_size, scrub_policy, allocator);
     if (context->arenas.data[0].allocator.context == NULL) goto individual_arena_alloc_failed_cleanup;
+    context->pages_allocated = 1;
 
-    page_allocator.allocator.allocate = ctd_page_allocator_allocate;
-    page_allocator.allocator.reallocate = ctd_page_allocator_reallocate;
-    page_allocator.allocator.deallocate = ctd_page_allocator_deallocate;
+    page_allocator.allocator = ctd_page_allocator_scrub_vtables[scrub_policy];
     page_allocator.allocator.context = context;
+    page_allocator.allocator.try_resize = ctd_page_allocator_try_resize;
+    page_allocator.allocator.allocate_sized = ctd_page_allocator_allocate_sized;
+    page_allocator.allocator.allocate_batch = ctd_page_allocator_allocate_batch;
+    page_allocator.allocator.deallocate_batch = ctd_page_allocator_deallocate_batch;
 
     return page_allocator;
 
 individual_arena_alloc_failed_cleanup:
+    if (context->free_pages.data != NULL)
+    {
+        allocator->deallocate(allocator->context, context->free_pages.data, max_cached_pages * sizeof(ctd_arena_allocator));
+    }
+free_page_array_alloc_failed_cleanup:
     allocator->deallocate(allocator->context, context->arenas.data, sizeof(ctd_arena_allocator));
 arena_array_alloc_failed_cleanup:
     allocator->deallocate(allocator->context, context, sizeof(ctd_page_context));
@@ -141,8 +615,111 @@ void ctd_page_allocator_destroy(ctd_page_allocator* self)
         current_arena = context->arenas.data[i];
         ctd_arena_allocator_destroy(&current_arena, underlying_allocator);
     }
-    underlying_allocator->deallocate(underlying_allocator->context, context->arenas.data, context->arenas.capacity * sizeof(ctd_arena_allocator));
+    for (ptrdiff_t i = context->large_pages_capacity - 1; i >= 0; i--)
+    {
+        current_arena = context->large_pages[i].page;
+        if (current_arena.allocator.context != NULL)
+        {
+            ctd_arena_allocator_destroy(&current_arena, underlying_allocator);
+        }
+    }
+    for (ptrdiff_t i = context->free_pages.length - 1; i >= 0; i--)
+    {
+        current_arena = context->free_pages.data[i];
+        ctd_arena_allocator_destroy(&current_arena, underlying_allocator);
+    }
+    underlying_allocator->deallocate(underlying_allocator->context, context->arenas.data, context->arenas.allocated_size);
+    if (context->large_pages != NULL)
+    {
+        underlying_allocator->deallocate(underlying_allocator->context, context->large_pages, context->large_pages_capacity * sizeof(ctd_large_page));
+    }
+    if (context->free_pages.data != NULL)
+    {
+        underlying_allocator->deallocate(underlying_allocator->context, context->free_pages.data, context->free_pages.allocated_size);
+    }
     underlying_allocator->deallocate(underlying_allocator->context, context, sizeof(ctd_page_context));
 
     *self = (ctd_page_allocator) {0};
 }
+
+ctd_arena_save_point ctd_page_allocator_mark(ctd_page_allocator* self)
+{
+    ctd_page_context* context = self->allocator.context;
+    const ptrdiff_t current_arena = context->arenas.length - 1;
+    ctd_arena_save_point save_point = ctd_arena_allocator_mark(&context->arenas.data[current_arena]);
+    save_point.page = current_arena;
+    save_point.large_pages = context->large_pages_created;
+
+    return save_point;
+}
+
+void ctd_page_allocator_rewind(ctd_page_allocator* self, ctd_arena_save_point save_point)
+{
+    ctd_page_context* context = self->allocator.context;
+    if (save_point.page >= context->arenas.length || save_point.large_pages > context->large_pages_created)
+    {
+        return;
+    }
+
+    // Pages created after the save point are released, even if they took the slot of an older page
+    for (ptrdiff_t i = context->large_pages_capacity - 1; i >= 0 && context->large_pages_live > 0; i--)
+    {
+        ctd_large_page* large_page = &context->large_pages[i];
+        if (large_page->page.allocator.context != NULL && large_page->sequence >= save_point.large_pages)
+        {
+            remove_large_page(context, large_page);
+        }
+    }
+
+    for (ptrdiff_t i = context->arenas.length - 1; i > save_point.page; i--)
+    {
+        release_page(context, context->arenas.data[i]);
+    }
+    context->arenas.length = save_point.page + 1;
+    ctd_arena_allocator_rewind(&context->arenas.data[save_point.page], save_point);
+}
+
+void ctd_page_allocator_reset(ctd_page_allocator* self)
+{
+    ctd_page_allocator_rewind(self, (ctd_arena_save_point){.page = 0, .length = 0, .large_pages = 0});
+}
+
+ptrdiff_t ctd_page_allocator_in_place_reallocations(ctd_page_allocator* self)
+{
+    ctd_page_context* context = self->allocator.context;
+    return context->in_place_reallocations;
+}
+
+ctd_page_allocator_stats ctd_page_allocator_get_stats(ctd_page_allocator* self)
+{
+    ctd_page_context* context = self->allocator.context;
+    ctd_page_allocator_stats stats = {0};
+    stats.pages_allocated = context->pages_allocated;
+    stats.cached_pages = context->free_pages.length;
+    for (ptrdiff_t i = 0; i < context->arenas.length; i++)
+    {
+        ctd_arena_allocator* arena = &context->arenas.data[i];
+        stats.used_bytes += ctd_arena_allocator_used(arena);
+        stats.capacity_bytes += ctd_arena_allocator_capacity(arena);
+        if (i < context->arenas.length - 1)
+        {
+            stats.stranded_bytes += ctd_arena_allocator_capacity(arena) - ctd_arena_allocator_used(arena);
+        }
+    }
+    for (ptrdiff_t i = 0; i < context->large_pages_capacity; i++)
+    {
+        ctd_arena_allocator* large_arena = &context->large_pages[i].page;
+        if (large_arena->allocator.context != NULL)
+        {
+            stats.large_pages++;
+            stats.used_bytes += ctd_arena_allocator_used(large_arena);
+            stats.capacity_bytes += ctd_arena_allocator_capacity(large_arena);
+        }
+    }
+    for (ptrdiff_t i = 0; i < context->free_pages.length; i++)
+    {
+        stats.cached_bytes += ctd_arena_allocator_capacity(&context->free_pages.data[i]);
+    }
+
+    return stats;
+}
@@ -0,0 +1,213 @@
+#if defined(__linux__)
+// For mremap
+#define _GNU_SOURCE
+#endif
+#include <ctd_routing_allocator.h>
+#include <ctd_define.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * The routes are kept in two arrays so that finding one only reads max_sizes. The last route is always the mmap
+ * allocator, with a max_size of PTRDIFF_MAX so that every search ends.
+ */
+typedef struct ctd_routing_context
+{
+    ptrdiff_t max_sizes[CTD_ROUTING_MAX_TIERS + 1];
+    ctd_allocator* tiers[CTD_ROUTING_MAX_TIERS + 1];
+    ctd_allocator* allocator;
+} ctd_routing_context;
+
+static inline ptrdiff_t ctd_mmap_size(const ptrdiff_t size)
+{
+    const ptrdiff_t page_size = sysconf(_SC_PAGESIZE);
+    return ctd_max((size + page_size - 1) & ~(page_size - 1), page_size);
+}
+
+static void* ctd_mmap_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    (void)context;
+    if (align > sysconf(_SC_PAGESIZE))
+    {
+        return NULL;
+    }
+    void* block = mmap(NULL, ctd_mmap_size(size), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return block == MAP_FAILED ? NULL : block;
+}
+
+static void ctd_mmap_deallocate(void* context, void* block, const ptrdiff_t size)
+{
+    (void)context;
+    munmap(block, ctd_mmap_size(size));
+}
+
+static bool ctd_mmap_try_resize(void* context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    (void)context;
+    const ptrdiff_t old_mapped_size = ctd_mmap_size(old_size);
+    const ptrdiff_t new_mapped_size = ctd_mmap_size(new_size);
+    if (new_mapped_size == old_mapped_size)
+    {
+        return true;
+    }
+    if (new_mapped_size < old_mapped_size)
+    {
+        return munmap((char*)block + new_mapped_size, old_mapped_size - new_mapped_size) == 0;
+    }
+#if defined(__linux__)
+    return mremap(block, old_mapped_size, new_mapped_size, 0) != MAP_FAILED;
+#else
+    return false;
+#endif
+}
+
+static void* ctd_mmap_reallocate(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align)
+{
+    (void)align;
+    if (ctd_mmap_try_resize(context, source, old_size, new_size))
+    {
+        return source;
+    }
+#if defined(__linux__)
+    // The kernel moves the pages instead of copying them
+    void* destination = mremap(source, ctd_mmap_size(old_size), ctd_mmap_size(new_size), MREMAP_MAYMOVE);
+    return destination == MAP_FAILED ? NULL : destination;
+#else
+    void* destination = ctd_mmap_allocate(context, new_size, align);
+    if (destination == NULL)
+    {
+        return NULL;
+    }
+    memcpy(destination, source, ctd_min(old_size, new_size));
+    ctd_mmap_deallocate(context, source, old_size);
+    return destination;
+#endif
+}
+
+// Huge blocks are page aligned no matter what align is, so it only needs to be checked when mapping a new block
+static ctd_allocator ctd_mmap_allocator = {
+    .allocate = ctd_mmap_allocate,
+    .reallocate = ctd_mmap_reallocate,
+    .deallocate = ctd_mmap_deallocate,
+    .try_resize = ctd_mmap_try_resize,
+};
+
+static inline ctd_allocator* ctd_routing_route(const ctd_routing_context* routing, const ptrdiff_t size)
+{
+    ptrdiff_t i = 0;
+    while (size > routing->max_sizes[i])
+    {
+        i++;
+    }
+    return routing->tiers[i];
+}
+
+static void* ctd_routing_allocator_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ctd_allocator* tier = ctd_routing_route(context, size);
+    return tier->allocate(tier->context, size, align);
+}
+
+static void* ctd_routing_allocator_reallocate(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align)
+{
+    ctd_allocator* old_tier = ctd_routing_route(context, old_size);
+    ctd_allocator* new_tier = ctd_routing_route(context, new_size);
+    if (old_tier == new_tier)
+    {
+        return old_tier->reallocate(old_tier->context, source, old_size, new_size, align);
+    }
+
+    void* destination = new_tier->allocate(new_tier->context, new_size, align);
+    if (destination == NULL)
+    {
+        return NULL;
+    }
+    memcpy(destination, source, ctd_min(old_size, new_size));
+    old_tier->deallocate(old_tier->context, source, old_size);
+    return destination;
+}
+
+static void ctd_routing_allocator_deallocate(void* context, void* block, const ptrdiff_t size)
+{
+    ctd_allocator* tier = ctd_routing_route(context, size);
+    tier->deallocate(tier->context, block, size);
+}
+
+/**
+ * Resizes a block without moving it, which is only possible if the new size belongs to the same tier as the old one.
+ */
+static bool ctd_routing_allocator_try_resize(void* context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    ctd_allocator* tier = ctd_routing_route(context, old_size);
+    if (tier != ctd_routing_route(context, new_size))
+    {
+        return false;
+    }
+    return ctd_allocator_try_resize(tier, block, old_size, new_size);
+}
+
+/**
+ * Every block of a batch has the same size, so the whole batch is routed once and handed to a single tier.
+ */
+static bool ctd_routing_allocator_allocate_batch(void* context, const ptrdiff_t count, const ptrdiff_t size, const ptrdiff_t align, void** blocks)
+{
+    return ctd_allocator_allocate_batch(ctd_routing_route(context, size), count, size, align, blocks);
+}
+
+static void ctd_routing_allocator_deallocate_batch(void* context, const ptrdiff_t count, const ptrdiff_t size, void** blocks)
+{
+    ctd_allocator_deallocate_batch(ctd_routing_route(context, size), count, size, blocks);
+}
+
+ctd_routing_allocator ctd_routing_allocator_create(const ctd_routing_tier* tiers, const ptrdiff_t tier_count, ctd_allocator* allocator)
+{
+    ctd_routing_allocator routing_allocator = {0};
+    if (tier_count < 0 || tier_count > CTD_ROUTING_MAX_TIERS)
+    {
+        return routing_allocator;
+    }
+    for (ptrdiff_t i = 0; i < tier_count; i++)
+    {
+        if (tiers[i].allocator == NULL || tiers[i].max_size < 0 || (i > 0 && tiers[i].max_size <= tiers[i - 1].max_size))
+        {
+            return routing_allocator;
+        }
+    }
+
+    ctd_routing_context* context = allocator->allocate(allocator->context, sizeof(ctd_routing_context), alignof(ctd_routing_context));
+    if (context == NULL)
+    {
+        return routing_allocator;
+    }
+    for (ptrdiff_t i = 0; i < tier_count; i++)
+    {
+        context->max_sizes[i] = tiers[i].max_size;
+        context->tiers[i] = tiers[i].allocator;
+    }
+    context->max_sizes[tier_count] = PTRDIFF_MAX;
+    context->tiers[tier_count] = &ctd_mmap_allocator;
+    context->allocator = allocator;
+
+    routing_allocator.allocator = (ctd_allocator){
+        .allocate = ctd_routing_allocator_allocate,
+        .reallocate = ctd_routing_allocator_reallocate,
+        .deallocate = ctd_routing_allocator_deallocate,
+        .context = context,
+        .try_resize = ctd_routing_allocator_try_resize,
+        .allocate_batch = ctd_routing_allocator_allocate_batch,
+        .deallocate_batch = ctd_routing_allocator_deallocate_batch,
+    };
+    return routing_allocator;
+}
+
+void ctd_routing_allocator_destroy(ctd_routing_allocator* self)
+{
+    ctd_routing_context* context = self->allocator.context;
+    ctd_allocator* allocator = context->allocator;
+    allocator->deallocate(allocator->context, context, sizeof(ctd_routing_context));
+
+    *self = (ctd_routing_allocator){0};
+}
@@ -0,0 +1,49 @@
+#include <ctd_scrub.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+const ctd_scrub_function ctd_scrub_functions[] = {
+    [CTD_SCRUB_ZERO] = ctd_scrub_zero,
+    [CTD_SCRUB_NONE] = ctd_scrub_none,
+    [CTD_SCRUB_POISON] = ctd_scrub_poison,
+    [CTD_SCRUB_RELEASE_PAGES] = ctd_scrub_release_pages,
+};
+
+/**
+ * Zeroes a region of memory, handing the whole pages inside it back to the operating system instead of writing to
+ * them if the region is large enough. The partial pages at either end are zeroed with memset, since the rest of those
+ * pages may still be in use.
+ *
+ * @param block Pointer to the region of memory
+ * @param size Size of the region of memory in bytes
+ */
+void ctd_scrub_release_pages(void* block, const ptrdiff_t size)
+{
+    if (size < CTD_SCRUB_RELEASE_PAGES_THRESHOLD)
+    {
+        memset(block, 0, size);
+        return;
+    }
+
+    const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    char* start = block;
+    char* end = start + size;
+    char* first_page = start + (-(uintptr_t)start & (page_size - 1));
+    char* last_page = end - ((uintptr_t)end & (page_size - 1));
+
+    // On systems with large pages, the region might not contain a whole page
+    if (first_page >= last_page)
+    {
+        memset(block, 0, size);
+        return;
+    }
+
+    memset(start, 0, first_page - start);
+    if (madvise(first_page, last_page - first_page, MADV_DONTNEED) != 0)
+    {
+        memset(first_page, 0, last_page - first_page);
+    }
+    memset(last_page, 0, end - last_page);
+}
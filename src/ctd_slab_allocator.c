@@ -0,0 +1,229 @@
+#include <ctd_slab_allocator.h>
+#include <ctd_internal_dynamic_array.h>
+#include <ctd_internal_size_classes.h>
+#include <ctd_define.h>
+#include <ctd_scrub.h>
+#include <ctd_error.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct ctd_slab_free_block
+{
+    struct ctd_slab_free_block* next;
+} ctd_slab_free_block;
+
+typedef struct ctd_slab_class
+{
+    ctd_slab_free_block* free_list;
+    char* bump;
+    char* bump_end;
+} ctd_slab_class;
+
+typedef struct ctd_slab
+{
+    char* data;
+    ptrdiff_t size;
+} ctd_slab;
+
+typedef struct ctd_slab_context
+{
+    ctd_slab_class classes[CTD_SIZE_CLASS_COUNT];
+    unsigned char class_lookup[CTD_SIZE_CLASS_LOOKUP_LENGTH];
+    ctd_internal_dynamic_array(ctd_slab) slabs;
+    ptrdiff_t slab_size;
+    ctd_allocator* allocator;
+} ctd_slab_context;
+
+static inline ptrdiff_t ctd_slab_class_index(const ctd_slab_context* slab_context, const ptrdiff_t size)
+{
+    return ctd_size_class_lookup(slab_context->class_lookup, size);
+}
+
+/**
+ * Takes a new slab from the parent allocator and makes it the bump region of a size class. Whatever was left of the
+ * previous bump region is abandoned, which is at most one block's worth of memory.
+ *
+ * @param slab_context Context of slab allocator
+ * @param class_index Size class the slab will be carved into
+ * @param error Pointer to error struct
+ */
+static void add_new_slab(ctd_slab_context* slab_context, const ptrdiff_t class_index, ctd_error* error)
+{
+    ctd_allocator* allocator = slab_context->allocator;
+    char* data = allocator->allocate(allocator->context, slab_context->slab_size, ctd_size_class_alignment(class_index));
+    if (data == NULL)
+    {
+        error->error_type = ALLOCATION_FAIL;
+        error->error_message = "Failed to allocate new slab";
+
+        return;
+    }
+
+    ctd_slab new_slab = {.data = data, .size = slab_context->slab_size};
+    ctd_internal_dynamic_array_append_with_allocator(slab_context->slabs, ctd_slab, new_slab, *allocator, error);
+    if (error->error_type != NO_ERROR)
+    {
+        allocator->deallocate(allocator->context, data, slab_context->slab_size);
+
+        return;
+    }
+
+    slab_context->classes[class_index].bump = data;
+    slab_context->classes[class_index].bump_end = data + slab_context->slab_size;
+}
+
+/**
+ * Allocates memory from a slab allocator
+ *
+ * @param context Context of slab allocator
+ * @param size Size of memory to be allocated in bytes
+ * @param align Alignment of memory to be allocated
+ * @return Pointer to allocated memory if allocation is successful, otherwise returns NULL.
+ */
+static void* ctd_slab_allocator_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ctd_slab_context* slab_context = context;
+    if (size > CTD_MAX_SIZE_CLASS)
+    {
+        return slab_context->allocator->allocate(slab_context->allocator->context, size, align);
+    }
+
+    const ptrdiff_t class_index = ctd_slab_class_index(slab_context, size);
+    if (ctd_size_class_alignment(class_index) % align != 0)
+    {
+        return NULL;
+    }
+
+    ctd_slab_class* slab_class = &slab_context->classes[class_index];
+    ctd_slab_free_block* block = slab_class->free_list;
+    if (block != NULL)
+    {
+        slab_class->free_list = block->next;
+        return block;
+    }
+
+    const ptrdiff_t class_size = ctd_size_classes[class_index];
+    if (slab_class->bump_end - slab_class->bump < class_size)
+    {
+        ctd_error error = {0};
+        add_new_slab(slab_context, class_index, &error);
+        if (error.error_type != NO_ERROR) return NULL;
+    }
+
+    void* ptr = slab_class->bump;
+    slab_class->bump += class_size;
+    return ptr;
+}
+
+/**
+ * Deallocates a region of memory by scrubbing it and pushing it onto the free list of its size class.
+ *
+ * @param context Context of slab allocator
+ * @param block Pointer to memory to be deallocated
+ * @param size Size of memory to be deallocated
+ * @param scrub Scrub function of the slab allocator's scrub policy
+ */
+static inline void ctd_slab_allocator_deallocate_with_scrub(void* context, void* block, const ptrdiff_t size, const ctd_scrub_function scrub)
+{
+    ctd_slab_context* slab_context = context;
+    if (size > CTD_MAX_SIZE_CLASS)
+    {
+        slab_context->allocator->deallocate(slab_context->allocator->context, block, size);
+        return;
+    }
+
+    scrub(block, size);
+    ctd_slab_class* slab_class = &slab_context->classes[ctd_slab_class_index(slab_context, size)];
+    ctd_slab_free_block* free_block = block;
+    free_block->next = slab_class->free_list;
+    slab_class->free_list = free_block;
+}
+
+/**
+ * Reallocates a region of memory. If the old and new sizes fall into the same size class the block is returned as is,
+ * otherwise the data is copied into a block of the new size class and the old block is deallocated.
+ *
+ * @param context Slab allocator's context
+ * @param source Pointer to the memory to be reallocated
+ * @param old_size The size of the memory to be reallocated
+ * @param new_size The size the memory will be reallocated to
+ * @param align The alignment of the region of memory
+ * @param scrub Scrub function of the slab allocator's scrub policy
+ * @return Pointer to the reallocated memory if reallocation succeeds, otherwise returns NULL pointer.
+ */
+static inline void* ctd_slab_allocator_reallocate_with_scrub(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const ctd_scrub_function scrub)
+{
+    ctd_slab_context* slab_context = context;
+    if (old_size > CTD_MAX_SIZE_CLASS && new_size > CTD_MAX_SIZE_CLASS)
+    {
+        return slab_context->allocator->reallocate(slab_context->allocator->context, source, old_size, new_size, align);
+    }
+    if (old_size <= CTD_MAX_SIZE_CLASS && new_size <= CTD_MAX_SIZE_CLASS &&
+        ctd_slab_class_index(slab_context, old_size) == ctd_slab_class_index(slab_context, new_size))
+    {
+        if (new_size < old_size)
+        {
+            scrub((char*)source + new_size, old_size - new_size);
+        }
+        return source;
+    }
+
+    void* destination = ctd_slab_allocator_allocate(context, new_size, align);
+    if (destination == NULL) return NULL;
+
+    memcpy(destination, source, ctd_min(old_size, new_size));
+    ctd_slab_allocator_deallocate_with_scrub(context, source, old_size, scrub);
+
+    return destination;
+}
+
+ctd_scrub_specialize(ctd_slab_allocator)
+
+ctd_slab_allocator ctd_slab_allocator_create(ptrdiff_t slab_size, ctd_allocator* allocator)
+{
+    return ctd_slab_allocator_create_with_scrub_policy(slab_size, CTD_SCRUB_ZERO, allocator);
+}
+
+ctd_slab_allocator ctd_slab_allocator_create_with_scrub_policy(ptrdiff_t slab_size, ctd_scrub_policy scrub_policy, ctd_allocator* allocator)
+{
+    ctd_slab_allocator slab_allocator = {0};
+    ctd_slab_context* context = allocator->allocate(allocator->context, sizeof(ctd_slab_context), alignof(ctd_slab_context));
+    if (context == NULL) goto context_alloc_failed_cleanup;
+    *context = (ctd_slab_context){0};
+
+    context->slabs.data = allocator->allocate(allocator->context, sizeof(ctd_slab), alignof(ctd_slab));
+    if (context->slabs.data == NULL) goto slab_array_alloc_failed_cleanup;
+    context->slabs.length = 0;
+    context->slabs.capacity = 1;
+    context->slabs.allocated_size = sizeof(ctd_slab);
+    context->slab_size = ctd_max(slab_size, CTD_MAX_SIZE_CLASS);
+    context->allocator = allocator;
+
+    ctd_size_class_fill_lookup(context->class_lookup);
+
+    slab_allocator.allocator = ctd_slab_allocator_scrub_vtables[scrub_policy];
+    slab_allocator.allocator.context = context;
+
+    return slab_allocator;
+
+slab_array_alloc_failed_cleanup:
+    allocator->deallocate(allocator->context, context, sizeof(ctd_slab_context));
+context_alloc_failed_cleanup:
+    return (ctd_slab_allocator) {0};
+}
+
+void ctd_slab_allocator_destroy(ctd_slab_allocator* self)
+{
+    ctd_slab_context* context = self->allocator.context;
+    ctd_allocator* underlying_allocator = context->allocator;
+
+    for (ptrdiff_t i = context->slabs.length - 1; i >= 0; i--)
+    {
+        underlying_allocator->deallocate(underlying_allocator->context, context->slabs.data[i].data, context->slabs.data[i].size);
+    }
+    underlying_allocator->deallocate(underlying_allocator->context, context->slabs.data, context->slabs.allocated_size);
+    underlying_allocator->deallocate(underlying_allocator->context, context, sizeof(ctd_slab_context));
+
+    *self = (ctd_slab_allocator) {0};
+}
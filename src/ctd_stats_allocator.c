@@ -0,0 +1,331 @@
+#include <ctd_stats_allocator.h>
+#include <ctd_define.h>
+#include <stdalign.h>
+#include <time.h>
+
+typedef struct ctd_stats_context
+{
+    ctd_allocator_stats stats;
+    ctd_allocator* allocator;
+    // The optional entries are only forwarded when the wrapped allocator has them, so rather than having a timed and an
+    // untimed version of each, they check this
+    bool record_latency;
+} ctd_stats_context;
+
+static inline int64_t ctd_stats_now_ns()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (int64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+static inline ptrdiff_t ctd_stats_histogram_bucket(const ptrdiff_t size)
+{
+    if (size <= 0)
+    {
+        return 0;
+    }
+#if defined(__GNUC__)
+    const ptrdiff_t bucket = 64 - __builtin_clzll((unsigned long long)size);
+#else
+    ptrdiff_t bucket = 0;
+    for (unsigned long long remaining = size; remaining != 0; remaining >>= 1)
+    {
+        bucket++;
+    }
+#endif
+    return ctd_min(bucket, CTD_STATS_HISTOGRAM_BUCKETS - 1);
+}
+
+static inline void ctd_stats_add_live_bytes(ctd_allocator_stats* stats, const ptrdiff_t bytes)
+{
+    stats->bytes_live += bytes;
+    if (bytes > 0)
+    {
+        stats->bytes_allocated += bytes;
+    }
+    if (stats->bytes_live > stats->peak_bytes_live)
+    {
+        stats->peak_bytes_live = stats->bytes_live;
+    }
+}
+
+static inline void* ctd_stats_allocator_allocate_with_timing(void* context, const ptrdiff_t size, const ptrdiff_t align, const bool timed)
+{
+    ctd_stats_context* stats_context = context;
+    ctd_allocator* allocator = stats_context->allocator;
+    ctd_allocator_stats* stats = &stats_context->stats;
+
+    const int64_t start = timed ? ctd_stats_now_ns() : 0;
+    void* ptr = allocator->allocate(allocator->context, size, align);
+    if (timed)
+    {
+        stats->allocate_ns += ctd_stats_now_ns() - start;
+    }
+
+    stats->allocations++;
+    stats->size_histogram[ctd_stats_histogram_bucket(size)]++;
+    if (ptr == NULL)
+    {
+        stats->failed_allocations++;
+        return NULL;
+    }
+    ctd_stats_add_live_bytes(stats, size);
+
+    return ptr;
+}
+
+static inline void* ctd_stats_allocator_reallocate_with_timing(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const bool timed)
+{
+    ctd_stats_context* stats_context = context;
+    ctd_allocator* allocator = stats_context->allocator;
+    ctd_allocator_stats* stats = &stats_context->stats;
+
+    const int64_t start = timed ? ctd_stats_now_ns() : 0;
+    void* ptr = allocator->reallocate(allocator->context, source, old_size, new_size, align);
+    if (timed)
+    {
+        stats->reallocate_ns += ctd_stats_now_ns() - start;
+    }
+
+    stats->reallocations++;
+    stats->size_histogram[ctd_stats_histogram_bucket(new_size)]++;
+    if (ptr == NULL)
+    {
+        stats->failed_allocations++;
+        return NULL;
+    }
+    ctd_stats_add_live_bytes(stats, new_size - old_size);
+
+    return ptr;
+}
+
+static inline void ctd_stats_allocator_deallocate_with_timing(void* context, void* block, const ptrdiff_t size, const bool timed)
+{
+    ctd_stats_context* stats_context = context;
+    ctd_allocator* allocator = stats_context->allocator;
+    ctd_allocator_stats* stats = &stats_context->stats;
+
+    const int64_t start = timed ? ctd_stats_now_ns() : 0;
+    allocator->deallocate(allocator->context, block, size);
+    if (timed)
+    {
+        stats->deallocate_ns += ctd_stats_now_ns() - start;
+    }
+
+    stats->deallocations++;
+    stats->bytes_live -= size;
+}
+
+static void* ctd_stats_allocator_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    return ctd_stats_allocator_allocate_with_timing(context, size, align, false);
+}
+
+static void* ctd_stats_allocator_reallocate(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align)
+{
+    return ctd_stats_allocator_reallocate_with_timing(context, source, old_size, new_size, align, false);
+}
+
+static void ctd_stats_allocator_deallocate(void* context, void* block, const ptrdiff_t size)
+{
+    ctd_stats_allocator_deallocate_with_timing(context, block, size, false);
+}
+
+static void* ctd_stats_allocator_allocate_timed(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    return ctd_stats_allocator_allocate_with_timing(context, size, align, true);
+}
+
+static void* ctd_stats_allocator_reallocate_timed(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align)
+{
+    return ctd_stats_allocator_reallocate_with_timing(context, source, old_size, new_size, align, true);
+}
+
+static void ctd_stats_allocator_deallocate_timed(void* context, void* block, const ptrdiff_t size)
+{
+    ctd_stats_allocator_deallocate_with_timing(context, block, size, true);
+}
+
+/**
+ * Resizes a block in place. Only resizes that succeed count as reallocations, since a failed one leaves the block as it
+ * was, and isn't a failed allocation either.
+ */
+static bool ctd_stats_allocator_try_resize(void* context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    ctd_stats_context* stats_context = context;
+    ctd_allocator* allocator = stats_context->allocator;
+    ctd_allocator_stats* stats = &stats_context->stats;
+
+    const int64_t start = stats_context->record_latency ? ctd_stats_now_ns() : 0;
+    const bool resized = allocator->try_resize(allocator->context, block, old_size, new_size);
+    if (stats_context->record_latency)
+    {
+        stats->reallocate_ns += ctd_stats_now_ns() - start;
+    }
+
+    if (resized)
+    {
+        stats->reallocations++;
+        stats->size_histogram[ctd_stats_histogram_bucket(new_size)]++;
+        ctd_stats_add_live_bytes(stats, new_size - old_size);
+    }
+
+    return resized;
+}
+
+/**
+ * Allocates a block and reports its usable size. The usable size is what the block is deallocated with, so that's what
+ * counts as live, while the histogram records the requested size.
+ */
+static void* ctd_stats_allocator_allocate_sized(void* context, const ptrdiff_t size, const ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    ctd_stats_context* stats_context = context;
+    ctd_allocator* allocator = stats_context->allocator;
+    ctd_allocator_stats* stats = &stats_context->stats;
+
+    const int64_t start = stats_context->record_latency ? ctd_stats_now_ns() : 0;
+    void* ptr = allocator->allocate_sized(allocator->context, size, align, usable_size);
+    if (stats_context->record_latency)
+    {
+        stats->allocate_ns += ctd_stats_now_ns() - start;
+    }
+
+    stats->allocations++;
+    stats->size_histogram[ctd_stats_histogram_bucket(size)]++;
+    if (ptr == NULL)
+    {
+        stats->failed_allocations++;
+        return NULL;
+    }
+    ctd_stats_add_live_bytes(stats, *usable_size);
+
+    return ptr;
+}
+
+static void* ctd_stats_allocator_reallocate_sized(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    ctd_stats_context* stats_context = context;
+    ctd_allocator* allocator = stats_context->allocator;
+    ctd_allocator_stats* stats = &stats_context->stats;
+
+    const int64_t start = stats_context->record_latency ? ctd_stats_now_ns() : 0;
+    void* ptr = allocator->reallocate_sized(allocator->context, source, old_size, new_size, align, usable_size);
+    if (stats_context->record_latency)
+    {
+        stats->reallocate_ns += ctd_stats_now_ns() - start;
+    }
+
+    stats->reallocations++;
+    stats->size_histogram[ctd_stats_histogram_bucket(new_size)]++;
+    if (ptr == NULL)
+    {
+        stats->failed_allocations++;
+        return NULL;
+    }
+    ctd_stats_add_live_bytes(stats, *usable_size - old_size);
+
+    return ptr;
+}
+
+/**
+ * Allocates a batch of blocks, which counts as one allocation per block. A failed batch allocates none of them, so
+ * every block counts as a failed allocation.
+ */
+static bool ctd_stats_allocator_allocate_batch(void* context, const ptrdiff_t count, const ptrdiff_t size, const ptrdiff_t align, void** blocks)
+{
+    ctd_stats_context* stats_context = context;
+    ctd_allocator* allocator = stats_context->allocator;
+    ctd_allocator_stats* stats = &stats_context->stats;
+
+    const int64_t start = stats_context->record_latency ? ctd_stats_now_ns() : 0;
+    const bool allocated = allocator->allocate_batch(allocator->context, count, size, align, blocks);
+    if (stats_context->record_latency)
+    {
+        stats->allocate_ns += ctd_stats_now_ns() - start;
+    }
+
+    stats->allocations += count;
+    stats->size_histogram[ctd_stats_histogram_bucket(size)] += count;
+    if (!allocated)
+    {
+        stats->failed_allocations += count;
+        return false;
+    }
+    ctd_stats_add_live_bytes(stats, count * size);
+
+    return true;
+}
+
+static void ctd_stats_allocator_deallocate_batch(void* context, const ptrdiff_t count, const ptrdiff_t size, void** blocks)
+{
+    ctd_stats_context* stats_context = context;
+    ctd_allocator* allocator = stats_context->allocator;
+    ctd_allocator_stats* stats = &stats_context->stats;
+
+    const int64_t start = stats_context->record_latency ? ctd_stats_now_ns() : 0;
+    allocator->deallocate_batch(allocator->context, count, size, blocks);
+    if (stats_context->record_latency)
+    {
+        stats->deallocate_ns += ctd_stats_now_ns() - start;
+    }
+
+    stats->deallocations += count;
+    stats->bytes_live -= count * size;
+}
+
+ctd_stats_allocator ctd_stats_allocator_create(ctd_allocator* allocator, const bool record_latency)
+{
+    ctd_stats_allocator stats_allocator = {0};
+    ctd_stats_context* context = allocator->allocate(allocator->context, sizeof(ctd_stats_context), alignof(ctd_stats_context));
+    if (context == NULL) return stats_allocator;
+    *context = (ctd_stats_context) {0};
+    context->allocator = allocator;
+    context->record_latency = record_latency;
+
+    if (record_latency)
+    {
+        stats_allocator.allocator.allocate = ctd_stats_allocator_allocate_timed;
+        stats_allocator.allocator.reallocate = ctd_stats_allocator_reallocate_timed;
+        stats_allocator.allocator.deallocate = ctd_stats_allocator_deallocate_timed;
+    }
+    else
+    {
+        stats_allocator.allocator.allocate = ctd_stats_allocator_allocate;
+        stats_allocator.allocator.reallocate = ctd_stats_allocator_reallocate;
+        stats_allocator.allocator.deallocate = ctd_stats_allocator_deallocate;
+    }
+    // Entries the wrapped allocator doesn't have are left NULL, so that callers fall back to the entries above
+    stats_allocator.allocator.try_resize = allocator->try_resize != NULL ? ctd_stats_allocator_try_resize : NULL;
+    stats_allocator.allocator.allocate_sized = allocator->allocate_sized != NULL ? ctd_stats_allocator_allocate_sized : NULL;
+    stats_allocator.allocator.reallocate_sized = allocator->reallocate_sized != NULL ? ctd_stats_allocator_reallocate_sized : NULL;
+    stats_allocator.allocator.allocate_batch = allocator->allocate_batch != NULL ? ctd_stats_allocator_allocate_batch : NULL;
+    stats_allocator.allocator.deallocate_batch = allocator->deallocate_batch != NULL ? ctd_stats_allocator_deallocate_batch : NULL;
+    stats_allocator.allocator.context = context;
+
+    return stats_allocator;
+}
+
+void ctd_stats_allocator_destroy(ctd_stats_allocator* self)
+{
+    ctd_stats_context* context = self->allocator.context;
+    ctd_allocator* allocator = context->allocator;
+    allocator->deallocate(allocator->context, context, sizeof(ctd_stats_context));
+
+    *self = (ctd_stats_allocator) {0};
+}
+
+ctd_allocator_stats ctd_stats_allocator_get_stats(ctd_stats_allocator* self)
+{
+    ctd_stats_context* context = self->allocator.context;
+    return context->stats;
+}
+
+void ctd_stats_allocator_reset_stats(ctd_stats_allocator* self)
+{
+    ctd_stats_context* context = self->allocator.context;
+    const ptrdiff_t bytes_live = context->stats.bytes_live;
+    context->stats = (ctd_allocator_stats) {0};
+    context->stats.bytes_live = bytes_live;
+    context->stats.peak_bytes_live = bytes_live;
+}
@@ -1,4 +1,6 @@
 #include <ctd_string.h>
+#include <ctd_fallback_allocator.h>
+#include <ctd_internal_string_search.h>
 #include <stdalign.h>
 #include <string.h>
 
@@ -82,27 +84,13 @@ ctd_option(ptrdiff_t) ctd_string_find(ctd_string str, ctd_string substring, ptrd
         return NONE(ptrdiff_t);
     }
 
-    for (ptrdiff_t i = start; i <= str.length - substring.length; i++)
+    // The search runs on the fastest SIMD kernel the CPU supports
+    const ptrdiff_t index = ctd_internal_string_find(str.data + start, str.length - start, substring.data, substring.length);
+    if (index < 0)
     {
-        // If this is true, there isn't enough room inside str to contain the substring
-        if (str.length - i < substring.length)
-        {
-            return NONE(ptrdiff_t);
-        }
-        // If this is true, then the substring can't start at this character, and we move onto the next one
-        if (str.data[i] != substring.data[0])
-        {
-            continue;
-        }
-
-        ctd_string candidate = {.data = str.data + i, .length = substring.length};
-        if (ctd_string_equals(candidate, substring))
-        {
-            return SOME(ptrdiff_t, i);
-        }
+        return NONE(ptrdiff_t);
     }
-
-    return NONE(ptrdiff_t);
+    return SOME(ptrdiff_t, start + index);
 }
 
 /**
@@ -132,25 +120,18 @@ ctd_option(ptrdiff_t) ctd_string_reverse_find(ctd_string str, ctd_string substri
     {
         return NONE(ptrdiff_t);
     }
-    ptrdiff_t beginning_index = end - substring.length;
-
-    for (ptrdiff_t i = beginning_index; i >= 0; i--)
+    const ptrdiff_t index = ctd_internal_string_reverse_find(str.data, end, substring.data, substring.length);
+    if (index < 0)
     {
-        if (str.data[i] != substring.data[0])
-        {
-            continue;
-        }
-
-        ctd_string candidate = {.data = str.data + i, .length = substring.length};
-        if (ctd_string_equals(candidate, substring))
-        {
-            return SOME(ptrdiff_t, i);
-        }
+        return NONE(ptrdiff_t);
     }
-
-    return NONE(ptrdiff_t);
+    return SOME(ptrdiff_t, index);
 }
 
+/**
+ * Hashes a string with djb2, a byte at a time. Kept so that hashes computed with it before stay the same, new code
+ * should use ctd_string_hash64 from ctd_string_hash.h, which is much faster and spreads its hashes better.
+ */
 uint64_t ctd_string_hash(ctd_string str)
 {
     unsigned long hash = 5381;
@@ -165,9 +146,15 @@ uint64_t ctd_string_hash(ctd_string str)
     return hash;
 }
 
+// Size of the stack buffer that ctd_string_remove_whitespace builds its result in, before copying it to the allocator
+#define CTD_STRING_REMOVE_WHITESPACE_BUFFER_SIZE 512
+
 ctd_string ctd_string_remove_whitespace(ctd_string str, ctd_allocator allocator, ctd_error* error)
 {
-    char* initial_buffer = allocator.allocate(allocator.context, str.length * sizeof(char), alignof(char));
+    // Short strings are stripped on the stack, and longer ones spill to the allocator they are returned in
+    alignas(max_align_t) char stack_buffer[CTD_STRING_REMOVE_WHITESPACE_BUFFER_SIZE];
+    ctd_fallback_allocator scratch = ctd_fallback_allocator_create_with_scrub_policy(stack_buffer, sizeof(stack_buffer), CTD_SCRUB_NONE, &allocator);
+    char* initial_buffer = scratch.allocator.allocate(scratch.allocator.context, str.length * sizeof(char), alignof(char));
     if (initial_buffer == NULL)
     {
         return (ctd_string) {0};
@@ -201,12 +188,12 @@ ctd_string ctd_string_remove_whitespace(ctd_string str, ctd_allocator allocator,
     ctd_string modified_string = ctd_string_create(length, allocator, error);
     if (error->error_type != NO_ERROR)
     {
-        allocator.deallocate(allocator.context, initial_buffer, str.length);
+        scratch.allocator.deallocate(scratch.allocator.context, initial_buffer, str.length);
         return (ctd_string) {0};
     }
 
     memcpy(modified_string.data, initial_buffer, length * sizeof(char));
-    allocator.deallocate(allocator.context, initial_buffer, str.length);
+    scratch.allocator.deallocate(scratch.allocator.context, initial_buffer, str.length);
 
     return modified_string;
 }
@@ -251,7 +238,8 @@ void ctd_string_destroy(ctd_string* self, ctd_allocator allocator)
 
 ctd_string_builder ctd_string_builder_create(ptrdiff_t capacity, ctd_allocator* allocator, ctd_error* error)
 {
-    char *data = allocator->allocate(allocator->context, capacity, alignof(char));
+    // The allocator may hand out more than was asked for, and all of it can be used before the builder has to grow
+    char *data = ctd_allocator_allocate_sized(allocator, capacity, alignof(char), &capacity);
     if (data == NULL)
     {
         error->error_type = ALLOCATION_FAIL;
@@ -466,21 +454,99 @@ void ctd_string_builder_replace(ctd_string_builder* self, ctd_string substring,
     ctd_string_builder_replace_at(self, replacement, index, substring.length, error);
 }
 
+/**
+ * Finds the next instance of a substring, without checking the arguments.
+ *
+ * @return Index of the instance, or -1 if there is none.
+ */
+static inline ptrdiff_t ctd_string_builder_find_next(const char* data, ptrdiff_t length, ctd_string substring, ptrdiff_t start)
+{
+    if (length - start < substring.length)
+    {
+        return -1;
+    }
+    const ptrdiff_t index = ctd_internal_string_find(data + start, length - start, substring.data, substring.length);
+    return index < 0 ? -1 : start + index;
+}
+
+/**
+ * Replaces every instance of a substring that doesn't overlap a previous one, from left to right. Replacements aren't
+ * searched again.
+ *
+ * Instead of moving the rest of the string once per instance, the instances are counted first, so that the builder is
+ * resized at most once, and the result is then assembled in a single forward pass. When the replacement is longer than
+ * the substring, the part of the string from the first instance on is moved to the end of the resized builder first,
+ * so that what is left to be read always stays ahead of what has been written.
+ *
+ * @param self String builder to modify.
+ * @param substring String to be replaced. Nothing is replaced if it is empty.
+ * @param replacement String to replace it with.
+ * @param start Beginning index to search from. Inclusive.
+ * @param error Pointer to error struct. Set to INVALID_ARGUMENT if start is out of range, and to ALLOCATION_FAIL if the
+ * builder couldn't grow, in which case it is left unchanged.
+ */
 void ctd_string_builder_replace_all(ctd_string_builder* self, ctd_string substring, ctd_string replacement, ptrdiff_t start, ctd_error* error)
 {
-    ctd_option(ptrdiff_t) index_option = ctd_string_builder_find(self, substring, start, error);
-    ptrdiff_t length_difference = replacement.length - substring.length;
-    ptrdiff_t index;
-    while (IS_SOME((index_option = ctd_string_builder_find(self, substring, start, error))) && error->error_type == NO_ERROR)
-    {
-        index = index_option.value;
-        ctd_string_builder_replace_at(self, replacement, index, substring.length, error);
-        start = index + replacement.length;
-        if (start >= self->length + length_difference)
+    if (self == NULL)
+    {
+        error->error_type = INVALID_ARGUMENT;
+        error->error_message = "Ctd_string_builder was NULL";
+
+        return;
+    }
+    if (start < 0 || start >= self->length)
+    {
+        error->error_type = INVALID_ARGUMENT;
+        error->error_message = "Starting index was greater than or equal to string's length.";
+
+        return;
+    }
+    if (substring.length == 0)
+    {
+        return;
+    }
+
+    const ptrdiff_t first = ctd_string_builder_find_next(self->data, self->length, substring, start);
+    if (first < 0)
+    {
+        return;
+    }
+    const ptrdiff_t length_difference = replacement.length - substring.length;
+
+    // The text before the first instance never moves, so reading and writing both start there
+    ptrdiff_t read = first;
+    ptrdiff_t write = first;
+    ptrdiff_t length = self->length;
+    if (length_difference > 0)
+    {
+        ptrdiff_t count = 0;
+        for (ptrdiff_t index = first; index >= 0; index = ctd_string_builder_find_next(self->data, self->length, substring, index + substring.length))
         {
-            break;
+            count++;
         }
+        const ptrdiff_t growth = count * length_difference;
+        ctd_string_builder_maybe_expand(self, growth, error);
+        if (error->error_type != NO_ERROR)
+        {
+            return;
+        }
+
+        memmove(self->data + first + growth, self->data + first, (self->length - first) * sizeof(char));
+        read += growth;
+        length += growth;
     }
+
+    // The replacements written so far never grow by more than the growth, so they stay behind the next instance
+    for (ptrdiff_t index = read; index >= 0; index = ctd_string_builder_find_next(self->data, length, substring, read))
+    {
+        memmove(self->data + write, self->data + read, (index - read) * sizeof(char));
+        write += index - read;
+        memcpy(self->data + write, replacement.data, replacement.length * sizeof(char));
+        write += replacement.length;
+        read = index + substring.length;
+    }
+    memmove(self->data + write, self->data + read, (length - read) * sizeof(char));
+    self->length = write + length - read;
 }
 
 void ctd_string_builder_reverse(ctd_string_builder* self)
@@ -499,9 +565,14 @@ void ctd_string_builder_reverse(ctd_string_builder* self)
     }
 }
 
+/**
+ * Empties a string builder in O(1) while keeping its capacity. Nothing past a builder's length is ever read, so the old
+ * characters are left in place instead of being zeroed.
+ *
+ * @param self The string builder to clear.
+ */
 void ctd_string_builder_clear(ctd_string_builder* self)
 {
-    memset(self->data, 0, self->length * sizeof(char));
     self->length = 0;
 }
 
@@ -594,7 +665,14 @@ void ctd_string_builder_maybe_contract(ctd_string_builder* self, ctd_error* erro
 
 void ctd_string_builder_resize(ctd_string_builder *self, ptrdiff_t new_capacity, ctd_error* error)
 {
-    char* new_data = self->allocator->reallocate(self->allocator->context, self->data, self->capacity, new_capacity, alignof(char));
+    // Resizing in place avoids copying the string, e.g. when it is the most recent allocation of an arena
+    if (ctd_allocator_try_resize(self->allocator, self->data, self->capacity, new_capacity))
+    {
+        self->capacity = new_capacity;
+        return;
+    }
+
+    char* new_data = ctd_allocator_reallocate_sized(self->allocator, self->data, self->capacity, new_capacity, alignof(char), &new_capacity);
     if (new_data == NULL)
     {
         error->error_type = ALLOCATION_FAIL;
@@ -0,0 +1,207 @@
+#include <ctd_string_hash.h>
+#include <string.h>
+
+// The default secret of wyhash
+static const uint64_t ctd_string_hash_secret[4] = {
+    0x2d358dccaa6c78a5u, 0x8bb84b93962eacc9u, 0x4b33a62ed433d4a3u, 0x4d5a2da51de1aa47u,
+};
+
+/**
+ * Multiplies two numbers into 128 bits, and returns the low half in a and the high half in b.
+ */
+static inline void ctd_string_hash_multiply(uint64_t* a, uint64_t* b)
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = (unsigned __int128)*a * *b;
+    *a = (uint64_t)product;
+    *b = (uint64_t)(product >> 64);
+#else
+    const uint64_t a_high = *a >> 32, a_low = (uint32_t)*a, b_high = *b >> 32, b_low = (uint32_t)*b;
+    const uint64_t high_high = a_high * b_high, high_low = a_high * b_low, low_high = a_low * b_high, low_low = a_low * b_low;
+    const uint64_t middle = (low_low >> 32) + (uint32_t)high_low + (uint32_t)low_high;
+    *a = (middle << 32) | (uint32_t)low_low;
+    *b = high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+#endif
+}
+
+static inline uint64_t ctd_string_hash_mix(uint64_t a, uint64_t b)
+{
+    ctd_string_hash_multiply(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t ctd_string_hash_read64(const char* p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static inline uint64_t ctd_string_hash_read32(const char* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+static inline uint64_t ctd_string_hash_seed(const uint64_t seed)
+{
+    return seed ^ ctd_string_hash_mix(seed ^ ctd_string_hash_secret[0], ctd_string_hash_secret[1]);
+}
+
+/**
+ * Mixes a block into the three lanes.
+ */
+static inline void ctd_string_hash_block(uint64_t* lanes, const char* p)
+{
+    lanes[0] = ctd_string_hash_mix(ctd_string_hash_read64(p) ^ ctd_string_hash_secret[1], ctd_string_hash_read64(p + 8) ^ lanes[0]);
+    lanes[1] = ctd_string_hash_mix(ctd_string_hash_read64(p + 16) ^ ctd_string_hash_secret[2], ctd_string_hash_read64(p + 24) ^ lanes[1]);
+    lanes[2] = ctd_string_hash_mix(ctd_string_hash_read64(p + 32) ^ ctd_string_hash_secret[3], ctd_string_hash_read64(p + 40) ^ lanes[2]);
+}
+
+/**
+ * Hashes up to 16 bytes, reading the middle of strings of 4 to 16 bytes twice so that no branch depends on the exact
+ * length.
+ */
+static inline uint64_t ctd_string_hash_short(const char* p, const ptrdiff_t length, const uint64_t seed)
+{
+    uint64_t a = 0, b = 0;
+    if (length >= 4)
+    {
+        const ptrdiff_t middle = (length >> 3) << 2;
+        a = (ctd_string_hash_read32(p) << 32) | ctd_string_hash_read32(p + middle);
+        b = (ctd_string_hash_read32(p + length - 4) << 32) | ctd_string_hash_read32(p + length - 4 - middle);
+    }
+    else if (length > 0)
+    {
+        a = ((uint64_t)(unsigned char)p[0] << 16) | ((uint64_t)(unsigned char)p[length >> 1] << 8) | (unsigned char)p[length - 1];
+    }
+    a ^= ctd_string_hash_secret[1];
+    b ^= seed;
+    ctd_string_hash_multiply(&a, &b);
+    return ctd_string_hash_mix(a ^ ctd_string_hash_secret[0] ^ (uint64_t)length, b ^ ctd_string_hash_secret[1]);
+}
+
+/**
+ * Hashes the bytes after the last block of a string longer than 16 bytes. Its last 16 bytes are read even when fewer of
+ * them are left, so up to CTD_STRING_HASH_HISTORY bytes before p have to be the ones that came before it.
+ *
+ * @param p First byte that isn't in a block.
+ * @param remaining Number of bytes left, less than CTD_STRING_HASH_BLOCK.
+ * @param seed First lane, with the other two folded in if there were any blocks.
+ * @param length Length of the whole string.
+ */
+static inline uint64_t ctd_string_hash_tail(const char* p, ptrdiff_t remaining, uint64_t seed, const uint64_t length)
+{
+    while (remaining > 16)
+    {
+        seed = ctd_string_hash_mix(ctd_string_hash_read64(p) ^ ctd_string_hash_secret[1], ctd_string_hash_read64(p + 8) ^ seed);
+        p += 16;
+        remaining -= 16;
+    }
+    uint64_t a = ctd_string_hash_read64(p + remaining - 16) ^ ctd_string_hash_secret[1];
+    uint64_t b = ctd_string_hash_read64(p + remaining - 8) ^ seed;
+    ctd_string_hash_multiply(&a, &b);
+    return ctd_string_hash_mix(a ^ ctd_string_hash_secret[0] ^ length, b ^ ctd_string_hash_secret[1]);
+}
+
+/**
+ * Hashes a string with a seed that has already been mixed, so that the mixing of a constant seed is done at compile time.
+ */
+static inline uint64_t ctd_string_hash_with_mixed_seed(const ctd_string str, uint64_t seed)
+{
+    if (str.length <= 16)
+    {
+        return ctd_string_hash_short(str.data, str.length, seed);
+    }
+
+    const char* p = str.data;
+    ptrdiff_t remaining = str.length;
+    if (remaining >= CTD_STRING_HASH_BLOCK)
+    {
+        uint64_t lanes[3] = {seed, seed, seed};
+        do
+        {
+            ctd_string_hash_block(lanes, p);
+            p += CTD_STRING_HASH_BLOCK;
+            remaining -= CTD_STRING_HASH_BLOCK;
+        } while (remaining >= CTD_STRING_HASH_BLOCK);
+        seed = lanes[0] ^ lanes[1] ^ lanes[2];
+    }
+    return ctd_string_hash_tail(p, remaining, seed, (uint64_t)str.length);
+}
+
+uint64_t ctd_string_hash64(ctd_string str)
+{
+    return ctd_string_hash_with_mixed_seed(str, ctd_string_hash_seed(0));
+}
+
+uint64_t ctd_string_hash64_seeded(ctd_string str, uint64_t seed)
+{
+    return ctd_string_hash_with_mixed_seed(str, ctd_string_hash_seed(seed));
+}
+
+ctd_string_hasher ctd_string_hasher_create(uint64_t seed)
+{
+    seed = ctd_string_hash_seed(seed);
+    return (ctd_string_hasher) {.seed = seed, .lanes = {seed, seed, seed}};
+}
+
+void ctd_string_hasher_update(ctd_string_hasher* self, ctd_string str)
+{
+    if (str.length == 0)
+    {
+        return;
+    }
+    char* pending = self->buffer + CTD_STRING_HASH_HISTORY;
+    const char* p = str.data;
+    ptrdiff_t remaining = str.length;
+    self->length += (uint64_t)remaining;
+
+    // Blocks are processed as soon as they are complete, which is what ctd_string_hash64_seeded does too
+    if (self->buffered > 0)
+    {
+        const ptrdiff_t taken = ctd_min(remaining, CTD_STRING_HASH_BLOCK - self->buffered);
+        memcpy(pending + self->buffered, p, taken);
+        self->buffered += taken;
+        p += taken;
+        remaining -= taken;
+        if (self->buffered < CTD_STRING_HASH_BLOCK)
+        {
+            return;
+        }
+        ctd_string_hash_block(self->lanes, pending);
+        memcpy(self->buffer, pending + CTD_STRING_HASH_BLOCK - CTD_STRING_HASH_HISTORY, CTD_STRING_HASH_HISTORY);
+        self->buffered = 0;
+    }
+
+    if (remaining >= CTD_STRING_HASH_BLOCK)
+    {
+        do
+        {
+            ctd_string_hash_block(self->lanes, p);
+            p += CTD_STRING_HASH_BLOCK;
+            remaining -= CTD_STRING_HASH_BLOCK;
+        } while (remaining >= CTD_STRING_HASH_BLOCK);
+        memcpy(self->buffer, p - CTD_STRING_HASH_HISTORY, CTD_STRING_HASH_HISTORY);
+    }
+    memcpy(pending, p, remaining);
+    self->buffered = remaining;
+}
+
+uint64_t ctd_string_hasher_finish(const ctd_string_hasher* self)
+{
+    const char* pending = self->buffer + CTD_STRING_HASH_HISTORY;
+    if (self->length <= 16)
+    {
+        return ctd_string_hash_short(pending, (ptrdiff_t)self->length, self->seed);
+    }
+    const uint64_t seed = self->length >= CTD_STRING_HASH_BLOCK ? self->lanes[0] ^ self->lanes[1] ^ self->lanes[2] : self->seed;
+    return ctd_string_hash_tail(pending, self->buffered, seed, self->length);
+}
@@ -0,0 +1,287 @@
+#include <ctd_internal_string_search.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CTD_STRING_SEARCH_X86 1
+#include <immintrin.h>
+#else
+#define CTD_STRING_SEARCH_X86 0
+#endif
+
+static ptrdiff_t ctd_string_find_scalar(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    if (haystack_length < needle_length)
+    {
+        return -1;
+    }
+    const char* position = haystack;
+    // One past the last position the needle can start at
+    const char* end = haystack + haystack_length - needle_length + 1;
+    while (position < end)
+    {
+        position = memchr(position, needle[0], end - position);
+        if (position == NULL)
+        {
+            return -1;
+        }
+        if (position[needle_length - 1] == needle[needle_length - 1] && memcmp(position, needle, needle_length) == 0)
+        {
+            return position - haystack;
+        }
+        position++;
+    }
+    return -1;
+}
+
+static ptrdiff_t ctd_string_reverse_find_scalar(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    for (ptrdiff_t i = haystack_length - needle_length; i >= 0; i--)
+    {
+        if (haystack[i] == needle[0] && haystack[i + needle_length - 1] == needle[needle_length - 1]
+            && memcmp(haystack + i, needle, needle_length) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+#if CTD_STRING_SEARCH_X86
+
+/*
+ * Every SIMD kernel works the same way. A block of positions is loaded twice, once at the positions themselves and
+ * once needle_length - 1 bytes further, and compared against the first and last bytes of the needle. Only positions
+ * where both match have the bytes in between compared, so false candidates are rare even for common first bytes. The
+ * positions left over at the end, fewer than a block, are searched by the scalar kernel.
+ */
+
+// Compares the bytes between the first and the last, which the kernels have already matched
+static inline bool ctd_string_search_middle_matches(const char* candidate, const char* needle, const ptrdiff_t needle_length)
+{
+    return needle_length <= 2 || memcmp(candidate + 1, needle + 1, needle_length - 2) == 0;
+}
+
+static ptrdiff_t ctd_string_find_sse2(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_length - 1]);
+    ptrdiff_t i = 0;
+    for (; i + needle_length - 1 + 16 <= haystack_length; i += 16)
+    {
+        const __m128i block_first = _mm_loadu_si128((const __m128i*)(haystack + i));
+        const __m128i block_last = _mm_loadu_si128((const __m128i*)(haystack + i + needle_length - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)));
+        while (mask != 0)
+        {
+            const ptrdiff_t position = i + __builtin_ctz(mask);
+            if (ctd_string_search_middle_matches(haystack + position, needle, needle_length))
+            {
+                return position;
+            }
+            mask &= mask - 1;
+        }
+    }
+    const ptrdiff_t found = ctd_string_find_scalar(haystack + i, haystack_length - i, needle, needle_length);
+    return found < 0 ? -1 : i + found;
+}
+
+static ptrdiff_t ctd_string_reverse_find_sse2(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_length - 1]);
+    // The block covers positions i to i + 15, and the last of them is the last position the needle can start at
+    ptrdiff_t i = haystack_length - needle_length + 1 - 16;
+    for (; i >= 0; i -= 16)
+    {
+        const __m128i block_first = _mm_loadu_si128((const __m128i*)(haystack + i));
+        const __m128i block_last = _mm_loadu_si128((const __m128i*)(haystack + i + needle_length - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)));
+        while (mask != 0)
+        {
+            const ptrdiff_t bit = 31 - __builtin_clz(mask);
+            if (ctd_string_search_middle_matches(haystack + i + bit, needle, needle_length))
+            {
+                return i + bit;
+            }
+            mask &= ~(1u << bit);
+        }
+    }
+    // Positions 0 to i + 15 are left, so the needle has to end before i + 16 + needle_length - 1
+    return ctd_string_reverse_find_scalar(haystack, i + 16 + needle_length - 1, needle, needle_length);
+}
+
+__attribute__((target("avx2")))
+static ptrdiff_t ctd_string_find_avx2(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needle_length - 1]);
+    ptrdiff_t i = 0;
+    for (; i + needle_length - 1 + 32 <= haystack_length; i += 32)
+    {
+        const __m256i block_first = _mm256_loadu_si256((const __m256i*)(haystack + i));
+        const __m256i block_last = _mm256_loadu_si256((const __m256i*)(haystack + i + needle_length - 1));
+        unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last)));
+        while (mask != 0)
+        {
+            const ptrdiff_t position = i + __builtin_ctz(mask);
+            if (ctd_string_search_middle_matches(haystack + position, needle, needle_length))
+            {
+                return position;
+            }
+            mask &= mask - 1;
+        }
+    }
+    const ptrdiff_t found = ctd_string_find_scalar(haystack + i, haystack_length - i, needle, needle_length);
+    return found < 0 ? -1 : i + found;
+}
+
+__attribute__((target("avx2")))
+static ptrdiff_t ctd_string_reverse_find_avx2(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needle_length - 1]);
+    ptrdiff_t i = haystack_length - needle_length + 1 - 32;
+    for (; i >= 0; i -= 32)
+    {
+        const __m256i block_first = _mm256_loadu_si256((const __m256i*)(haystack + i));
+        const __m256i block_last = _mm256_loadu_si256((const __m256i*)(haystack + i + needle_length - 1));
+        unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last)));
+        while (mask != 0)
+        {
+            const ptrdiff_t bit = 31 - __builtin_clz(mask);
+            if (ctd_string_search_middle_matches(haystack + i + bit, needle, needle_length))
+            {
+                return i + bit;
+            }
+            mask &= ~(1u << bit);
+        }
+    }
+    return ctd_string_reverse_find_scalar(haystack, i + 32 + needle_length - 1, needle, needle_length);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static ptrdiff_t ctd_string_find_avx512(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    const __m512i first = _mm512_set1_epi8(needle[0]);
+    const __m512i last = _mm512_set1_epi8(needle[needle_length - 1]);
+    ptrdiff_t i = 0;
+    for (; i + needle_length - 1 + 64 <= haystack_length; i += 64)
+    {
+        const __m512i block_first = _mm512_loadu_si512((const void*)(haystack + i));
+        const __m512i block_last = _mm512_loadu_si512((const void*)(haystack + i + needle_length - 1));
+        uint64_t mask = _mm512_cmpeq_epi8_mask(first, block_first) & _mm512_cmpeq_epi8_mask(last, block_last);
+        while (mask != 0)
+        {
+            const ptrdiff_t position = i + __builtin_ctzll(mask);
+            if (ctd_string_search_middle_matches(haystack + position, needle, needle_length))
+            {
+                return position;
+            }
+            mask &= mask - 1;
+        }
+    }
+    const ptrdiff_t found = ctd_string_find_scalar(haystack + i, haystack_length - i, needle, needle_length);
+    return found < 0 ? -1 : i + found;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static ptrdiff_t ctd_string_reverse_find_avx512(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    const __m512i first = _mm512_set1_epi8(needle[0]);
+    const __m512i last = _mm512_set1_epi8(needle[needle_length - 1]);
+    ptrdiff_t i = haystack_length - needle_length + 1 - 64;
+    for (; i >= 0; i -= 64)
+    {
+        const __m512i block_first = _mm512_loadu_si512((const void*)(haystack + i));
+        const __m512i block_last = _mm512_loadu_si512((const void*)(haystack + i + needle_length - 1));
+        uint64_t mask = _mm512_cmpeq_epi8_mask(first, block_first) & _mm512_cmpeq_epi8_mask(last, block_last);
+        while (mask != 0)
+        {
+            const ptrdiff_t bit = 63 - __builtin_clzll(mask);
+            if (ctd_string_search_middle_matches(haystack + i + bit, needle, needle_length))
+            {
+                return i + bit;
+            }
+            mask &= ~((uint64_t)1 << bit);
+        }
+    }
+    return ctd_string_reverse_find_scalar(haystack, i + 64 + needle_length - 1, needle, needle_length);
+}
+
+const ctd_string_search_function ctd_string_find_functions[CTD_STRING_SEARCH_LEVEL_COUNT] = {
+    [CTD_STRING_SEARCH_SCALAR] = ctd_string_find_scalar,
+    [CTD_STRING_SEARCH_SSE2] = ctd_string_find_sse2,
+    [CTD_STRING_SEARCH_AVX2] = ctd_string_find_avx2,
+    [CTD_STRING_SEARCH_AVX512] = ctd_string_find_avx512,
+};
+
+const ctd_string_search_function ctd_string_reverse_find_functions[CTD_STRING_SEARCH_LEVEL_COUNT] = {
+    [CTD_STRING_SEARCH_SCALAR] = ctd_string_reverse_find_scalar,
+    [CTD_STRING_SEARCH_SSE2] = ctd_string_reverse_find_sse2,
+    [CTD_STRING_SEARCH_AVX2] = ctd_string_reverse_find_avx2,
+    [CTD_STRING_SEARCH_AVX512] = ctd_string_reverse_find_avx512,
+};
+
+static ctd_string_search_level ctd_string_search_detect_level()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw"))
+    {
+        return CTD_STRING_SEARCH_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return CTD_STRING_SEARCH_AVX2;
+    }
+    return CTD_STRING_SEARCH_SSE2;
+}
+
+#else
+
+const ctd_string_search_function ctd_string_find_functions[CTD_STRING_SEARCH_LEVEL_COUNT] = {
+    [CTD_STRING_SEARCH_SCALAR] = ctd_string_find_scalar,
+    [CTD_STRING_SEARCH_SSE2] = ctd_string_find_scalar,
+    [CTD_STRING_SEARCH_AVX2] = ctd_string_find_scalar,
+    [CTD_STRING_SEARCH_AVX512] = ctd_string_find_scalar,
+};
+
+const ctd_string_search_function ctd_string_reverse_find_functions[CTD_STRING_SEARCH_LEVEL_COUNT] = {
+    [CTD_STRING_SEARCH_SCALAR] = ctd_string_reverse_find_scalar,
+    [CTD_STRING_SEARCH_SSE2] = ctd_string_reverse_find_scalar,
+    [CTD_STRING_SEARCH_AVX2] = ctd_string_reverse_find_scalar,
+    [CTD_STRING_SEARCH_AVX512] = ctd_string_reverse_find_scalar,
+};
+
+static ctd_string_search_level ctd_string_search_detect_level()
+{
+    return CTD_STRING_SEARCH_SCALAR;
+}
+
+#endif
+
+// -1 until the level is detected. Threads that race to detect it all store the same value
+static _Atomic int ctd_string_search_level_cache = -1;
+
+ctd_string_search_level ctd_string_search_supported_level()
+{
+    int level = atomic_load_explicit(&ctd_string_search_level_cache, memory_order_relaxed);
+    if (level < 0)
+    {
+        level = ctd_string_search_detect_level();
+        atomic_store_explicit(&ctd_string_search_level_cache, level, memory_order_relaxed);
+    }
+    return (ctd_string_search_level)level;
+}
+
+ptrdiff_t ctd_internal_string_find(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    return ctd_string_find_functions[ctd_string_search_supported_level()](haystack, haystack_length, needle, needle_length);
+}
+
+ptrdiff_t ctd_internal_string_reverse_find(const char* haystack, const ptrdiff_t haystack_length, const char* needle, const ptrdiff_t needle_length)
+{
+    return ctd_string_reverse_find_functions[ctd_string_search_supported_level()](haystack, haystack_length, needle, needle_length);
+}
@@ -0,0 +1,586 @@
+#include <ctd_string_searcher.h>
+#include <ctd_internal_string_search.h>
+#include <limits.h>
+#include <stdalign.h>
+#include <string.h>
+
+// Horspool and the SIMD filter hand over to Two-Way once they have compared this many times more bytes than they have
+// moved past
+#define CTD_STRING_SEARCHER_BUDGET 8
+
+/**
+ * Tables for searching in one direction. Searching backwards is searching for the reversed needle in the reversed
+ * haystack, so reverse_find uses the same algorithms with tables built from the reversed needle.
+ */
+typedef struct ctd_string_searcher_direction
+{
+    // Needle in the order it is searched in
+    const unsigned char* needle;
+    // How far the window can move when its last byte is the index, or 0 if it is the last byte of the needle
+    ptrdiff_t shifts[UCHAR_MAX + 1];
+    // How far Horspool can move the window when the hash of its last two bytes is the index
+    ptrdiff_t pair_shifts[UCHAR_MAX + 1];
+    // How far Horspool can move the window when its last two bytes match but the rest of the needle doesn't
+    ptrdiff_t last_pair_shift;
+    // Critical factorization of the needle for Two-Way, which splits it in two at suffix
+    ptrdiff_t suffix;
+    // Period of the needle if it is periodic, otherwise how far the window moves when the left half doesn't match
+    ptrdiff_t period;
+    bool periodic;
+} ctd_string_searcher_direction;
+
+/**
+ * Tables of a searcher for a long needle. The needle and the reversed needle are stored right after them, in the same
+ * block.
+ */
+typedef struct ctd_string_searcher_tables
+{
+    ctd_string_searcher_direction forward;
+    ctd_string_searcher_direction reverse;
+} ctd_string_searcher_tables;
+
+/**
+ * Finds the critical factorization of a needle with two passes for its maximal suffix, one for each order of the
+ * alphabet, and keeps the longer suffix. The needle is split in two at the returned index.
+ *
+ * @param needle Needle to factorize.
+ * @param needle_length Length of the needle.
+ * @param period Set to the period of the right half of the needle.
+ * @return Index the right half starts at.
+ */
+static ptrdiff_t ctd_string_searcher_critical_factorization(const unsigned char* needle, const ptrdiff_t needle_length, ptrdiff_t* period)
+{
+    if (needle_length < 3)
+    {
+        *period = 1;
+        return needle_length - 1;
+    }
+
+    ptrdiff_t max_suffix = -1, j = 0, k = 1, p = 1;
+    while (j + k < needle_length)
+    {
+        const unsigned char a = needle[j + k];
+        const unsigned char b = needle[max_suffix + k];
+        if (a < b)
+        {
+            j += k;
+            k = 1;
+            p = j - max_suffix;
+        }
+        else if (a == b)
+        {
+            if (k != p)
+            {
+                k++;
+            }
+            else
+            {
+                j += p;
+                k = 1;
+            }
+        }
+        else
+        {
+            max_suffix = j++;
+            k = p = 1;
+        }
+    }
+    *period = p;
+
+    ptrdiff_t max_suffix_reverse = -1;
+    j = 0;
+    k = p = 1;
+    while (j + k < needle_length)
+    {
+        const unsigned char a = needle[j + k];
+        const unsigned char b = needle[max_suffix_reverse + k];
+        if (b < a)
+        {
+            j += k;
+            k = 1;
+            p = j - max_suffix_reverse;
+        }
+        else if (a == b)
+        {
+            if (k != p)
+            {
+                k++;
+            }
+            else
+            {
+                j += p;
+                k = 1;
+            }
+        }
+        else
+        {
+            max_suffix_reverse = j++;
+            k = p = 1;
+        }
+    }
+
+    if (max_suffix_reverse < max_suffix)
+    {
+        return max_suffix + 1;
+    }
+    *period = p;
+    return max_suffix_reverse + 1;
+}
+
+static inline ptrdiff_t ctd_string_searcher_pair_hash(const unsigned char first, const unsigned char second)
+{
+    return (second - (first << 3)) & UCHAR_MAX;
+}
+
+static void ctd_string_searcher_direction_create(ctd_string_searcher_direction* direction, const unsigned char* needle, const ptrdiff_t needle_length)
+{
+    direction->needle = needle;
+    for (ptrdiff_t i = 0; i < countof(direction->shifts); i++)
+    {
+        direction->shifts[i] = needle_length;
+    }
+    for (ptrdiff_t i = 0; i < needle_length - 1; i++)
+    {
+        direction->shifts[needle[i]] = needle_length - i - 1;
+    }
+    direction->shifts[needle[needle_length - 1]] = 0;
+
+    // Pairs of bytes are much rarer than bytes, so Horspool skips further by the last two bytes of the window
+    for (ptrdiff_t i = 0; i < countof(direction->pair_shifts); i++)
+    {
+        direction->pair_shifts[i] = needle_length - 1;
+    }
+    for (ptrdiff_t i = 1; i < needle_length - 1; i++)
+    {
+        direction->pair_shifts[ctd_string_searcher_pair_hash(needle[i - 1], needle[i])] = needle_length - i - 1;
+    }
+    // Before the last pair gets its shift of 0, its shift is where it last appears in the rest of the needle
+    const ptrdiff_t last_pair = ctd_string_searcher_pair_hash(needle[needle_length - 2], needle[needle_length - 1]);
+    direction->last_pair_shift = direction->pair_shifts[last_pair];
+    direction->pair_shifts[last_pair] = 0;
+
+    direction->suffix = ctd_string_searcher_critical_factorization(needle, needle_length, &direction->period);
+    direction->periodic = memcmp(needle, needle + direction->period, direction->suffix) == 0;
+    if (!direction->periodic)
+    {
+        direction->period = ctd_max(direction->suffix, needle_length - direction->suffix) + 1;
+    }
+}
+
+// Byte of the haystack at an index of the direction being searched in
+#define CTD_HAYSTACK_AT(index) (((const unsigned char*)haystack)[reverse ? haystack_length - 1 - (index) : (index)])
+
+/**
+ * Two-Way search, starting from a window that is known not to have any matches before it. Every byte of the haystack
+ * is compared at most twice, and the window skips ahead by its last byte whenever it doesn't match the needle's.
+ *
+ * @return Index of the first match in the direction being searched in, or -1 if there isn't one.
+ */
+static inline ptrdiff_t ctd_string_searcher_two_way(const ctd_string_searcher_direction* direction, const char* haystack, const ptrdiff_t haystack_length,
+                                                    const ptrdiff_t needle_length, ptrdiff_t j, const bool reverse)
+{
+    const unsigned char* needle = direction->needle;
+    const ptrdiff_t suffix = direction->suffix;
+    const ptrdiff_t period = direction->period;
+    if (direction->periodic)
+    {
+        // The part of the needle that is already known to match after moving the window by a period
+        ptrdiff_t memory = 0;
+        while (j <= haystack_length - needle_length)
+        {
+            ptrdiff_t shift = direction->shifts[CTD_HAYSTACK_AT(j + needle_length - 1)];
+            if (shift > 0)
+            {
+                if (memory > 0 && shift < period)
+                {
+                    // The last period matched except for one byte, so the next match can only start past it
+                    shift = needle_length - period;
+                }
+                memory = 0;
+                j += shift;
+                continue;
+            }
+
+            ptrdiff_t i = ctd_max(suffix, memory);
+            while (i < needle_length - 1 && needle[i] == CTD_HAYSTACK_AT(i + j))
+            {
+                i++;
+            }
+            if (i < needle_length - 1)
+            {
+                j += i - suffix + 1;
+                memory = 0;
+                continue;
+            }
+            i = suffix - 1;
+            while (i >= memory && needle[i] == CTD_HAYSTACK_AT(i + j))
+            {
+                i--;
+            }
+            if (i < memory)
+            {
+                return j;
+            }
+            j += period;
+            memory = needle_length - period;
+        }
+        return -1;
+    }
+
+    while (j <= haystack_length - needle_length)
+    {
+        const ptrdiff_t shift = direction->shifts[CTD_HAYSTACK_AT(j + needle_length - 1)];
+        if (shift > 0)
+        {
+            j += shift;
+            continue;
+        }
+
+        ptrdiff_t i = suffix;
+        while (i < needle_length - 1 && needle[i] == CTD_HAYSTACK_AT(i + j))
+        {
+            i++;
+        }
+        if (i < needle_length - 1)
+        {
+            j += i - suffix + 1;
+            continue;
+        }
+        i = suffix - 1;
+        while (i >= 0 && needle[i] == CTD_HAYSTACK_AT(i + j))
+        {
+            i--;
+        }
+        if (i < 0)
+        {
+            return j;
+        }
+        j += period;
+    }
+    return -1;
+}
+
+/**
+ * Horspool search by the last two bytes of the window, which compares the whole window with memcmp whenever they match.
+ * That is quadratic when they match often but the rest doesn't, so once it has compared too many bytes for how far it
+ * has gotten the search carries on with Two-Way from where it is.
+ *
+ * @return Index of the first match in the direction being searched in, or -1 if there isn't one.
+ */
+static inline ptrdiff_t ctd_string_searcher_horspool(const ctd_string_searcher_direction* direction, const char* needle, const char* haystack,
+                                                     const ptrdiff_t haystack_length, const ptrdiff_t needle_length, const bool reverse)
+{
+    ptrdiff_t compared = 0;
+    ptrdiff_t j = 0;
+    while (j <= haystack_length - needle_length)
+    {
+        const ptrdiff_t pair = ctd_string_searcher_pair_hash(CTD_HAYSTACK_AT(j + needle_length - 2), CTD_HAYSTACK_AT(j + needle_length - 1));
+        const ptrdiff_t shift = direction->pair_shifts[pair];
+        if (shift > 0)
+        {
+            j += shift;
+            continue;
+        }
+
+        // The window is compared in the original order, so that it is a single memcmp in either direction
+        const ptrdiff_t index = reverse ? haystack_length - j - needle_length : j;
+        if (memcmp(haystack + index, needle, needle_length) == 0)
+        {
+            return j;
+        }
+        j += direction->last_pair_shift;
+        compared += needle_length;
+        if (compared > CTD_STRING_SEARCHER_BUDGET * (j + needle_length))
+        {
+            return ctd_string_searcher_two_way(direction, haystack, haystack_length, needle_length, j, reverse);
+        }
+    }
+    return -1;
+}
+
+#undef CTD_HAYSTACK_AT
+
+/**
+ * Finds the first CTD_STRING_SEARCHER_SHORT_NEEDLE bytes of a long needle with the SIMD kernels, and compares the rest
+ * wherever they are found. Like Horspool, it carries on with Two-Way once it has compared too many bytes.
+ *
+ * @return Index of the first match, or -1 if there isn't one.
+ */
+static ptrdiff_t ctd_string_searcher_filter_find(const ctd_string_searcher_tables* tables, const char* needle, const char* haystack,
+                                                 const ptrdiff_t haystack_length, const ptrdiff_t needle_length)
+{
+    const ptrdiff_t rest_length = needle_length - CTD_STRING_SEARCHER_SHORT_NEEDLE;
+    ptrdiff_t compared = 0;
+    ptrdiff_t j = 0;
+    while (j <= haystack_length - needle_length)
+    {
+        // Only the part of the haystack where the whole needle fits is searched for the prefix
+        const ptrdiff_t index = ctd_internal_string_find(haystack + j, haystack_length - rest_length - j, needle, CTD_STRING_SEARCHER_SHORT_NEEDLE);
+        if (index < 0)
+        {
+            return -1;
+        }
+        j += index;
+        if (memcmp(haystack + j + CTD_STRING_SEARCHER_SHORT_NEEDLE, needle + CTD_STRING_SEARCHER_SHORT_NEEDLE, rest_length) == 0)
+        {
+            return j;
+        }
+        j++;
+        compared += rest_length;
+        if (compared > CTD_STRING_SEARCHER_BUDGET * (j + needle_length))
+        {
+            return ctd_string_searcher_two_way(&tables->forward, haystack, haystack_length, needle_length, j, false);
+        }
+    }
+    return -1;
+}
+
+/**
+ * Finds the last CTD_STRING_SEARCHER_SHORT_NEEDLE bytes of a long needle with the SIMD kernels, and compares the rest
+ * wherever they are found.
+ *
+ * @return Index of the last match, or -1 if there isn't one.
+ */
+static ptrdiff_t ctd_string_searcher_filter_reverse_find(const ctd_string_searcher_tables* tables, const char* needle, const char* haystack,
+                                                         const ptrdiff_t haystack_length, const ptrdiff_t needle_length)
+{
+    const ptrdiff_t rest_length = needle_length - CTD_STRING_SEARCHER_SHORT_NEEDLE;
+    ptrdiff_t compared = 0;
+    // Matches have to end by end, which moves back past every window that didn't match
+    ptrdiff_t end = haystack_length;
+    while (end >= needle_length)
+    {
+        const ptrdiff_t index = ctd_internal_string_reverse_find(haystack + rest_length, end - rest_length, needle + rest_length, CTD_STRING_SEARCHER_SHORT_NEEDLE);
+        if (index < 0)
+        {
+            return -1;
+        }
+        if (memcmp(haystack + index, needle, rest_length) == 0)
+        {
+            return index;
+        }
+        end = index + needle_length - 1;
+        compared += rest_length;
+        if (compared > CTD_STRING_SEARCHER_BUDGET * (haystack_length - end + needle_length))
+        {
+            // Two-Way searches the reversed haystack, where the windows that are left start at haystack_length - end
+            const ptrdiff_t reverse_index = ctd_string_searcher_two_way(&tables->reverse, haystack, haystack_length, needle_length, haystack_length - end, true);
+            return reverse_index < 0 ? -1 : haystack_length - reverse_index - needle_length;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @return Index of the first match, or of the last one if reverse is true, or -1 if there isn't one. The haystack must
+ * be at least as long as the needle, and the needle must not be empty.
+ */
+static ptrdiff_t ctd_string_searcher_search(const ctd_string_searcher* self, const char* haystack, const ptrdiff_t haystack_length, const bool reverse)
+{
+    const ptrdiff_t needle_length = self->needle.length;
+    if (self->algorithm == CTD_STRING_SEARCHER_SIMD && needle_length <= CTD_STRING_SEARCHER_SHORT_NEEDLE)
+    {
+        return reverse ? ctd_internal_string_reverse_find(haystack, haystack_length, self->needle.data, needle_length)
+                       : ctd_internal_string_find(haystack, haystack_length, self->needle.data, needle_length);
+    }
+
+    const ctd_string_searcher_tables* tables = self->tables;
+    if (self->algorithm == CTD_STRING_SEARCHER_SIMD)
+    {
+        return reverse ? ctd_string_searcher_filter_reverse_find(tables, self->needle.data, haystack, haystack_length, needle_length)
+                       : ctd_string_searcher_filter_find(tables, self->needle.data, haystack, haystack_length, needle_length);
+    }
+    const ctd_string_searcher_direction* direction = reverse ? &tables->reverse : &tables->forward;
+    ptrdiff_t index;
+    if (self->algorithm == CTD_STRING_SEARCHER_HORSPOOL)
+    {
+        index = reverse ? ctd_string_searcher_horspool(direction, self->needle.data, haystack, haystack_length, needle_length, true)
+                        : ctd_string_searcher_horspool(direction, self->needle.data, haystack, haystack_length, needle_length, false);
+    }
+    else
+    {
+        index = reverse ? ctd_string_searcher_two_way(direction, haystack, haystack_length, needle_length, 0, true)
+                        : ctd_string_searcher_two_way(direction, haystack, haystack_length, needle_length, 0, false);
+    }
+    if (index < 0 || !reverse)
+    {
+        return index;
+    }
+    return haystack_length - index - needle_length;
+}
+
+/**
+ * Creates a searcher for a needle, choosing how to search for it from its length and how many different bytes it has.
+ *
+ * @param needle String to be searched for. It is copied into the searcher.
+ * @param allocator Allocator used for the copy of the needle and the tables.
+ * @param error Pointer to error struct.
+ * @return Searcher for the needle, or an empty searcher if allocation failed.
+ */
+ctd_string_searcher ctd_string_searcher_create(ctd_string needle, ctd_allocator* allocator, ctd_error* error)
+{
+    ctd_string_searcher searcher = {.allocator = allocator, .algorithm = CTD_STRING_SEARCHER_SIMD};
+    if (needle.length == 0)
+    {
+        // An empty needle is never found, so it needs nothing to be found with
+        return searcher;
+    }
+    if (needle.length <= CTD_STRING_SEARCHER_SHORT_NEEDLE)
+    {
+        searcher.tables_size = needle.length;
+        searcher.tables = allocator->allocate(allocator->context, searcher.tables_size, alignof(char));
+        if (searcher.tables == NULL)
+        {
+            error->error_type = ALLOCATION_FAIL;
+            error->error_message = "Allocation of ctd_string_searcher failed.";
+
+            return (ctd_string_searcher) {0};
+        }
+        memcpy(searcher.tables, needle.data, needle.length);
+        searcher.needle = (ctd_string) {.data = searcher.tables, .length = needle.length};
+        return searcher;
+    }
+
+    searcher.tables_size = sizeof(ctd_string_searcher_tables) + 2 * needle.length;
+    searcher.tables = allocator->allocate(allocator->context, searcher.tables_size, alignof(ctd_string_searcher_tables));
+    if (searcher.tables == NULL)
+    {
+        error->error_type = ALLOCATION_FAIL;
+        error->error_message = "Allocation of ctd_string_searcher failed.";
+
+        return (ctd_string_searcher) {0};
+    }
+    ctd_string_searcher_tables* tables = searcher.tables;
+    unsigned char* forward_needle = (unsigned char*)(tables + 1);
+    unsigned char* reverse_needle = forward_needle + needle.length;
+    memcpy(forward_needle, needle.data, needle.length);
+    bool seen[UCHAR_MAX + 1] = {0};
+    ptrdiff_t alphabet_size = 0;
+    for (ptrdiff_t i = 0; i < needle.length; i++)
+    {
+        reverse_needle[i] = forward_needle[needle.length - 1 - i];
+        alphabet_size += !seen[forward_needle[i]];
+        seen[forward_needle[i]] = true;
+    }
+    ctd_string_searcher_direction_create(&tables->forward, forward_needle, needle.length);
+    ctd_string_searcher_direction_create(&tables->reverse, reverse_needle, needle.length);
+
+    searcher.needle = (ctd_string) {.data = (char*)forward_needle, .length = needle.length};
+    if (alphabet_size < CTD_STRING_SEARCHER_MIN_ALPHABET)
+    {
+        searcher.algorithm = CTD_STRING_SEARCHER_TWO_WAY;
+    }
+    else if (needle.length >= CTD_STRING_SEARCHER_LONG_NEEDLE)
+    {
+        searcher.algorithm = CTD_STRING_SEARCHER_HORSPOOL;
+    }
+    return searcher;
+}
+
+void ctd_string_searcher_destroy(ctd_string_searcher* self)
+{
+    if (self->tables != NULL)
+    {
+        self->allocator->deallocate(self->allocator->context, self->tables, self->tables_size);
+    }
+
+    *self = (ctd_string_searcher) {0};
+}
+
+/**
+ * Finds the first instance of the searcher's needle in a string.
+ *
+ * @param self Searcher for the needle.
+ * @param str String to be searched.
+ * @param start Where search starts.
+ * @param error Pointer to error struct.
+ * @return Index of the needle, if it was found.
+ */
+ctd_option(ptrdiff_t) ctd_string_searcher_find(const ctd_string_searcher* self, ctd_string str, ptrdiff_t start, ctd_error* error)
+{
+    if (start >= str.length)
+    {
+        error->error_type = INVALID_ARGUMENT;
+        error->error_message = "Starting index was greater than or equal to string's length.";
+
+        return NONE(ptrdiff_t);
+    }
+
+    if (str.length - start < self->needle.length || self->needle.length == 0)
+    {
+        return NONE(ptrdiff_t);
+    }
+    const ptrdiff_t index = ctd_string_searcher_search(self, str.data + start, str.length - start, false);
+    if (index < 0)
+    {
+        return NONE(ptrdiff_t);
+    }
+    return SOME(ptrdiff_t, start + index);
+}
+
+/**
+ * Finds the last instance of the searcher's needle in a string.
+ *
+ * @param self Searcher for the needle.
+ * @param str String to be searched.
+ * @param end Where search ends. Exclusive.
+ * @param error Pointer to error struct.
+ * @return Index of the needle, if it was found.
+ */
+ctd_option(ptrdiff_t) ctd_string_searcher_reverse_find(const ctd_string_searcher* self, ctd_string str, ptrdiff_t end, ctd_error* error)
+{
+    if (end > str.length)
+    {
+        error->error_type = INVALID_ARGUMENT;
+        error->error_message = "End was greater than string length in ctd_string_searcher_reverse_find";
+
+        return NONE(ptrdiff_t);
+    }
+
+    if (end < self->needle.length || self->needle.length == 0)
+    {
+        return NONE(ptrdiff_t);
+    }
+    const ptrdiff_t index = ctd_string_searcher_search(self, str.data, end, true);
+    if (index < 0)
+    {
+        return NONE(ptrdiff_t);
+    }
+    return SOME(ptrdiff_t, index);
+}
+
+/**
+ * Finds every instance of the searcher's needle in a string, from left to right. Instances don't overlap, so the search
+ * for the next one starts right after the end of the last one.
+ *
+ * @param self Searcher for the needle.
+ * @param str String to be searched.
+ * @param callback Called with the index of every instance, until it returns false. Can be NULL to only count them.
+ * @param user_data Passed to the callback.
+ * @return Number of instances found, including the one the callback stopped the search at.
+ */
+ptrdiff_t ctd_string_searcher_find_all(const ctd_string_searcher* self, ctd_string str, ctd_string_searcher_callback callback, void* user_data)
+{
+    const ptrdiff_t needle_length = self->needle.length;
+    if (needle_length == 0)
+    {
+        return 0;
+    }
+    ptrdiff_t count = 0;
+    ptrdiff_t start = 0;
+    while (str.length - start >= needle_length)
+    {
+        const ptrdiff_t index = ctd_string_searcher_search(self, str.data + start, str.length - start, false);
+        if (index < 0)
+        {
+            break;
+        }
+        count++;
+        if (callback != NULL && !callback(user_data, start + index))
+        {
+            break;
+        }
+        start += index + needle_length;
+    }
+    return count;
+}
@@ -0,0 +1,366 @@
+#include <ctd_thread_cache_allocator.h>
+#include <ctd_internal_size_classes.h>
+#include <ctd_define.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <string.h>
+
+typedef struct ctd_thread_cache_magazine
+{
+    void* blocks[CTD_THREAD_CACHE_MAGAZINE_SIZE];
+    ptrdiff_t length;
+} ctd_thread_cache_magazine;
+
+typedef struct ctd_thread_cache_context ctd_thread_cache_context;
+
+/**
+ * Blocks cached by a single thread. Every thread cache of an allocator is kept in a list, so that destroying the
+ * allocator can return the blocks of threads that are still running.
+ */
+typedef struct ctd_thread_cache
+{
+    ctd_thread_cache_magazine magazines[CTD_SIZE_CLASS_COUNT];
+    ctd_thread_cache_context* owner;
+    struct ctd_thread_cache* previous;
+    struct ctd_thread_cache* next;
+} ctd_thread_cache;
+
+struct ctd_thread_cache_context
+{
+    unsigned char class_lookup[CTD_SIZE_CLASS_LOOKUP_LENGTH];
+    pthread_key_t thread_cache_key;
+    // Guards everything below it, as well as every use of the backing allocator
+    pthread_mutex_t lock;
+    ctd_allocator* backing_allocator;
+    ctd_thread_cache* thread_caches;
+    ptrdiff_t lock_acquisitions;
+};
+
+/**
+ * Alignment every cached block of a size class has. Blocks are taken from the backing allocator with this alignment,
+ * which is capped at alignof(max_align_t) so that the backing allocator can hand them out cheaply.
+ */
+static inline ptrdiff_t ctd_thread_cache_class_alignment(const ptrdiff_t class_index)
+{
+    return ctd_min(ctd_size_class_alignment(class_index), alignof(max_align_t));
+}
+
+static inline void ctd_thread_cache_lock(ctd_thread_cache_context* thread_cache_context)
+{
+    pthread_mutex_lock(&thread_cache_context->lock);
+    thread_cache_context->lock_acquisitions++;
+}
+
+static inline void ctd_thread_cache_unlock(ctd_thread_cache_context* thread_cache_context)
+{
+    pthread_mutex_unlock(&thread_cache_context->lock);
+}
+
+/**
+ * Returns up to count blocks from the top of a magazine to the backing allocator. The lock must be held.
+ *
+ * @param thread_cache_context Context of thread cache allocator
+ * @param magazine Magazine to be flushed
+ * @param class_index Size class of the magazine
+ * @param count Number of blocks to flush
+ */
+static void flush_magazine(ctd_thread_cache_context* thread_cache_context, ctd_thread_cache_magazine* magazine, const ptrdiff_t class_index, const ptrdiff_t count)
+{
+    ctd_allocator* backing_allocator = thread_cache_context->backing_allocator;
+    const ptrdiff_t class_size = ctd_size_classes[class_index];
+    const ptrdiff_t end = ctd_max(magazine->length - count, 0);
+    for (ptrdiff_t i = magazine->length - 1; i >= end; i--)
+    {
+        backing_allocator->deallocate(backing_allocator->context, magazine->blocks[i], class_size);
+    }
+    magazine->length = end;
+}
+
+/**
+ * Returns every block of a thread cache to the backing allocator, unlinks it and frees it. The lock must be held.
+ *
+ * @param thread_cache Thread cache to be released
+ */
+static void release_thread_cache(ctd_thread_cache* thread_cache)
+{
+    ctd_thread_cache_context* thread_cache_context = thread_cache->owner;
+    ctd_allocator* backing_allocator = thread_cache_context->backing_allocator;
+    for (ptrdiff_t i = 0; i < CTD_SIZE_CLASS_COUNT; i++)
+    {
+        flush_magazine(thread_cache_context, &thread_cache->magazines[i], i, CTD_THREAD_CACHE_MAGAZINE_SIZE);
+    }
+
+    if (thread_cache->previous != NULL)
+    {
+        thread_cache->previous->next = thread_cache->next;
+    }
+    else
+    {
+        thread_cache_context->thread_caches = thread_cache->next;
+    }
+    if (thread_cache->next != NULL)
+    {
+        thread_cache->next->previous = thread_cache->previous;
+    }
+    backing_allocator->deallocate(backing_allocator->context, thread_cache, sizeof(ctd_thread_cache));
+}
+
+/**
+ * Runs when a thread that used the allocator exits.
+ *
+ * @param thread_cache Thread cache of the exiting thread
+ */
+static void ctd_thread_cache_destructor(void* thread_cache)
+{
+    ctd_thread_cache_context* thread_cache_context = ((ctd_thread_cache*)thread_cache)->owner;
+    ctd_thread_cache_lock(thread_cache_context);
+    release_thread_cache(thread_cache);
+    ctd_thread_cache_unlock(thread_cache_context);
+}
+
+/**
+ * Gets the calling thread's cache, creating it the first time the thread uses the allocator.
+ *
+ * @param thread_cache_context Context of thread cache allocator
+ * @return The thread's cache, or NULL if it couldn't be created.
+ */
+static inline ctd_thread_cache* get_thread_cache(ctd_thread_cache_context* thread_cache_context)
+{
+    ctd_thread_cache* thread_cache = pthread_getspecific(thread_cache_context->thread_cache_key);
+    if (thread_cache != NULL)
+    {
+        return thread_cache;
+    }
+
+    ctd_thread_cache_lock(thread_cache_context);
+    ctd_allocator* backing_allocator = thread_cache_context->backing_allocator;
+    thread_cache = backing_allocator->allocate(backing_allocator->context, sizeof(ctd_thread_cache), alignof(ctd_thread_cache));
+    if (thread_cache != NULL)
+    {
+        *thread_cache = (ctd_thread_cache) {0};
+        thread_cache->owner = thread_cache_context;
+        thread_cache->next = thread_cache_context->thread_caches;
+        if (thread_cache->next != NULL)
+        {
+            thread_cache->next->previous = thread_cache;
+        }
+        thread_cache_context->thread_caches = thread_cache;
+        if (pthread_setspecific(thread_cache_context->thread_cache_key, thread_cache) != 0)
+        {
+            release_thread_cache(thread_cache);
+            thread_cache = NULL;
+        }
+    }
+    ctd_thread_cache_unlock(thread_cache_context);
+
+    return thread_cache;
+}
+
+/**
+ * Allocates directly from the backing allocator under the lock.
+ */
+static void* allocate_locked(ctd_thread_cache_context* thread_cache_context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ctd_allocator* backing_allocator = thread_cache_context->backing_allocator;
+    ctd_thread_cache_lock(thread_cache_context);
+    void* ptr = backing_allocator->allocate(backing_allocator->context, size, align);
+    ctd_thread_cache_unlock(thread_cache_context);
+
+    return ptr;
+}
+
+/**
+ * Allocates memory from a thread cache allocator. Small requests are served from the calling thread's magazine, which
+ * is refilled with a batch of blocks from the backing allocator when it runs empty.
+ *
+ * @param context Context of thread cache allocator
+ * @param size Size of memory to be allocated in bytes
+ * @param align Alignment of memory to be allocated
+ * @return Pointer to allocated memory if allocation is successful, otherwise returns NULL.
+ */
+static void* ctd_thread_cache_allocator_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ctd_thread_cache_context* thread_cache_context = context;
+    if (size > CTD_MAX_SIZE_CLASS)
+    {
+        return allocate_locked(thread_cache_context, size, align);
+    }
+    const ptrdiff_t class_index = ctd_size_class_lookup(thread_cache_context->class_lookup, size);
+    // Over-aligned blocks are still taken at their class size, so they can join a magazine once they're freed
+    if (align > ctd_thread_cache_class_alignment(class_index))
+    {
+        return allocate_locked(thread_cache_context, ctd_size_classes[class_index], align);
+    }
+
+    ctd_thread_cache* thread_cache = get_thread_cache(thread_cache_context);
+    if (thread_cache == NULL) return NULL;
+    ctd_thread_cache_magazine* magazine = &thread_cache->magazines[class_index];
+    if (magazine->length > 0)
+    {
+        magazine->length--;
+        return magazine->blocks[magazine->length];
+    }
+
+    ctd_allocator* backing_allocator = thread_cache_context->backing_allocator;
+    const ptrdiff_t class_size = ctd_size_classes[class_index];
+    const ptrdiff_t class_alignment = ctd_thread_cache_class_alignment(class_index);
+    ctd_thread_cache_lock(thread_cache_context);
+    for (ptrdiff_t i = 0; i < CTD_THREAD_CACHE_BATCH_SIZE; i++)
+    {
+        void* block = backing_allocator->allocate(backing_allocator->context, class_size, class_alignment);
+        if (block == NULL) break;
+        magazine->blocks[magazine->length] = block;
+        magazine->length++;
+    }
+    ctd_thread_cache_unlock(thread_cache_context);
+
+    if (magazine->length == 0) return NULL;
+    magazine->length--;
+    return magazine->blocks[magazine->length];
+}
+
+/**
+ * Deallocates a region of memory by putting it into the calling thread's magazine. If the magazine is full, a batch of
+ * blocks is returned to the backing allocator first.
+ *
+ * @param context Context of thread cache allocator
+ * @param block Pointer to memory to be deallocated
+ * @param size Size of memory to be deallocated
+ */
+static void ctd_thread_cache_allocator_deallocate(void* context, void* block, const ptrdiff_t size)
+{
+    ctd_thread_cache_context* thread_cache_context = context;
+    ctd_allocator* backing_allocator = thread_cache_context->backing_allocator;
+    const ptrdiff_t class_index = size > CTD_MAX_SIZE_CLASS ? -1 : ctd_size_class_lookup(thread_cache_context->class_lookup, size);
+    ctd_thread_cache* thread_cache = class_index == -1 ? NULL : get_thread_cache(thread_cache_context);
+    if (thread_cache == NULL)
+    {
+        ctd_thread_cache_lock(thread_cache_context);
+        backing_allocator->deallocate(backing_allocator->context, block, class_index == -1 ? size : ctd_size_classes[class_index]);
+        ctd_thread_cache_unlock(thread_cache_context);
+
+        return;
+    }
+
+    ctd_thread_cache_magazine* magazine = &thread_cache->magazines[class_index];
+    if (magazine->length == CTD_THREAD_CACHE_MAGAZINE_SIZE)
+    {
+        ctd_thread_cache_lock(thread_cache_context);
+        flush_magazine(thread_cache_context, magazine, class_index, CTD_THREAD_CACHE_BATCH_SIZE);
+        ctd_thread_cache_unlock(thread_cache_context);
+    }
+    magazine->blocks[magazine->length] = block;
+    magazine->length++;
+}
+
+/**
+ * Reallocates a region of memory. If the old and new sizes fall into the same size class the block is returned as is,
+ * otherwise the data is copied into a new block and the old block is deallocated.
+ *
+ * @param context Thread cache allocator's context
+ * @param source Pointer to the memory to be reallocated
+ * @param old_size The size of the memory to be reallocated
+ * @param new_size The size the memory will be reallocated to
+ * @param align The alignment of the region of memory
+ * @return Pointer to the reallocated memory if reallocation succeeds, otherwise returns NULL pointer.
+ */
+static void* ctd_thread_cache_allocator_reallocate(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align)
+{
+    ctd_thread_cache_context* thread_cache_context = context;
+    if (old_size > CTD_MAX_SIZE_CLASS && new_size > CTD_MAX_SIZE_CLASS)
+    {
+        ctd_allocator* backing_allocator = thread_cache_context->backing_allocator;
+        ctd_thread_cache_lock(thread_cache_context);
+        void* destination = backing_allocator->reallocate(backing_allocator->context, source, old_size, new_size, align);
+        ctd_thread_cache_unlock(thread_cache_context);
+
+        return destination;
+    }
+    if (old_size <= CTD_MAX_SIZE_CLASS && new_size <= CTD_MAX_SIZE_CLASS &&
+        ctd_size_class_lookup(thread_cache_context->class_lookup, old_size) == ctd_size_class_lookup(thread_cache_context->class_lookup, new_size))
+    {
+        return source;
+    }
+
+    void* destination = ctd_thread_cache_allocator_allocate(context, new_size, align);
+    if (destination == NULL) return NULL;
+
+    memcpy(destination, source, ctd_min(old_size, new_size));
+    ctd_thread_cache_allocator_deallocate(context, source, old_size);
+
+    return destination;
+}
+
+ctd_thread_cache_allocator ctd_thread_cache_allocator_create(ctd_allocator* backing_allocator)
+{
+    ctd_thread_cache_allocator thread_cache_allocator = {0};
+    ctd_thread_cache_context* context = backing_allocator->allocate(backing_allocator->context, sizeof(ctd_thread_cache_context), alignof(ctd_thread_cache_context));
+    if (context == NULL) goto context_alloc_failed_cleanup;
+    *context = (ctd_thread_cache_context) {0};
+
+    if (pthread_key_create(&context->thread_cache_key, ctd_thread_cache_destructor) != 0) goto key_create_failed_cleanup;
+    if (pthread_mutex_init(&context->lock, NULL) != 0) goto mutex_init_failed_cleanup;
+    context->backing_allocator = backing_allocator;
+    ctd_size_class_fill_lookup(context->class_lookup);
+
+    thread_cache_allocator.allocator.allocate = ctd_thread_cache_allocator_allocate;
+    thread_cache_allocator.allocator.reallocate = ctd_thread_cache_allocator_reallocate;
+    thread_cache_allocator.allocator.deallocate = ctd_thread_cache_allocator_deallocate;
+    thread_cache_allocator.allocator.context = context;
+
+    return thread_cache_allocator;
+
+mutex_init_failed_cleanup:
+    pthread_key_delete(context->thread_cache_key);
+key_create_failed_cleanup:
+    backing_allocator->deallocate(backing_allocator->context, context, sizeof(ctd_thread_cache_context));
+context_alloc_failed_cleanup:
+    return (ctd_thread_cache_allocator) {0};
+}
+
+void ctd_thread_cache_allocator_destroy(ctd_thread_cache_allocator* self)
+{
+    ctd_thread_cache_context* context = self->allocator.context;
+    ctd_allocator* backing_allocator = context->backing_allocator;
+
+    // Deleting the key first means exiting threads no longer run the destructor on caches that are about to be freed
+    pthread_key_delete(context->thread_cache_key);
+    pthread_mutex_lock(&context->lock);
+    while (context->thread_caches != NULL)
+    {
+        release_thread_cache(context->thread_caches);
+    }
+    pthread_mutex_unlock(&context->lock);
+    pthread_mutex_destroy(&context->lock);
+    backing_allocator->deallocate(backing_allocator->context, context, sizeof(ctd_thread_cache_context));
+
+    *self = (ctd_thread_cache_allocator) {0};
+}
+
+void ctd_thread_cache_allocator_flush(ctd_thread_cache_allocator* self)
+{
+    ctd_thread_cache_context* context = self->allocator.context;
+    ctd_thread_cache* thread_cache = pthread_getspecific(context->thread_cache_key);
+    if (thread_cache == NULL)
+    {
+        return;
+    }
+
+    ctd_thread_cache_lock(context);
+    for (ptrdiff_t i = 0; i < CTD_SIZE_CLASS_COUNT; i++)
+    {
+        flush_magazine(context, &thread_cache->magazines[i], i, CTD_THREAD_CACHE_MAGAZINE_SIZE);
+    }
+    ctd_thread_cache_unlock(context);
+}
+
+ptrdiff_t ctd_thread_cache_allocator_lock_acquisitions(ctd_thread_cache_allocator* self)
+{
+    ctd_thread_cache_context* context = self->allocator.context;
+    pthread_mutex_lock(&context->lock);
+    const ptrdiff_t lock_acquisitions = context->lock_acquisitions;
+    pthread_mutex_unlock(&context->lock);
+
+    return lock_acquisitions;
+}
@@ -0,0 +1,444 @@
+#include <ctd_tlsf_allocator.h>
+#include <ctd_define.h>
+#include <ctd_scrub.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CTD_TLSF_ALIGNMENT_LOG2 4
+#define CTD_TLSF_ALIGNMENT ((ptrdiff_t)1 << CTD_TLSF_ALIGNMENT_LOG2)
+// Sizes below this all share the first list of the first level, split linearly by CTD_TLSF_ALIGNMENT
+#define CTD_TLSF_FIRST_LEVEL_SHIFT (CTD_TLSF_SECOND_LEVEL_COUNT_LOG2 + CTD_TLSF_ALIGNMENT_LOG2)
+#define CTD_TLSF_SMALL_BLOCK_SIZE ((ptrdiff_t)1 << CTD_TLSF_FIRST_LEVEL_SHIFT)
+#define CTD_TLSF_FIRST_LEVEL_COUNT (62 - CTD_TLSF_FIRST_LEVEL_SHIFT + 1)
+
+#define CTD_TLSF_BLOCK_FREE 1
+#define CTD_TLSF_PREVIOUS_BLOCK_FREE 2
+#define CTD_TLSF_FLAGS (CTD_TLSF_BLOCK_FREE | CTD_TLSF_PREVIOUS_BLOCK_FREE)
+
+_Static_assert(alignof(max_align_t) <= CTD_TLSF_ALIGNMENT, "TLSF blocks must be aligned for any type");
+
+/**
+ * Header in front of every block. The free list pointers overlap the start of the block's memory, so they only take up
+ * room while the block is free, which is also why no block is smaller than CTD_TLSF_MIN_BLOCK_SIZE.
+ */
+typedef struct ctd_tlsf_block
+{
+    // Only valid while the previous block is free, so that the block can be merged with it
+    struct ctd_tlsf_block* previous_physical;
+    // Size of the block's memory, which is always a multiple of CTD_TLSF_ALIGNMENT, with the flags in its low bits
+    ptrdiff_t size;
+    struct ctd_tlsf_block* next_free;
+    struct ctd_tlsf_block* previous_free;
+} ctd_tlsf_block;
+
+#define CTD_TLSF_HEADER_SIZE ((ptrdiff_t)offsetof(ctd_tlsf_block, next_free))
+#define CTD_TLSF_MIN_BLOCK_SIZE (sizeof(ctd_tlsf_block) - CTD_TLSF_HEADER_SIZE)
+
+typedef struct ctd_tlsf_context
+{
+    // Bit n is set when second_level_bitmaps[n] isn't empty, and bit m of second_level_bitmaps[n] is set when
+    // free_lists[n][m] isn't empty
+    uint64_t first_level_bitmap;
+    uint32_t second_level_bitmaps[CTD_TLSF_FIRST_LEVEL_COUNT];
+    ctd_tlsf_block* free_lists[CTD_TLSF_FIRST_LEVEL_COUNT][CTD_TLSF_SECOND_LEVEL_COUNT];
+    char* data;
+    ptrdiff_t size;
+    ptrdiff_t free_bytes;
+    ctd_allocator* allocator;
+    // Used outside of reallocate and deallocate, which are specialized for the scrub policy instead
+    ctd_scrub_function scrub;
+} ctd_tlsf_context;
+
+static inline ptrdiff_t ctd_tlsf_block_size(const ctd_tlsf_block* block)
+{
+    return block->size & ~(ptrdiff_t)CTD_TLSF_FLAGS;
+}
+
+static inline void ctd_tlsf_block_set_size(ctd_tlsf_block* block, const ptrdiff_t size)
+{
+    block->size = size | (block->size & CTD_TLSF_FLAGS);
+}
+
+static inline char* ctd_tlsf_block_memory(ctd_tlsf_block* block)
+{
+    return (char*)block + CTD_TLSF_HEADER_SIZE;
+}
+
+static inline ctd_tlsf_block* ctd_tlsf_block_from_memory(void* memory)
+{
+    return (ctd_tlsf_block*)((char*)memory - CTD_TLSF_HEADER_SIZE);
+}
+
+static inline ctd_tlsf_block* ctd_tlsf_block_next(ctd_tlsf_block* block)
+{
+    return (ctd_tlsf_block*)(ctd_tlsf_block_memory(block) + ctd_tlsf_block_size(block));
+}
+
+static inline ptrdiff_t ctd_tlsf_round_size(const ptrdiff_t size)
+{
+    return (ctd_max(size, CTD_TLSF_MIN_BLOCK_SIZE) + CTD_TLSF_ALIGNMENT - 1) & ~(CTD_TLSF_ALIGNMENT - 1);
+}
+
+/**
+ * Finds the list a free block of a given size belongs in.
+ */
+static inline void ctd_tlsf_mapping(const ptrdiff_t size, int* first_level, int* second_level)
+{
+    if (size < CTD_TLSF_SMALL_BLOCK_SIZE)
+    {
+        *first_level = 0;
+        *second_level = (int)(size / (CTD_TLSF_SMALL_BLOCK_SIZE / CTD_TLSF_SECOND_LEVEL_COUNT));
+        return;
+    }
+    const int highest_bit = 63 - __builtin_clzll((unsigned long long)size);
+    *second_level = (int)(size >> (highest_bit - CTD_TLSF_SECOND_LEVEL_COUNT_LOG2)) ^ CTD_TLSF_SECOND_LEVEL_COUNT;
+    *first_level = highest_bit - (CTD_TLSF_FIRST_LEVEL_SHIFT - 1);
+}
+
+/**
+ * Finds the first list whose blocks are all at least size bytes. Rounding size up to the next list boundary means any
+ * block found there fits, so the list never has to be searched.
+ */
+static inline void ctd_tlsf_mapping_search(ptrdiff_t size, int* first_level, int* second_level)
+{
+    if (size >= CTD_TLSF_SMALL_BLOCK_SIZE)
+    {
+        const int highest_bit = 63 - __builtin_clzll((unsigned long long)size);
+        size += ((ptrdiff_t)1 << (highest_bit - CTD_TLSF_SECOND_LEVEL_COUNT_LOG2)) - 1;
+    }
+    ctd_tlsf_mapping(size, first_level, second_level);
+}
+
+/**
+ * Finds a free block of at least size bytes. If no list has blocks that are all big enough, the first block of the
+ * list size itself maps to is checked as well, which still fits sometimes, e.g. when a request takes the whole region.
+ */
+static ctd_tlsf_block* ctd_tlsf_find_free_block(const ctd_tlsf_context* tlsf, const ptrdiff_t size)
+{
+    int first_level;
+    int second_level;
+    ctd_tlsf_mapping_search(size, &first_level, &second_level);
+    if (first_level < CTD_TLSF_FIRST_LEVEL_COUNT)
+    {
+        uint32_t second_level_map = tlsf->second_level_bitmaps[first_level] & (~(uint32_t)0 << second_level);
+        if (second_level_map == 0)
+        {
+            const uint64_t first_level_map = tlsf->first_level_bitmap & (~(uint64_t)0 << (first_level + 1));
+            if (first_level_map != 0)
+            {
+                first_level = __builtin_ctzll(first_level_map);
+                second_level_map = tlsf->second_level_bitmaps[first_level];
+            }
+        }
+        if (second_level_map != 0)
+        {
+            return tlsf->free_lists[first_level][__builtin_ctz(second_level_map)];
+        }
+    }
+
+    ctd_tlsf_mapping(size, &first_level, &second_level);
+    ctd_tlsf_block* block = tlsf->free_lists[first_level][second_level];
+    return block != NULL && ctd_tlsf_block_size(block) >= size ? block : NULL;
+}
+
+static void ctd_tlsf_insert_free_block(ctd_tlsf_context* tlsf, ctd_tlsf_block* block)
+{
+    int first_level;
+    int second_level;
+    ctd_tlsf_mapping(ctd_tlsf_block_size(block), &first_level, &second_level);
+
+    block->previous_free = NULL;
+    block->next_free = tlsf->free_lists[first_level][second_level];
+    if (block->next_free != NULL)
+    {
+        block->next_free->previous_free = block;
+    }
+    tlsf->free_lists[first_level][second_level] = block;
+    tlsf->first_level_bitmap |= (uint64_t)1 << first_level;
+    tlsf->second_level_bitmaps[first_level] |= (uint32_t)1 << second_level;
+    tlsf->free_bytes += ctd_tlsf_block_size(block);
+}
+
+static void ctd_tlsf_remove_free_block(ctd_tlsf_context* tlsf, ctd_tlsf_block* block)
+{
+    int first_level;
+    int second_level;
+    ctd_tlsf_mapping(ctd_tlsf_block_size(block), &first_level, &second_level);
+
+    if (block->previous_free != NULL)
+    {
+        block->previous_free->next_free = block->next_free;
+    }
+    else
+    {
+        tlsf->free_lists[first_level][second_level] = block->next_free;
+    }
+    if (block->next_free != NULL)
+    {
+        block->next_free->previous_free = block->previous_free;
+    }
+    if (tlsf->free_lists[first_level][second_level] == NULL)
+    {
+        tlsf->second_level_bitmaps[first_level] &= ~((uint32_t)1 << second_level);
+        if (tlsf->second_level_bitmaps[first_level] == 0)
+        {
+            tlsf->first_level_bitmap &= ~((uint64_t)1 << first_level);
+        }
+    }
+    tlsf->free_bytes -= ctd_tlsf_block_size(block);
+}
+
+/**
+ * Frees a block that isn't in a free list, merging it with its neighbours if they are free. Free blocks are always
+ * merged straight away, so a free block never has a free neighbour, and at most two merges are needed.
+ */
+static void ctd_tlsf_release_block(ctd_tlsf_context* tlsf, ctd_tlsf_block* block)
+{
+    if (block->size & CTD_TLSF_PREVIOUS_BLOCK_FREE)
+    {
+        ctd_tlsf_block* previous = block->previous_physical;
+        ctd_tlsf_remove_free_block(tlsf, previous);
+        ctd_tlsf_block_set_size(previous, ctd_tlsf_block_size(previous) + CTD_TLSF_HEADER_SIZE + ctd_tlsf_block_size(block));
+        block = previous;
+    }
+    ctd_tlsf_block* next = ctd_tlsf_block_next(block);
+    if (next->size & CTD_TLSF_BLOCK_FREE)
+    {
+        ctd_tlsf_remove_free_block(tlsf, next);
+        ctd_tlsf_block_set_size(block, ctd_tlsf_block_size(block) + CTD_TLSF_HEADER_SIZE + ctd_tlsf_block_size(next));
+    }
+
+    block->size |= CTD_TLSF_BLOCK_FREE;
+    next = ctd_tlsf_block_next(block);
+    next->previous_physical = block;
+    next->size |= CTD_TLSF_PREVIOUS_BLOCK_FREE;
+    ctd_tlsf_insert_free_block(tlsf, block);
+}
+
+/**
+ * Cuts a used block down to size bytes, and frees the rest of it if that is big enough to be a block of its own.
+ */
+static void ctd_tlsf_trim_block(ctd_tlsf_context* tlsf, ctd_tlsf_block* block, const ptrdiff_t size)
+{
+    const ptrdiff_t remaining_size = ctd_tlsf_block_size(block) - size - CTD_TLSF_HEADER_SIZE;
+    if (remaining_size < CTD_TLSF_MIN_BLOCK_SIZE)
+    {
+        return;
+    }
+    ctd_tlsf_block* remainder = (ctd_tlsf_block*)(ctd_tlsf_block_memory(block) + size);
+    remainder->size = remaining_size;
+    ctd_tlsf_block_set_size(block, size);
+    ctd_tlsf_release_block(tlsf, remainder);
+}
+
+/**
+ * Allocates a block from a TLSF allocator. The first block from the first list whose blocks are all big enough is
+ * taken, and whatever it has left over is split off and freed again.
+ *
+ * @param context Context of TLSF allocator
+ * @param size Size of memory to be allocated in bytes
+ * @param align Alignment of memory to be allocated
+ * @param usable_size Set to the size of the block if allocation is successful
+ * @return Pointer to allocated memory if allocation is successful, otherwise returns NULL.
+ */
+static void* ctd_tlsf_allocator_allocate_sized(void* context, const ptrdiff_t size, const ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    ctd_tlsf_context* tlsf = context;
+    if (size > tlsf->size || align > tlsf->size)
+    {
+        return NULL;
+    }
+    const ptrdiff_t block_size = ctd_tlsf_round_size(size);
+    // An over-aligned block may have to skip ahead in the free block, and what it skips has to be a block of its own
+    const ptrdiff_t search_size = align <= CTD_TLSF_ALIGNMENT ? block_size : block_size + align + CTD_TLSF_HEADER_SIZE + CTD_TLSF_MIN_BLOCK_SIZE;
+
+    ctd_tlsf_block* block = ctd_tlsf_find_free_block(tlsf, search_size);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    ctd_tlsf_remove_free_block(tlsf, block);
+
+    if (align > CTD_TLSF_ALIGNMENT)
+    {
+        char* memory = ctd_tlsf_block_memory(block);
+        ptrdiff_t gap = -(uintptr_t)memory & (align - 1);
+        if (gap != 0 && gap < CTD_TLSF_HEADER_SIZE + CTD_TLSF_MIN_BLOCK_SIZE)
+        {
+            gap += align;
+        }
+        if (gap != 0)
+        {
+            ctd_tlsf_block* leading = block;
+            block = ctd_tlsf_block_from_memory(memory + gap);
+            block->size = ctd_tlsf_block_size(leading) - gap;
+            ctd_tlsf_block_set_size(leading, gap - CTD_TLSF_HEADER_SIZE);
+            ctd_tlsf_release_block(tlsf, leading);
+        }
+    }
+
+    block->size &= ~(ptrdiff_t)CTD_TLSF_BLOCK_FREE;
+    ctd_tlsf_block_next(block)->size &= ~(ptrdiff_t)CTD_TLSF_PREVIOUS_BLOCK_FREE;
+    ctd_tlsf_trim_block(tlsf, block, block_size);
+
+    *usable_size = ctd_tlsf_block_size(block);
+    return ctd_tlsf_block_memory(block);
+}
+
+static void* ctd_tlsf_allocator_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ptrdiff_t usable_size;
+    return ctd_tlsf_allocator_allocate_sized(context, size, align, &usable_size);
+}
+
+/**
+ * Resizes a block without moving it. Shrinking frees the end of the block, and growing absorbs the next block if it is
+ * free and big enough.
+ *
+ * @param tlsf Context of TLSF allocator
+ * @param memory Pointer to the block to be resized
+ * @param old_size Current size of the block
+ * @param new_size Size the block should be resized to
+ * @param scrub Scrub function used on memory that is given up
+ * @return Whether the block was resized.
+ */
+static bool ctd_tlsf_context_try_resize(ctd_tlsf_context* tlsf, void* memory, const ptrdiff_t old_size, const ptrdiff_t new_size, const ctd_scrub_function scrub)
+{
+    if (new_size > tlsf->size)
+    {
+        return false;
+    }
+    ctd_tlsf_block* block = ctd_tlsf_block_from_memory(memory);
+    const ptrdiff_t block_size = ctd_tlsf_round_size(new_size);
+    const ptrdiff_t current_size = ctd_tlsf_block_size(block);
+
+    if (block_size > current_size)
+    {
+        ctd_tlsf_block* next = ctd_tlsf_block_next(block);
+        if (!(next->size & CTD_TLSF_BLOCK_FREE) || current_size + CTD_TLSF_HEADER_SIZE + ctd_tlsf_block_size(next) < block_size)
+        {
+            return false;
+        }
+        ctd_tlsf_remove_free_block(tlsf, next);
+        ctd_tlsf_block_set_size(block, current_size + CTD_TLSF_HEADER_SIZE + ctd_tlsf_block_size(next));
+        ctd_tlsf_block_next(block)->size &= ~(ptrdiff_t)CTD_TLSF_PREVIOUS_BLOCK_FREE;
+    }
+    if (new_size < old_size)
+    {
+        scrub((char*)memory + new_size, old_size - new_size);
+    }
+    ctd_tlsf_trim_block(tlsf, block, block_size);
+
+    return true;
+}
+
+static bool ctd_tlsf_allocator_try_resize(void* context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    ctd_tlsf_context* tlsf = context;
+    return ctd_tlsf_context_try_resize(tlsf, block, old_size, new_size, tlsf->scrub);
+}
+
+/**
+ * Deallocates a block by scrubbing it and merging it back into the free lists.
+ *
+ * @param context Context of TLSF allocator
+ * @param block Pointer to memory to be deallocated
+ * @param size Size of memory to be deallocated
+ * @param scrub Scrub function of the TLSF allocator's scrub policy
+ */
+static inline void ctd_tlsf_allocator_deallocate_with_scrub(void* context, void* block, const ptrdiff_t size, const ctd_scrub_function scrub)
+{
+    scrub(block, size);
+    ctd_tlsf_release_block(context, ctd_tlsf_block_from_memory(block));
+}
+
+/**
+ * Reallocates a region of memory. It is resized in place if possible, see ctd_tlsf_context_try_resize, otherwise the
+ * data is copied into a new block and the old block is deallocated.
+ *
+ * @param context TLSF allocator's context
+ * @param source Pointer to the memory to be reallocated
+ * @param old_size The size of the memory to be reallocated
+ * @param new_size The size the memory will be reallocated to
+ * @param align The alignment of the region of memory
+ * @param scrub Scrub function of the TLSF allocator's scrub policy
+ * @return Pointer to the reallocated memory if reallocation succeeds, otherwise returns NULL pointer.
+ */
+static inline void* ctd_tlsf_allocator_reallocate_with_scrub(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const ctd_scrub_function scrub)
+{
+    if (ctd_tlsf_context_try_resize(context, source, old_size, new_size, scrub))
+    {
+        return source;
+    }
+
+    void* destination = ctd_tlsf_allocator_allocate(context, new_size, align);
+    if (destination == NULL) return NULL;
+
+    memcpy(destination, source, ctd_min(old_size, new_size));
+    ctd_tlsf_allocator_deallocate_with_scrub(context, source, old_size, scrub);
+
+    return destination;
+}
+
+ctd_scrub_specialize(ctd_tlsf_allocator)
+
+ctd_tlsf_allocator ctd_tlsf_allocator_create(ptrdiff_t size, ctd_allocator* allocator)
+{
+    return ctd_tlsf_allocator_create_with_scrub_policy(size, CTD_SCRUB_ZERO, allocator);
+}
+
+ctd_tlsf_allocator ctd_tlsf_allocator_create_with_scrub_policy(ptrdiff_t size, ctd_scrub_policy scrub_policy, ctd_allocator* allocator)
+{
+    // Room for one block, and the empty block at the end that stops it from being merged past the region
+    size &= ~(CTD_TLSF_ALIGNMENT - 1);
+    if (size < 2 * CTD_TLSF_HEADER_SIZE + CTD_TLSF_MIN_BLOCK_SIZE)
+    {
+        return (ctd_tlsf_allocator) {0};
+    }
+
+    ctd_tlsf_context* context = allocator->allocate(allocator->context, sizeof(ctd_tlsf_context), alignof(ctd_tlsf_context));
+    if (context == NULL) goto context_alloc_failed_cleanup;
+    *context = (ctd_tlsf_context) {0};
+    context->size = size;
+    context->allocator = allocator;
+    context->scrub = ctd_scrub_functions[scrub_policy];
+
+    context->data = allocator->allocate(allocator->context, size, CTD_TLSF_ALIGNMENT);
+    if (context->data == NULL) goto region_alloc_failed_cleanup;
+
+    ctd_tlsf_block* block = (ctd_tlsf_block*)context->data;
+    block->size = size - 2 * CTD_TLSF_HEADER_SIZE;
+    ctd_tlsf_block_next(block)->size = 0;
+    ctd_tlsf_release_block(context, block);
+
+    ctd_tlsf_allocator tlsf_allocator = {0};
+    tlsf_allocator.allocator = ctd_tlsf_allocator_scrub_vtables[scrub_policy];
+    tlsf_allocator.allocator.context = context;
+    tlsf_allocator.allocator.try_resize = ctd_tlsf_allocator_try_resize;
+    tlsf_allocator.allocator.allocate_sized = ctd_tlsf_allocator_allocate_sized;
+
+    return tlsf_allocator;
+
+region_alloc_failed_cleanup:
+    allocator->deallocate(allocator->context, context, sizeof(ctd_tlsf_context));
+context_alloc_failed_cleanup:
+    return (ctd_tlsf_allocator) {0};
+}
+
+void ctd_tlsf_allocator_destroy(ctd_tlsf_allocator* self)
+{
+    ctd_tlsf_context* context = self->allocator.context;
+    ctd_allocator* underlying_allocator = context->allocator;
+
+    underlying_allocator->deallocate(underlying_allocator->context, context->data, context->size);
+    underlying_allocator->deallocate(underlying_allocator->context, context, sizeof(ctd_tlsf_context));
+
+    *self = (ctd_tlsf_allocator) {0};
+}
+
+ptrdiff_t ctd_tlsf_allocator_free_bytes(ctd_tlsf_allocator* self)
+{
+    const ctd_tlsf_context* context = self->allocator.context;
+    return context->free_bytes;
+}
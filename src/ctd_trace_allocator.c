@@ -0,0 +1,392 @@
+#include <ctd_trace_allocator.h>
+#include <ctd_define.h>
+#include <stdalign.h>
+#include <string.h>
+#include <time.h>
+
+#define CTD_TRACE_MAGIC "CTDTRACE"
+#define CTD_TRACE_MAGIC_LENGTH 8
+#define CTD_TRACE_VERSION 1
+// An operation byte followed by at most 5 varints of at most 10 bytes each
+#define CTD_TRACE_MAX_RECORD_SIZE 64
+#define CTD_TRACE_OPERATION_MASK 0x3
+#define CTD_TRACE_ALIGN_SHIFT 2
+
+typedef struct ctd_trace_context
+{
+    ctd_allocator* allocator;
+    FILE* stream;
+    uint64_t last_ns;
+    uint64_t last_address;
+    ptrdiff_t length;
+    bool failed;
+    unsigned char buffer[CTD_TRACE_BUFFER_SIZE];
+} ctd_trace_context;
+
+static inline uint64_t ctd_trace_now_ns()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000u + (uint64_t)time.tv_nsec;
+}
+
+static inline uint64_t ctd_trace_zigzag_encode(const uint64_t address, const uint64_t previous)
+{
+    const int64_t delta = (int64_t)(address - previous);
+    return ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+}
+
+static inline uint64_t ctd_trace_zigzag_decode(const uint64_t value, const uint64_t previous)
+{
+    return previous + ((value >> 1) ^ -(value & 1));
+}
+
+static inline unsigned char ctd_trace_log2(ptrdiff_t align)
+{
+    unsigned char log2 = 0;
+    while (align > 1)
+    {
+        align >>= 1;
+        log2++;
+    }
+    return log2;
+}
+
+static bool ctd_trace_write_buffer(ctd_trace_context* context)
+{
+    if (context->length != 0 && fwrite(context->buffer, 1, context->length, context->stream) != (size_t)context->length)
+    {
+        context->failed = true;
+    }
+    context->length = 0;
+    return !context->failed;
+}
+
+static inline void ctd_trace_put_byte(ctd_trace_context* context, const unsigned char byte)
+{
+    context->buffer[context->length++] = byte;
+}
+
+static inline void ctd_trace_put_varint(ctd_trace_context* context, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        context->buffer[context->length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    context->buffer[context->length++] = (unsigned char)value;
+}
+
+/**
+ * Starts a record, making sure the whole record fits into the buffer.
+ */
+static inline void ctd_trace_begin_record(ctd_trace_context* context, const ctd_trace_operation operation, const ptrdiff_t align, const uint64_t now)
+{
+    if (context->length > CTD_TRACE_BUFFER_SIZE - CTD_TRACE_MAX_RECORD_SIZE)
+    {
+        ctd_trace_write_buffer(context);
+    }
+    ctd_trace_put_byte(context, (unsigned char)(operation | ctd_trace_log2(align) << CTD_TRACE_ALIGN_SHIFT));
+    ctd_trace_put_varint(context, now - context->last_ns);
+    context->last_ns = now;
+}
+
+/**
+ * Stores an address relative to the previous one. Failed calls return NULL, which doesn't move the previous address so
+ * the next record's delta stays small.
+ */
+static inline void ctd_trace_put_address(ctd_trace_context* context, const void* address)
+{
+    ctd_trace_put_varint(context, ctd_trace_zigzag_encode((uintptr_t)address, context->last_address));
+    if (address != NULL)
+    {
+        context->last_address = (uintptr_t)address;
+    }
+}
+
+static inline void ctd_trace_record_allocate(ctd_trace_context* context, const uint64_t now, const ptrdiff_t size, const ptrdiff_t align, const void* ptr)
+{
+    ctd_trace_begin_record(context, CTD_TRACE_ALLOCATE, align, now);
+    ctd_trace_put_varint(context, size);
+    ctd_trace_put_address(context, ptr);
+}
+
+static inline void ctd_trace_record_reallocate(ctd_trace_context* context, const uint64_t now, const void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const void* ptr)
+{
+    ctd_trace_begin_record(context, CTD_TRACE_REALLOCATE, align, now);
+    ctd_trace_put_address(context, source);
+    ctd_trace_put_varint(context, old_size);
+    ctd_trace_put_varint(context, new_size);
+    ctd_trace_put_address(context, ptr);
+}
+
+static inline void ctd_trace_record_deallocate(ctd_trace_context* context, const uint64_t now, const void* block, const ptrdiff_t size)
+{
+    ctd_trace_begin_record(context, CTD_TRACE_DEALLOCATE, 1, now);
+    ctd_trace_put_address(context, block);
+    ctd_trace_put_varint(context, size);
+}
+
+static void* ctd_trace_allocator_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ctd_trace_context* trace_context = context;
+    ctd_allocator* allocator = trace_context->allocator;
+
+    const uint64_t now = ctd_trace_now_ns();
+    void* ptr = allocator->allocate(allocator->context, size, align);
+
+    ctd_trace_record_allocate(trace_context, now, size, align, ptr);
+
+    return ptr;
+}
+
+static void* ctd_trace_allocator_reallocate(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align)
+{
+    ctd_trace_context* trace_context = context;
+    ctd_allocator* allocator = trace_context->allocator;
+
+    const uint64_t now = ctd_trace_now_ns();
+    void* ptr = allocator->reallocate(allocator->context, source, old_size, new_size, align);
+
+    ctd_trace_record_reallocate(trace_context, now, source, old_size, new_size, align, ptr);
+
+    return ptr;
+}
+
+static void ctd_trace_allocator_deallocate(void* context, void* block, const ptrdiff_t size)
+{
+    ctd_trace_context* trace_context = context;
+    ctd_allocator* allocator = trace_context->allocator;
+
+    const uint64_t now = ctd_trace_now_ns();
+    allocator->deallocate(allocator->context, block, size);
+
+    ctd_trace_record_deallocate(trace_context, now, block, size);
+}
+
+/**
+ * Resizes a block in place, which is recorded as a reallocation that returned the same block. A failed resize is
+ * recorded as a failed reallocation, since the block is left as it was either way.
+ */
+static bool ctd_trace_allocator_try_resize(void* context, void* block, const ptrdiff_t old_size, const ptrdiff_t new_size)
+{
+    ctd_trace_context* trace_context = context;
+    ctd_allocator* allocator = trace_context->allocator;
+
+    const uint64_t now = ctd_trace_now_ns();
+    const bool resized = allocator->try_resize(allocator->context, block, old_size, new_size);
+
+    ctd_trace_record_reallocate(trace_context, now, block, old_size, new_size, 1, resized ? block : NULL);
+
+    return resized;
+}
+
+/**
+ * Allocates a block and reports its usable size. The block is deallocated with its usable size, so that's the size
+ * that is recorded, and a replay uses the block the same way.
+ */
+static void* ctd_trace_allocator_allocate_sized(void* context, const ptrdiff_t size, const ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    ctd_trace_context* trace_context = context;
+    ctd_allocator* allocator = trace_context->allocator;
+
+    const uint64_t now = ctd_trace_now_ns();
+    void* ptr = allocator->allocate_sized(allocator->context, size, align, usable_size);
+
+    ctd_trace_record_allocate(trace_context, now, ptr != NULL ? *usable_size : size, align, ptr);
+
+    return ptr;
+}
+
+static void* ctd_trace_allocator_reallocate_sized(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, ptrdiff_t* usable_size)
+{
+    ctd_trace_context* trace_context = context;
+    ctd_allocator* allocator = trace_context->allocator;
+
+    const uint64_t now = ctd_trace_now_ns();
+    void* ptr = allocator->reallocate_sized(allocator->context, source, old_size, new_size, align, usable_size);
+
+    ctd_trace_record_reallocate(trace_context, now, source, old_size, ptr != NULL ? *usable_size : new_size, align, ptr);
+
+    return ptr;
+}
+
+/**
+ * Allocates a batch of blocks, which is recorded as one allocation per block, all at the same time. A failed batch
+ * allocates none of them, so every block is recorded as a failed allocation.
+ */
+static bool ctd_trace_allocator_allocate_batch(void* context, const ptrdiff_t count, const ptrdiff_t size, const ptrdiff_t align, void** blocks)
+{
+    ctd_trace_context* trace_context = context;
+    ctd_allocator* allocator = trace_context->allocator;
+
+    const uint64_t now = ctd_trace_now_ns();
+    const bool allocated = allocator->allocate_batch(allocator->context, count, size, align, blocks);
+
+    for (ptrdiff_t i = 0; i < count; i++)
+    {
+        ctd_trace_record_allocate(trace_context, now, size, align, allocated ? blocks[i] : NULL);
+    }
+
+    return allocated;
+}
+
+static void ctd_trace_allocator_deallocate_batch(void* context, const ptrdiff_t count, const ptrdiff_t size, void** blocks)
+{
+    ctd_trace_context* trace_context = context;
+    ctd_allocator* allocator = trace_context->allocator;
+
+    const uint64_t now = ctd_trace_now_ns();
+    allocator->deallocate_batch(allocator->context, count, size, blocks);
+
+    // Batches are freed in reverse, so that's the order they're replayed in
+    for (ptrdiff_t i = count - 1; i >= 0; i--)
+    {
+        ctd_trace_record_deallocate(trace_context, now, blocks[i], size);
+    }
+}
+
+ctd_trace_allocator ctd_trace_allocator_create(ctd_allocator* allocator, FILE* stream)
+{
+    ctd_trace_allocator trace_allocator = {0};
+    ctd_trace_context* context = allocator->allocate(allocator->context, sizeof(ctd_trace_context), alignof(ctd_trace_context));
+    if (context == NULL) return trace_allocator;
+    context->allocator = allocator;
+    context->stream = stream;
+    context->last_ns = ctd_trace_now_ns();
+    context->last_address = 0;
+    context->length = 0;
+    context->failed = false;
+
+    memcpy(context->buffer, CTD_TRACE_MAGIC, CTD_TRACE_MAGIC_LENGTH);
+    context->buffer[CTD_TRACE_MAGIC_LENGTH] = CTD_TRACE_VERSION;
+    context->length = CTD_TRACE_MAGIC_LENGTH + 1;
+
+    trace_allocator.allocator.allocate = ctd_trace_allocator_allocate;
+    trace_allocator.allocator.reallocate = ctd_trace_allocator_reallocate;
+    trace_allocator.allocator.deallocate = ctd_trace_allocator_deallocate;
+    // Entries the wrapped allocator doesn't have are left NULL, so that callers fall back to the entries above
+    trace_allocator.allocator.try_resize = allocator->try_resize != NULL ? ctd_trace_allocator_try_resize : NULL;
+    trace_allocator.allocator.allocate_sized = allocator->allocate_sized != NULL ? ctd_trace_allocator_allocate_sized : NULL;
+    trace_allocator.allocator.reallocate_sized = allocator->reallocate_sized != NULL ? ctd_trace_allocator_reallocate_sized : NULL;
+    trace_allocator.allocator.allocate_batch = allocator->allocate_batch != NULL ? ctd_trace_allocator_allocate_batch : NULL;
+    trace_allocator.allocator.deallocate_batch = allocator->deallocate_batch != NULL ? ctd_trace_allocator_deallocate_batch : NULL;
+    trace_allocator.allocator.context = context;
+
+    return trace_allocator;
+}
+
+void ctd_trace_allocator_destroy(ctd_trace_allocator* self)
+{
+    ctd_trace_context* context = self->allocator.context;
+    ctd_trace_write_buffer(context);
+    fflush(context->stream);
+
+    ctd_allocator* allocator = context->allocator;
+    allocator->deallocate(allocator->context, context, sizeof(ctd_trace_context));
+
+    *self = (ctd_trace_allocator) {0};
+}
+
+bool ctd_trace_allocator_flush(ctd_trace_allocator* self)
+{
+    ctd_trace_context* context = self->allocator.context;
+    if (!ctd_trace_write_buffer(context) || fflush(context->stream) != 0)
+    {
+        context->failed = true;
+    }
+    return !context->failed;
+}
+
+ctd_trace_reader ctd_trace_reader_create(FILE* stream, ctd_error* error)
+{
+    ctd_trace_reader reader = {stream, 0, 0};
+
+    unsigned char header[CTD_TRACE_MAGIC_LENGTH + 1];
+    if ((ptrdiff_t)fread(header, 1, sizeof(header), stream) != sizeof(header) || memcmp(header, CTD_TRACE_MAGIC, CTD_TRACE_MAGIC_LENGTH) != 0)
+    {
+        error->error_type = FILE_IO;
+        error->error_message = "Stream doesn't start with a trace header.";
+        return reader;
+    }
+    if (header[CTD_TRACE_MAGIC_LENGTH] != CTD_TRACE_VERSION)
+    {
+        error->error_type = FILE_IO;
+        error->error_message = "Trace was recorded with an unsupported version.";
+    }
+
+    return reader;
+}
+
+static inline uint64_t ctd_trace_get_varint(FILE* stream, ctd_error* error)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        const int byte = getc(stream);
+        if (byte == EOF)
+        {
+            error->error_type = FILE_IO;
+            error->error_message = "Trace ended partway through a record.";
+            return 0;
+        }
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    error->error_type = FILE_IO;
+    error->error_message = "Trace contains a malformed record.";
+    return 0;
+}
+
+static inline uint64_t ctd_trace_get_address(ctd_trace_reader* self, ctd_error* error)
+{
+    const uint64_t address = ctd_trace_zigzag_decode(ctd_trace_get_varint(self->stream, error), self->last_address);
+    if (address != 0)
+    {
+        self->last_address = address;
+    }
+    return address;
+}
+
+bool ctd_trace_reader_next(ctd_trace_reader* self, ctd_trace_record* record, ctd_error* error)
+{
+    const int byte = getc(self->stream);
+    if (byte == EOF)
+    {
+        return false;
+    }
+
+    *record = (ctd_trace_record) {0};
+    record->operation = byte & CTD_TRACE_OPERATION_MASK;
+    self->timestamp_ns += ctd_trace_get_varint(self->stream, error);
+    record->timestamp_ns = self->timestamp_ns;
+
+    switch (record->operation)
+    {
+    case CTD_TRACE_ALLOCATE:
+        record->align = (ptrdiff_t)1 << (byte >> CTD_TRACE_ALIGN_SHIFT);
+        record->size = (ptrdiff_t)ctd_trace_get_varint(self->stream, error);
+        record->result = ctd_trace_get_address(self, error);
+        break;
+    case CTD_TRACE_REALLOCATE:
+        record->align = (ptrdiff_t)1 << (byte >> CTD_TRACE_ALIGN_SHIFT);
+        record->source = ctd_trace_get_address(self, error);
+        record->old_size = (ptrdiff_t)ctd_trace_get_varint(self->stream, error);
+        record->size = (ptrdiff_t)ctd_trace_get_varint(self->stream, error);
+        record->result = ctd_trace_get_address(self, error);
+        break;
+    case CTD_TRACE_DEALLOCATE:
+        record->source = ctd_trace_get_address(self, error);
+        record->size = (ptrdiff_t)ctd_trace_get_varint(self->stream, error);
+        break;
+    default:
+        error->error_type = FILE_IO;
+        error->error_message = "Trace contains a malformed record.";
+        return false;
+    }
+
+    return error->error_type == NO_ERROR;
+}
@@ -0,0 +1,208 @@
+#include <ctd_virtual_arena_allocator.h>
+#include <ctd_define.h>
+#include <ctd_scrub.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Pages are committed in chunks of this size so that steady growth doesn't make a system call per page
+#define CTD_VIRTUAL_ARENA_COMMIT_GRANULARITY ((ptrdiff_t)64 * 1024)
+
+/**
+ * Lives at the start of the reserved range. length and committed are both measured from the start of the range, so the
+ * context itself is counted as used memory.
+ */
+typedef struct ctd_virtual_arena_context
+{
+    ptrdiff_t length;
+    ptrdiff_t committed;
+    ptrdiff_t reserved;
+    ptrdiff_t commit_granularity;
+} ctd_virtual_arena_context;
+
+static inline char* ctd_virtual_arena_base(ctd_virtual_arena_context* virtual_arena)
+{
+    return (char*)virtual_arena;
+}
+
+static inline ptrdiff_t ctd_virtual_arena_round_up(const ptrdiff_t size, const ptrdiff_t granularity)
+{
+    return (size + granularity - 1) / granularity * granularity;
+}
+
+/**
+ * Makes sure that everything up to end is committed.
+ *
+ * @param virtual_arena Context of virtual arena allocator
+ * @param end Offset from the start of the reserved range that has to be readable and writable
+ * @return Whether the memory could be committed.
+ */
+static bool ctd_virtual_arena_commit(ctd_virtual_arena_context* virtual_arena, const ptrdiff_t end)
+{
+    if (end <= virtual_arena->committed)
+    {
+        return true;
+    }
+    if (end > virtual_arena->reserved)
+    {
+        return false;
+    }
+
+    const ptrdiff_t new_committed = ctd_min(ctd_virtual_arena_round_up(end, virtual_arena->commit_granularity), virtual_arena->reserved);
+    char* commit_start = ctd_virtual_arena_base(virtual_arena) + virtual_arena->committed;
+    if (mprotect(commit_start, new_committed - virtual_arena->committed, PROT_READ | PROT_WRITE) != 0)
+    {
+        return false;
+    }
+    virtual_arena->committed = new_committed;
+
+    return true;
+}
+
+static void* ctd_virtual_arena_allocator_allocate(void* context, const ptrdiff_t size, const ptrdiff_t align)
+{
+    ctd_virtual_arena_context* virtual_arena = context;
+    char* base = ctd_virtual_arena_base(virtual_arena);
+
+    const ptrdiff_t padding = -(uintptr_t)(base + virtual_arena->length) & (align-1);
+    if (!ctd_virtual_arena_commit(virtual_arena, virtual_arena->length + padding + size))
+    {
+        return NULL;
+    }
+    void* ptr = base + virtual_arena->length + padding;
+    virtual_arena->length += padding + size;
+    return ptr;
+}
+
+static inline void* ctd_virtual_arena_allocator_reallocate_with_scrub(void* context, void* source, const ptrdiff_t old_size, const ptrdiff_t new_size, const ptrdiff_t align, const ctd_scrub_function scrub)
+{
+    ctd_virtual_arena_context* virtual_arena = context;
+    char* base = ctd_virtual_arena_base(virtual_arena);
+    const ptrdiff_t difference = new_size - old_size;
+
+    // If there isn't any change, simply return the source pointer
+    if (difference == 0)
+    {
+        return source;
+    }
+    // If the reallocated object is at the end of the virtual arena, it can grow or shrink in place
+    if (base + virtual_arena->length - old_size == source)
+    {
+        if (difference < 0)
+        {
+            scrub(base + virtual_arena->length + difference, -difference);
+        }
+        else if (!ctd_virtual_arena_commit(virtual_arena, virtual_arena->length + difference))
+        {
+            return NULL;
+        }
+        virtual_arena->length += difference;
+
+        return source;
+    }
+    // If the object is shrunk, we scrub the end of it but leave it where it is
+    if (difference < 0)
+    {
+        scrub((char*)source + new_size, -difference);
+        return source;
+    }
+
+    // Otherwise, the object is moved to the end of the virtual arena
+    char* destination = ctd_virtual_arena_allocator_allocate(context, new_size, align);
+    if (destination == NULL)
+    {
+        return NULL;
+    }
+    memcpy(destination, source, old_size);
+    return destination;
+}
+
+static inline void ctd_virtual_arena_allocator_deallocate_with_scrub(void* context, void* block, const ptrdiff_t size, const ctd_scrub_function scrub)
+{
+    ctd_virtual_arena_context* virtual_arena = context;
+    scrub(block, size);
+    if (block == ctd_virtual_arena_base(virtual_arena) + virtual_arena->length - size)
+    {
+        virtual_arena->length -= size;
+    }
+}
+
+ctd_scrub_specialize(ctd_virtual_arena_allocator)
+
+ctd_virtual_arena_allocator ctd_virtual_arena_allocator_create(ptrdiff_t reserve_size)
+{
+    return ctd_virtual_arena_allocator_create_with_scrub_policy(reserve_size, CTD_SCRUB_ZERO);
+}
+
+ctd_virtual_arena_allocator ctd_virtual_arena_allocator_create_with_scrub_policy(ptrdiff_t reserve_size, const ctd_scrub_policy scrub_policy)
+{
+    const ptrdiff_t page_size = sysconf(_SC_PAGESIZE);
+    const ptrdiff_t commit_granularity = ctd_virtual_arena_round_up(CTD_VIRTUAL_ARENA_COMMIT_GRANULARITY, page_size);
+    reserve_size = ctd_virtual_arena_round_up(ctd_max(reserve_size, commit_granularity), commit_granularity);
+
+    char* base = mmap(NULL, reserve_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        return (ctd_virtual_arena_allocator) {0};
+    }
+    // The first chunk is committed right away since it holds the context
+    if (mprotect(base, commit_granularity, PROT_READ | PROT_WRITE) != 0)
+    {
+        munmap(base, reserve_size);
+        return (ctd_virtual_arena_allocator) {0};
+    }
+
+    ctd_virtual_arena_context* context = (ctd_virtual_arena_context*)base;
+    context->length = sizeof(ctd_virtual_arena_context);
+    context->committed = commit_granularity;
+    context->reserved = reserve_size;
+    context->commit_granularity = commit_granularity;
+
+    ctd_virtual_arena_allocator virtual_arena = {0};
+    virtual_arena.allocator = ctd_virtual_arena_allocator_scrub_vtables[scrub_policy];
+    virtual_arena.allocator.context = context;
+
+    return virtual_arena;
+}
+
+void ctd_virtual_arena_allocator_destroy(ctd_virtual_arena_allocator* self)
+{
+    ctd_virtual_arena_context* context = self->allocator.context;
+    munmap(ctd_virtual_arena_base(context), context->reserved);
+
+    *self = (ctd_virtual_arena_allocator) {0};
+}
+
+ctd_arena_save_point ctd_virtual_arena_allocator_mark(ctd_virtual_arena_allocator* self)
+{
+    ctd_virtual_arena_context* context = self->allocator.context;
+    return (ctd_arena_save_point){.page = 0, .length = context->length};
+}
+
+void ctd_virtual_arena_allocator_rewind(ctd_virtual_arena_allocator* self, ctd_arena_save_point save_point)
+{
+    ctd_virtual_arena_context* context = self->allocator.context;
+    if (save_point.length >= sizeof(ctd_virtual_arena_context) && save_point.length < context->length)
+    {
+        context->length = save_point.length;
+    }
+}
+
+void ctd_virtual_arena_allocator_reset(ctd_virtual_arena_allocator* self)
+{
+    ctd_virtual_arena_context* context = self->allocator.context;
+    char* base = ctd_virtual_arena_base(context);
+    const ptrdiff_t kept = context->commit_granularity;
+
+    if (context->committed > kept)
+    {
+        // MADV_DONTNEED drops the physical pages right away, and PROT_NONE returns the range to its reserved state
+        madvise(base + kept, context->committed - kept, MADV_DONTNEED);
+        mprotect(base + kept, context->committed - kept, PROT_NONE);
+        context->committed = kept;
+    }
+    context->length = sizeof(ctd_virtual_arena_context);
+}
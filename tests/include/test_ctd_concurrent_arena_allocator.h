@@ -0,0 +1,6 @@
+#ifndef TEST_CTD_CONCURRENT_ARENA_ALLOCATOR_H
+#define TEST_CTD_CONCURRENT_ARENA_ALLOCATOR_H
+
+void test_ctd_concurrent_arena_allocator_functions();
+
+#endif // TEST_CTD_CONCURRENT_ARENA_ALLOCATOR_H
@@ -0,0 +1,6 @@
+#ifndef TEST_CTD_FALLBACK_ALLOCATOR_H
+#define TEST_CTD_FALLBACK_ALLOCATOR_H
+
+void test_ctd_fallback_allocator_functions();
+
+#endif // TEST_CTD_FALLBACK_ALLOCATOR_H
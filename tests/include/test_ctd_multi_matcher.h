@@ -0,0 +1,6 @@
+#ifndef TEST_CTD_MULTI_MATCHER_H
+#define TEST_CTD_MULTI_MATCHER_H
+
+void test_ctd_multi_matcher_functions();
+
+#endif // TEST_CTD_MULTI_MATCHER_H
@@ -0,0 +1,6 @@
+#ifndef TEST_CTD_ROUTING_ALLOCATOR_H
+#define TEST_CTD_ROUTING_ALLOCATOR_H
+
+void test_ctd_routing_allocator_functions();
+
+#endif // TEST_CTD_ROUTING_ALLOCATOR_H
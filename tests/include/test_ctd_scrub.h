@@ -0,0 +1,6 @@
+#ifndef TEST_CTD_SCRUB_H
+#define TEST_CTD_SCRUB_H
+
+void test_ctd_scrub_functions();
+
+#endif // TEST_CTD_SCRUB_H
@@ -0,0 +1,6 @@
+#ifndef TEST_CTD_STATS_ALLOCATOR_H
+#define TEST_CTD_STATS_ALLOCATOR_H
+
+void test_ctd_stats_allocator_functions();
+
+#endif // TEST_CTD_STATS_ALLOCATOR_H
@@ -0,0 +1,6 @@
+#ifndef TEST_CTD_STRING_HASH_H
+#define TEST_CTD_STRING_HASH_H
+
+void test_ctd_string_hash_functions();
+
+#endif // TEST_CTD_STRING_HASH_H
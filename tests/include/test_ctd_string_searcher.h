@@ -0,0 +1,6 @@
+#ifndef TEST_CTD_STRING_SEARCHER_H
+#define TEST_CTD_STRING_SEARCHER_H
+
+void test_ctd_string_searcher_functions();
+
+#endif // TEST_CTD_STRING_SEARCHER_H
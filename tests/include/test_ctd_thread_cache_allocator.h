@@ -0,0 +1,6 @@
+#ifndef TEST_CTD_THREAD_CACHE_ALLOCATOR_H
+#define TEST_CTD_THREAD_CACHE_ALLOCATOR_H
+
+void test_ctd_thread_cache_allocator_functions();
+
+#endif // TEST_CTD_THREAD_CACHE_ALLOCATOR_H
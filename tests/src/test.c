@@ -1,17 +1,45 @@
 #include <test_ctd_allocator.h>
 #include <test_ctd_arena_allocator.h>
+#include <test_ctd_buddy_allocator.h>
+#include <test_ctd_concurrent_arena_allocator.h>
 #include <test_ctd_expandable_arena_allocator.h>
+#include <test_ctd_fallback_allocator.h>
 #include <test_ctd_page_allocator.h>
+#include <test_ctd_routing_allocator.h>
+#include <test_ctd_scrub.h>
+#include <test_ctd_slab_allocator.h>
+#include <test_ctd_stats_allocator.h>
+#include <test_ctd_thread_cache_allocator.h>
+#include <test_ctd_tlsf_allocator.h>
+#include <test_ctd_trace_allocator.h>
+#include <test_ctd_virtual_arena_allocator.h>
 #include <test_ctd_string.h>
+#include <test_ctd_string_hash.h>
+#include <test_ctd_string_searcher.h>
+#include <test_ctd_multi_matcher.h>
 
 int main()
 {
     // Command to check for memory leaks: leaks --atExit -- ./cmake-build-debug/test
     test_ctd_string_functions();
+    test_ctd_string_hash_functions();
+    test_ctd_string_searcher_functions();
+    test_ctd_multi_matcher_functions();
     test_ctd_allocator_functions();
+    test_ctd_scrub_functions();
     test_ctd_arena_allocator_functions();
+    test_ctd_buddy_allocator_functions();
+    test_ctd_concurrent_arena_allocator_functions();
     test_ctd_expandable_arena_allocator_functions();
+    test_ctd_fallback_allocator_functions();
     test_ctd_page_allocator_functions();
+    test_ctd_routing_allocator_functions();
+    test_ctd_slab_allocator_functions();
+    test_ctd_stats_allocator_functions();
+    test_ctd_thread_cache_allocator_functions();
+    test_ctd_tlsf_allocator_functions();
+    test_ctd_trace_allocator_functions();
+    test_ctd_virtual_arena_allocator_functions();
 
     return 0;
 }
\ No newline at end of file
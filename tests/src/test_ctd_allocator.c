@@ -2,6 +2,7 @@
 #include <ctd_allocator.h>
 #include <stdint.h>
 #include <stdalign.h>
+#include <string.h>
 #include <stdlib.h>
 
 int test_ctd_heap_allocator_create()
@@ -49,6 +50,126 @@ cleanup:
     return 1;
 }
 
+int test_ctd_heap_allocator_aligned_allocate()
+{
+    ctd_heap_allocator heap_allocator = ctd_heap_allocator_create();
+    ctd_allocator allocator = heap_allocator.allocator;
+
+    const ptrdiff_t align = 64;
+    char* buffer = allocator.allocate(allocator.context, 100, align);
+    if (buffer == NULL) return 1;
+    if ((uintptr_t)buffer % align != 0) goto cleanup;
+
+    free(buffer);
+    return 0;
+cleanup:
+    free(buffer);
+    return 1;
+}
+
+int test_ctd_heap_allocator_aligned_reallocate()
+{
+    ctd_heap_allocator heap_allocator = ctd_heap_allocator_create();
+    ctd_allocator allocator = heap_allocator.allocator;
+
+    const ptrdiff_t align = 128;
+    const ptrdiff_t size = 100 * sizeof(uint32_t);
+    uint32_t* buffer = allocator.allocate(allocator.context, size, align);
+    if (buffer == NULL) return 1;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        buffer[i] = i;
+    }
+    uint32_t* new_buffer = allocator.reallocate(allocator.context, buffer, size, size * 64, align);
+    if (new_buffer == NULL) goto cleanup;
+    if ((uintptr_t)new_buffer % align != 0) goto new_buffer_cleanup;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        if (new_buffer[i] != i) goto new_buffer_cleanup;
+    }
+
+    free(new_buffer);
+    return 0;
+new_buffer_cleanup:
+    free(new_buffer);
+    return 1;
+cleanup:
+    free(buffer);
+    return 1;
+}
+
+int test_ctd_heap_allocator_try_resize()
+{
+    ctd_heap_allocator heap_allocator = ctd_heap_allocator_create();
+    ctd_allocator allocator = heap_allocator.allocator;
+#if defined(__GLIBC__)
+    if (allocator.try_resize == NULL) return 1;
+#endif
+
+    char* buffer = allocator.allocate(allocator.context, 100, alignof(char));
+    if (buffer == NULL) return 1;
+    // Shrinking always fits in the block, and growing past what malloc handed out never does
+    if (allocator.try_resize != NULL && !ctd_allocator_try_resize(&allocator, buffer, 100, 50)) goto cleanup;
+    if (ctd_allocator_try_resize(&allocator, buffer, 50, (ptrdiff_t)1 << 30)) goto cleanup;
+
+    free(buffer);
+    return 0;
+cleanup:
+    free(buffer);
+    return 1;
+}
+
+int test_ctd_heap_allocator_allocate_sized()
+{
+    ctd_heap_allocator heap_allocator = ctd_heap_allocator_create();
+    ctd_allocator allocator = heap_allocator.allocator;
+
+    ptrdiff_t usable_size = 0;
+    char* buffer = ctd_allocator_allocate_sized(&allocator, 100, alignof(char), &usable_size);
+    if (buffer == NULL) return 1;
+    if (usable_size < 100) goto cleanup;
+    // Every usable byte belongs to the block
+    memset(buffer, 1, usable_size);
+
+    char* reallocated = ctd_allocator_reallocate_sized(&allocator, buffer, usable_size, 1000, alignof(char), &usable_size);
+    if (reallocated == NULL) goto cleanup;
+    buffer = reallocated;
+    if (usable_size < 1000 || buffer[99] != 1) goto cleanup;
+    memset(buffer, 1, usable_size);
+
+    free(buffer);
+    return 0;
+cleanup:
+    free(buffer);
+    return 1;
+}
+
+int test_ctd_heap_allocator_batch()
+{
+    ctd_heap_allocator heap_allocator = ctd_heap_allocator_create();
+    ctd_allocator allocator = heap_allocator.allocator;
+    void* blocks[16];
+
+    if (!ctd_allocator_allocate_batch(&allocator, 16, 24, 64, blocks)) return 1;
+    for (ptrdiff_t i = 0; i < 16; i++)
+    {
+        if ((uintptr_t)blocks[i] % 64 != 0) goto cleanup;
+        memset(blocks[i], 1, 24);
+    }
+    ctd_allocator_deallocate_batch(&allocator, 16, 24, blocks);
+
+    // Allocators without batch entries get one call per block
+    allocator.allocate_batch = NULL;
+    allocator.deallocate_batch = NULL;
+    if (!ctd_allocator_allocate_batch(&allocator, 16, 24, alignof(char), blocks)) return 1;
+    ctd_allocator_deallocate_batch(&allocator, 16, 24, blocks);
+
+    return 0;
+cleanup:
+    ctd_allocator_deallocate_batch(&allocator, 16, 24, blocks);
+    return 1;
+}
+
 void test_ctd_allocator_functions()
 {
     int status;
@@ -58,6 +179,11 @@ void test_ctd_allocator_functions()
     RUN_TEST(ctd_heap_allocator_create, status, number_of_tests_failed)
     RUN_TEST(ctd_heap_allocator_allocate, status, number_of_tests_failed)
     RUN_TEST(ctd_heap_allocator_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_heap_allocator_aligned_allocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_heap_allocator_aligned_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_heap_allocator_try_resize, status, number_of_tests_failed)
+    RUN_TEST(ctd_heap_allocator_allocate_sized, status, number_of_tests_failed)
+    RUN_TEST(ctd_heap_allocator_batch, status, number_of_tests_failed)
 
     if (number_of_tests_failed == 0)
     {
@@ -3,12 +3,14 @@
 #include <test.h>
 #include <stdint.h>
 #include <stdalign.h>
+#include <string.h>
 
 typedef struct ctd_arena_context
 {
     ptrdiff_t length;
     ptrdiff_t capacity;
     char* data;
+    ctd_scrub_function scrub;
 } ctd_arena_context;
 
 int test_ctd_arena_allocator_create()
@@ -31,6 +33,41 @@ cleanup:
     return 1;
 }
 
+int test_ctd_arena_allocator_create_in_buffer()
+{
+    alignas(max_align_t) char buffer[256];
+    ctd_arena_allocator arena_allocator = ctd_arena_allocator_create_in_buffer(buffer, sizeof(buffer));
+    const ctd_allocator arena = arena_allocator.allocator;
+    ctd_arena_context* context = arena.context;
+    if (arena.context == NULL) return 1;
+    // The context is at the front of the buffer, and the rest of it is handed out
+    if ((char*)context != buffer) return 1;
+    if (context->data != buffer + sizeof(ctd_arena_context)) return 1;
+    if (ctd_arena_allocator_capacity(&arena_allocator) != sizeof(buffer) - sizeof(ctd_arena_context)) return 1;
+
+    const ptrdiff_t capacity = ctd_arena_allocator_capacity(&arena_allocator);
+    char* block = arena.allocate(arena.context, capacity, alignof(char));
+    if (block != context->data) return 1;
+    memset(block, 1, capacity);
+    if (arena.allocate(arena.context, 1, alignof(char)) != NULL) return 1;
+    ctd_arena_allocator_reset(&arena_allocator);
+    if (arena.allocate(arena.context, 16, alignof(char)) != block) return 1;
+
+    // A misaligned buffer is aligned for the context
+    ctd_arena_allocator misaligned = ctd_arena_allocator_create_in_buffer(buffer + 1, sizeof(buffer) - 1);
+    if (misaligned.allocator.context == NULL) return 1;
+    if ((uintptr_t)misaligned.allocator.context % alignof(ctd_arena_context) != 0) return 1;
+    if (ctd_arena_allocator_capacity(&misaligned) != sizeof(buffer) - alignof(ctd_arena_context) - sizeof(ctd_arena_context)) return 1;
+
+    // Too small for the context
+    ctd_arena_allocator too_small = ctd_arena_allocator_create_in_buffer(buffer, sizeof(ctd_arena_context) - 1);
+    if (too_small.allocator.context != NULL) return 1;
+    ctd_arena_allocator negative = ctd_arena_allocator_create_in_buffer(buffer, -1);
+    if (negative.allocator.context != NULL) return 1;
+
+    return 0;
+}
+
 int test_ctd_arena_allocate()
 {
     ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
@@ -82,6 +119,68 @@ cleanup:
     return 1;
 }
 
+int test_ctd_arena_try_resize()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_arena_allocator arena_allocator = ctd_arena_allocator_create(100 * sizeof(char), &heap_allocator);
+    const ctd_allocator arena = arena_allocator.allocator;
+    ctd_arena_context* context = arena.context;
+
+    char* data_1 = arena.allocate(context, 10, alignof(char));
+    if (!ctd_allocator_try_resize(&arena, data_1, 10, 40)) goto cleanup;
+    if (context->length != 40) goto cleanup;
+    // The arena only has 100 bytes
+    if (ctd_allocator_try_resize(&arena, data_1, 40, 200)) goto cleanup;
+    if (context->length != 40) goto cleanup;
+
+    char* data_2 = arena.allocate(context, 10, alignof(char));
+    if (data_2 == NULL) goto cleanup;
+    // data_1 isn't the tail anymore, so it can only shrink
+    if (ctd_allocator_try_resize(&arena, data_1, 40, 50)) goto cleanup;
+    data_1[39] = 1;
+    if (!ctd_allocator_try_resize(&arena, data_1, 40, 30)) goto cleanup;
+    if (data_1[39] != 0 || context->length != 50) goto cleanup;
+
+    ctd_arena_allocator_destroy(&arena_allocator, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_arena_allocator_destroy(&arena_allocator, &heap_allocator);
+    return 1;
+}
+
+int test_ctd_arena_batch()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_arena_allocator arena_allocator = ctd_arena_allocator_create(100 * sizeof(char), &heap_allocator);
+    const ctd_allocator arena = arena_allocator.allocator;
+    ctd_arena_context* context = arena.context;
+    void* blocks[10];
+
+    // Blocks are rounded up to their alignment, but the last one isn't padded
+    if (!ctd_allocator_allocate_batch(&arena, 4, 6, 4, blocks)) goto cleanup;
+    if (context->length != 30) goto cleanup;
+    for (ptrdiff_t i = 0; i < 4; i++)
+    {
+        if ((char*)blocks[i] != context->data + i * 8) goto cleanup;
+    }
+    // A batch that doesn't fit fails without taking any memory
+    if (ctd_allocator_allocate_batch(&arena, 10, 8, 8, blocks)) goto cleanup;
+    if (context->length != 30) goto cleanup;
+
+    void* unpadded_blocks[8];
+    if (!ctd_allocator_allocate_batch(&arena, 8, 8, 8, unpadded_blocks)) goto cleanup;
+    if (context->length != 96) goto cleanup;
+    memset(unpadded_blocks[7], 1, 8);
+    ctd_allocator_deallocate_batch(&arena, 8, 8, unpadded_blocks);
+    if (context->length != 32 || *(char*)unpadded_blocks[7] != 0) goto cleanup;
+
+    ctd_arena_allocator_destroy(&arena_allocator, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_arena_allocator_destroy(&arena_allocator, &heap_allocator);
+    return 1;
+}
+
 int test_ctd_arena_deallocate()
 {
     ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
@@ -106,6 +205,69 @@ cleanup:
     return 1;
 }
 
+int test_ctd_arena_rewind()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_arena_allocator wrapped_arena = ctd_arena_allocator_create(100 * sizeof(char), &heap_allocator);
+    const ctd_allocator arena = wrapped_arena.allocator;
+    ctd_arena_context* context = arena.context;
+
+    char* data_1 = arena.allocate(context, 10 * sizeof(char), alignof(char));
+    ctd_arena_save_point save_point = ctd_arena_allocator_mark(&wrapped_arena);
+    char* data_2 = arena.allocate(context, 20 * sizeof(char), alignof(char));
+    arena.allocate(context, 30 * sizeof(char), alignof(char));
+    if (context->length != 60 * sizeof(char)) goto cleanup;
+
+    ctd_arena_allocator_rewind(&wrapped_arena, save_point);
+    if (context->length != 10 * sizeof(char)) goto cleanup;
+    char* data_3 = arena.allocate(context, 20 * sizeof(char), alignof(char));
+    if (data_3 != data_2) goto cleanup;
+
+    ctd_arena_allocator_reset(&wrapped_arena);
+    if (context->length != 0) goto cleanup;
+    char* data_4 = arena.allocate(context, 10 * sizeof(char), alignof(char));
+    if (data_4 != data_1) goto cleanup;
+
+    ctd_arena_allocator_destroy(&wrapped_arena, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_arena_allocator_destroy(&wrapped_arena, &heap_allocator);
+    return 1;
+}
+
+int test_ctd_arena_scrub_policy()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_arena_allocator unscrubbed_arena = ctd_arena_allocator_create_with_scrub_policy(100 * sizeof(char), CTD_SCRUB_NONE, &heap_allocator);
+    ctd_arena_allocator poisoned_arena = ctd_arena_allocator_create_with_scrub_policy(100 * sizeof(char), CTD_SCRUB_POISON, &heap_allocator);
+    const ctd_allocator unscrubbed = unscrubbed_arena.allocator;
+    const ctd_allocator poisoned = poisoned_arena.allocator;
+    if (unscrubbed.context == NULL || poisoned.context == NULL) goto cleanup;
+
+    char* data_1 = unscrubbed.allocate(unscrubbed.context, 10 * sizeof(char), alignof(char));
+    memset(data_1, 'a', 10 * sizeof(char));
+    unscrubbed.deallocate(unscrubbed.context, data_1, 10 * sizeof(char));
+    if (data_1[0] != 'a' || data_1[9] != 'a') goto cleanup;
+    if (ctd_arena_allocator_used(&unscrubbed_arena) != 0) goto cleanup;
+
+    char* data_2 = poisoned.allocate(poisoned.context, 10 * sizeof(char), alignof(char));
+    poisoned.allocate(poisoned.context, 10 * sizeof(char), alignof(char));
+    memset(data_2, 'a', 10 * sizeof(char));
+    // Shrinking a block that isn't at the end of the arena poisons the part that was cut off
+    poisoned.reallocate(poisoned.context, data_2, 10 * sizeof(char), 4 * sizeof(char), alignof(char));
+    if (data_2[3] != 'a' || (unsigned char)data_2[4] != CTD_SCRUB_POISON_BYTE) goto cleanup;
+    poisoned.deallocate(poisoned.context, data_2, 4 * sizeof(char));
+    if ((unsigned char)data_2[0] != CTD_SCRUB_POISON_BYTE) goto cleanup;
+
+    ctd_arena_allocator_destroy(&unscrubbed_arena, &heap_allocator);
+    ctd_arena_allocator_destroy(&poisoned_arena, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_arena_allocator_destroy(&unscrubbed_arena, &heap_allocator);
+    ctd_arena_allocator_destroy(&poisoned_arena, &heap_allocator);
+    return 1;
+}
+
 void test_ctd_arena_allocator_functions()
 {
     int status;
@@ -113,9 +275,14 @@ void test_ctd_arena_allocator_functions()
     printf("---------- Begin ctd_arena Test ----------\n");
 
     RUN_TEST(ctd_arena_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_arena_allocator_create_in_buffer, status, number_of_tests_failed)
     RUN_TEST(ctd_arena_allocate, status, number_of_tests_failed)
     RUN_TEST(ctd_arena_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_arena_try_resize, status, number_of_tests_failed)
+    RUN_TEST(ctd_arena_batch, status, number_of_tests_failed)
     RUN_TEST(ctd_arena_deallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_arena_rewind, status, number_of_tests_failed)
+    RUN_TEST(ctd_arena_scrub_policy, status, number_of_tests_failed)
 
     if (number_of_tests_failed == 0)
     {
@@ -0,0 +1,189 @@
+#include <test_ctd_buddy_allocator.h>
+#include <ctd_buddy_allocator.h>
+#include <ctd_string.h>
+#include <ctd_define.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+int test_ctd_buddy_allocator_create()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    // Rounded up to 4096 bytes
+    ctd_buddy_allocator buddy_allocator = ctd_buddy_allocator_create(3000, 64, &heap_allocator);
+    const ctd_allocator allocator = buddy_allocator.allocator;
+    if (allocator.context == NULL) return 1;
+    if (allocator.allocate == NULL) goto cleanup;
+    if (allocator.reallocate == NULL) goto cleanup;
+    if (allocator.deallocate == NULL) goto cleanup;
+    if (ctd_buddy_allocator_free_bytes(&buddy_allocator) != 4096) goto cleanup;
+    if (ctd_buddy_allocator_largest_free_block(&buddy_allocator) != 4096) goto cleanup;
+
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+    return 0;
+cleanup:
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+    return 1;
+}
+
+int test_ctd_buddy_allocator_allocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_buddy_allocator buddy_allocator = ctd_buddy_allocator_create(4096, 64, &heap_allocator);
+    const ctd_allocator allocator = buddy_allocator.allocator;
+
+    // Each block is rounded up to a power of two, and aligned to it
+    char* blocks[4];
+    const ptrdiff_t sizes[4] = {1000, 64, 100, 2000};
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        blocks[i] = allocator.allocate(allocator.context, sizes[i], alignof(max_align_t));
+        if (blocks[i] == NULL) goto cleanup;
+        memset(blocks[i], (int)i + 1, sizes[i]);
+    }
+    if ((uintptr_t)blocks[0] % 1024 != 0 || (uintptr_t)blocks[3] % 2048 != 0) goto cleanup;
+    if (ctd_buddy_allocator_free_bytes(&buddy_allocator) != 4096 - 1024 - 64 - 128 - 2048) goto cleanup;
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        if (blocks[i][sizes[i] - 1] != (char)(i + 1)) goto cleanup;
+    }
+
+    // Bigger than any free block
+    if (allocator.allocate(allocator.context, 1024, alignof(char)) != NULL) goto cleanup;
+    // Bigger than the region
+    if (allocator.allocate(allocator.context, 8192, alignof(char)) != NULL) goto cleanup;
+    // Aligned to more than the block's size
+    if (allocator.allocate(allocator.context, 64, 128) != NULL) goto cleanup;
+
+    ptrdiff_t usable_size = 0;
+    char* sized = ctd_allocator_allocate_sized(&allocator, 300, alignof(char), &usable_size);
+    if (sized == NULL || usable_size != 512) goto cleanup;
+
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+    return 0;
+cleanup:
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+    return 1;
+}
+
+int test_ctd_buddy_allocator_deallocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_buddy_allocator buddy_allocator = ctd_buddy_allocator_create(4096, 64, &heap_allocator);
+    const ctd_allocator allocator = buddy_allocator.allocator;
+
+    char* blocks[64];
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        blocks[i] = allocator.allocate(allocator.context, 64, alignof(char));
+        if (blocks[i] == NULL) goto cleanup;
+        blocks[i][0] = 1;
+    }
+    if (ctd_buddy_allocator_free_bytes(&buddy_allocator) != 0) goto cleanup;
+
+    // Every other block is free, but no two free blocks are buddies
+    for (ptrdiff_t i = 0; i < countof(blocks); i += 2)
+    {
+        allocator.deallocate(allocator.context, blocks[i], 64);
+    }
+    if (blocks[0][1] != 0) goto cleanup;
+    if (ctd_buddy_allocator_largest_free_block(&buddy_allocator) != 64) goto cleanup;
+
+    // Freed in an arbitrary order, and merged back into a single block
+    for (ptrdiff_t i = countof(blocks) - 1; i > 0; i -= 2)
+    {
+        allocator.deallocate(allocator.context, blocks[(i * 7) % countof(blocks) | 1], 64);
+    }
+    if (ctd_buddy_allocator_largest_free_block(&buddy_allocator) != 4096) goto cleanup;
+    if (ctd_buddy_allocator_free_bytes(&buddy_allocator) != 4096) goto cleanup;
+    if (allocator.allocate(allocator.context, 4096, alignof(char)) != blocks[0]) goto cleanup;
+
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+    return 0;
+cleanup:
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+    return 1;
+}
+
+int test_ctd_buddy_allocator_reallocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_buddy_allocator buddy_allocator = ctd_buddy_allocator_create(4096, 64, &heap_allocator);
+    const ctd_allocator allocator = buddy_allocator.allocator;
+
+    char* first = allocator.allocate(allocator.context, 64, alignof(char));
+    char* second = allocator.allocate(allocator.context, 64, alignof(char));
+    if (first == NULL || second == NULL) goto cleanup;
+    memset(second, 2, 64);
+
+    // second's buddy is taken, so it has to move
+    char* moved = allocator.reallocate(allocator.context, second, 64, 128, alignof(char));
+    if (moved == NULL || moved == second || moved[63] != 2) goto cleanup;
+    // first's buddy was freed by the move, and the rest of the region is free as well
+    if (!ctd_allocator_try_resize(&allocator, first, 64, 128)) goto cleanup;
+    if (ctd_allocator_try_resize(&allocator, first, 128, 512)) goto cleanup;
+    allocator.deallocate(allocator.context, moved, 128);
+    if (allocator.reallocate(allocator.context, first, 128, 2048, alignof(char)) != first) goto cleanup;
+
+    // Shrinking frees the halves that are no longer needed
+    first[100] = 1;
+    if (allocator.reallocate(allocator.context, first, 2048, 64, alignof(char)) != first) goto cleanup;
+    if (first[100] != 0) goto cleanup;
+    if (ctd_buddy_allocator_free_bytes(&buddy_allocator) != 4096 - 64) goto cleanup;
+
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+    return 0;
+cleanup:
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+    return 1;
+}
+
+int test_ctd_buddy_allocator_string_builder()
+{
+    ctd_error error = {0};
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_buddy_allocator buddy_allocator = ctd_buddy_allocator_create(1 << 16, 64, &heap_allocator);
+    ctd_string_builder builder = ctd_string_builder_create(64, &buddy_allocator.allocator, &error);
+    if (error.error_type != NO_ERROR) goto cleanup;
+    const char* data = builder.data;
+
+    // Nothing else is allocated, so every buddy the builder grows into is free
+    ctd_string str = ctd_string_create_from_literal("Hello there!");
+    for (ptrdiff_t i = 0; i < 1000; i++)
+    {
+        ctd_string_builder_append(&builder, str, &error);
+        if (error.error_type != NO_ERROR) goto cleanup;
+    }
+    if (builder.data != data) goto cleanup;
+
+    ctd_string_builder_destroy(&builder);
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+    return 0;
+cleanup:
+    ctd_string_builder_destroy(&builder);
+    ctd_buddy_allocator_destroy(&buddy_allocator);
+    return 1;
+}
+
+void test_ctd_buddy_allocator_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_buddy_allocator Test ----------\n");
+
+    RUN_TEST(ctd_buddy_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_buddy_allocator_allocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_buddy_allocator_deallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_buddy_allocator_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_buddy_allocator_string_builder, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_buddy_allocator Test ----------\n\n");
+}
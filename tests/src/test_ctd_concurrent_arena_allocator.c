@@ -0,0 +1,201 @@
+#include <test_ctd_concurrent_arena_allocator.h>
+#include <ctd_concurrent_arena_allocator.h>
+#include <ctd_define.h>
+#include <test.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+#define TEST_THREAD_COUNT 8
+#define TEST_ALLOCATIONS_PER_THREAD 2000
+
+int test_ctd_concurrent_arena_allocator_create()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_concurrent_arena_allocator concurrent_arena = ctd_concurrent_arena_allocator_create(1024, &heap_allocator);
+    const ctd_allocator arena = concurrent_arena.allocator;
+    if (arena.context == NULL) return 1;
+    if (arena.allocate == NULL) goto cleanup;
+    if (ctd_concurrent_arena_allocator_used(&concurrent_arena) != 0) goto cleanup;
+
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return 1;
+}
+
+int test_ctd_concurrent_arena_allocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_concurrent_arena_allocator concurrent_arena = ctd_concurrent_arena_allocator_create(1024, &heap_allocator);
+    const ctd_allocator arena = concurrent_arena.allocator;
+
+    char* data_1 = arena.allocate(arena.context, 3, alignof(char));
+    if (data_1 == NULL) goto cleanup;
+    // Every allocation is rounded up, so the next one is aligned without any padding
+    if (ctd_concurrent_arena_allocator_used(&concurrent_arena) != CTD_CONCURRENT_ARENA_ALIGNMENT) goto cleanup;
+    uint64_t* data_2 = arena.allocate(arena.context, 2 * sizeof(uint64_t), alignof(uint64_t));
+    if ((char*)data_2 != data_1 + CTD_CONCURRENT_ARENA_ALIGNMENT) goto cleanup;
+    char* data_3 = arena.allocate(arena.context, 10, 256);
+    if (data_3 == NULL) goto cleanup;
+    if ((uintptr_t)data_3 % 256 != 0) goto cleanup;
+    if (arena.allocate(arena.context, 1024, alignof(char)) != NULL) goto cleanup;
+
+    ctd_concurrent_arena_allocator_reset(&concurrent_arena);
+    if (ctd_concurrent_arena_allocator_used(&concurrent_arena) != 0) goto cleanup;
+    if (arena.allocate(arena.context, 1024, alignof(char)) != data_1) goto cleanup;
+
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return 1;
+}
+
+int test_ctd_concurrent_arena_failed_allocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_concurrent_arena_allocator concurrent_arena = ctd_concurrent_arena_allocator_create(4096, &heap_allocator);
+    const ctd_allocator arena = concurrent_arena.allocator;
+
+    // A request that doesn't fit must not use up the rest of the arena
+    if (arena.allocate(arena.context, 8192, alignof(char)) != NULL) goto cleanup;
+    if (ctd_concurrent_arena_allocator_used(&concurrent_arena) != 0) goto cleanup;
+    char* data_1 = arena.allocate(arena.context, 16, alignof(char));
+    if (data_1 == NULL) goto cleanup;
+    if (arena.allocate(arena.context, 4096, 256) != NULL) goto cleanup;
+    if (ctd_concurrent_arena_allocator_used(&concurrent_arena) != CTD_CONCURRENT_ARENA_ALIGNMENT) goto cleanup;
+    if (arena.allocate(arena.context, 16, alignof(char)) != data_1 + CTD_CONCURRENT_ARENA_ALIGNMENT) goto cleanup;
+
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return 1;
+}
+
+int test_ctd_concurrent_arena_reallocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_concurrent_arena_allocator concurrent_arena = ctd_concurrent_arena_allocator_create(1024, &heap_allocator);
+    const ctd_allocator arena = concurrent_arena.allocator;
+
+    char* data_1 = arena.allocate(arena.context, 20, alignof(char));
+    data_1[0] = 'a';
+    char* data_2 = arena.reallocate(arena.context, data_1, 20, 100, alignof(char));
+    if (data_2 != data_1) goto cleanup;
+    if (ctd_concurrent_arena_allocator_used(&concurrent_arena) != 112) goto cleanup;
+    char* data_3 = arena.reallocate(arena.context, data_2, 100, 10, alignof(char));
+    if (data_3 != data_1) goto cleanup;
+    if (ctd_concurrent_arena_allocator_used(&concurrent_arena) != 16) goto cleanup;
+
+    arena.allocate(arena.context, 1, alignof(char));
+    // No longer at the end of the arena, so growing has to copy
+    char* data_4 = arena.reallocate(arena.context, data_3, 10, 100, alignof(char));
+    if (data_4 == data_3 || data_4 == NULL) goto cleanup;
+    if (data_4[0] != 'a') goto cleanup;
+    arena.deallocate(arena.context, data_4, 100);
+    if (ctd_concurrent_arena_allocator_used(&concurrent_arena) != 32) goto cleanup;
+
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return 1;
+}
+
+int test_ctd_concurrent_arena_reserve()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_concurrent_arena_allocator concurrent_arena = ctd_concurrent_arena_allocator_create(1024, &heap_allocator);
+
+    ctd_concurrent_arena_chunk chunk = ctd_concurrent_arena_allocator_reserve(&concurrent_arena, 100);
+    if (chunk.data == NULL) goto cleanup;
+    if (chunk.capacity != 112) goto cleanup;
+    uint32_t* data_1 = ctd_concurrent_arena_chunk_allocate(&chunk, 25 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_1 == NULL) goto cleanup;
+    if (ctd_concurrent_arena_chunk_allocate(&chunk, 3 * sizeof(uint32_t), alignof(uint32_t)) == NULL) goto cleanup;
+    if (ctd_concurrent_arena_chunk_allocate(&chunk, 1, alignof(char)) != NULL) goto cleanup;
+
+    ctd_concurrent_arena_chunk too_large = ctd_concurrent_arena_allocator_reserve(&concurrent_arena, 1024);
+    if (too_large.data != NULL) goto cleanup;
+
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return 1;
+}
+
+static void* test_concurrent_arena_worker(void* argument)
+{
+    const ctd_allocator* arena = argument;
+    uint64_t* blocks[TEST_ALLOCATIONS_PER_THREAD];
+    for (ptrdiff_t i = 0; i < TEST_ALLOCATIONS_PER_THREAD; i++)
+    {
+        const ptrdiff_t align = i % 3 == 0 ? 64 : alignof(uint64_t);
+        blocks[i] = arena->allocate(arena->context, 3 * sizeof(uint64_t), align);
+        if (blocks[i] == NULL || (uintptr_t)blocks[i] % align != 0) return argument;
+        for (ptrdiff_t j = 0; j < 3; j++)
+        {
+            blocks[i][j] = (uintptr_t)blocks;
+        }
+    }
+    // Another thread writing to the same memory would have overwritten the pattern
+    for (ptrdiff_t i = 0; i < TEST_ALLOCATIONS_PER_THREAD; i++)
+    {
+        for (ptrdiff_t j = 0; j < 3; j++)
+        {
+            if (blocks[i][j] != (uintptr_t)blocks) return argument;
+        }
+    }
+
+    return NULL;
+}
+
+int test_ctd_concurrent_arena_threads()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_concurrent_arena_allocator concurrent_arena = ctd_concurrent_arena_allocator_create(4 << 20, &heap_allocator);
+    pthread_t threads[TEST_THREAD_COUNT];
+    int failed = 0;
+
+    for (ptrdiff_t i = 0; i < TEST_THREAD_COUNT; i++)
+    {
+        pthread_create(&threads[i], NULL, test_concurrent_arena_worker, &concurrent_arena.allocator);
+    }
+    for (ptrdiff_t i = 0; i < TEST_THREAD_COUNT; i++)
+    {
+        void* result;
+        pthread_join(threads[i], &result);
+        failed |= result != NULL;
+    }
+
+    ctd_concurrent_arena_allocator_destroy(&concurrent_arena, &heap_allocator);
+    return failed;
+}
+
+void test_ctd_concurrent_arena_allocator_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_concurrent_arena Test ----------\n");
+
+    RUN_TEST(ctd_concurrent_arena_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_concurrent_arena_allocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_concurrent_arena_failed_allocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_concurrent_arena_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_concurrent_arena_reserve, status, number_of_tests_failed)
+    RUN_TEST(ctd_concurrent_arena_threads, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_concurrent_arena Test ----------\n\n");
+}
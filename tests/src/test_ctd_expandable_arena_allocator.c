@@ -10,6 +10,7 @@ typedef struct ctd_expandable_arena_context
     ptrdiff_t capacity;
     char* data;
     ctd_allocator* allocator;
+    ctd_scrub_function scrub;
 } ctd_expandable_arena_context;
 
 int test_ctd_expandable_arena_allocator_create()
@@ -89,6 +90,31 @@ cleanup:
     return 1;
 }
 
+int test_ctd_expandable_arena_try_resize()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_expandable_arena_allocator arena_allocator = ctd_expandable_arena_allocator_create(100 * sizeof(char), &heap_allocator);
+    const ctd_allocator arena = arena_allocator.allocator;
+    ctd_expandable_arena_context* context = arena.context;
+
+    char* data_1 = arena.allocate(context, 10, alignof(char));
+    if (!ctd_allocator_try_resize(&arena, data_1, 10, 40)) goto cleanup;
+    if (context->length != 40) goto cleanup;
+    // Growing past the capacity would expand the arena, which can move it
+    if (ctd_allocator_try_resize(&arena, data_1, 40, 200)) goto cleanup;
+    if (context->capacity != 100) goto cleanup;
+
+    data_1[39] = 1;
+    if (!ctd_allocator_try_resize(&arena, data_1, 40, 30)) goto cleanup;
+    if (data_1[39] != 0 || context->length != 30) goto cleanup;
+
+    ctd_expandable_arena_allocator_destroy(&arena_allocator);
+    return 0;
+cleanup:
+    ctd_expandable_arena_allocator_destroy(&arena_allocator);
+    return 1;
+}
+
 int test_ctd_expandable_arena_deallocate()
 {
     ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
@@ -113,6 +139,34 @@ cleanup:
     return 1;
 }
 
+int test_ctd_expandable_arena_rewind()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_expandable_arena_allocator wrapped_arena = ctd_expandable_arena_allocator_create(100 * sizeof(char), &heap_allocator);
+    const ctd_allocator arena = wrapped_arena.allocator;
+    ctd_expandable_arena_context* context = arena.context;
+
+    arena.allocate(context, 10 * sizeof(char), alignof(char));
+    ctd_arena_save_point save_point = ctd_expandable_arena_allocator_mark(&wrapped_arena);
+    arena.allocate(context, 200 * sizeof(char), alignof(char));
+    const ptrdiff_t expanded_capacity = context->capacity;
+    if (ctd_expandable_arena_allocator_used(&wrapped_arena) != 210 * sizeof(char)) goto cleanup;
+    if (ctd_expandable_arena_allocator_capacity(&wrapped_arena) != expanded_capacity) goto cleanup;
+
+    ctd_expandable_arena_allocator_rewind(&wrapped_arena, save_point);
+    if (context->length != 10 * sizeof(char)) goto cleanup;
+    if (context->capacity != expanded_capacity) goto cleanup;
+
+    ctd_expandable_arena_allocator_reset(&wrapped_arena);
+    if (context->length != 0) goto cleanup;
+
+    ctd_expandable_arena_allocator_destroy(&wrapped_arena);
+    return 0;
+cleanup:
+    ctd_expandable_arena_allocator_destroy(&wrapped_arena);
+    return 1;
+}
+
 void test_ctd_expandable_arena_allocator_functions()
 {
 
@@ -123,7 +177,9 @@ void test_ctd_expandable_arena_allocator_functions()
     RUN_TEST(ctd_expandable_arena_allocator_create, status, number_of_tests_failed)
     RUN_TEST(ctd_expandable_arena_allocate, status, number_of_tests_failed)
     RUN_TEST(ctd_expandable_arena_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_expandable_arena_try_resize, status, number_of_tests_failed)
     RUN_TEST(ctd_expandable_arena_deallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_expandable_arena_rewind, status, number_of_tests_failed)
 
     if (number_of_tests_failed == 0)
     {
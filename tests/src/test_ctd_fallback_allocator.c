@@ -0,0 +1,212 @@
+#include <test_ctd_fallback_allocator.h>
+#include <ctd_fallback_allocator.h>
+#include <ctd_stats_allocator.h>
+#include <ctd_string.h>
+#include <ctd_define.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+int test_ctd_fallback_allocator_create()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    alignas(max_align_t) char buffer[256];
+    ctd_fallback_allocator fallback_allocator = ctd_fallback_allocator_create(buffer, sizeof(buffer), &heap_allocator);
+    const ctd_allocator allocator = fallback_allocator.allocator;
+    if (allocator.context == NULL) return 1;
+    if (allocator.allocate == NULL) return 1;
+    if (allocator.reallocate == NULL) return 1;
+    if (allocator.deallocate == NULL) return 1;
+    if (ctd_fallback_allocator_used(&fallback_allocator) != 0) return 1;
+    // The bookkeeping is stored at the front of the buffer
+    if ((char*)allocator.context < buffer || (char*)allocator.context >= buffer + sizeof(buffer)) return 1;
+    ctd_fallback_allocator_destroy(&fallback_allocator);
+    if (fallback_allocator.allocator.context != NULL) return 1;
+
+    // Too small for the bookkeeping
+    ctd_fallback_allocator too_small = ctd_fallback_allocator_create(buffer, 4, &heap_allocator);
+    if (too_small.allocator.context != NULL) return 1;
+    ctd_fallback_allocator negative = ctd_fallback_allocator_create(buffer, -1, &heap_allocator);
+    if (negative.allocator.context != NULL) return 1;
+
+    return 0;
+}
+
+int test_ctd_fallback_allocator_allocate()
+{
+    ctd_stats_allocator stats_allocator = ctd_stats_allocator_create(&ctd_heap_allocator_instance.allocator, false);
+    alignas(max_align_t) char buffer[256];
+    ctd_fallback_allocator fallback_allocator = ctd_fallback_allocator_create(buffer, sizeof(buffer), &stats_allocator.allocator);
+    const ctd_allocator allocator = fallback_allocator.allocator;
+    char* spilled = NULL;
+
+    char* small = allocator.allocate(allocator.context, 100, alignof(char));
+    if (small == NULL || !ctd_fallback_allocator_owns(&fallback_allocator, small)) goto cleanup;
+    char* aligned = allocator.allocate(allocator.context, 16, 64);
+    if (aligned == NULL || !ctd_fallback_allocator_owns(&fallback_allocator, aligned)) goto cleanup;
+    if ((uintptr_t)aligned % 64 != 0) goto cleanup;
+    memset(small, 1, 100);
+    memset(aligned, 2, 16);
+    if (ctd_stats_allocator_get_stats(&stats_allocator).allocations != 0) goto cleanup;
+
+    // The rest of the buffer can't hold it, so it goes to the parent allocator
+    spilled = allocator.allocate(allocator.context, 200, alignof(char));
+    if (spilled == NULL || ctd_fallback_allocator_owns(&fallback_allocator, spilled)) goto cleanup;
+    memset(spilled, 3, 200);
+    if (ctd_stats_allocator_get_stats(&stats_allocator).allocations != 1) goto cleanup;
+    if (small[99] != 1 || aligned[15] != 2) goto cleanup;
+
+    allocator.deallocate(allocator.context, spilled, 200);
+    if (ctd_stats_allocator_get_stats(&stats_allocator).bytes_live != 0) goto cleanup;
+
+    ctd_fallback_allocator_destroy(&fallback_allocator);
+    ctd_stats_allocator_destroy(&stats_allocator);
+    return 0;
+cleanup:
+    if (spilled != NULL) allocator.deallocate(allocator.context, spilled, 200);
+    ctd_fallback_allocator_destroy(&fallback_allocator);
+    ctd_stats_allocator_destroy(&stats_allocator);
+    return 1;
+}
+
+int test_ctd_fallback_allocator_deallocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    alignas(max_align_t) char buffer[256];
+    ctd_fallback_allocator fallback_allocator = ctd_fallback_allocator_create(buffer, sizeof(buffer), &heap_allocator);
+    const ctd_allocator allocator = fallback_allocator.allocator;
+
+    char* a = allocator.allocate(allocator.context, 32, alignof(char));
+    char* b = allocator.allocate(allocator.context, 32, alignof(char));
+    if (a == NULL || b == NULL) return 1;
+    memset(a, 1, 32);
+    memset(b, 1, 32);
+
+    // Freeing a block that isn't the most recent one zeroes it but keeps its memory
+    allocator.deallocate(allocator.context, a, 32);
+    if (a[0] != 0 || a[31] != 0) return 1;
+    if (ctd_fallback_allocator_used(&fallback_allocator) != 64) return 1;
+    // Freeing the most recent one gives its memory back
+    allocator.deallocate(allocator.context, b, 32);
+    if (b[0] != 0) return 1;
+    if (ctd_fallback_allocator_used(&fallback_allocator) != 32) return 1;
+    if (allocator.allocate(allocator.context, 32, alignof(char)) != b) return 1;
+
+    return 0;
+}
+
+int test_ctd_fallback_allocator_reallocate()
+{
+    ctd_stats_allocator stats_allocator = ctd_stats_allocator_create(&ctd_heap_allocator_instance.allocator, false);
+    alignas(max_align_t) char buffer[256];
+    ctd_fallback_allocator fallback_allocator = ctd_fallback_allocator_create(buffer, sizeof(buffer), &stats_allocator.allocator);
+    const ctd_allocator allocator = fallback_allocator.allocator;
+    const ptrdiff_t capacity = sizeof(buffer) - ctd_fallback_allocator_used(&fallback_allocator) - 64;
+    char* block = NULL;
+    ptrdiff_t size = 0;
+
+    // The most recent block grows in place
+    char* a = allocator.allocate(allocator.context, 16, alignof(char));
+    if (a == NULL) goto cleanup;
+    memset(a, 1, 16);
+    char* grown = allocator.reallocate(allocator.context, a, 16, 32, alignof(char));
+    if (grown != a || ctd_fallback_allocator_used(&fallback_allocator) != 32) goto cleanup;
+    memset(a + 16, 1, 16);
+
+    // Any other block moves to the end of the buffer
+    char* b = allocator.allocate(allocator.context, 16, alignof(char));
+    if (b == NULL) goto cleanup;
+    memset(b, 2, 16);
+    char* moved = allocator.reallocate(allocator.context, a, 32, 48, alignof(char));
+    if (moved == NULL || moved == a || !ctd_fallback_allocator_owns(&fallback_allocator, moved)) goto cleanup;
+    if (moved[0] != 1 || moved[31] != 1 || b[15] != 2) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&stats_allocator).allocations != 0) goto cleanup;
+
+    // Until the buffer is full and the block migrates to the parent allocator
+    block = allocator.reallocate(allocator.context, moved, 48, capacity, alignof(char));
+    size = capacity;
+    if (block == NULL || ctd_fallback_allocator_owns(&fallback_allocator, block)) goto cleanup;
+    if (block[0] != 1 || block[31] != 1) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&stats_allocator).bytes_live != capacity) goto cleanup;
+    // It was the most recent block, so its memory in the buffer was given back
+    if (ctd_fallback_allocator_used(&fallback_allocator) != 48) goto cleanup;
+
+    // Once in the parent allocator, the block stays there even if it would fit in the buffer again
+    block = allocator.reallocate(allocator.context, block, capacity, 8, alignof(char));
+    size = 8;
+    if (block == NULL || ctd_fallback_allocator_owns(&fallback_allocator, block)) goto cleanup;
+    if (block[0] != 1 || block[7] != 1) goto cleanup;
+
+    allocator.deallocate(allocator.context, block, size);
+    if (ctd_stats_allocator_get_stats(&stats_allocator).bytes_live != 0) goto cleanup;
+
+    ctd_fallback_allocator_destroy(&fallback_allocator);
+    ctd_stats_allocator_destroy(&stats_allocator);
+    return 0;
+cleanup:
+    if (block != NULL) allocator.deallocate(allocator.context, block, size);
+    ctd_fallback_allocator_destroy(&fallback_allocator);
+    ctd_stats_allocator_destroy(&stats_allocator);
+    return 1;
+}
+
+int test_ctd_fallback_allocator_string_builder()
+{
+    ctd_error error = {0};
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    alignas(max_align_t) char buffer[256];
+    ctd_fallback_allocator fallback_allocator = ctd_fallback_allocator_create(buffer, sizeof(buffer), &heap_allocator);
+    ctd_string_builder builder = ctd_string_builder_create(16, &fallback_allocator.allocator, &error);
+    if (error.error_type != NO_ERROR) return 1;
+
+    // Short strings are built in the buffer, and longer ones carry on in the parent allocator
+    ctd_string str = ctd_string_create_from_literal("Hello there!");
+    for (ptrdiff_t i = 0; i < 10; i++)
+    {
+        ctd_string_builder_append(&builder, str, &error);
+        if (error.error_type != NO_ERROR) goto cleanup;
+    }
+    if (!ctd_fallback_allocator_owns(&fallback_allocator, builder.data)) goto cleanup;
+    for (ptrdiff_t i = 0; i < 100; i++)
+    {
+        ctd_string_builder_append(&builder, str, &error);
+        if (error.error_type != NO_ERROR) goto cleanup;
+    }
+    if (ctd_fallback_allocator_owns(&fallback_allocator, builder.data)) goto cleanup;
+    if (builder.length != 110 * str.length) goto cleanup;
+    for (ptrdiff_t i = 0; i < 110; i++)
+    {
+        if (memcmp(builder.data + i * str.length, str.data, str.length) != 0) goto cleanup;
+    }
+
+    ctd_string_builder_destroy(&builder);
+    ctd_fallback_allocator_destroy(&fallback_allocator);
+    return 0;
+cleanup:
+    ctd_string_builder_destroy(&builder);
+    ctd_fallback_allocator_destroy(&fallback_allocator);
+    return 1;
+}
+
+void test_ctd_fallback_allocator_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_fallback_allocator Test ----------\n");
+
+    RUN_TEST(ctd_fallback_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_fallback_allocator_allocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_fallback_allocator_deallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_fallback_allocator_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_fallback_allocator_string_builder, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_fallback_allocator Test ----------\n\n");
+}
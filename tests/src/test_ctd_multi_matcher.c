@@ -0,0 +1,199 @@
+#include <test_ctd_multi_matcher.h>
+#include <ctd_multi_matcher.h>
+#include <ctd_stats_allocator.h>
+#include <test.h>
+#include <stdint.h>
+#include <string.h>
+
+int test_ctd_multi_matcher_create()
+{
+    ctd_error error = {0};
+    ctd_stats_allocator stats = ctd_stats_allocator_create(&ctd_heap_allocator_instance.allocator, false);
+    const ctd_string patterns[] = {
+        ctd_string_create_from_literal("he"),
+        ctd_string_create_from_literal("she"),
+        ctd_string_create_from_literal("his"),
+        ctd_string_create_from_literal("hers"),
+    };
+
+    ctd_multi_matcher matcher = ctd_multi_matcher_create(patterns, countof(patterns), &stats.allocator, &error);
+    if (error.error_type != NO_ERROR || matcher.tables == NULL) goto cleanup;
+    // h, he, her, hers, hi, his, s, sh, she and the root
+    if (matcher.state_count != 10) goto cleanup;
+    // e, h, i, r, s and every other byte
+    if (matcher.class_count != 6) goto cleanup;
+    // Only the memory the automaton was built in is left after creation
+    if (ctd_stats_allocator_get_stats(&stats).bytes_live != matcher.tables_size) goto cleanup;
+    ctd_multi_matcher_destroy(&matcher);
+    if (matcher.tables != NULL) goto cleanup;
+
+    const ctd_string empty_patterns[] = {ctd_string_create_from_literal("he"), {0}};
+    matcher = ctd_multi_matcher_create(empty_patterns, countof(empty_patterns), &stats.allocator, &error);
+    if (error.error_type != INVALID_ARGUMENT || matcher.tables != NULL) goto cleanup;
+    error = (ctd_error) {0};
+
+    // Without patterns nothing is ever found
+    matcher = ctd_multi_matcher_create(NULL, 0, &stats.allocator, &error);
+    if (error.error_type != NO_ERROR) goto cleanup;
+    if (ctd_multi_matcher_find_all(&matcher, ctd_string_create_from_literal("hers"), NULL, NULL) != 0) goto cleanup;
+    ctd_multi_matcher_destroy(&matcher);
+
+    if (ctd_stats_allocator_get_stats(&stats).bytes_live != 0) goto cleanup;
+    ctd_stats_allocator_destroy(&stats);
+    return 0;
+cleanup:
+    ctd_multi_matcher_destroy(&matcher);
+    ctd_stats_allocator_destroy(&stats);
+    return 1;
+}
+
+typedef struct test_multi_matches
+{
+    ctd_multi_match matches[8];
+    ptrdiff_t count;
+    ptrdiff_t limit;
+} test_multi_matches;
+
+static bool test_multi_matcher_collect(void* user_data, ptrdiff_t pattern_id, ptrdiff_t offset)
+{
+    test_multi_matches* matches = user_data;
+    matches->matches[matches->count++] = (ctd_multi_match) {.pattern_id = pattern_id, .offset = offset};
+    return matches->count < matches->limit;
+}
+
+int test_ctd_multi_matcher_find_all()
+{
+    ctd_error error = {0};
+    const ctd_string patterns[] = {
+        ctd_string_create_from_literal("he"),
+        ctd_string_create_from_literal("she"),
+        ctd_string_create_from_literal("his"),
+        ctd_string_create_from_literal("hers"),
+        ctd_string_create_from_literal("he"),
+    };
+    ctd_multi_matcher matcher = ctd_multi_matcher_create(patterns, countof(patterns), &ctd_heap_allocator_instance.allocator, &error);
+    const ctd_string str = ctd_string_create_from_literal("ushers");
+
+    // Matches are reported in the order they end, longest first, and equal patterns in the order they were given
+    const ctd_multi_match expected[] = {{1, 1}, {0, 2}, {4, 2}, {3, 2}};
+    test_multi_matches matches = {.limit = countof(matches.matches)};
+    if (ctd_multi_matcher_find_all(&matcher, str, test_multi_matcher_collect, &matches) != countof(expected)) goto cleanup;
+    if (matches.count != countof(expected)) goto cleanup;
+    for (ptrdiff_t i = 0; i < countof(expected); i++)
+    {
+        if (matches.matches[i].pattern_id != expected[i].pattern_id || matches.matches[i].offset != expected[i].offset) goto cleanup;
+    }
+
+    // The callback stops the search
+    matches = (test_multi_matches) {.limit = 2};
+    if (ctd_multi_matcher_find_all(&matcher, str, test_multi_matcher_collect, &matches) != 2) goto cleanup;
+
+    ctd_dynamic_array_ctd_multi_match array = ctd_dynamic_array_create(ctd_multi_match, 1, &error);
+    ctd_multi_matcher_find_all_into(&matcher, str, &array, &error);
+    ctd_multi_matcher_find_all_into(&matcher, ctd_string_create_from_literal("this"), &array, &error);
+    if (error.error_type != NO_ERROR || array.length != countof(expected) + 1) goto array_cleanup;
+    for (ptrdiff_t i = 0; i < countof(expected); i++)
+    {
+        if (array.data[i].pattern_id != expected[i].pattern_id || array.data[i].offset != expected[i].offset) goto array_cleanup;
+    }
+    if (array.data[countof(expected)].pattern_id != 2 || array.data[countof(expected)].offset != 1) goto array_cleanup;
+
+    ctd_dynamic_array_ctd_multi_match_destroy(&array, &error);
+    ctd_multi_matcher_destroy(&matcher);
+    return 0;
+array_cleanup:
+    ctd_dynamic_array_ctd_multi_match_destroy(&array, &error);
+cleanup:
+    ctd_multi_matcher_destroy(&matcher);
+    return 1;
+}
+
+static uint64_t test_xorshift(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Checks random sets of patterns against a naive search. Patterns and strings are made of three bytes, one of them
+ * outside of ASCII, so that patterns are prefixes and suffixes of each other all the time.
+ */
+int test_ctd_multi_matcher_find_all_random()
+{
+    static const char alphabet[] = {'a', 'b', '\xFF'};
+    ctd_error error = {0};
+    char pattern_data[16][6];
+    ctd_string patterns[16];
+    char str_data[200];
+    uint64_t random = 0x9E3779B97F4A7C15u;
+    ctd_dynamic_array_ctd_multi_match array = ctd_dynamic_array_create(ctd_multi_match, 16, &error);
+    for (ptrdiff_t round = 0; round < 500; round++)
+    {
+        const ptrdiff_t pattern_count = 1 + (ptrdiff_t)(test_xorshift(&random) % countof(patterns));
+        for (ptrdiff_t i = 0; i < pattern_count; i++)
+        {
+            patterns[i] = (ctd_string) {.data = pattern_data[i], .length = 1 + (ptrdiff_t)(test_xorshift(&random) % countof(pattern_data[i]))};
+            for (ptrdiff_t j = 0; j < patterns[i].length; j++)
+            {
+                patterns[i].data[j] = alphabet[test_xorshift(&random) % countof(alphabet)];
+            }
+        }
+        const ctd_string str = {.data = str_data, .length = (ptrdiff_t)(test_xorshift(&random) % countof(str_data))};
+        for (ptrdiff_t i = 0; i < str.length; i++)
+        {
+            str.data[i] = alphabet[test_xorshift(&random) % countof(alphabet)];
+        }
+
+        ctd_multi_matcher matcher = ctd_multi_matcher_create(patterns, pattern_count, &ctd_heap_allocator_instance.allocator, &error);
+        array.length = 0;
+        ctd_multi_matcher_find_all_into(&matcher, str, &array, &error);
+        ctd_multi_matcher_destroy(&matcher);
+        if (error.error_type != NO_ERROR) goto cleanup;
+
+        // Matches that end at the same index come longest first, and then in the order the patterns were given
+        ptrdiff_t match = 0;
+        for (ptrdiff_t end = 1; end <= str.length; end++)
+        {
+            for (ptrdiff_t length = countof(pattern_data[0]); length > 0; length--)
+            {
+                for (ptrdiff_t i = 0; i < pattern_count; i++)
+                {
+                    if (patterns[i].length != length || length > end || memcmp(str.data + end - length, patterns[i].data, length) != 0) continue;
+                    if (match >= array.length) goto cleanup;
+                    if (array.data[match].pattern_id != i || array.data[match].offset != end - length) goto cleanup;
+                    match++;
+                }
+            }
+        }
+        if (match != array.length) goto cleanup;
+    }
+
+    ctd_dynamic_array_ctd_multi_match_destroy(&array, &error);
+    return 0;
+cleanup:
+    ctd_dynamic_array_ctd_multi_match_destroy(&array, &error);
+    return 1;
+}
+
+void test_ctd_multi_matcher_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_multi_matcher Test ----------\n");
+
+    RUN_TEST(ctd_multi_matcher_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_multi_matcher_find_all, status, number_of_tests_failed)
+    RUN_TEST(ctd_multi_matcher_find_all_random, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_multi_matcher Test ----------\n\n");
+}
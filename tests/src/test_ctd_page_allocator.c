@@ -1,16 +1,34 @@
 #include <test_ctd_page_allocator.h>
 #include <ctd_arena_allocator.h>
 #include <ctd_page_allocator.h>
+#include <ctd_arena_scope.h>
 #include <ctd_internal_dynamic_array.h>
 #include <test.h>
 #include <stdint.h>
 #include <stdalign.h>
+#include <string.h>
+
+typedef struct ctd_large_page
+{
+    void* block;
+    ctd_arena_allocator page;
+    ptrdiff_t sequence;
+} ctd_large_page;
 
 typedef struct ctd_page_context
 {
     ctd_internal_dynamic_array(ctd_arena_allocator) arenas;
     ptrdiff_t default_page_size;
     ctd_allocator* allocator;
+    ptrdiff_t in_place_reallocations;
+    ctd_large_page* large_pages;
+    ptrdiff_t large_pages_capacity;
+    ptrdiff_t large_pages_used;
+    ptrdiff_t large_pages_live;
+    ptrdiff_t large_pages_created;
+    ctd_internal_dynamic_array(ctd_arena_allocator) free_pages;
+    ptrdiff_t pages_allocated;
+    ctd_scrub_policy scrub_policy;
 } ctd_page_context;
 
 int test_ctd_page_allocator_create()
@@ -42,9 +60,10 @@ int test_ctd_page_allocator_allocate()
     if (context->arenas.length <= 1) goto cleanup;
     if (context->arenas.capacity <= 1) goto cleanup;
     if (second_alloc == NULL) goto cleanup;
+    // Too large for a default page, so it gets a dedicated page and the current page stays in use
     void* third_alloc = page_allocator.allocate(page_allocator.context, 103 * sizeof(char), alignof(char));
-    if (context->arenas.length <= 2) goto cleanup;
-    if (context->arenas.capacity <= 2) goto cleanup;
+    if (context->arenas.length != 2) goto cleanup;
+    if (context->large_pages_live != 1) goto cleanup;
     if (third_alloc == NULL) goto cleanup;
 
     ctd_page_allocator_destroy(&wrapped_page_allocator);
@@ -69,8 +88,7 @@ int test_ctd_page_allocator_reallocate()
     first_alloc_data[2] = 6;
     first_alloc_data[3] = 7;
     void* second_alloc = page_allocator.reallocate(page_allocator.context, first_alloc, 98 * sizeof(char), 104 * sizeof(char), alignof(char));
-    if (context->arenas.length <= 1) goto cleanup;
-    if (context->arenas.capacity <= 1) goto cleanup;
+    if (context->large_pages_live != 1) goto cleanup;
     if (second_alloc == NULL) goto cleanup;
     uint32_t* second_alloc_data = second_alloc;
     if (second_alloc_data[0] != 4) goto cleanup;
@@ -84,6 +102,128 @@ cleanup:
     ctd_page_allocator_destroy(&wrapped_page_allocator);
     return 1;
 }
+int test_ctd_page_allocator_reallocate_in_place()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator wrapped_page_allocator = ctd_page_allocator_create(100 * sizeof(char), &heap_allocator);
+    ctd_allocator page_allocator = wrapped_page_allocator.allocator;
+    ctd_page_context* context = page_allocator.context;
+
+    char* first_alloc = page_allocator.allocate(page_allocator.context, 10 * sizeof(char), alignof(char));
+    if (first_alloc == NULL) goto cleanup;
+    first_alloc[0] = 1;
+    char* second_alloc = page_allocator.reallocate(page_allocator.context, first_alloc, 10 * sizeof(char), 50 * sizeof(char), alignof(char));
+    if (second_alloc != first_alloc) goto cleanup;
+    char* third_alloc = page_allocator.reallocate(page_allocator.context, second_alloc, 50 * sizeof(char), 20 * sizeof(char), alignof(char));
+    if (third_alloc != first_alloc) goto cleanup;
+    if (ctd_page_allocator_in_place_reallocations(&wrapped_page_allocator) != 2) goto cleanup;
+
+    // Once the block isn't the tail and the arena is exhausted, the data has to be copied into a new arena
+    if (page_allocator.allocate(page_allocator.context, 70 * sizeof(char), alignof(char)) == NULL) goto cleanup;
+    char* fourth_alloc = page_allocator.reallocate(page_allocator.context, third_alloc, 20 * sizeof(char), 30 * sizeof(char), alignof(char));
+    if (fourth_alloc == NULL || fourth_alloc == third_alloc) goto cleanup;
+    if (fourth_alloc[0] != 1) goto cleanup;
+    if (context->arenas.length != 2) goto cleanup;
+    if (ctd_page_allocator_in_place_reallocations(&wrapped_page_allocator) != 2) goto cleanup;
+
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 0;
+cleanup:
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 1;
+}
+int test_ctd_page_allocator_try_resize()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator wrapped_page_allocator = ctd_page_allocator_create(100 * sizeof(char), &heap_allocator);
+    ctd_allocator page_allocator = wrapped_page_allocator.allocator;
+    ctd_page_context* context = page_allocator.context;
+
+    char* first_alloc = page_allocator.allocate(page_allocator.context, 10 * sizeof(char), alignof(char));
+    if (first_alloc == NULL) goto cleanup;
+    if (!ctd_allocator_try_resize(&page_allocator, first_alloc, 10 * sizeof(char), 50 * sizeof(char))) goto cleanup;
+    // try_resize never adds a page
+    if (ctd_allocator_try_resize(&page_allocator, first_alloc, 50 * sizeof(char), 150 * sizeof(char))) goto cleanup;
+    if (context->arenas.length != 1) goto cleanup;
+
+    // A block with a dedicated page can grow into the rest of it
+    char* large_alloc = page_allocator.allocate(page_allocator.context, 200 * sizeof(char), 16);
+    if (large_alloc == NULL) goto cleanup;
+    if (!ctd_allocator_try_resize(&page_allocator, large_alloc, 200 * sizeof(char), 210 * sizeof(char))) goto cleanup;
+    if (ctd_allocator_try_resize(&page_allocator, large_alloc, 210 * sizeof(char), 400 * sizeof(char))) goto cleanup;
+
+    first_alloc[49] = 1;
+    if (!ctd_allocator_try_resize(&page_allocator, first_alloc, 50 * sizeof(char), 20 * sizeof(char))) goto cleanup;
+    if (first_alloc[49] != 0) goto cleanup;
+
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 0;
+cleanup:
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 1;
+}
+
+int test_ctd_page_allocator_allocate_sized()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator wrapped_page_allocator = ctd_page_allocator_create(100 * sizeof(char), &heap_allocator);
+    ctd_allocator page_allocator = wrapped_page_allocator.allocator;
+
+    // Other allocations come after a block in a regular page, so it only gets what it asked for
+    ptrdiff_t usable_size = 0;
+    char* small_alloc = ctd_allocator_allocate_sized(&page_allocator, 10 * sizeof(char), alignof(char), &usable_size);
+    if (small_alloc == NULL || usable_size != 10 * sizeof(char)) goto cleanup;
+
+    // A block with a dedicated page gets the rest of it
+    char* large_alloc = ctd_allocator_allocate_sized(&page_allocator, 200 * sizeof(char), 16, &usable_size);
+    if (large_alloc == NULL || usable_size <= (ptrdiff_t)(200 * sizeof(char))) goto cleanup;
+    memset(large_alloc, 1, usable_size);
+    if (ctd_allocator_try_resize(&page_allocator, large_alloc, usable_size, usable_size + 1)) goto cleanup;
+
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 0;
+cleanup:
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 1;
+}
+
+int test_ctd_page_allocator_batch()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator wrapped_page_allocator = ctd_page_allocator_create(100 * sizeof(char), &heap_allocator);
+    ctd_allocator page_allocator = wrapped_page_allocator.allocator;
+    ctd_page_context* context = page_allocator.context;
+    void* blocks[30];
+
+    // 30 blocks of 8 bytes need three pages
+    if (!ctd_allocator_allocate_batch(&page_allocator, 30, 8, 8, blocks)) goto cleanup;
+    if (context->arenas.length != 3) goto cleanup;
+    for (ptrdiff_t i = 0; i < 30; i++)
+    {
+        if ((uintptr_t)blocks[i] % 8 != 0) goto cleanup;
+        memset(blocks[i], (int)i, 8);
+    }
+    for (ptrdiff_t i = 0; i < 30; i++)
+    {
+        if (((char*)blocks[i])[7] != (char)i) goto cleanup;
+    }
+    ctd_allocator_deallocate_batch(&page_allocator, 30, 8, blocks);
+    if (((char*)blocks[0])[0] != 0) goto cleanup;
+
+    // Each large block gets its own page
+    void* large_blocks[2];
+    if (!ctd_allocator_allocate_batch(&page_allocator, 2, 200, 8, large_blocks)) goto cleanup;
+    if (context->large_pages_live != 2) goto cleanup;
+    ctd_allocator_deallocate_batch(&page_allocator, 2, 200, large_blocks);
+    if (context->free_pages.length != 2) goto cleanup;
+
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 0;
+cleanup:
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 1;
+}
+
 int test_ctd_page_allocator_deallocate()
 {
     ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
@@ -110,6 +250,212 @@ cleanup:
     ctd_page_allocator_destroy(&wrapped_page_allocator);
     return 1;
 }
+int test_ctd_page_allocator_rewind()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator wrapped_page_allocator = ctd_page_allocator_create(100 * sizeof(char), &heap_allocator);
+    ctd_allocator page_allocator = wrapped_page_allocator.allocator;
+    ctd_page_context* context = page_allocator.context;
+
+    page_allocator.allocate(page_allocator.context, 50 * sizeof(char), alignof(char));
+    ctd_arena_save_point save_point = ctd_page_allocator_mark(&wrapped_page_allocator);
+    char* first_alloc = page_allocator.allocate(page_allocator.context, 40 * sizeof(char), alignof(char));
+    char* second_alloc = page_allocator.allocate(page_allocator.context, 90 * sizeof(char), alignof(char));
+    char* third_alloc = page_allocator.allocate(page_allocator.context, 90 * sizeof(char), alignof(char));
+    if (context->arenas.length != 3) goto cleanup;
+
+    ctd_page_allocator_rewind(&wrapped_page_allocator, save_point);
+    if (context->arenas.length != 1) goto cleanup;
+    if (context->free_pages.length != 2) goto cleanup;
+    // The arenas added after the save point are cached and handed out again in the same order
+    if (page_allocator.allocate(page_allocator.context, 40 * sizeof(char), alignof(char)) != first_alloc) goto cleanup;
+    if (page_allocator.allocate(page_allocator.context, 90 * sizeof(char), alignof(char)) != second_alloc) goto cleanup;
+    if (page_allocator.allocate(page_allocator.context, 90 * sizeof(char), alignof(char)) != third_alloc) goto cleanup;
+    if (context->arenas.length != 3) goto cleanup;
+    if (context->pages_allocated != 3) goto cleanup;
+
+    ctd_page_allocator_reset(&wrapped_page_allocator);
+    if (context->arenas.length != 1) goto cleanup;
+    if (context->free_pages.length != 2) goto cleanup;
+
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 0;
+cleanup:
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 1;
+}
+
+int test_ctd_page_allocator_large_pages()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator wrapped_page_allocator = ctd_page_allocator_create_with_page_cache(100 * sizeof(char), 1, &heap_allocator);
+    ctd_allocator page_allocator = wrapped_page_allocator.allocator;
+
+    char* small_alloc = page_allocator.allocate(page_allocator.context, 10 * sizeof(char), alignof(char));
+    char* large_alloc = page_allocator.allocate(page_allocator.context, 1000 * sizeof(char), alignof(char));
+    if (small_alloc == NULL || large_alloc == NULL) goto cleanup;
+    // The small allocation's page wasn't abandoned
+    if (page_allocator.allocate(page_allocator.context, 10 * sizeof(char), alignof(char)) != small_alloc + 10) goto cleanup;
+    ctd_page_allocator_stats stats = ctd_page_allocator_get_stats(&wrapped_page_allocator);
+    if (stats.large_pages != 1) goto cleanup;
+    if (stats.pages_allocated != 2) goto cleanup;
+    if (stats.stranded_bytes != 0) goto cleanup;
+    if (stats.used_bytes != 1020 * sizeof(char)) goto cleanup;
+    if (stats.capacity_bytes != 1100 * sizeof(char)) goto cleanup;
+
+    // Freeing the large allocation puts its page into the cache, and the next large allocation reuses it
+    page_allocator.deallocate(page_allocator.context, large_alloc, 1000 * sizeof(char));
+    stats = ctd_page_allocator_get_stats(&wrapped_page_allocator);
+    if (stats.large_pages != 0) goto cleanup;
+    if (stats.cached_pages != 1) goto cleanup;
+    if (stats.cached_bytes != 1000 * sizeof(char)) goto cleanup;
+    if (stats.used_bytes != 20 * sizeof(char)) goto cleanup;
+    char* second_large_alloc = page_allocator.allocate(page_allocator.context, 900 * sizeof(char), alignof(char));
+    if (second_large_alloc != large_alloc) goto cleanup;
+    if (ctd_page_allocator_get_stats(&wrapped_page_allocator).pages_allocated != 2) goto cleanup;
+
+    // The cache only holds one page, so the other one is given back to the heap allocator
+    ctd_page_allocator_reset(&wrapped_page_allocator);
+    page_allocator.allocate(page_allocator.context, 90 * sizeof(char), alignof(char));
+    page_allocator.allocate(page_allocator.context, 90 * sizeof(char), alignof(char));
+    page_allocator.allocate(page_allocator.context, 90 * sizeof(char), alignof(char));
+    ctd_page_allocator_reset(&wrapped_page_allocator);
+    stats = ctd_page_allocator_get_stats(&wrapped_page_allocator);
+    if (stats.cached_pages != 1) goto cleanup;
+
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 0;
+cleanup:
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 1;
+}
+
+int test_ctd_page_allocator_large_page_resize()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator wrapped_page_allocator = ctd_page_allocator_create_with_page_cache(100 * sizeof(char), 2, &heap_allocator);
+    ctd_allocator page_allocator = wrapped_page_allocator.allocator;
+
+    // A small block that is over-aligned enough gets a dedicated page too, and gives it back when freed
+    char* aligned_alloc = page_allocator.allocate(page_allocator.context, 10 * sizeof(char), 128);
+    if (aligned_alloc == NULL || (uintptr_t)aligned_alloc % 128 != 0) goto cleanup;
+    if (ctd_page_allocator_get_stats(&wrapped_page_allocator).large_pages != 1) goto cleanup;
+    page_allocator.deallocate(page_allocator.context, aligned_alloc, 10 * sizeof(char));
+    ctd_page_allocator_stats stats = ctd_page_allocator_get_stats(&wrapped_page_allocator);
+    if (stats.large_pages != 0 || stats.cached_pages != 1) goto cleanup;
+
+    // A shrunk block still releases its page when it is freed at its new size
+    char* large_alloc = page_allocator.allocate(page_allocator.context, 1000 * sizeof(char), alignof(char));
+    if (large_alloc == NULL) goto cleanup;
+    if (page_allocator.reallocate(page_allocator.context, large_alloc, 1000 * sizeof(char), 200 * sizeof(char), alignof(char)) != large_alloc) goto cleanup;
+    if (!ctd_allocator_try_resize(&page_allocator, large_alloc, 200 * sizeof(char), 150 * sizeof(char))) goto cleanup;
+    page_allocator.deallocate(page_allocator.context, large_alloc, 150 * sizeof(char));
+    stats = ctd_page_allocator_get_stats(&wrapped_page_allocator);
+    if (stats.large_pages != 0 || stats.cached_pages != 2) goto cleanup;
+
+    // Reallocate grows a block into the rest of its dedicated page instead of copying it
+    large_alloc = page_allocator.allocate(page_allocator.context, 200 * sizeof(char), alignof(char));
+    if (large_alloc == NULL) goto cleanup;
+    if (page_allocator.reallocate(page_allocator.context, large_alloc, 200 * sizeof(char), 900 * sizeof(char), alignof(char)) != large_alloc) goto cleanup;
+    if (ctd_page_allocator_get_stats(&wrapped_page_allocator).pages_allocated != 3) goto cleanup;
+
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 0;
+cleanup:
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 1;
+}
+
+int test_ctd_page_allocator_large_page_slots()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator wrapped_page_allocator = ctd_page_allocator_create(100 * sizeof(char), &heap_allocator);
+    ctd_allocator page_allocator = wrapped_page_allocator.allocator;
+    ctd_page_context* context = page_allocator.context;
+
+    // Freed large pages leave their slots to be reused, so the table doesn't grow with every large allocation
+    for (ptrdiff_t i = 0; i < 1000; i++)
+    {
+        char* large_alloc = page_allocator.allocate(page_allocator.context, 1000 * sizeof(char), alignof(char));
+        if (large_alloc == NULL) goto cleanup;
+        page_allocator.deallocate(page_allocator.context, large_alloc, 1000 * sizeof(char));
+    }
+    if (context->large_pages_live != 0 || context->large_pages_capacity > 8) goto cleanup;
+
+    // Rewinding releases the pages created after the save point, even when they reuse the slot of an older one
+    char* kept_alloc = page_allocator.allocate(page_allocator.context, 1000 * sizeof(char), alignof(char));
+    char* freed_alloc = page_allocator.allocate(page_allocator.context, 1000 * sizeof(char), alignof(char));
+    ctd_arena_save_point save_point = ctd_page_allocator_mark(&wrapped_page_allocator);
+    page_allocator.deallocate(page_allocator.context, freed_alloc, 1000 * sizeof(char));
+    for (ptrdiff_t i = 0; i < 3; i++)
+    {
+        if (page_allocator.allocate(page_allocator.context, 1000 * sizeof(char), alignof(char)) == NULL) goto cleanup;
+    }
+    if (context->large_pages_live != 4) goto cleanup;
+    ctd_page_allocator_rewind(&wrapped_page_allocator, save_point);
+    if (context->large_pages_live != 1) goto cleanup;
+    page_allocator.deallocate(page_allocator.context, kept_alloc, 1000 * sizeof(char));
+    if (context->large_pages_live != 0) goto cleanup;
+
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 0;
+cleanup:
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 1;
+}
+
+int test_ctd_page_allocator_scrub_policy()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator wrapped_page_allocator = ctd_page_allocator_create_with_options(100 * sizeof(char), 0, CTD_SCRUB_NONE, &heap_allocator);
+    const ctd_allocator page_allocator = wrapped_page_allocator.allocator;
+    if (page_allocator.context == NULL) return 1;
+
+    char* data_1 = page_allocator.allocate(page_allocator.context, 10 * sizeof(char), alignof(char));
+    char* data_2 = page_allocator.allocate(page_allocator.context, 10 * sizeof(char), alignof(char));
+    data_1[5] = 'a';
+    data_2[5] = 'b';
+    page_allocator.reallocate(page_allocator.context, data_1, 10 * sizeof(char), 5 * sizeof(char), alignof(char));
+    if (data_1[5] != 'a') goto cleanup;
+    page_allocator.deallocate(page_allocator.context, data_1, 5 * sizeof(char));
+    // The tail of a page is resized through its arena, which has to follow the same policy
+    page_allocator.reallocate(page_allocator.context, data_2, 10 * sizeof(char), 5 * sizeof(char), alignof(char));
+    if (data_2[5] != 'b') goto cleanup;
+
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 0;
+cleanup:
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 1;
+}
+
+int test_ctd_arena_scope()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator wrapped_page_allocator = ctd_page_allocator_create(100 * sizeof(char), &heap_allocator);
+    ctd_allocator page_allocator = wrapped_page_allocator.allocator;
+    ctd_page_context* context = page_allocator.context;
+
+    char* before_scope = page_allocator.allocate(page_allocator.context, 10 * sizeof(char), alignof(char));
+    ctd_arena_scope(outer_mark, &wrapped_page_allocator)
+    {
+        page_allocator.allocate(page_allocator.context, 80 * sizeof(char), alignof(char));
+        ctd_arena_scope(inner_mark, &wrapped_page_allocator)
+        {
+            page_allocator.allocate(page_allocator.context, 80 * sizeof(char), alignof(char));
+        }
+        if (context->arenas.length != 1) goto cleanup;
+    }
+    char* after_scope = page_allocator.allocate(page_allocator.context, 10 * sizeof(char), alignof(char));
+    if (after_scope != before_scope + 10) goto cleanup;
+
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 0;
+cleanup:
+    ctd_page_allocator_destroy(&wrapped_page_allocator);
+    return 1;
+}
+
 void test_ctd_page_allocator_functions()
 {
     int status;
@@ -119,7 +465,17 @@ void test_ctd_page_allocator_functions()
     RUN_TEST(ctd_page_allocator_create, status, number_of_tests_failed)
     RUN_TEST(ctd_page_allocator_allocate, status, number_of_tests_failed)
     RUN_TEST(ctd_page_allocator_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_page_allocator_reallocate_in_place, status, number_of_tests_failed)
+    RUN_TEST(ctd_page_allocator_try_resize, status, number_of_tests_failed)
+    RUN_TEST(ctd_page_allocator_allocate_sized, status, number_of_tests_failed)
+    RUN_TEST(ctd_page_allocator_batch, status, number_of_tests_failed)
     RUN_TEST(ctd_page_allocator_deallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_page_allocator_rewind, status, number_of_tests_failed)
+    RUN_TEST(ctd_page_allocator_large_pages, status, number_of_tests_failed)
+    RUN_TEST(ctd_page_allocator_large_page_resize, status, number_of_tests_failed)
+    RUN_TEST(ctd_page_allocator_large_page_slots, status, number_of_tests_failed)
+    RUN_TEST(ctd_page_allocator_scrub_policy, status, number_of_tests_failed)
+    RUN_TEST(ctd_arena_scope, status, number_of_tests_failed)
 
     if (number_of_tests_failed == 0)
     {
@@ -0,0 +1,187 @@
+#include <test_ctd_routing_allocator.h>
+#include <ctd_routing_allocator.h>
+#include <ctd_stats_allocator.h>
+#include <ctd_define.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdalign.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_ROUTING_SMALL_MAX_SIZE 256
+#define TEST_ROUTING_MEDIUM_MAX_SIZE ((ptrdiff_t)64 * 1024)
+
+/**
+ * Two tiers that count what they were sent, small blocks up to 256 bytes and medium blocks up to 64 KB, with anything
+ * larger mapped from the operating system.
+ */
+typedef struct test_routing_tiers
+{
+    ctd_stats_allocator small;
+    ctd_stats_allocator medium;
+    ctd_routing_allocator routing;
+} test_routing_tiers;
+
+static void test_routing_tiers_create(test_routing_tiers* tiers)
+{
+    tiers->small = ctd_stats_allocator_create(&ctd_heap_allocator_instance.allocator, false);
+    tiers->medium = ctd_stats_allocator_create(&ctd_heap_allocator_instance.allocator, false);
+    const ctd_routing_tier routes[] = {
+        {.max_size = TEST_ROUTING_SMALL_MAX_SIZE, .allocator = &tiers->small.allocator},
+        {.max_size = TEST_ROUTING_MEDIUM_MAX_SIZE, .allocator = &tiers->medium.allocator},
+    };
+    tiers->routing = ctd_routing_allocator_create(routes, countof(routes), &ctd_heap_allocator_instance.allocator);
+}
+
+static void test_routing_tiers_destroy(test_routing_tiers* tiers)
+{
+    ctd_routing_allocator_destroy(&tiers->routing);
+    ctd_stats_allocator_destroy(&tiers->medium);
+    ctd_stats_allocator_destroy(&tiers->small);
+}
+
+int test_ctd_routing_allocator_create()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    const ctd_routing_tier routes[] = {
+        {.max_size = 1024, .allocator = &heap_allocator},
+        {.max_size = 512, .allocator = &heap_allocator},
+    };
+
+    ctd_routing_allocator routing = ctd_routing_allocator_create(routes, countof(routes), &heap_allocator);
+    if (routing.allocator.context != NULL) return 1;
+    routing = ctd_routing_allocator_create(routes, CTD_ROUTING_MAX_TIERS + 1, &heap_allocator);
+    if (routing.allocator.context != NULL) return 1;
+
+    routing = ctd_routing_allocator_create(routes, 1, &heap_allocator);
+    const ctd_allocator allocator = routing.allocator;
+    if (allocator.context == NULL) return 1;
+    if (allocator.allocate == NULL || allocator.reallocate == NULL || allocator.deallocate == NULL) goto cleanup;
+    if (allocator.try_resize == NULL) goto cleanup;
+
+    ctd_routing_allocator_destroy(&routing);
+    if (routing.allocator.context != NULL) return 1;
+    return 0;
+cleanup:
+    ctd_routing_allocator_destroy(&routing);
+    return 1;
+}
+
+int test_ctd_routing_allocator_allocate()
+{
+    test_routing_tiers tiers;
+    test_routing_tiers_create(&tiers);
+    const ctd_allocator allocator = tiers.routing.allocator;
+    const ptrdiff_t huge_size = 2 * TEST_ROUTING_MEDIUM_MAX_SIZE;
+    char* huge = NULL;
+    if (allocator.context == NULL) goto cleanup;
+
+    char* small = allocator.allocate(allocator.context, TEST_ROUTING_SMALL_MAX_SIZE, alignof(max_align_t));
+    char* medium = allocator.allocate(allocator.context, TEST_ROUTING_SMALL_MAX_SIZE + 1, alignof(max_align_t));
+    huge = allocator.allocate(allocator.context, huge_size, alignof(max_align_t));
+    if (small == NULL || medium == NULL || huge == NULL) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&tiers.small).bytes_live != TEST_ROUTING_SMALL_MAX_SIZE) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&tiers.medium).bytes_live != TEST_ROUTING_SMALL_MAX_SIZE + 1) goto cleanup;
+    // Huge blocks are mapped straight from the operating system
+    if ((uintptr_t)huge % sysconf(_SC_PAGESIZE) != 0) goto cleanup;
+    memset(huge, 1, huge_size);
+
+    // Deallocation finds the tiers again from the sizes
+    allocator.deallocate(allocator.context, small, TEST_ROUTING_SMALL_MAX_SIZE);
+    allocator.deallocate(allocator.context, medium, TEST_ROUTING_SMALL_MAX_SIZE + 1);
+    allocator.deallocate(allocator.context, huge, huge_size);
+    huge = NULL;
+    if (ctd_stats_allocator_get_stats(&tiers.small).bytes_live != 0) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&tiers.medium).bytes_live != 0) goto cleanup;
+
+    // Huge blocks can't be aligned to more than a page
+    if (allocator.allocate(allocator.context, huge_size, 2 * sysconf(_SC_PAGESIZE)) != NULL) goto cleanup;
+
+    void* blocks[16];
+    if (!ctd_allocator_allocate_batch(&allocator, countof(blocks), 32, alignof(char), blocks)) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&tiers.small).bytes_live != countof(blocks) * 32) goto cleanup;
+    ctd_allocator_deallocate_batch(&allocator, countof(blocks), 32, blocks);
+    if (ctd_stats_allocator_get_stats(&tiers.small).bytes_live != 0) goto cleanup;
+
+    test_routing_tiers_destroy(&tiers);
+    return 0;
+cleanup:
+    if (huge != NULL) allocator.deallocate(allocator.context, huge, huge_size);
+    test_routing_tiers_destroy(&tiers);
+    return 1;
+}
+
+int test_ctd_routing_allocator_reallocate()
+{
+    test_routing_tiers tiers;
+    test_routing_tiers_create(&tiers);
+    const ctd_allocator allocator = tiers.routing.allocator;
+    char* block = NULL;
+    ptrdiff_t size = 100;
+    if (allocator.context == NULL) goto cleanup;
+
+    block = allocator.allocate(allocator.context, size, alignof(char));
+    if (block == NULL) goto cleanup;
+    for (ptrdiff_t i = 0; i < size; i++)
+    {
+        block[i] = (char)i;
+    }
+
+    // Within a tier, the tier reallocates the block itself
+    char* reallocated = allocator.reallocate(allocator.context, block, size, 200, alignof(char));
+    if (reallocated == NULL) goto cleanup;
+    block = reallocated;
+    size = 200;
+    if (ctd_stats_allocator_get_stats(&tiers.small).reallocations != 1) goto cleanup;
+
+    // Across tiers, the block moves from one to the other
+    const ptrdiff_t sizes[] = {1000, 3 * TEST_ROUTING_MEDIUM_MAX_SIZE, 5 * TEST_ROUTING_MEDIUM_MAX_SIZE, 50};
+    for (ptrdiff_t i = 0; i < countof(sizes); i++)
+    {
+        reallocated = allocator.reallocate(allocator.context, block, size, sizes[i], alignof(char));
+        if (reallocated == NULL) goto cleanup;
+        block = reallocated;
+        size = sizes[i];
+        for (ptrdiff_t j = 0; j < 50; j++)
+        {
+            if (block[j] != (char)j) goto cleanup;
+        }
+        if (i == 1) memset(block + 1000, 1, size - 1000);
+    }
+    if (ctd_stats_allocator_get_stats(&tiers.small).bytes_live != 50) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&tiers.medium).bytes_live != 0) goto cleanup;
+
+    // try_resize never moves a block to another tier
+    if (ctd_allocator_try_resize(&allocator, block, size, TEST_ROUTING_SMALL_MAX_SIZE + 1)) goto cleanup;
+
+    allocator.deallocate(allocator.context, block, size);
+    if (ctd_stats_allocator_get_stats(&tiers.small).bytes_live != 0) goto cleanup;
+
+    test_routing_tiers_destroy(&tiers);
+    return 0;
+cleanup:
+    if (block != NULL) allocator.deallocate(allocator.context, block, size);
+    test_routing_tiers_destroy(&tiers);
+    return 1;
+}
+
+void test_ctd_routing_allocator_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_routing_allocator Test ----------\n");
+
+    RUN_TEST(ctd_routing_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_routing_allocator_allocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_routing_allocator_reallocate, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_routing_allocator Test ----------\n\n");
+}
@@ -0,0 +1,85 @@
+#include <test_ctd_scrub.h>
+#include <ctd_scrub.h>
+#include <ctd_define.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+int test_ctd_scrub_policies()
+{
+    unsigned char block[64];
+
+    memset(block, 1, sizeof(block));
+    ctd_scrub_functions[CTD_SCRUB_NONE](block, sizeof(block));
+    for (ptrdiff_t i = 0; i < countof(block); i++)
+    {
+        if (block[i] != 1) return 1;
+    }
+
+    ctd_scrub_functions[CTD_SCRUB_ZERO](block, sizeof(block));
+    for (ptrdiff_t i = 0; i < countof(block); i++)
+    {
+        if (block[i] != 0) return 1;
+    }
+
+    ctd_scrub_functions[CTD_SCRUB_POISON](block + 8, 16);
+    for (ptrdiff_t i = 0; i < countof(block); i++)
+    {
+        const unsigned char expected = i >= 8 && i < 24 ? CTD_SCRUB_POISON_BYTE : 0;
+        if (block[i] != expected) return 1;
+    }
+
+    memset(block, 1, sizeof(block));
+    // Small regions are zeroed without any system calls
+    ctd_scrub_functions[CTD_SCRUB_RELEASE_PAGES](block, sizeof(block));
+    for (ptrdiff_t i = 0; i < countof(block); i++)
+    {
+        if (block[i] != 0) return 1;
+    }
+
+    return 0;
+}
+
+int test_ctd_scrub_release_pages()
+{
+    const ptrdiff_t size = 4 * CTD_SCRUB_RELEASE_PAGES_THRESHOLD;
+    unsigned char* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) return 1;
+    memset(data, 1, size);
+
+    // The region starts and ends partway through a page, so its edges have to be zeroed by hand
+    ctd_scrub_release_pages(data + 100, size - 200);
+    for (ptrdiff_t i = 0; i < size; i++)
+    {
+        const unsigned char expected = i >= 100 && i < size - 100 ? 0 : 1;
+        if (data[i] != expected) goto cleanup;
+    }
+
+    munmap(data, size);
+    return 0;
+cleanup:
+    munmap(data, size);
+    return 1;
+}
+
+void test_ctd_scrub_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_scrub Test ----------\n");
+
+    RUN_TEST(ctd_scrub_policies, status, number_of_tests_failed)
+    RUN_TEST(ctd_scrub_release_pages, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_scrub Test ----------\n\n");
+}
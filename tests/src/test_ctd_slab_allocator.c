@@ -0,0 +1,142 @@
+#include <test_ctd_slab_allocator.h>
+#include <ctd_slab_allocator.h>
+#include <ctd_page_allocator.h>
+#include <ctd_define.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+int test_ctd_slab_allocator_create()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_slab_allocator slab_allocator = ctd_slab_allocator_create(4096, &heap_allocator);
+    const ctd_allocator allocator = slab_allocator.allocator;
+    if (allocator.context == NULL) return 1;
+    if (allocator.allocate == NULL) goto cleanup;
+    if (allocator.reallocate == NULL) goto cleanup;
+    if (allocator.deallocate == NULL) goto cleanup;
+
+    ctd_slab_allocator_destroy(&slab_allocator);
+    return 0;
+cleanup:
+    ctd_slab_allocator_destroy(&slab_allocator);
+    return 1;
+}
+
+int test_ctd_slab_allocator_allocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_slab_allocator slab_allocator = ctd_slab_allocator_create(4096, &heap_allocator);
+    const ctd_allocator allocator = slab_allocator.allocator;
+
+    // More blocks than fit in one slab, so a second slab has to be taken from the parent allocator
+    uint64_t* blocks[600];
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        blocks[i] = allocator.allocate(allocator.context, 3 * sizeof(uint64_t), alignof(uint64_t));
+        if (blocks[i] == NULL) goto cleanup;
+        if ((uintptr_t)blocks[i] % alignof(uint64_t) != 0) goto cleanup;
+        blocks[i][0] = i;
+        blocks[i][2] = i;
+    }
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        if (blocks[i][0] != (uint64_t)i || blocks[i][2] != (uint64_t)i) goto cleanup;
+    }
+
+    char* large = allocator.allocate(allocator.context, 10000, alignof(char));
+    if (large == NULL) goto cleanup;
+    large[9999] = 1;
+    allocator.deallocate(allocator.context, large, 10000);
+
+    ctd_slab_allocator_destroy(&slab_allocator);
+    return 0;
+cleanup:
+    ctd_slab_allocator_destroy(&slab_allocator);
+    return 1;
+}
+
+int test_ctd_slab_allocator_reallocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_slab_allocator slab_allocator = ctd_slab_allocator_create(4096, &heap_allocator);
+    const ctd_allocator allocator = slab_allocator.allocator;
+
+    uint32_t* data_1 = allocator.allocate(allocator.context, 10 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_1 == NULL) goto cleanup;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        data_1[i] = i;
+    }
+    // 40 and 44 bytes share the 48 byte size class
+    uint32_t* data_2 = allocator.reallocate(allocator.context, data_1, 10 * sizeof(uint32_t), 11 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_2 != data_1) goto cleanup;
+    uint32_t* data_3 = allocator.reallocate(allocator.context, data_2, 11 * sizeof(uint32_t), 100 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_3 == NULL) goto cleanup;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        if (data_3[i] != i) goto cleanup;
+    }
+    uint32_t* data_4 = allocator.reallocate(allocator.context, data_3, 100 * sizeof(uint32_t), 1000 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_4 == NULL) goto cleanup;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        if (data_4[i] != i) goto cleanup;
+    }
+    allocator.deallocate(allocator.context, data_4, 1000 * sizeof(uint32_t));
+
+    ctd_slab_allocator_destroy(&slab_allocator);
+    return 0;
+cleanup:
+    ctd_slab_allocator_destroy(&slab_allocator);
+    return 1;
+}
+
+int test_ctd_slab_allocator_deallocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator page_allocator = ctd_page_allocator_create(4096, &heap_allocator);
+    ctd_slab_allocator slab_allocator = ctd_slab_allocator_create(4096, &page_allocator.allocator);
+    const ctd_allocator allocator = slab_allocator.allocator;
+
+    char* data_1 = allocator.allocate(allocator.context, 24, alignof(uint64_t));
+    char* data_2 = allocator.allocate(allocator.context, 24, alignof(uint64_t));
+    if (data_1 == NULL || data_2 == NULL) goto cleanup;
+    allocator.deallocate(allocator.context, data_1, 24);
+    allocator.deallocate(allocator.context, data_2, 24);
+    // Freed blocks are reused last in, first out
+    char* data_3 = allocator.allocate(allocator.context, 20, alignof(uint32_t));
+    char* data_4 = allocator.allocate(allocator.context, 32, alignof(uint64_t));
+    if (data_3 != data_2) goto cleanup;
+    if (data_4 != data_1) goto cleanup;
+
+    ctd_slab_allocator_destroy(&slab_allocator);
+    ctd_page_allocator_destroy(&page_allocator);
+    return 0;
+cleanup:
+    ctd_slab_allocator_destroy(&slab_allocator);
+    ctd_page_allocator_destroy(&page_allocator);
+    return 1;
+}
+
+void test_ctd_slab_allocator_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_slab_allocator Test ----------\n");
+
+    RUN_TEST(ctd_slab_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_slab_allocator_allocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_slab_allocator_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_slab_allocator_deallocate, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_slab_allocator Test ----------\n\n");
+}
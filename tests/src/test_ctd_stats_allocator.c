@@ -0,0 +1,143 @@
+#include <test_ctd_stats_allocator.h>
+#include <ctd_stats_allocator.h>
+#include <ctd_arena_allocator.h>
+#include <ctd_page_allocator.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+int test_ctd_stats_allocator_create()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_stats_allocator stats_allocator = ctd_stats_allocator_create(&heap_allocator, false);
+    const ctd_allocator allocator = stats_allocator.allocator;
+    if (allocator.context == NULL) return 1;
+    if (allocator.allocate == NULL) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&stats_allocator).allocations != 0) goto cleanup;
+
+    ctd_stats_allocator_destroy(&stats_allocator);
+    return 0;
+cleanup:
+    ctd_stats_allocator_destroy(&stats_allocator);
+    return 1;
+}
+
+int test_ctd_stats_allocator_counts()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_stats_allocator stats_allocator = ctd_stats_allocator_create(&heap_allocator, false);
+    const ctd_allocator allocator = stats_allocator.allocator;
+
+    char* data_1 = allocator.allocate(allocator.context, 100, alignof(char));
+    char* data_2 = allocator.allocate(allocator.context, 3000, alignof(char));
+    data_1 = allocator.reallocate(allocator.context, data_1, 100, 200, alignof(char));
+    ctd_allocator_stats stats = ctd_stats_allocator_get_stats(&stats_allocator);
+    if (stats.allocations != 2 || stats.reallocations != 1 || stats.deallocations != 0) goto cleanup;
+    if (stats.bytes_live != 3200) goto cleanup;
+    if (stats.bytes_allocated != 3200) goto cleanup;
+    // 100 is in [64, 128), 200 is in [128, 256), and 3000 is in [2048, 4096)
+    if (stats.size_histogram[7] != 1 || stats.size_histogram[8] != 1 || stats.size_histogram[12] != 1) goto cleanup;
+    if (stats.allocate_ns != 0) goto cleanup;
+
+    allocator.deallocate(allocator.context, data_2, 3000);
+    allocator.deallocate(allocator.context, data_1, 200);
+    stats = ctd_stats_allocator_get_stats(&stats_allocator);
+    if (stats.deallocations != 2) goto cleanup;
+    if (stats.bytes_live != 0) goto cleanup;
+    if (stats.peak_bytes_live != 3200) goto cleanup;
+
+    ctd_stats_allocator_reset_stats(&stats_allocator);
+    stats = ctd_stats_allocator_get_stats(&stats_allocator);
+    if (stats.allocations != 0 || stats.peak_bytes_live != 0) goto cleanup;
+
+    ctd_stats_allocator_destroy(&stats_allocator);
+    return 0;
+cleanup:
+    ctd_stats_allocator_destroy(&stats_allocator);
+    return 1;
+}
+
+int test_ctd_stats_allocator_failures()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_arena_allocator arena = ctd_arena_allocator_create(1000, &heap_allocator);
+    ctd_stats_allocator stats_allocator = ctd_stats_allocator_create(&arena.allocator, true);
+    const ctd_allocator allocator = stats_allocator.allocator;
+
+    if (allocator.allocate(allocator.context, 10, alignof(char)) == NULL) goto cleanup;
+    if (allocator.allocate(allocator.context, 10000, alignof(char)) != NULL) goto cleanup;
+    ctd_allocator_stats stats = ctd_stats_allocator_get_stats(&stats_allocator);
+    if (stats.failed_allocations != 1) goto cleanup;
+    if (stats.bytes_live != 10) goto cleanup;
+    if (stats.allocate_ns <= 0) goto cleanup;
+
+    ctd_stats_allocator_destroy(&stats_allocator);
+    ctd_arena_allocator_destroy(&arena, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_stats_allocator_destroy(&stats_allocator);
+    ctd_arena_allocator_destroy(&arena, &heap_allocator);
+    return 1;
+}
+
+int test_ctd_stats_allocator_optional_entries()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator page_allocator = ctd_page_allocator_create(1000, &heap_allocator);
+    ctd_stats_allocator stats_allocator = ctd_stats_allocator_create(&page_allocator.allocator, false);
+    const ctd_allocator allocator = stats_allocator.allocator;
+    void* blocks[4];
+
+    // Only the entries the page allocator has are forwarded
+    if (allocator.try_resize == NULL || allocator.allocate_batch == NULL || allocator.reallocate_sized != NULL) goto cleanup;
+
+    if (!ctd_allocator_allocate_batch(&allocator, 4, 16, alignof(char), blocks)) goto cleanup;
+    if (!ctd_allocator_try_resize(&allocator, blocks[3], 16, 32)) goto cleanup;
+    ctd_allocator_stats stats = ctd_stats_allocator_get_stats(&stats_allocator);
+    if (stats.allocations != 4 || stats.reallocations != 1) goto cleanup;
+    if (stats.bytes_live != 80) goto cleanup;
+    if (stats.size_histogram[5] != 4 || stats.size_histogram[6] != 1) goto cleanup;
+
+    allocator.deallocate(allocator.context, blocks[3], 32);
+    ctd_allocator_deallocate_batch(&allocator, 3, 16, blocks);
+    stats = ctd_stats_allocator_get_stats(&stats_allocator);
+    if (stats.deallocations != 4 || stats.bytes_live != 0) goto cleanup;
+
+    // A block with a dedicated page is live for its whole usable size
+    ptrdiff_t usable_size = 0;
+    char* large_block = ctd_allocator_allocate_sized(&allocator, 2000, alignof(char), &usable_size);
+    if (large_block == NULL) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&stats_allocator).bytes_live != usable_size) goto cleanup;
+    allocator.deallocate(allocator.context, large_block, usable_size);
+    if (ctd_stats_allocator_get_stats(&stats_allocator).bytes_live != 0) goto cleanup;
+
+    ctd_stats_allocator_destroy(&stats_allocator);
+    ctd_page_allocator_destroy(&page_allocator);
+    return 0;
+cleanup:
+    ctd_stats_allocator_destroy(&stats_allocator);
+    ctd_page_allocator_destroy(&page_allocator);
+    return 1;
+}
+
+void test_ctd_stats_allocator_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_stats_allocator Test ----------\n");
+
+    RUN_TEST(ctd_stats_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_stats_allocator_counts, status, number_of_tests_failed)
+    RUN_TEST(ctd_stats_allocator_failures, status, number_of_tests_failed)
+    RUN_TEST(ctd_stats_allocator_optional_entries, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_stats_allocator Test ----------\n\n");
+}
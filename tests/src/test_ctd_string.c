@@ -1,4 +1,9 @@
 #include <ctd_string.h>
+#include <ctd_arena_allocator.h>
+#include <ctd_page_allocator.h>
+#include <ctd_stats_allocator.h>
+#include <ctd_internal_string_search.h>
+#include <stdalign.h>
 #include <string.h>
 #include <test.h>
 
@@ -113,6 +118,89 @@ static int test_ctd_string_reverse_find()
     return 0;
 }
 
+static ptrdiff_t test_naive_find(const char* haystack, ptrdiff_t haystack_length, const char* needle, ptrdiff_t needle_length)
+{
+    for (ptrdiff_t i = 0; i + needle_length <= haystack_length; i++)
+    {
+        if (memcmp(haystack + i, needle, needle_length) == 0) return i;
+    }
+    return -1;
+}
+
+static ptrdiff_t test_naive_reverse_find(const char* haystack, ptrdiff_t haystack_length, const char* needle, ptrdiff_t needle_length)
+{
+    for (ptrdiff_t i = haystack_length - needle_length; i >= 0; i--)
+    {
+        if (memcmp(haystack + i, needle, needle_length) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * Checks every kernel the CPU supports against a naive search. Haystacks are made of two letters, so that almost every
+ * position is a candidate, and their lengths cross every block size the kernels use.
+ */
+static int test_ctd_string_find_kernels()
+{
+    char haystack[300];
+    char needle[20];
+    uint64_t random = 0x9E3779B97F4A7C15u;
+    for (ptrdiff_t level = 0; level <= ctd_string_search_supported_level(); level++)
+    {
+        for (ptrdiff_t round = 0; round < 2000; round++)
+        {
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            const ptrdiff_t haystack_length = (ptrdiff_t)(random % countof(haystack));
+            const ptrdiff_t needle_length = 1 + (ptrdiff_t)((random >> 16) % countof(needle));
+            for (ptrdiff_t i = 0; i < haystack_length; i++)
+            {
+                haystack[i] = (random >> (i % 61)) & 1 ? 'a' : 'b';
+            }
+            for (ptrdiff_t i = 0; i < needle_length; i++)
+            {
+                needle[i] = (random >> ((i * 7) % 59)) & 1 ? 'a' : 'b';
+            }
+
+            if (ctd_string_find_functions[level](haystack, haystack_length, needle, needle_length)
+                != test_naive_find(haystack, haystack_length, needle, needle_length)) return 1;
+            if (ctd_string_reverse_find_functions[level](haystack, haystack_length, needle, needle_length)
+                != test_naive_reverse_find(haystack, haystack_length, needle, needle_length)) return 1;
+        }
+    }
+    return 0;
+}
+
+static int test_ctd_string_find_long()
+{
+    ctd_error error = {0};
+    char data[100000];
+    memset(data, '.', sizeof(data));
+    memcpy(data + 12345, "needle", 6);
+    memcpy(data + 99990, "needle", 6);
+    const ctd_string str = {.data = data, .length = sizeof(data)};
+    const ctd_string substring = ctd_string_create_from_literal("needle");
+
+    ctd_option(ptrdiff_t) index = ctd_string_find(str, substring, 0, &error);
+    if (IS_NONE(index) || index.value != 12345) return 1;
+    index = ctd_string_find(str, substring, 12346, &error);
+    if (IS_NONE(index) || index.value != 99990) return 1;
+    index = ctd_string_find(str, substring, 99991, &error);
+    if (IS_SOME(index)) return 1;
+
+    index = ctd_string_reverse_find(str, substring, str.length, &error);
+    if (IS_NONE(index) || index.value != 99990) return 1;
+    // The match has to end by end, so one byte short of the last needle finds the first one
+    index = ctd_string_reverse_find(str, substring, 99995, &error);
+    if (IS_NONE(index) || index.value != 12345) return 1;
+    index = ctd_string_reverse_find(str, substring, 12350, &error);
+    if (IS_SOME(index)) return 1;
+    if (error.error_type != NO_ERROR) return 1;
+
+    return 0;
+}
+
 static int test_ctd_string_remove_whitespace()
 {
     ctd_error error = {0};
@@ -140,6 +228,44 @@ static int test_ctd_string_remove_whitespace()
     return 0;
 }
 
+static int test_ctd_string_remove_whitespace_long()
+{
+    ctd_error error = {0};
+    ctd_stats_allocator stats_allocator = ctd_stats_allocator_create(&ctd_heap_allocator_instance.allocator, false);
+    ctd_allocator allocator = stats_allocator.allocator;
+
+    // Short strings are stripped on the stack, so only the result is allocated
+    ctd_string short_str = ctd_string_create_from_literal(" a b c ");
+    ctd_string stripped = ctd_string_remove_whitespace(short_str, allocator, &error);
+    if (error.error_type != NO_ERROR) goto cleanup;
+    if (stripped.length != 3 || memcmp(stripped.data, "abc", 3) != 0) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&stats_allocator).allocations != 1) goto cleanup;
+    ctd_string_destroy(&stripped, allocator);
+
+    // Longer strings don't fit on the stack and are stripped in the allocator instead
+    char long_data[2000];
+    for (ptrdiff_t i = 0; i < countof(long_data); i++)
+    {
+        long_data[i] = i % 2 == 0 ? ' ' : (char)('a' + i % 26);
+    }
+    ctd_string long_str = {.data = long_data, .length = countof(long_data)};
+    stripped = ctd_string_remove_whitespace(long_str, allocator, &error);
+    if (error.error_type != NO_ERROR) goto cleanup;
+    if (stripped.length != 1000) goto cleanup;
+    for (ptrdiff_t i = 0; i < stripped.length; i++)
+    {
+        if (stripped.data[i] != long_data[2 * i + 1]) goto cleanup;
+    }
+    ctd_string_destroy(&stripped, allocator);
+    if (ctd_stats_allocator_get_stats(&stats_allocator).bytes_live != 0) goto cleanup;
+
+    ctd_stats_allocator_destroy(&stats_allocator);
+    return 0;
+cleanup:
+    ctd_stats_allocator_destroy(&stats_allocator);
+    return 1;
+}
+
 static int test_ctd_string_copy()
 {
     ctd_error error = {0};
@@ -338,6 +464,65 @@ cleanup:
     return 1;
 }
 
+static int test_ctd_string_builder_grow_in_place()
+{
+    ctd_error error = {0};
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_arena_allocator arena = ctd_arena_allocator_create(1000, &heap_allocator);
+    ctd_string_builder builder = ctd_string_builder_create(4, &arena.allocator, &error);
+    if (error.error_type != NO_ERROR) goto cleanup;
+    char* data = builder.data;
+
+    // The builder is the arena's only allocation, so it can keep growing without being copied
+    ctd_string str = ctd_string_create_from_literal("Hello there!");
+    for (ptrdiff_t i = 0; i < 20; i++)
+    {
+        ctd_string_builder_append(&builder, str, &error);
+        if (error.error_type != NO_ERROR) goto cleanup;
+    }
+    if (builder.data != data) goto cleanup;
+    if (ctd_arena_allocator_used(&arena) != builder.capacity) goto cleanup;
+    if (memcmp(builder.data + 19 * str.length, str.data, str.length) != 0) goto cleanup;
+
+    ctd_string_builder_destroy(&builder);
+    ctd_arena_allocator_destroy(&arena, &heap_allocator);
+    return 0;
+cleanup:
+    ctd_string_builder_destroy(&builder);
+    ctd_arena_allocator_destroy(&arena, &heap_allocator);
+    return 1;
+}
+
+static int test_ctd_string_builder_usable_capacity()
+{
+    ctd_error error = {0};
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator page = ctd_page_allocator_create(16, &heap_allocator);
+    // Leaves a 100 byte page in the free page cache
+    void* large_block = page.allocator.allocate(page.allocator.context, 100, alignof(char));
+    page.allocator.deallocate(page.allocator.context, large_block, 100);
+    // Too big for a default page, so the builder gets the cached page to itself and can use all of it
+    ctd_string_builder builder = ctd_string_builder_create(20, &page.allocator, &error);
+    if (error.error_type != NO_ERROR) goto cleanup;
+    if (builder.capacity != 100) goto cleanup;
+    const char* data = builder.data;
+
+    ctd_string str = ctd_string_create_from_literal("a");
+    for (ptrdiff_t i = 0; i < builder.capacity - 1; i++)
+    {
+        ctd_string_builder_append(&builder, str, &error);
+    }
+    if (error.error_type != NO_ERROR || builder.length != builder.capacity - 1 || builder.data != data) goto cleanup;
+
+    ctd_string_builder_destroy(&builder);
+    ctd_page_allocator_destroy(&page);
+    return 0;
+cleanup:
+    ctd_string_builder_destroy(&builder);
+    ctd_page_allocator_destroy(&page);
+    return 1;
+}
+
 static int test_ctd_string_builder_insert()
 {
     ctd_error error = {0};
@@ -627,6 +812,85 @@ cleanup:
     return 1;
 }
 
+/**
+ * Checks replacing against building the result naively, with substrings and replacements of every relative length.
+ * The replacements are made of the same bytes as the strings, so that a replacement that was searched again would
+ * show.
+ */
+static int test_ctd_string_builder_replace_all_random()
+{
+    ctd_error error = {0};
+    ctd_allocator allocator = ctd_heap_allocator_create().allocator;
+    ctd_string_builder builder = ctd_string_builder_create(1, &allocator, &error);
+    ctd_string_builder expected = ctd_string_builder_create(1, &allocator, &error);
+    if (error.error_type != NO_ERROR) goto cleanup;
+    char substring_data[4];
+    char replacement_data[7];
+    uint64_t random = 0x9E3779B97F4A7C15u;
+    for (ptrdiff_t round = 0; round < 2000; round++)
+    {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        const ctd_string substring = {.data = substring_data, .length = 1 + (ptrdiff_t)(random % countof(substring_data))};
+        const ctd_string replacement = {.data = replacement_data, .length = (ptrdiff_t)((random >> 8) % countof(replacement_data))};
+        const ptrdiff_t length = 1 + (ptrdiff_t)((random >> 16) % 64);
+        const ptrdiff_t start = (ptrdiff_t)((random >> 24) % length);
+        for (ptrdiff_t i = 0; i < substring.length; i++)
+        {
+            substring.data[i] = (random >> (32 + i)) & 1 ? 'a' : 'b';
+        }
+        for (ptrdiff_t i = 0; i < replacement.length; i++)
+        {
+            replacement.data[i] = (random >> (40 + i)) & 1 ? 'a' : 'b';
+        }
+
+        ctd_string_builder_clear(&builder);
+        ctd_string_builder_clear(&expected);
+        for (ptrdiff_t i = 0; i < length; i++)
+        {
+            // Mostly a, so that there are runs of instances that overlap
+            ctd_string_builder_push_back(&builder, (random >> (i % 61)) & 1 || (random >> ((i * 7) % 59)) & 1 ? 'a' : 'b', &error);
+        }
+        if (error.error_type != NO_ERROR) goto cleanup;
+
+        ptrdiff_t i = 0;
+        for (; i < start; i++)
+        {
+            ctd_string_builder_push_back(&expected, builder.data[i], &error);
+        }
+        while (i < length)
+        {
+            if (length - i >= substring.length && memcmp(builder.data + i, substring.data, substring.length) == 0)
+            {
+                ctd_string_builder_append(&expected, replacement, &error);
+                i += substring.length;
+            }
+            else
+            {
+                ctd_string_builder_push_back(&expected, builder.data[i++], &error);
+            }
+        }
+        if (error.error_type != NO_ERROR) goto cleanup;
+
+        ctd_string_builder_replace_all(&builder, substring, replacement, start, &error);
+        if (error.error_type != NO_ERROR) goto cleanup;
+        if (builder.length != expected.length || memcmp(builder.data, expected.data, expected.length) != 0) goto cleanup;
+    }
+
+    // Like find, starting at the end is out of range
+    ctd_string_builder_replace_all(&builder, ctd_string_create_from_literal("a"), ctd_string_create_from_literal(""), builder.length, &error);
+    if (error.error_type != INVALID_ARGUMENT) goto cleanup;
+
+    ctd_string_builder_destroy(&builder);
+    ctd_string_builder_destroy(&expected);
+    return 0;
+cleanup:
+    ctd_string_builder_destroy(&builder);
+    ctd_string_builder_destroy(&expected);
+    return 1;
+}
+
 static int test_ctd_string_builder_reverse()
 {
     ctd_error error = {0};
@@ -698,18 +962,24 @@ void test_ctd_string_functions()
     RUN_TEST(ctd_string_compare, status, number_of_tests_failed)
     RUN_TEST(ctd_string_find, status, number_of_tests_failed)
     RUN_TEST(ctd_string_reverse_find, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_find_kernels, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_find_long, status, number_of_tests_failed)
     RUN_TEST(ctd_string_remove_whitespace, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_remove_whitespace_long, status, number_of_tests_failed)
     RUN_TEST(ctd_string_copy, status, number_of_tests_failed)
     RUN_TEST(ctd_string_to_c_string, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_push_back, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_pop_back, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_append, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_builder_grow_in_place, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_builder_usable_capacity, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_insert, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_remove, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_find, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_contains, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_replace, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_replace_all, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_builder_replace_all_random, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_reverse, status, number_of_tests_failed)
     RUN_TEST(ctd_string_builder_clear, status, number_of_tests_failed)
 
@@ -0,0 +1,169 @@
+#include <test_ctd_string_hash.h>
+#include <ctd_string_hash.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Hashes every length up to a few blocks from a heap block of exactly that length, so that reading past the end of the
+ * string is caught by the address sanitizer, and checks that every seed and length gives a different hash and that known
+ * strings keep their hashes.
+ */
+int test_ctd_string_hash64()
+{
+    char* data = NULL;
+    uint64_t hashes[200];
+    for (ptrdiff_t length = 0; length < countof(hashes) / 2; length++)
+    {
+        // One byte more so that empty strings have a block too, put before the string so that it still ends the block
+        data = malloc(length + 1);
+        if (data == NULL) goto cleanup;
+        const ctd_string str = {.data = data + 1, .length = length};
+        for (ptrdiff_t i = 0; i < length; i++)
+        {
+            str.data[i] = (char)(i * 31);
+        }
+        hashes[2 * length] = ctd_string_hash64(str);
+        hashes[2 * length + 1] = ctd_string_hash64_seeded(str, 0x9E3779B97F4A7C15u);
+        if (ctd_string_hash64_seeded(str, 0) != hashes[2 * length]) goto cleanup;
+        if (ctd_string_hash64(str) != hashes[2 * length]) goto cleanup;
+        free(data);
+        data = NULL;
+    }
+
+    // Hashes can be stored, so they must not change by accident, nor with the byte order
+    static const char* const strings[] = {
+        "", "a", "abc", "message digest", "abcdefghijklmnopqrstuvwxyz",
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+        "12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+    };
+    static const uint64_t expected[] = {
+        0x93228a4de0eec5a2u, 0xc5bac3db178713c4u, 0xa97f2f7b1d9b3314u, 0x786d1f1df3801df4u,
+        0xdca5a8138ad37c87u, 0xb9e734f117cfaf70u, 0x6cc5eab49a92d617u,
+    };
+    for (ptrdiff_t i = 0; i < countof(strings); i++)
+    {
+        const ctd_string str = {.data = (char*)strings[i], .length = (ptrdiff_t)strlen(strings[i])};
+        // The seed is the index
+        if (ctd_string_hash64_seeded(str, (uint64_t)i) != expected[i]) goto cleanup;
+    }
+
+    for (ptrdiff_t i = 0; i < countof(hashes); i++)
+    {
+        for (ptrdiff_t j = 0; j < i; j++)
+        {
+            if (hashes[i] == hashes[j]) goto cleanup;
+        }
+    }
+    return 0;
+cleanup:
+    free(data);
+    return 1;
+}
+
+/**
+ * Flips every bit of a few strings that are short, as long as the tail and as long as several blocks, and checks that
+ * every bit of the hash flips about half of the time.
+ */
+int test_ctd_string_hash64_avalanche()
+{
+    static const ptrdiff_t lengths[] = {3, 8, 16, 40, 100};
+    char data[100];
+    for (ptrdiff_t i = 0; i < countof(data); i++)
+    {
+        data[i] = (char)(i * 7 + 1);
+    }
+    for (ptrdiff_t l = 0; l < countof(lengths); l++)
+    {
+        const ctd_string str = {.data = data, .length = lengths[l]};
+        const uint64_t hash = ctd_string_hash64(str);
+        ptrdiff_t flips[64] = {0};
+        for (ptrdiff_t bit = 0; bit < 8 * str.length; bit++)
+        {
+            data[bit / 8] ^= (char)(1 << (bit % 8));
+            const uint64_t difference = hash ^ ctd_string_hash64(str);
+            data[bit / 8] ^= (char)(1 << (bit % 8));
+            for (ptrdiff_t i = 0; i < countof(flips); i++)
+            {
+                flips[i] += (difference >> i) & 1;
+            }
+        }
+        for (ptrdiff_t i = 0; i < countof(flips); i++)
+        {
+            // Within 5 standard deviations of half of the flips, squared to stay in integers
+            const ptrdiff_t deviation = 2 * flips[i] - 8 * str.length;
+            if (deviation * deviation > 25 * 8 * str.length) return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Splits strings of every length up to a few blocks in every way into two or three pieces, and checks that hashing the
+ * pieces gives the same hash as hashing the whole string.
+ */
+int test_ctd_string_hasher()
+{
+    char data[110];
+    for (ptrdiff_t i = 0; i < countof(data); i++)
+    {
+        data[i] = (char)(i * 13 + 5);
+    }
+    for (ptrdiff_t length = 0; length <= countof(data); length++)
+    {
+        const ctd_string str = {.data = data, .length = length};
+        const uint64_t seed = (uint64_t)length * 0x9E3779B97F4A7C15u;
+        const uint64_t expected = ctd_string_hash64_seeded(str, seed);
+        for (ptrdiff_t first = 0; first <= length; first++)
+        {
+            ctd_string_hasher hasher = ctd_string_hasher_create(seed);
+            ctd_string_hasher_update(&hasher, (ctd_string) {.data = data, .length = first});
+            ctd_string_hasher_update(&hasher, (ctd_string) {.data = data + first, .length = length - first});
+            if (ctd_string_hasher_finish(&hasher) != expected) return 1;
+
+            // Three pieces, the last one of up to one block
+            const ptrdiff_t second = ctd_min(length, first + CTD_STRING_HASH_BLOCK);
+            hasher = ctd_string_hasher_create(seed);
+            ctd_string_hasher_update(&hasher, (ctd_string) {.data = data, .length = first});
+            ctd_string_hasher_update(&hasher, (ctd_string) {.data = data + first, .length = second - first});
+            ctd_string_hasher_update(&hasher, (ctd_string) {0});
+            ctd_string_hasher_update(&hasher, (ctd_string) {.data = data + second, .length = length - second});
+            if (ctd_string_hasher_finish(&hasher) != expected) return 1;
+        }
+
+        // A byte at a time, finishing along the way
+        ctd_string_hasher hasher = ctd_string_hasher_create(seed);
+        for (ptrdiff_t i = 0; i < length; i++)
+        {
+            if (ctd_string_hasher_finish(&hasher) != ctd_string_hash64_seeded((ctd_string) {.data = data, .length = i}, seed)) return 1;
+            ctd_string_hasher_update(&hasher, (ctd_string) {.data = data + i, .length = 1});
+        }
+        if (ctd_string_hasher_finish(&hasher) != expected) return 1;
+    }
+
+    ctd_string_hasher hasher = ctd_string_hasher_create(0);
+    if (ctd_string_hasher_finish(&hasher) != ctd_string_hash64((ctd_string) {0})) return 1;
+    return 0;
+}
+
+void test_ctd_string_hash_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_string_hash Test ----------\n");
+
+    RUN_TEST(ctd_string_hash64, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_hash64_avalanche, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_hasher, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_string_hash Test ----------\n\n");
+}
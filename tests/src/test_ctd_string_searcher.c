@@ -0,0 +1,306 @@
+#include <test_ctd_string_searcher.h>
+#include <ctd_string_searcher.h>
+#include <ctd_stats_allocator.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static ptrdiff_t test_naive_find(const char* haystack, ptrdiff_t haystack_length, const char* needle, ptrdiff_t needle_length)
+{
+    for (ptrdiff_t i = 0; i + needle_length <= haystack_length; i++)
+    {
+        if (memcmp(haystack + i, needle, needle_length) == 0) return i;
+    }
+    return -1;
+}
+
+static ptrdiff_t test_naive_reverse_find(const char* haystack, ptrdiff_t haystack_length, const char* needle, ptrdiff_t needle_length)
+{
+    for (ptrdiff_t i = haystack_length - needle_length; i >= 0; i--)
+    {
+        if (memcmp(haystack + i, needle, needle_length) == 0) return i;
+    }
+    return -1;
+}
+
+static uint64_t test_xorshift(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+int test_ctd_string_searcher_create()
+{
+    ctd_error error = {0};
+    ctd_stats_allocator stats = ctd_stats_allocator_create(&ctd_heap_allocator_instance.allocator, false);
+    char long_needle[CTD_STRING_SEARCHER_LONG_NEEDLE];
+    for (ptrdiff_t i = 0; i < countof(long_needle); i++)
+    {
+        long_needle[i] = (char)('a' + i % 26);
+    }
+
+    ctd_string_searcher searcher = ctd_string_searcher_create(ctd_string_create_from_literal("needle"), &stats.allocator, &error);
+    if (searcher.algorithm != CTD_STRING_SEARCHER_SIMD || searcher.needle.length != 6) goto cleanup;
+    if (memcmp(searcher.needle.data, "needle", 6) != 0) goto cleanup;
+    ctd_string_searcher_destroy(&searcher);
+
+    searcher = ctd_string_searcher_create(ctd_string_create_from_literal("The quick brown fox jumps over the lazy dog"), &stats.allocator, &error);
+    if (searcher.algorithm != CTD_STRING_SEARCHER_SIMD) goto cleanup;
+    ctd_string_searcher_destroy(&searcher);
+
+    searcher = ctd_string_searcher_create((ctd_string) {.data = long_needle, .length = sizeof(long_needle)}, &stats.allocator, &error);
+    if (searcher.algorithm != CTD_STRING_SEARCHER_HORSPOOL) goto cleanup;
+    // The needle is copied, so changing the original doesn't change what is searched for
+    long_needle[0] = 'z';
+    if (searcher.needle.data[0] != 'a') goto cleanup;
+    ctd_string_searcher_destroy(&searcher);
+    if (searcher.tables != NULL) goto cleanup;
+
+    searcher = ctd_string_searcher_create(ctd_string_create_from_literal("abababababababababababababababababababab"), &stats.allocator, &error);
+    if (searcher.algorithm != CTD_STRING_SEARCHER_TWO_WAY) goto cleanup;
+    ctd_string_searcher_destroy(&searcher);
+
+    // An empty needle is never found
+    searcher = ctd_string_searcher_create((ctd_string) {0}, &stats.allocator, &error);
+    if (IS_SOME(ctd_string_searcher_find(&searcher, ctd_string_create_from_literal("abc"), 0, &error))) goto cleanup;
+    if (ctd_string_searcher_find_all(&searcher, ctd_string_create_from_literal("abc"), NULL, NULL) != 0) goto cleanup;
+    ctd_string_searcher_destroy(&searcher);
+
+    if (error.error_type != NO_ERROR) goto cleanup;
+    if (ctd_stats_allocator_get_stats(&stats).bytes_live != 0) goto cleanup;
+    ctd_stats_allocator_destroy(&stats);
+    return 0;
+cleanup:
+    ctd_string_searcher_destroy(&searcher);
+    ctd_stats_allocator_destroy(&stats);
+    return 1;
+}
+
+/**
+ * Checks every algorithm against a naive search. Haystacks are made of two letters, where every long needle uses
+ * Two-Way, or of ten letters where long needles use the SIMD filter or Horspool, and half of the needles are cut out of
+ * the haystack so that there is something to find.
+ */
+int test_ctd_string_searcher_find()
+{
+    ctd_error error = {0};
+    const ptrdiff_t max_haystack_length = 4 * CTD_STRING_SEARCHER_LONG_NEEDLE;
+    char* haystack = malloc(max_haystack_length);
+    char* needle = malloc(max_haystack_length);
+    if (haystack == NULL || needle == NULL) goto cleanup;
+    uint64_t random = 0x9E3779B97F4A7C15u;
+    for (ptrdiff_t round = 0; round < 3000; round++)
+    {
+        const ptrdiff_t alphabet_size = round % 2 == 0 ? 2 : 10;
+        // Every tenth needle is long enough for Horspool
+        const ptrdiff_t max_needle_length = round % 10 == 1 ? 2 * CTD_STRING_SEARCHER_LONG_NEEDLE : 120;
+        const ptrdiff_t haystack_length = 1 + (ptrdiff_t)(test_xorshift(&random) % max_haystack_length);
+        const ptrdiff_t needle_length = 1 + (ptrdiff_t)(test_xorshift(&random) % max_needle_length);
+        for (ptrdiff_t i = 0; i < haystack_length; i++)
+        {
+            // Runs of the same letter make the ends of the window match far more often than they would at random
+            haystack[i] = test_xorshift(&random) % 4 == 0 ? (char)('a' + test_xorshift(&random) % alphabet_size) : 'a';
+        }
+        if (round % 4 < 2 && needle_length <= haystack_length)
+        {
+            const ptrdiff_t offset = (ptrdiff_t)(test_xorshift(&random) % (haystack_length - needle_length + 1));
+            memcpy(needle, haystack + offset, needle_length);
+        }
+        else
+        {
+            for (ptrdiff_t i = 0; i < needle_length; i++)
+            {
+                needle[i] = test_xorshift(&random) % 4 == 0 ? (char)('a' + test_xorshift(&random) % alphabet_size) : 'a';
+            }
+        }
+
+        const ctd_string str = {.data = haystack, .length = haystack_length};
+        ctd_string_searcher searcher = ctd_string_searcher_create((ctd_string) {.data = needle, .length = needle_length},
+                                                                  &ctd_heap_allocator_instance.allocator, &error);
+        if (error.error_type != NO_ERROR) goto cleanup;
+        const ptrdiff_t start = (ptrdiff_t)(test_xorshift(&random) % haystack_length);
+        const ptrdiff_t end = (ptrdiff_t)(test_xorshift(&random) % (haystack_length + 1));
+        const ptrdiff_t expected_find = test_naive_find(haystack + start, haystack_length - start, needle, needle_length);
+        const ptrdiff_t expected_reverse_find = test_naive_reverse_find(haystack, end, needle, needle_length);
+
+        const ctd_option(ptrdiff_t) index = ctd_string_searcher_find(&searcher, str, start, &error);
+        const ctd_option(ptrdiff_t) reverse_index = ctd_string_searcher_reverse_find(&searcher, str, end, &error);
+        ctd_string_searcher_destroy(&searcher);
+        if (expected_find < 0 ? IS_SOME(index) : IS_NONE(index) || index.value != start + expected_find) goto cleanup;
+        if (expected_reverse_find < 0 ? IS_SOME(reverse_index) : IS_NONE(reverse_index) || reverse_index.value != expected_reverse_find) goto cleanup;
+    }
+    free(needle);
+    free(haystack);
+    return 0;
+cleanup:
+    free(needle);
+    free(haystack);
+    return 1;
+}
+
+/**
+ * Searches a haystack that is all 'a' except for a single copy of the needle, with needles that are mostly 'a' as well.
+ * The bytes a plain search checks first match at almost every position, and the needle is only told apart from the
+ * haystack further along, which makes it quadratic.
+ *
+ * @param needle Needle to search for.
+ * @param needle_length Length of the needle.
+ * @param algorithm Algorithm the searcher is expected to choose.
+ */
+static int test_searcher_find_in_run(const char* needle, const ptrdiff_t needle_length, const ctd_string_searcher_algorithm algorithm)
+{
+    ctd_error error = {0};
+    const ptrdiff_t length = 1 << 20;
+    char* haystack = malloc(length);
+    if (haystack == NULL) return 1;
+    memset(haystack, 'a', length);
+    const ptrdiff_t match = length - 2 * needle_length;
+    memcpy(haystack + match, needle, needle_length);
+    const ctd_string str = {.data = haystack, .length = length};
+
+    ctd_string_searcher searcher = ctd_string_searcher_create((ctd_string) {.data = (char*)needle, .length = needle_length},
+                                                              &ctd_heap_allocator_instance.allocator, &error);
+    if (searcher.algorithm != algorithm) goto cleanup;
+    ctd_option(ptrdiff_t) index = ctd_string_searcher_find(&searcher, str, 0, &error);
+    if (IS_NONE(index) || index.value != match) goto cleanup;
+    index = ctd_string_searcher_find(&searcher, str, match + 1, &error);
+    if (IS_SOME(index)) goto cleanup;
+    index = ctd_string_searcher_reverse_find(&searcher, str, length, &error);
+    if (IS_NONE(index) || index.value != match) goto cleanup;
+    index = ctd_string_searcher_reverse_find(&searcher, str, match + needle_length - 1, &error);
+    if (IS_SOME(index)) goto cleanup;
+    if (error.error_type != NO_ERROR) goto cleanup;
+
+    ctd_string_searcher_destroy(&searcher);
+    free(haystack);
+    return 0;
+cleanup:
+    ctd_string_searcher_destroy(&searcher);
+    free(haystack);
+    return 1;
+}
+
+int test_ctd_string_searcher_find_worst_case()
+{
+    char needle[2 * CTD_STRING_SEARCHER_LONG_NEEDLE];
+    memset(needle, 'a', sizeof(needle));
+
+    // The prefix the SIMD filter searches for is found everywhere, so it hands over to Two-Way
+    memcpy(needle + 100, "bcdefghij", 9);
+    if (test_searcher_find_in_run(needle, 200, CTD_STRING_SEARCHER_SIMD)) return 1;
+    memset(needle + 100, 'a', 9);
+
+    // So are the last two bytes Horspool skips by
+    memcpy(needle, "bcdefghij", 9);
+    if (test_searcher_find_in_run(needle, sizeof(needle), CTD_STRING_SEARCHER_HORSPOOL)) return 1;
+    memset(needle, 'a', 9);
+
+    // A single different byte in the middle of a periodic needle
+    needle[100] = 'b';
+    if (test_searcher_find_in_run(needle, 200, CTD_STRING_SEARCHER_TWO_WAY)) return 1;
+
+    return 0;
+}
+
+int test_ctd_string_searcher_find_invalid()
+{
+    ctd_error error = {0};
+    ctd_string_searcher searcher = ctd_string_searcher_create(ctd_string_create_from_literal("needle"),
+                                                              &ctd_heap_allocator_instance.allocator, &error);
+    const ctd_string str = ctd_string_create_from_literal("haystack with a needle");
+
+    ctd_option(ptrdiff_t) index = ctd_string_searcher_find(&searcher, str, str.length, &error);
+    if (IS_SOME(index) || error.error_type != INVALID_ARGUMENT) goto cleanup;
+    error = (ctd_error) {0};
+    index = ctd_string_searcher_reverse_find(&searcher, str, str.length + 1, &error);
+    if (IS_SOME(index) || error.error_type != INVALID_ARGUMENT) goto cleanup;
+
+    ctd_string_searcher_destroy(&searcher);
+    return 0;
+cleanup:
+    ctd_string_searcher_destroy(&searcher);
+    return 1;
+}
+
+typedef struct test_searcher_matches
+{
+    ptrdiff_t indices[8];
+    ptrdiff_t count;
+    ptrdiff_t limit;
+} test_searcher_matches;
+
+static bool test_searcher_collect(void* user_data, ptrdiff_t index)
+{
+    test_searcher_matches* matches = user_data;
+    matches->indices[matches->count++] = index;
+    return matches->count < matches->limit;
+}
+
+int test_ctd_string_searcher_find_all()
+{
+    ctd_error error = {0};
+    ctd_string_searcher searcher = ctd_string_searcher_create(ctd_string_create_from_literal("aa"),
+                                                              &ctd_heap_allocator_instance.allocator, &error);
+    // Matches don't overlap
+    test_searcher_matches matches = {.limit = countof(matches.indices)};
+    if (ctd_string_searcher_find_all(&searcher, ctd_string_create_from_literal("aaaaa"), test_searcher_collect, &matches) != 2) goto cleanup;
+    if (matches.count != 2 || matches.indices[0] != 0 || matches.indices[1] != 2) goto cleanup;
+    ctd_string_searcher_destroy(&searcher);
+
+    char haystack[1000];
+    memset(haystack, '.', sizeof(haystack));
+    const ctd_string needle = ctd_string_create_from_literal("a needle longer than the prefix the SIMD kernels filter by");
+    const ptrdiff_t offsets[] = {0, 100, 158, 600, sizeof(haystack) - needle.length};
+    for (ptrdiff_t i = 0; i < countof(offsets); i++)
+    {
+        memcpy(haystack + offsets[i], needle.data, needle.length);
+    }
+    const ctd_string str = {.data = haystack, .length = sizeof(haystack)};
+    searcher = ctd_string_searcher_create(needle, &ctd_heap_allocator_instance.allocator, &error);
+
+    matches = (test_searcher_matches) {.limit = countof(matches.indices)};
+    if (ctd_string_searcher_find_all(&searcher, str, test_searcher_collect, &matches) != countof(offsets)) goto cleanup;
+    for (ptrdiff_t i = 0; i < countof(offsets); i++)
+    {
+        if (matches.indices[i] != offsets[i]) goto cleanup;
+    }
+    if (ctd_string_searcher_find_all(&searcher, str, NULL, NULL) != countof(offsets)) goto cleanup;
+
+    // The callback stops the search
+    matches = (test_searcher_matches) {.limit = 2};
+    if (ctd_string_searcher_find_all(&searcher, str, test_searcher_collect, &matches) != 2) goto cleanup;
+    if (matches.indices[1] != 100) goto cleanup;
+
+    ctd_string_searcher_destroy(&searcher);
+    if (error.error_type != NO_ERROR) return 1;
+    return 0;
+cleanup:
+    ctd_string_searcher_destroy(&searcher);
+    return 1;
+}
+
+void test_ctd_string_searcher_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_string_searcher Test ----------\n");
+
+    RUN_TEST(ctd_string_searcher_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_searcher_find, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_searcher_find_worst_case, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_searcher_find_invalid, status, number_of_tests_failed)
+    RUN_TEST(ctd_string_searcher_find_all, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_string_searcher Test ----------\n\n");
+}
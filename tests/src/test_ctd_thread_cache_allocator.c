@@ -0,0 +1,191 @@
+#include <test_ctd_thread_cache_allocator.h>
+#include <ctd_thread_cache_allocator.h>
+#include <ctd_slab_allocator.h>
+#include <ctd_define.h>
+#include <test.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+#define TEST_THREAD_COUNT 8
+#define TEST_THREAD_ITERATIONS 20000
+
+int test_ctd_thread_cache_allocator_create()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_thread_cache_allocator thread_cache_allocator = ctd_thread_cache_allocator_create(&heap_allocator);
+    const ctd_allocator allocator = thread_cache_allocator.allocator;
+    if (allocator.context == NULL) return 1;
+    if (allocator.allocate == NULL) goto cleanup;
+    if (allocator.reallocate == NULL) goto cleanup;
+    if (allocator.deallocate == NULL) goto cleanup;
+
+    ctd_thread_cache_allocator_destroy(&thread_cache_allocator);
+    return 0;
+cleanup:
+    ctd_thread_cache_allocator_destroy(&thread_cache_allocator);
+    return 1;
+}
+
+int test_ctd_thread_cache_allocator_allocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_thread_cache_allocator thread_cache_allocator = ctd_thread_cache_allocator_create(&heap_allocator);
+    const ctd_allocator allocator = thread_cache_allocator.allocator;
+
+    uint64_t* data_1 = allocator.allocate(allocator.context, 5 * sizeof(uint64_t), alignof(uint64_t));
+    if (data_1 == NULL) goto cleanup;
+    data_1[4] = 42;
+    // A freed block goes into the thread's magazine, and is the first one handed out again
+    allocator.deallocate(allocator.context, data_1, 5 * sizeof(uint64_t));
+    uint64_t* data_2 = allocator.allocate(allocator.context, 6 * sizeof(uint64_t), alignof(uint64_t));
+    if (data_2 != data_1) goto cleanup;
+
+    char* aligned = allocator.allocate(allocator.context, 64, 256);
+    if (aligned == NULL) goto cleanup;
+    if ((uintptr_t)aligned % 256 != 0) goto cleanup;
+    allocator.deallocate(allocator.context, aligned, 64);
+
+    char* large = allocator.allocate(allocator.context, 10000, alignof(char));
+    if (large == NULL) goto cleanup;
+    large[9999] = 1;
+    allocator.deallocate(allocator.context, large, 10000);
+    allocator.deallocate(allocator.context, data_2, 6 * sizeof(uint64_t));
+
+    ctd_thread_cache_allocator_destroy(&thread_cache_allocator);
+    return 0;
+cleanup:
+    ctd_thread_cache_allocator_destroy(&thread_cache_allocator);
+    return 1;
+}
+
+int test_ctd_thread_cache_allocator_reallocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_thread_cache_allocator thread_cache_allocator = ctd_thread_cache_allocator_create(&heap_allocator);
+    const ctd_allocator allocator = thread_cache_allocator.allocator;
+
+    uint32_t* data_1 = allocator.allocate(allocator.context, 10 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_1 == NULL) goto cleanup;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        data_1[i] = i;
+    }
+    // 40 and 44 bytes share the 48 byte size class
+    uint32_t* data_2 = allocator.reallocate(allocator.context, data_1, 10 * sizeof(uint32_t), 11 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_2 != data_1) goto cleanup;
+    uint32_t* data_3 = allocator.reallocate(allocator.context, data_2, 11 * sizeof(uint32_t), 1000 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_3 == NULL) goto cleanup;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        if (data_3[i] != i) goto cleanup;
+    }
+    allocator.deallocate(allocator.context, data_3, 1000 * sizeof(uint32_t));
+
+    ctd_thread_cache_allocator_destroy(&thread_cache_allocator);
+    return 0;
+cleanup:
+    ctd_thread_cache_allocator_destroy(&thread_cache_allocator);
+    return 1;
+}
+
+int test_ctd_thread_cache_allocator_batching()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_thread_cache_allocator thread_cache_allocator = ctd_thread_cache_allocator_create(&heap_allocator);
+    const ctd_allocator allocator = thread_cache_allocator.allocator;
+
+    void* blocks[10 * CTD_THREAD_CACHE_BATCH_SIZE];
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        blocks[i] = allocator.allocate(allocator.context, 32, alignof(max_align_t));
+        if (blocks[i] == NULL) goto cleanup;
+    }
+    // One acquisition creates the thread's cache, then each refill brings in a whole batch
+    if (ctd_thread_cache_allocator_lock_acquisitions(&thread_cache_allocator) != 1 + 10) goto cleanup;
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        allocator.deallocate(allocator.context, blocks[i], 32);
+    }
+    if (ctd_thread_cache_allocator_lock_acquisitions(&thread_cache_allocator) > 1 + 10 + 10) goto cleanup;
+    ctd_thread_cache_allocator_flush(&thread_cache_allocator);
+
+    ctd_thread_cache_allocator_destroy(&thread_cache_allocator);
+    return 0;
+cleanup:
+    ctd_thread_cache_allocator_destroy(&thread_cache_allocator);
+    return 1;
+}
+
+static void* test_thread_cache_worker(void* argument)
+{
+    const ctd_allocator* allocator = argument;
+    uint64_t* blocks[16] = {0};
+    for (ptrdiff_t i = 0; i < TEST_THREAD_ITERATIONS; i++)
+    {
+        const ptrdiff_t slot = i % countof(blocks);
+        const ptrdiff_t size = (slot + 1) * sizeof(uint64_t);
+        if (blocks[slot] != NULL)
+        {
+            if (blocks[slot][0] != (uint64_t)slot) return argument;
+            allocator->deallocate(allocator->context, blocks[slot], size);
+        }
+        blocks[slot] = allocator->allocate(allocator->context, size, alignof(uint64_t));
+        if (blocks[slot] == NULL) return argument;
+        blocks[slot][0] = slot;
+    }
+    for (ptrdiff_t slot = 0; slot < countof(blocks); slot++)
+    {
+        allocator->deallocate(allocator->context, blocks[slot], (slot + 1) * sizeof(uint64_t));
+    }
+
+    return NULL;
+}
+
+int test_ctd_thread_cache_allocator_threads()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    // The slab allocator isn't thread-safe, so this only works if every use of it is serialized
+    ctd_slab_allocator slab_allocator = ctd_slab_allocator_create(4096, &heap_allocator);
+    ctd_thread_cache_allocator thread_cache_allocator = ctd_thread_cache_allocator_create(&slab_allocator.allocator);
+    pthread_t threads[TEST_THREAD_COUNT];
+    int failed = 0;
+
+    for (ptrdiff_t i = 0; i < TEST_THREAD_COUNT; i++)
+    {
+        pthread_create(&threads[i], NULL, test_thread_cache_worker, &thread_cache_allocator.allocator);
+    }
+    for (ptrdiff_t i = 0; i < TEST_THREAD_COUNT; i++)
+    {
+        void* result;
+        pthread_join(threads[i], &result);
+        failed |= result != NULL;
+    }
+
+    ctd_thread_cache_allocator_destroy(&thread_cache_allocator);
+    ctd_slab_allocator_destroy(&slab_allocator);
+    return failed;
+}
+
+void test_ctd_thread_cache_allocator_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_thread_cache_allocator Test ----------\n");
+
+    RUN_TEST(ctd_thread_cache_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_thread_cache_allocator_allocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_thread_cache_allocator_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_thread_cache_allocator_batching, status, number_of_tests_failed)
+    RUN_TEST(ctd_thread_cache_allocator_threads, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_thread_cache_allocator Test ----------\n\n");
+}
@@ -0,0 +1,164 @@
+#include <test_ctd_tlsf_allocator.h>
+#include <ctd_tlsf_allocator.h>
+#include <ctd_define.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+// Every block has a 16 byte header, and the end of the region is marked by one more
+#define TEST_TLSF_HEADER_SIZE 16
+
+int test_ctd_tlsf_allocator_create()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_tlsf_allocator tlsf_allocator = ctd_tlsf_allocator_create(4096, &heap_allocator);
+    const ctd_allocator allocator = tlsf_allocator.allocator;
+    if (allocator.context == NULL) return 1;
+    if (allocator.allocate == NULL) goto cleanup;
+    if (allocator.reallocate == NULL) goto cleanup;
+    if (allocator.deallocate == NULL) goto cleanup;
+    if (ctd_tlsf_allocator_free_bytes(&tlsf_allocator) != 4096 - 2 * TEST_TLSF_HEADER_SIZE) goto cleanup;
+
+    ctd_tlsf_allocator_destroy(&tlsf_allocator);
+    // Too small for a single block
+    tlsf_allocator = ctd_tlsf_allocator_create(16, &heap_allocator);
+    if (tlsf_allocator.allocator.context != NULL) goto cleanup;
+
+    return 0;
+cleanup:
+    ctd_tlsf_allocator_destroy(&tlsf_allocator);
+    return 1;
+}
+
+int test_ctd_tlsf_allocator_allocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_tlsf_allocator tlsf_allocator = ctd_tlsf_allocator_create(1 << 16, &heap_allocator);
+    const ctd_allocator allocator = tlsf_allocator.allocator;
+
+    char* blocks[64];
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        const ptrdiff_t size = 1 + i * 13;
+        blocks[i] = allocator.allocate(allocator.context, size, alignof(char));
+        if (blocks[i] == NULL) goto cleanup;
+        if ((uintptr_t)blocks[i] % alignof(max_align_t) != 0) goto cleanup;
+        memset(blocks[i], (int)i, size);
+    }
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        if (blocks[i][i * 13] != (char)i) goto cleanup;
+    }
+
+    // Over-aligned blocks skip ahead, and the memory they skip stays free
+    char* aligned = allocator.allocate(allocator.context, 100, 4096);
+    if (aligned == NULL || (uintptr_t)aligned % 4096 != 0) goto cleanup;
+    allocator.deallocate(allocator.context, aligned, 100);
+
+    ptrdiff_t usable_size = 0;
+    char* sized = ctd_allocator_allocate_sized(&allocator, 20, alignof(char), &usable_size);
+    if (sized == NULL || usable_size != 32) goto cleanup;
+
+    // Bigger than the region
+    if (allocator.allocate(allocator.context, 1 << 17, alignof(char)) != NULL) goto cleanup;
+
+    ctd_tlsf_allocator_destroy(&tlsf_allocator);
+    return 0;
+cleanup:
+    ctd_tlsf_allocator_destroy(&tlsf_allocator);
+    return 1;
+}
+
+int test_ctd_tlsf_allocator_deallocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_tlsf_allocator tlsf_allocator = ctd_tlsf_allocator_create(1 << 16, &heap_allocator);
+    const ctd_allocator allocator = tlsf_allocator.allocator;
+    const ptrdiff_t initial_free_bytes = ctd_tlsf_allocator_free_bytes(&tlsf_allocator);
+
+    char* blocks[64];
+    ptrdiff_t sizes[64];
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        sizes[i] = 32 + (i * 37) % 500;
+        blocks[i] = allocator.allocate(allocator.context, sizes[i], alignof(char));
+        if (blocks[i] == NULL) goto cleanup;
+        blocks[i][16] = 1;
+    }
+
+    // Freed in an arbitrary order, and merged back into a single block. The start of a free block holds its free list
+    // pointers, so only what comes after them stays scrubbed
+    for (ptrdiff_t i = 0; i < countof(blocks); i++)
+    {
+        const ptrdiff_t index = (i * 23) % countof(blocks);
+        allocator.deallocate(allocator.context, blocks[index], sizes[index]);
+        if (blocks[index][16] != 0) goto cleanup;
+    }
+    if (ctd_tlsf_allocator_free_bytes(&tlsf_allocator) != initial_free_bytes) goto cleanup;
+    if (allocator.allocate(allocator.context, initial_free_bytes, alignof(char)) != blocks[0]) goto cleanup;
+
+    ctd_tlsf_allocator_destroy(&tlsf_allocator);
+    return 0;
+cleanup:
+    ctd_tlsf_allocator_destroy(&tlsf_allocator);
+    return 1;
+}
+
+int test_ctd_tlsf_allocator_reallocate()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_tlsf_allocator tlsf_allocator = ctd_tlsf_allocator_create(4096, &heap_allocator);
+    const ctd_allocator allocator = tlsf_allocator.allocator;
+
+    char* first = allocator.allocate(allocator.context, 64, alignof(char));
+    char* second = allocator.allocate(allocator.context, 64, alignof(char));
+    char* third = allocator.allocate(allocator.context, 64, alignof(char));
+    if (first == NULL || second == NULL || third == NULL) goto cleanup;
+    memset(first, 1, 64);
+
+    // second is in the way
+    if (ctd_allocator_try_resize(&allocator, first, 64, 100)) goto cleanup;
+    char* moved = allocator.reallocate(allocator.context, first, 64, 100, alignof(char));
+    if (moved == NULL || moved == first || moved[63] != 1) goto cleanup;
+
+    // Growing into the free block after it
+    allocator.deallocate(allocator.context, third, 64);
+    if (ctd_allocator_try_resize(&allocator, second, 64, 150)) goto cleanup;
+    if (!ctd_allocator_try_resize(&allocator, second, 64, 120)) goto cleanup;
+    if (allocator.reallocate(allocator.context, second, 120, 64, alignof(char)) != second) goto cleanup;
+
+    // Shrinking gives the end of the block back, which merges with the free memory after it, header and all
+    const ptrdiff_t free_bytes = ctd_tlsf_allocator_free_bytes(&tlsf_allocator);
+    moved[99] = 1;
+    if (allocator.reallocate(allocator.context, moved, 100, 32, alignof(char)) != moved) goto cleanup;
+    if (moved[99] != 0) goto cleanup;
+    if (ctd_tlsf_allocator_free_bytes(&tlsf_allocator) != free_bytes + 112 - 32) goto cleanup;
+
+    ctd_tlsf_allocator_destroy(&tlsf_allocator);
+    return 0;
+cleanup:
+    ctd_tlsf_allocator_destroy(&tlsf_allocator);
+    return 1;
+}
+
+void test_ctd_tlsf_allocator_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_tlsf_allocator Test ----------\n");
+
+    RUN_TEST(ctd_tlsf_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_tlsf_allocator_allocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_tlsf_allocator_deallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_tlsf_allocator_reallocate, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_tlsf_allocator Test ----------\n\n");
+}
@@ -0,0 +1,205 @@
+#include <test_ctd_trace_allocator.h>
+#include <ctd_trace_allocator.h>
+#include <ctd_arena_allocator.h>
+#include <ctd_page_allocator.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+int test_ctd_trace_allocator_create()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    FILE* trace = tmpfile();
+    if (trace == NULL) return 1;
+    ctd_trace_allocator trace_allocator = ctd_trace_allocator_create(&heap_allocator, trace);
+    if (trace_allocator.allocator.context == NULL) goto cleanup;
+    ctd_trace_allocator_destroy(&trace_allocator);
+
+    // An empty trace is just the header
+    ctd_error error = {0};
+    rewind(trace);
+    ctd_trace_reader reader = ctd_trace_reader_create(trace, &error);
+    if (error.error_type != NO_ERROR) goto cleanup;
+    ctd_trace_record record;
+    if (ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+    if (error.error_type != NO_ERROR) goto cleanup;
+
+    fclose(trace);
+    return 0;
+cleanup:
+    fclose(trace);
+    return 1;
+}
+
+int test_ctd_trace_allocator_records()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    FILE* trace = tmpfile();
+    if (trace == NULL) return 1;
+    ctd_trace_allocator trace_allocator = ctd_trace_allocator_create(&heap_allocator, trace);
+    const ctd_allocator allocator = trace_allocator.allocator;
+
+    char* data_1 = allocator.allocate(allocator.context, 100, alignof(char));
+    char* data_2 = allocator.allocate(allocator.context, 3000, 64);
+    char* data_3 = allocator.reallocate(allocator.context, data_1, 100, 200, alignof(char));
+    allocator.deallocate(allocator.context, data_2, 3000);
+    allocator.deallocate(allocator.context, data_3, 200);
+    if (!ctd_trace_allocator_flush(&trace_allocator)) goto cleanup;
+
+    ctd_error error = {0};
+    rewind(trace);
+    ctd_trace_reader reader = ctd_trace_reader_create(trace, &error);
+    ctd_trace_record record;
+    if (!ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+    if (record.operation != CTD_TRACE_ALLOCATE || record.size != 100 || record.align != 1) goto cleanup;
+    if (record.result != (uintptr_t)data_1) goto cleanup;
+    const uint64_t first_timestamp = record.timestamp_ns;
+
+    if (!ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+    if (record.operation != CTD_TRACE_ALLOCATE || record.size != 3000 || record.align != 64) goto cleanup;
+    if (record.result != (uintptr_t)data_2) goto cleanup;
+    if (record.timestamp_ns < first_timestamp) goto cleanup;
+
+    if (!ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+    if (record.operation != CTD_TRACE_REALLOCATE || record.old_size != 100 || record.size != 200) goto cleanup;
+    if (record.source != (uintptr_t)data_1 || record.result != (uintptr_t)data_3) goto cleanup;
+
+    if (!ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+    if (record.operation != CTD_TRACE_DEALLOCATE || record.source != (uintptr_t)data_2 || record.size != 3000) goto cleanup;
+    if (!ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+    if (record.operation != CTD_TRACE_DEALLOCATE || record.source != (uintptr_t)data_3 || record.size != 200) goto cleanup;
+
+    if (ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+    if (error.error_type != NO_ERROR) goto cleanup;
+
+    ctd_trace_allocator_destroy(&trace_allocator);
+    fclose(trace);
+    return 0;
+cleanup:
+    ctd_trace_allocator_destroy(&trace_allocator);
+    fclose(trace);
+    return 1;
+}
+
+int test_ctd_trace_allocator_failures()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_arena_allocator arena = ctd_arena_allocator_create(sizeof(ctd_trace_allocator) + CTD_TRACE_BUFFER_SIZE + 1000, &heap_allocator);
+    FILE* trace = tmpfile();
+    if (trace == NULL) return 1;
+    ctd_trace_allocator trace_allocator = ctd_trace_allocator_create(&arena.allocator, trace);
+    const ctd_allocator allocator = trace_allocator.allocator;
+
+    // A failed call is recorded with a NULL result, and doesn't disturb the addresses after it
+    char* data_1 = allocator.allocate(allocator.context, 10, alignof(char));
+    if (allocator.allocate(allocator.context, 10000, alignof(char)) != NULL) goto cleanup;
+    char* data_2 = allocator.allocate(allocator.context, 10, alignof(char));
+    ctd_trace_allocator_destroy(&trace_allocator);
+
+    ctd_error error = {0};
+    rewind(trace);
+    ctd_trace_reader reader = ctd_trace_reader_create(trace, &error);
+    ctd_trace_record record;
+    if (!ctd_trace_reader_next(&reader, &record, &error) || record.result != (uintptr_t)data_1) goto cleanup;
+    if (!ctd_trace_reader_next(&reader, &record, &error) || record.result != 0) goto cleanup;
+    if (!ctd_trace_reader_next(&reader, &record, &error) || record.result != (uintptr_t)data_2) goto cleanup;
+
+    // A trace cut off partway through a record is an error, not the end of the trace
+    rewind(trace);
+    FILE* truncated = tmpfile();
+    if (truncated == NULL) goto cleanup;
+    char bytes[64];
+    const ptrdiff_t length = (ptrdiff_t)fread(bytes, 1, sizeof(bytes), trace);
+    fwrite(bytes, 1, length - 1, truncated);
+    rewind(truncated);
+    reader = ctd_trace_reader_create(truncated, &error);
+    while (ctd_trace_reader_next(&reader, &record, &error));
+    fclose(truncated);
+    if (error.error_type != FILE_IO) goto cleanup;
+
+    // Anything that isn't a trace is rejected up front
+    error = (ctd_error) {0};
+    rewind(trace);
+    fputs("NOTATRACE", trace);
+    rewind(trace);
+    ctd_trace_reader_create(trace, &error);
+    if (error.error_type != FILE_IO) goto cleanup;
+
+    fclose(trace);
+    ctd_arena_allocator_destroy(&arena, &heap_allocator);
+    return 0;
+cleanup:
+    fclose(trace);
+    ctd_arena_allocator_destroy(&arena, &heap_allocator);
+    return 1;
+}
+
+int test_ctd_trace_allocator_optional_entries()
+{
+    ctd_allocator heap_allocator = ctd_heap_allocator_create().allocator;
+    ctd_page_allocator page_allocator = ctd_page_allocator_create(1000, &heap_allocator);
+    FILE* trace = tmpfile();
+    if (trace == NULL) return 1;
+    ctd_trace_allocator trace_allocator = ctd_trace_allocator_create(&page_allocator.allocator, trace);
+    const ctd_allocator allocator = trace_allocator.allocator;
+    void* blocks[2];
+
+    // Only the entries the page allocator has are forwarded
+    if (allocator.try_resize == NULL || allocator.allocate_batch == NULL || allocator.reallocate_sized != NULL) goto cleanup;
+
+    if (!ctd_allocator_allocate_batch(&allocator, 2, 16, 8, blocks)) goto cleanup;
+    if (!ctd_allocator_try_resize(&allocator, blocks[1], 16, 32)) goto cleanup;
+    ctd_allocator_deallocate_batch(&allocator, 1, 16, blocks);
+    if (!ctd_trace_allocator_flush(&trace_allocator)) goto cleanup;
+
+    ctd_error error = {0};
+    rewind(trace);
+    ctd_trace_reader reader = ctd_trace_reader_create(trace, &error);
+    ctd_trace_record record;
+    for (ptrdiff_t i = 0; i < 2; i++)
+    {
+        if (!ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+        if (record.operation != CTD_TRACE_ALLOCATE || record.size != 16 || record.align != 8) goto cleanup;
+        if (record.result != (uintptr_t)blocks[i]) goto cleanup;
+    }
+    // A resize in place is a reallocation that returned the same block
+    if (!ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+    if (record.operation != CTD_TRACE_REALLOCATE || record.old_size != 16 || record.size != 32) goto cleanup;
+    if (record.source != (uintptr_t)blocks[1] || record.result != (uintptr_t)blocks[1]) goto cleanup;
+    if (!ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+    if (record.operation != CTD_TRACE_DEALLOCATE || record.source != (uintptr_t)blocks[0] || record.size != 16) goto cleanup;
+    if (ctd_trace_reader_next(&reader, &record, &error)) goto cleanup;
+    if (error.error_type != NO_ERROR) goto cleanup;
+
+    ctd_trace_allocator_destroy(&trace_allocator);
+    ctd_page_allocator_destroy(&page_allocator);
+    fclose(trace);
+    return 0;
+cleanup:
+    ctd_trace_allocator_destroy(&trace_allocator);
+    ctd_page_allocator_destroy(&page_allocator);
+    fclose(trace);
+    return 1;
+}
+
+void test_ctd_trace_allocator_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_trace_allocator Test ----------\n");
+
+    RUN_TEST(ctd_trace_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_trace_allocator_records, status, number_of_tests_failed)
+    RUN_TEST(ctd_trace_allocator_failures, status, number_of_tests_failed)
+    RUN_TEST(ctd_trace_allocator_optional_entries, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_trace_allocator Test ----------\n\n");
+}
@@ -0,0 +1,135 @@
+#include <test_ctd_virtual_arena_allocator.h>
+#include <ctd_virtual_arena_allocator.h>
+#include <ctd_arena_scope.h>
+#include <test.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+typedef struct ctd_virtual_arena_context
+{
+    ptrdiff_t length;
+    ptrdiff_t committed;
+    ptrdiff_t reserved;
+    ptrdiff_t commit_granularity;
+} ctd_virtual_arena_context;
+
+int test_ctd_virtual_arena_allocator_create()
+{
+    ctd_virtual_arena_allocator virtual_arena = ctd_virtual_arena_allocator_create((ptrdiff_t)1 << 30);
+    ctd_virtual_arena_context* context = virtual_arena.allocator.context;
+    if (context == NULL) return 1;
+    if (context->reserved < (ptrdiff_t)1 << 30) goto cleanup;
+    if (context->committed >= context->reserved) goto cleanup;
+
+    ctd_virtual_arena_allocator_destroy(&virtual_arena);
+    return 0;
+cleanup:
+    ctd_virtual_arena_allocator_destroy(&virtual_arena);
+    return 1;
+}
+
+int test_ctd_virtual_arena_allocator_allocate()
+{
+    ctd_virtual_arena_allocator virtual_arena = ctd_virtual_arena_allocator_create((ptrdiff_t)1 << 30);
+    const ctd_allocator arena = virtual_arena.allocator;
+    ctd_virtual_arena_context* context = arena.context;
+
+    uint64_t* first_alloc = arena.allocate(context, 4 * sizeof(uint64_t), alignof(uint64_t));
+    if (first_alloc == NULL) goto cleanup;
+    if ((uintptr_t)first_alloc % alignof(uint64_t) != 0) goto cleanup;
+    first_alloc[0] = 42;
+
+    // Larger than the first committed chunk, so more pages have to be committed
+    const ptrdiff_t large_size = 10 * 1024 * 1024;
+    char* large_alloc = arena.allocate(context, large_size, alignof(char));
+    if (large_alloc == NULL) goto cleanup;
+    large_alloc[0] = 1;
+    large_alloc[large_size - 1] = 1;
+    if (context->committed < large_size) goto cleanup;
+    if (first_alloc[0] != 42) goto cleanup;
+
+    if (arena.allocate(context, (ptrdiff_t)2 << 30, alignof(char)) != NULL) goto cleanup;
+
+    ctd_virtual_arena_allocator_destroy(&virtual_arena);
+    return 0;
+cleanup:
+    ctd_virtual_arena_allocator_destroy(&virtual_arena);
+    return 1;
+}
+
+int test_ctd_virtual_arena_allocator_reallocate()
+{
+    ctd_virtual_arena_allocator virtual_arena = ctd_virtual_arena_allocator_create((ptrdiff_t)1 << 30);
+    const ctd_allocator arena = virtual_arena.allocator;
+
+    uint32_t* data_1 = arena.allocate(arena.context, 4 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_1 == NULL) goto cleanup;
+    data_1[3] = 7;
+    // The tail allocation grows in place, even across many committed chunks
+    uint32_t* data_2 = arena.reallocate(arena.context, data_1, 4 * sizeof(uint32_t), 1024 * 1024 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_2 != data_1) goto cleanup;
+    data_2[1024 * 1024 - 1] = 8;
+
+    uint32_t* other = arena.allocate(arena.context, sizeof(uint32_t), alignof(uint32_t));
+    if (other == NULL) goto cleanup;
+    uint32_t* data_3 = arena.reallocate(arena.context, data_2, 1024 * 1024 * sizeof(uint32_t), 2 * 1024 * 1024 * sizeof(uint32_t), alignof(uint32_t));
+    if (data_3 == NULL) goto cleanup;
+    if (data_3[3] != 7) goto cleanup;
+    if (data_3[1024 * 1024 - 1] != 8) goto cleanup;
+
+    ctd_virtual_arena_allocator_destroy(&virtual_arena);
+    return 0;
+cleanup:
+    ctd_virtual_arena_allocator_destroy(&virtual_arena);
+    return 1;
+}
+
+int test_ctd_virtual_arena_allocator_reset()
+{
+    ctd_virtual_arena_allocator virtual_arena = ctd_virtual_arena_allocator_create((ptrdiff_t)1 << 30);
+    const ctd_allocator arena = virtual_arena.allocator;
+    ctd_virtual_arena_context* context = arena.context;
+    const ptrdiff_t initial_length = context->length;
+    const ptrdiff_t initial_committed = context->committed;
+
+    char* first_alloc = arena.allocate(context, 16, alignof(char));
+    ctd_arena_save_point save_point = ctd_arena_mark(&virtual_arena);
+    char* second_alloc = arena.allocate(context, 1024 * 1024, alignof(char));
+    if (second_alloc == NULL) goto cleanup;
+    second_alloc[1024 * 1024 - 1] = 1;
+    ctd_arena_rewind(&virtual_arena, save_point);
+    if (arena.allocate(context, 1024 * 1024, alignof(char)) != second_alloc) goto cleanup;
+
+    ctd_arena_reset(&virtual_arena);
+    if (context->length != initial_length) goto cleanup;
+    if (context->committed != initial_committed) goto cleanup;
+    if (arena.allocate(context, 16, alignof(char)) != first_alloc) goto cleanup;
+
+    ctd_virtual_arena_allocator_destroy(&virtual_arena);
+    return 0;
+cleanup:
+    ctd_virtual_arena_allocator_destroy(&virtual_arena);
+    return 1;
+}
+
+void test_ctd_virtual_arena_allocator_functions()
+{
+    int status;
+    uint32_t number_of_tests_failed = 0;
+    printf("---------- Begin ctd_virtual_arena_allocator Test ----------\n");
+
+    RUN_TEST(ctd_virtual_arena_allocator_create, status, number_of_tests_failed)
+    RUN_TEST(ctd_virtual_arena_allocator_allocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_virtual_arena_allocator_reallocate, status, number_of_tests_failed)
+    RUN_TEST(ctd_virtual_arena_allocator_reset, status, number_of_tests_failed)
+
+    if (number_of_tests_failed == 0)
+    {
+        printf("\x1b[32mAll tests passed!\x1b[0m\n");
+    }
+    else
+    {
+        printf("\x1b[31m%u tests failed.\x1b[0m\n", number_of_tests_failed);
+    }
+    printf("---------- End ctd_virtual_arena_allocator Test ----------\n\n");
+}